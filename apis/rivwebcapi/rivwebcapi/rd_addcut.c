@@ -28,6 +28,7 @@
 #include "rd_addcut.h"
 #include "rd_common.h"
 #include "rd_getuseragent.h"
+#include "rd_session.h"
 
 struct xml_data {
   char elem_name[256];
@@ -231,7 +232,7 @@ int RD_AddCut(struct rd_cut *cut[],
   struct curl_httppost *first=NULL;
   struct curl_httppost *last=NULL;
 
-  if((curl=curl_easy_init())==NULL) {
+  if((curl=RD_CurlInit())==NULL) {
     curl_easy_cleanup(curl);
     return -1;
   }
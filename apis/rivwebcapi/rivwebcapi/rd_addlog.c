@@ -23,6 +23,7 @@
 
 #include "rd_addlog.h"
 #include "rd_getuseragent.h"
+#include "rd_session.h"
 
 int RD_AddLog(const char hostname[],
 	      const char username[],
@@ -41,7 +42,7 @@ int RD_AddLog(const char hostname[],
   struct curl_httppost *first=NULL;
   struct curl_httppost *last=NULL;
 
-  if((curl=curl_easy_init())==NULL) {
+  if((curl=RD_CurlInit())==NULL) {
     curl_easy_cleanup(curl);
     return -1;
   }
@@ -27,6 +27,7 @@
 #include "rd_common.h"
 #include "rd_audiostore.h"
 #include "rd_getuseragent.h"
+#include "rd_session.h"
 
 struct xml_data {
   char elem_name[256];
@@ -104,7 +105,7 @@ int RD_AudioStore(struct rd_audiostore *audiosto[],
    /* Set number of recs so if fail already set */
   *numrecs = 0;
 
-  if((curl=curl_easy_init())==NULL) {
+  if((curl=RD_CurlInit())==NULL) {
     curl_easy_cleanup(curl);
     return -1;
   }
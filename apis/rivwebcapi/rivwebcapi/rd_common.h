@@ -39,6 +39,11 @@
 
 #define RIVC_DEBUG_OUT  Uncomment for stderr output */
 
+/*
+ * Carts requested per page by RD_ListCarts() and RD_ListCartsCuts()
+ */
+#define RD_LISTCARTS_PAGE_SIZE 1000
+
 #if defined(__cplusplus)
 #define _MYRIVLIB_INIT_DECL extern "C" {
 #define _MYRIVLIB_FINI_DECL }
@@ -22,6 +22,7 @@
 
 #include "rd_getuseragent.h"
 #include "rd_deletelog.h"
+#include "rd_session.h"
 
 int RD_DeleteLog(const char hostname[],
 		 const char username[],
@@ -39,7 +40,7 @@ int RD_DeleteLog(const char hostname[],
   struct curl_httppost *first=NULL;
   struct curl_httppost *last=NULL;
 
-  if((curl=curl_easy_init())==NULL) {
+  if((curl=RD_CurlInit())==NULL) {
     curl_easy_cleanup(curl);
     return -1;
   }
@@ -28,6 +28,7 @@
 #include "rd_deletepodcast.h"
 #include "rd_common.h"
 #include "rd_getuseragent.h"
+#include "rd_session.h"
 
 struct xml_data {
   char elem_name[256];
@@ -87,7 +88,7 @@ int RD_DeletePodcast(     const char   hostname[],
   struct curl_httppost *first=NULL;
   struct curl_httppost *last=NULL;
 
-  if((curl=curl_easy_init())==NULL) {
+  if((curl=RD_CurlInit())==NULL) {
     curl_easy_cleanup(curl);
     return -1;
   }
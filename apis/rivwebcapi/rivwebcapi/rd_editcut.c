@@ -27,6 +27,7 @@
 #include "rd_common.h"
 #include "rd_getuseragent.h"
 #include "rd_editcut.h"
+#include "rd_session.h"
 
 struct xml_data {
   char elem_name[256];
@@ -200,7 +201,7 @@ int RD_EditCut(struct rd_cut *cut[],
   struct curl_httppost *first=NULL;
   struct curl_httppost *last=NULL;
 
-  if((curl=curl_easy_init())==NULL) {
+  if((curl=RD_CurlInit())==NULL) {
     curl_easy_cleanup(curl);
     return -1;
   }
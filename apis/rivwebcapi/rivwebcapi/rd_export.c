@@ -26,6 +26,7 @@
 #include "rd_common.h"
 #include "rd_getuseragent.h"
 #include "rd_export.h"
+#include "rd_session.h"
 
 size_t write_data( void *ptr, size_t size, size_t nmemb, void *userdata)
 {
@@ -85,7 +86,7 @@ int RD_ExportCart( const char hostname[],
 //
 // Generate POST Data
 //
-  if((curl=curl_easy_init())==NULL) {
+  if((curl=RD_CurlInit())==NULL) {
     curl_easy_cleanup(curl);
     return -1;
   }
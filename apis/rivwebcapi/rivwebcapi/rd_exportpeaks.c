@@ -27,6 +27,7 @@
 #include "rd_exportpeaks.h"
 #include "rd_getuseragent.h"
 #include "rd_common.h"
+#include "rd_session.h"
 
 size_t __ExportPeaks_write_peaks_data( void *ptr, size_t size, size_t nmemb, FILE *stream)
 {
@@ -45,6 +46,23 @@ int RD_ExportPeaks( const char hostname[],
 			const unsigned         cutnum,
                         const char         filename[],
                         const char 	  user_agent[])
+{
+  return RD_ExportPeaksRange(hostname,username,passwd,ticket,cartnum,cutnum,
+			     -1,-1,0,filename,user_agent);
+}
+
+
+int RD_ExportPeaksRange( const char hostname[],
+			const char         username[],
+			const char           passwd[],
+			const char           ticket[],
+			const unsigned        cartnum,
+			const unsigned         cutnum,
+			const int         start_point,
+			const int           end_point,
+			const unsigned         points,
+                        const char         filename[],
+                        const char 	  user_agent[])
 {
   char url[1500];
   CURL *curl=NULL;
@@ -57,6 +75,7 @@ int RD_ExportPeaks( const char hostname[],
   CURLcode res;
   char user_agent_string[255];
   char cart_buffer[7];
+  char num_buffer[20];
   struct curl_httppost *first=NULL;
   struct curl_httppost *last=NULL;
 
@@ -72,7 +91,7 @@ int RD_ExportPeaks( const char hostname[],
   }
   
 
-  if((curl=curl_easy_init())==NULL) {
+  if((curl=RD_CurlInit())==NULL) {
     curl_easy_cleanup(curl);
     return -1;
   }
@@ -133,6 +152,39 @@ int RD_ExportPeaks( const char hostname[],
 	cart_buffer,
 	CURLFORM_END);
 
+  if(start_point>=0) {
+    snprintf(num_buffer,20,"%d",start_point);
+    curl_formadd(&first,
+	  &last,
+	  CURLFORM_PTRNAME,
+	  "START_POINT",
+	  CURLFORM_COPYCONTENTS,
+	  num_buffer,
+	  CURLFORM_END);
+  }
+
+  if(end_point>=0) {
+    snprintf(num_buffer,20,"%d",end_point);
+    curl_formadd(&first,
+	  &last,
+	  CURLFORM_PTRNAME,
+	  "END_POINT",
+	  CURLFORM_COPYCONTENTS,
+	  num_buffer,
+	  CURLFORM_END);
+  }
+
+  if(points>0) {
+    snprintf(num_buffer,20,"%u",points);
+    curl_formadd(&first,
+	  &last,
+	  CURLFORM_PTRNAME,
+	  "POINTS",
+	  CURLFORM_COPYCONTENTS,
+	  num_buffer,
+	  CURLFORM_END);
+  }
+
   /*
    * Setup the CURL call
    */
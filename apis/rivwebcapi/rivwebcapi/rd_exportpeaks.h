@@ -34,6 +34,18 @@ int RD_ExportPeaks(const char hostname[],
 		   const char         filename[],
 		   const char 	user_agent[]);
 
+int RD_ExportPeaksRange(const char hostname[],
+			const char         username[],
+			const char           passwd[],
+			const char           ticket[],
+			const unsigned        cartnum,
+			const unsigned         cutnum,
+			const int         start_point,
+			const int           end_point,
+			const unsigned         points,
+			const char         filename[],
+			const char 	 user_agent[]);
+
 _MYRIVLIB_FINI_DECL
 
 
@@ -27,6 +27,7 @@
 #include "rd_import.h"
 #include "rd_getuseragent.h"
 #include "rd_common.h"
+#include "rd_session.h"
 
 struct xml_data {
   char elem_name[256];
@@ -125,7 +126,7 @@ int RD_ImportCart(struct rd_cartimport *cartimport[],
   CURLcode res;
   char user_agent_string[255];
 
-  if((curl=curl_easy_init())==NULL) {
+  if((curl=RD_CurlInit())==NULL) {
     curl_easy_cleanup(curl);
     return -1;
   }
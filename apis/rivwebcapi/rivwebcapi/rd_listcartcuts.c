@@ -28,6 +28,7 @@
 #include "rd_common.h"
 #include "rd_getuseragent.h"
 #include "rd_listcart.h"
+#include "rd_session.h"
 
 struct xml_data {
   char elem_name[256];
@@ -348,7 +349,7 @@ int RD_ListCartCuts(struct rd_cart *carts[],
   /*  Set number of recs so if fail already set */
   *numrecs = 0;
   
-  if((curl=curl_easy_init())==NULL) {
+  if((curl=RD_CurlInit())==NULL) {
     curl_easy_cleanup(curl);
     return -1;
   }
@@ -28,6 +28,7 @@
 #include "rd_common.h"
 #include "rd_getuseragent.h"
 #include "rd_listcarts.h"
+#include "rd_session.h"
 
 struct xml_data {
   unsigned carts_quan;
@@ -193,81 +194,26 @@ int RD_ListCarts(struct rd_cart *carts[],
   char user_agent_string[255];
   struct curl_httppost *first=NULL;
   struct curl_httppost *last=NULL;
+  char limit_str[12];
+  char after_str[12];
+  unsigned after=0;
+  unsigned page_start;
+  unsigned quan;
 
   /*  Set number of recs so if fail already set */
   *numrecs = 0;
 
-  if((curl=curl_easy_init())==NULL) {
+  if((curl=RD_CurlInit())==NULL) {
     curl_easy_cleanup(curl);
     return -1;
   }
   
-   /*
+  /*
    * Setup the CURL call
    */
   memset(&xml_data,0,sizeof(xml_data));
-  parser=XML_ParserCreate(NULL);
-  XML_SetUserData(parser,&xml_data);
-  XML_SetElementHandler(parser,__ListCartsElementStart,
-			__ListCartsElementEnd);
-  XML_SetCharacterDataHandler(parser,__ListCartsElementData);
   snprintf(url,1500,"http://%s/rd-bin/rdxport.cgi",hostname);
-
-  curl_formadd(&first,
-	&last,
-	CURLFORM_PTRNAME,
-	"COMMAND",
-        CURLFORM_COPYCONTENTS,
-        "6",
-        CURLFORM_END);
-
-  curl_formadd(&first,
-	&last,
-	CURLFORM_PTRNAME,
-	"LOGIN_NAME",
-	CURLFORM_COPYCONTENTS,
-	username,
-	CURLFORM_END); 
-
-  curl_formadd(&first,
-	&last,
-	CURLFORM_PTRNAME,
-	"PASSWORD",
-        CURLFORM_COPYCONTENTS,
-	passwd,
-	CURLFORM_END);
-
-  curl_formadd(&first,
-	&last,
-	CURLFORM_PTRNAME,
-	"TICKET",
-        CURLFORM_COPYCONTENTS,
-        ticket,
-	CURLFORM_END);
-
-  curl_formadd(&first,
-	&last,
-	CURLFORM_PTRNAME,
-	"GROUP_NAME",
-        CURLFORM_COPYCONTENTS,
-        group_name,
-	CURLFORM_END);
-
-  curl_formadd(&first,
-	&last,
-	CURLFORM_PTRNAME,
-	"FILTER",
-        CURLFORM_COPYCONTENTS,
-        filter,
-	CURLFORM_END);
-
-  curl_formadd(&first,
-	&last,
-	CURLFORM_PTRNAME,
-	"TYPE",
-        CURLFORM_COPYCONTENTS,
-        type,
-	CURLFORM_END);
+  snprintf(limit_str,12,"%u",RD_LISTCARTS_PAGE_SIZE);
 
   // Check if User Agent Present otherwise set to default
   if (strlen(user_agent)> 0){
@@ -279,45 +225,153 @@ int RD_ListCarts(struct rd_cart *carts[],
     strcat(user_agent_string,VERSION);
     curl_easy_setopt(curl, CURLOPT_USERAGENT,user_agent_string);
   }
-
-  curl_easy_setopt(curl,CURLOPT_WRITEDATA,parser);
   curl_easy_setopt(curl,CURLOPT_WRITEFUNCTION,__ListCartsCallback);
   curl_easy_setopt(curl,CURLOPT_URL,url);
   curl_easy_setopt(curl,CURLOPT_POST,1);
-  curl_easy_setopt(curl,CURLOPT_HTTPPOST,first);
   curl_easy_setopt(curl,CURLOPT_NOPROGRESS,1);
   curl_easy_setopt(curl,CURLOPT_ERRORBUFFER,errbuf);
 
-  res = curl_easy_perform(curl);
-  if(res != CURLE_OK) {
-    #ifdef RIVC_DEBUG_OUT
-        size_t len = strlen(errbuf);
-        fprintf(stderr, "\nlibcurl error: (%d)", res);
-        if (len)
-            fprintf(stderr, "%s%s", errbuf,
-                ((errbuf[len-1] != '\n') ? "\n" : ""));
-        else
-            fprintf(stderr, "%s\n", curl_easy_strerror(res));
-    #endif
-    curl_easy_cleanup(curl);
-    return -1;
-  }
+  /*
+   * Fetch the list a page at a time, each page starting after the last
+   * cart of the one before
+   */
+  while(1) {
+    page_start=xml_data.carts_quan;
+    parser=XML_ParserCreate(NULL);
+    XML_SetUserData(parser,&xml_data);
+    XML_SetElementHandler(parser,__ListCartsElementStart,
+			  __ListCartsElementEnd);
+    XML_SetCharacterDataHandler(parser,__ListCartsElementData);
+    snprintf(after_str,12,"%u",after);
+    first=NULL;
+    last=NULL;
+
+    curl_formadd(&first,
+	  &last,
+	  CURLFORM_PTRNAME,
+	  "COMMAND",
+	  CURLFORM_COPYCONTENTS,
+	  "6",
+	  CURLFORM_END);
+
+    curl_formadd(&first,
+	  &last,
+	  CURLFORM_PTRNAME,
+	  "LOGIN_NAME",
+	  CURLFORM_COPYCONTENTS,
+	  username,
+	  CURLFORM_END); 
+
+    curl_formadd(&first,
+	  &last,
+	  CURLFORM_PTRNAME,
+	  "PASSWORD",
+	  CURLFORM_COPYCONTENTS,
+	  passwd,
+	  CURLFORM_END);
+
+    curl_formadd(&first,
+	  &last,
+	  CURLFORM_PTRNAME,
+	  "TICKET",
+	  CURLFORM_COPYCONTENTS,
+	  ticket,
+	  CURLFORM_END);
+
+    curl_formadd(&first,
+	  &last,
+	  CURLFORM_PTRNAME,
+	  "GROUP_NAME",
+	  CURLFORM_COPYCONTENTS,
+	  group_name,
+	  CURLFORM_END);
+
+    curl_formadd(&first,
+	  &last,
+	  CURLFORM_PTRNAME,
+	  "FILTER",
+	  CURLFORM_COPYCONTENTS,
+	  filter,
+	  CURLFORM_END);
+
+    curl_formadd(&first,
+	  &last,
+	  CURLFORM_PTRNAME,
+	  "TYPE",
+	  CURLFORM_COPYCONTENTS,
+	  type,
+	  CURLFORM_END);
+
+    curl_formadd(&first,
+	  &last,
+	  CURLFORM_PTRNAME,
+	  "LIMIT",
+	  CURLFORM_COPYCONTENTS,
+	  limit_str,
+	  CURLFORM_END);
+
+    curl_formadd(&first,
+	  &last,
+	  CURLFORM_PTRNAME,
+	  "AFTER_CART",
+	  CURLFORM_COPYCONTENTS,
+	  after_str,
+	  CURLFORM_END);
+
+    curl_easy_setopt(curl,CURLOPT_WRITEDATA,parser);
+    curl_easy_setopt(curl,CURLOPT_HTTPPOST,first);
+
+    res = curl_easy_perform(curl);
+    XML_ParserFree(parser);
+    if(res != CURLE_OK) {
+      #ifdef RIVC_DEBUG_OUT
+          size_t len = strlen(errbuf);
+          fprintf(stderr, "\nlibcurl error: (%d)", res);
+          if (len)
+              fprintf(stderr, "%s%s", errbuf,
+                  ((errbuf[len-1] != '\n') ? "\n" : ""));
+          else
+              fprintf(stderr, "%s\n", curl_easy_strerror(res));
+      #endif
+      curl_formfree(first);
+      curl_easy_cleanup(curl);
+      return -1;
+    }
 
-/* The response OK - so figure out if we got what we wanted.. */
+    /* The response OK - so figure out if we got what we wanted.. */
 
-  curl_easy_getinfo(curl,CURLINFO_RESPONSE_CODE,&response_code);
-  curl_formfree(first);
-  curl_easy_cleanup(curl);
-  
-  if (response_code > 199 && response_code < 300) {
-    *carts=xml_data.carts;
-    *numrecs = xml_data.carts_quan;
-    return 0;
-  }
-  else {
-    #ifdef RIVC_DEBUG_OUT
-        fprintf(stderr," rd_listcarts Call Returned Error: %s\n",xml_data.strbuf);
-    #endif
-    return (int)response_code;
+    curl_easy_getinfo(curl,CURLINFO_RESPONSE_CODE,&response_code);
+    curl_formfree(first);
+    if((response_code<200)||(response_code>299)) {
+      #ifdef RIVC_DEBUG_OUT
+          fprintf(stderr," rd_listcarts Call Returned Error: %s\n",xml_data.strbuf);
+      #endif
+      curl_easy_cleanup(curl);
+      return (int)response_code;
+    }
+    quan=xml_data.carts_quan;
+
+    /*
+     * A server that predates paging sends the whole list every time, so
+     * a page that does not start after the previous one is a repeat
+     */
+    if((quan>page_start)&&(xml_data.carts[page_start].cart_number<=after)) {
+      xml_data.carts_quan=page_start;
+      break;
+    }
+
+    /*
+     * A short page is the last one, as is an overlong one from a server
+     * that ignored LIMIT
+     */
+    if((quan-page_start)!=RD_LISTCARTS_PAGE_SIZE) {
+      break;
+    }
+    after=xml_data.carts[quan-1].cart_number;
   }
+  curl_easy_cleanup(curl);
+
+  *carts=xml_data.carts;
+  *numrecs = xml_data.carts_quan;
+  return 0;
 }
@@ -28,6 +28,7 @@
 #include "rd_listcartschedcodes.h"
 #include "rd_common.h"
 #include "rd_getuseragent.h"
+#include "rd_session.h"
 
 struct xml_data {
   unsigned schedcodes_quan;
@@ -107,7 +108,7 @@ int RD_ListCartSchedCodes(struct rd_schedcodes *scodes[],
    /* Set number of recs so if fail already set */
   *numrecs = 0;
 
-  if((curl=curl_easy_init())==NULL) {
+  if((curl=RD_CurlInit())==NULL) {
     curl_easy_cleanup(curl);
     return -1;
   }
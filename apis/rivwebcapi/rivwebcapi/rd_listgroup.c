@@ -28,6 +28,7 @@
 #include "rd_common.h"
 #include "rd_getuseragent.h"
 #include "rd_listgroup.h"
+#include "rd_session.h"
 
 struct xml_data {
   char elem_name[256];
@@ -137,7 +138,7 @@ int RD_ListGroup(struct rd_group *grp[],
    /* set number of recs so if fail already set */
   *numrecs = 0;
 
-  if((curl=curl_easy_init())==NULL) {
+  if((curl=RD_CurlInit())==NULL) {
     curl_easy_cleanup(curl);
     return -1;
   }
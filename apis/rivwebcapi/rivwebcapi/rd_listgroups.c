@@ -28,6 +28,7 @@
 #include "rd_common.h"
 #include "rd_getuseragent.h"
 #include "rd_listgroups.h"
+#include "rd_session.h"
 
 struct xml_data {
   unsigned grps_quan;
@@ -138,7 +139,7 @@ int RD_ListGroups(struct rd_group *grps[],
    /* set number of recs so if fail already set */
   *numrecs = 0;
 
-  if((curl=curl_easy_init())==NULL) {
+  if((curl=RD_CurlInit())==NULL) {
     curl_easy_cleanup(curl);
     return -1;
   }
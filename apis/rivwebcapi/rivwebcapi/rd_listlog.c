@@ -28,6 +28,7 @@
 #include "rd_common.h"
 #include "rd_getuseragent.h"
 #include "rd_listlog.h"
+#include "rd_session.h"
 
 struct xml_data {
   unsigned logline_quan;
@@ -441,7 +442,7 @@ int RD_ListLog(struct rd_logline *logline[],
   if (strlen(logname)==0)  {
     return 400;        /* Log Name Missing */
   }
-  if((curl=curl_easy_init())==NULL) {
+  if((curl=RD_CurlInit())==NULL) {
     curl_easy_cleanup(curl);
     return -1;
   }
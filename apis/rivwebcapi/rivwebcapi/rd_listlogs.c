@@ -28,6 +28,7 @@
 #include "rd_common.h"
 #include "rd_getuseragent.h"
 #include "rd_listlogs.h"
+#include "rd_session.h"
 
 struct xml_data {
   unsigned logs_quan;
@@ -186,7 +187,7 @@ int RD_ListLogs(struct rd_log *logs[],
       }
     }
   }
-  if((curl=curl_easy_init())==NULL) {
+  if((curl=RD_CurlInit())==NULL) {
     curl_easy_cleanup(curl);
     return -1;
   }
@@ -27,6 +27,7 @@
 #include "rd_listschedcodes.h"
 #include "rd_common.h"
 #include "rd_getuseragent.h"
+#include "rd_session.h"
 
 struct xml_data {
   unsigned schedcodes_quan;
@@ -105,7 +106,7 @@ int RD_ListSchedCodes(struct rd_schedcodes *scodes[],
    /* Set number of recs so if fail already set */
   *numrecs = 0;
 
-  if((curl=curl_easy_init())==NULL) {
+  if((curl=RD_CurlInit())==NULL) {
     curl_easy_cleanup(curl);
     return -1;
   }
@@ -23,6 +23,7 @@
 
 #include "rd_savelog.h"
 #include "rd_getuseragent.h"
+#include "rd_session.h"
 
 char *AppendString(char *str,const char *added_str)
 {
@@ -55,7 +56,7 @@ int RD_SaveLog(struct save_loghdr_values *hdrvals,
   struct curl_httppost *first=NULL;
   struct curl_httppost *last=NULL;
 
-  if((curl=curl_easy_init())==NULL) {
+  if((curl=RD_CurlInit())==NULL) {
     curl_easy_cleanup(curl);
     return -1;
   }
@@ -28,6 +28,7 @@
 #include "rd_common.h"
 #include "rd_getuseragent.h"
 #include "rd_savepodcast.h"
+#include "rd_session.h"
 
 struct xml_data {
   char elem_name[256];
@@ -92,7 +93,7 @@ int RD_SavePodcast(const char hostname[],
   CURLcode res;
   char user_agent_string[255];
 
-  if((curl=curl_easy_init())==NULL) {
+  if((curl=RD_CurlInit())==NULL) {
     curl_easy_cleanup(curl);
     return -1;
   }
@@ -0,0 +1,365 @@
+/* rd_session.c
+ *
+ * Implementation of the Session Rivendell Access Library
+ *
+ * (C) Copyright 2021 Fred Gleason <fredg@paravelsystems.com>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#if !((defined(_WINDLL)) || (defined(_WIN32)))
+#include <pthread.h>
+#endif
+
+#include <curl/curl.h>
+
+#include "rd_common.h"
+#include "rd_getuseragent.h"
+#include "rd_session.h"
+
+struct __rd_session_request {
+  CURL *curl;
+  struct curl_httppost *first;
+  char *data;
+  size_t len;
+  size_t size;
+  rd_session_cb callback;
+  void *userdata;
+  struct __rd_session_request *next;
+};
+
+struct rd_session {
+  char url[1500];
+  char username[256];
+  char passwd[256];
+  char ticket[41];
+  char user_agent[255];
+  CURLM *multi;
+  unsigned max_requests;
+  unsigned active;
+  struct __rd_session_request *queue_head;
+  struct __rd_session_request *queue_tail;
+};
+
+
+#if !((defined(_WINDLL)) || (defined(_WIN32)))
+static pthread_mutex_t __rd_session_share_mutex=PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t __rd_session_lock_mutex[CURL_LOCK_DATA_LAST];
+static CURLSH *__rd_session_share=NULL;
+
+
+static void __RD_SessionLock(CURL *handle,curl_lock_data data,
+			     curl_lock_access access,void *userptr)
+{
+  pthread_mutex_lock(&__rd_session_lock_mutex[data]);
+}
+
+
+static void __RD_SessionUnlock(CURL *handle,curl_lock_data data,
+			       void *userptr)
+{
+  pthread_mutex_unlock(&__rd_session_lock_mutex[data]);
+}
+
+
+static CURLSH *__RD_SessionShare()
+{
+  int i;
+
+  pthread_mutex_lock(&__rd_session_share_mutex);
+  if(__rd_session_share==NULL) {
+    for(i=0;i<CURL_LOCK_DATA_LAST;i++) {
+      pthread_mutex_init(&__rd_session_lock_mutex[i],NULL);
+    }
+    if((__rd_session_share=curl_share_init())!=NULL) {
+      curl_share_setopt(__rd_session_share,CURLSHOPT_LOCKFUNC,
+			__RD_SessionLock);
+      curl_share_setopt(__rd_session_share,CURLSHOPT_UNLOCKFUNC,
+			__RD_SessionUnlock);
+      curl_share_setopt(__rd_session_share,CURLSHOPT_SHARE,
+			CURL_LOCK_DATA_DNS);
+      curl_share_setopt(__rd_session_share,CURLSHOPT_SHARE,
+			CURL_LOCK_DATA_SSL_SESSION);
+#if LIBCURL_VERSION_NUM >= 0x073900
+      curl_share_setopt(__rd_session_share,CURLSHOPT_SHARE,
+			CURL_LOCK_DATA_CONNECT);
+#endif
+    }
+  }
+  pthread_mutex_unlock(&__rd_session_share_mutex);
+
+  return __rd_session_share;
+}
+#endif
+
+
+CURL *RD_CurlInit(void)
+{
+  CURL *curl=NULL;
+
+  if((curl=curl_easy_init())==NULL) {
+    return NULL;
+  }
+#if !((defined(_WINDLL)) || (defined(_WIN32)))
+  if(__RD_SessionShare()!=NULL) {
+    curl_easy_setopt(curl,CURLOPT_SHARE,__RD_SessionShare());
+  }
+#endif
+
+  return curl;
+}
+
+
+static size_t __RD_SessionCallback(void *ptr,size_t size,size_t nmemb,
+				   void *userdata)
+{
+  struct __rd_session_request *req=(struct __rd_session_request *)userdata;
+  size_t len=size*nmemb;
+  char *data=NULL;
+
+  if((req->len+len+1)>req->size) {
+    if((data=realloc(req->data,2*(req->len+len+1)))==NULL) {
+      return 0;
+    }
+    req->data=data;
+    req->size=2*(req->len+len+1);
+  }
+  memcpy(req->data+req->len,ptr,len);
+  req->len+=len;
+  req->data[req->len]=0;
+
+  return len;
+}
+
+
+static void __RD_SessionFreeRequest(struct __rd_session_request *req)
+{
+  if(req->curl!=NULL) {
+    curl_easy_cleanup(req->curl);
+  }
+  curl_formfree(req->first);
+  free(req->data);
+  free(req);
+}
+
+
+static void __RD_SessionStartRequests(struct rd_session *sess)
+{
+  struct __rd_session_request *req=NULL;
+
+  while((sess->queue_head!=NULL)&&(sess->active<sess->max_requests)) {
+    req=sess->queue_head;
+    sess->queue_head=req->next;
+    if(sess->queue_head==NULL) {
+      sess->queue_tail=NULL;
+    }
+    req->next=NULL;
+    if(curl_multi_add_handle(sess->multi,req->curl)!=CURLM_OK) {
+      req->callback(req->userdata,-1,"",0);
+      __RD_SessionFreeRequest(req);
+      continue;
+    }
+    sess->active++;
+  }
+}
+
+
+struct rd_session *RD_CreateSession(const char hostname[],
+				    const char username[],
+				    const char passwd[],
+				    const char ticket[],
+				    const char user_agent[],
+				    unsigned max_requests)
+{
+  struct rd_session *sess=NULL;
+
+  if((sess=malloc(sizeof(struct rd_session)))==NULL) {
+    return NULL;
+  }
+  memset(sess,0,sizeof(struct rd_session));
+  if((sess->multi=curl_multi_init())==NULL) {
+    free(sess);
+    return NULL;
+  }
+  snprintf(sess->url,1500,"http://%s/rd-bin/rdxport.cgi",hostname);
+  strlcpy(sess->username,username,256);
+  strlcpy(sess->passwd,passwd,256);
+  strlcpy(sess->ticket,ticket,41);
+
+  // Check if User Agent Present otherwise set to default
+  if(strlen(user_agent)>0) {
+    strlcpy(sess->user_agent,user_agent,255);
+  }
+  else {
+    strlcpy(sess->user_agent,RD_GetUserAgent(),255);
+    strlcpy(sess->user_agent+strlen(sess->user_agent),VERSION,
+	    255-strlen(sess->user_agent));
+  }
+  sess->max_requests=max_requests;
+  if(sess->max_requests==0) {
+    sess->max_requests=1;
+  }
+
+  return sess;
+}
+
+
+int RD_SessionPost(struct rd_session *sess,
+		   const char *fields[],
+		   rd_session_cb callback,
+		   void *userdata)
+{
+  struct __rd_session_request *req=NULL;
+  struct curl_httppost *last=NULL;
+  int i;
+
+  if((req=malloc(sizeof(struct __rd_session_request)))==NULL) {
+    return -1;
+  }
+  memset(req,0,sizeof(struct __rd_session_request));
+  if((req->curl=RD_CurlInit())==NULL) {
+    free(req);
+    return -1;
+  }
+  req->callback=callback;
+  req->userdata=userdata;
+
+  curl_formadd(&req->first,
+	&last,
+	CURLFORM_PTRNAME,
+	"LOGIN_NAME",
+	CURLFORM_COPYCONTENTS,
+	sess->username,
+	CURLFORM_END);
+
+  curl_formadd(&req->first,
+	&last,
+	CURLFORM_PTRNAME,
+	"PASSWORD",
+	CURLFORM_COPYCONTENTS,
+	sess->passwd,
+	CURLFORM_END);
+
+  curl_formadd(&req->first,
+	&last,
+	CURLFORM_PTRNAME,
+	"TICKET",
+	CURLFORM_COPYCONTENTS,
+	sess->ticket,
+	CURLFORM_END);
+
+  for(i=0;fields[i]!=NULL;i+=2) {
+    curl_formadd(&req->first,
+	  &last,
+	  CURLFORM_COPYNAME,
+	  fields[i],
+	  CURLFORM_COPYCONTENTS,
+	  fields[i+1],
+	  CURLFORM_END);
+  }
+
+  curl_easy_setopt(req->curl,CURLOPT_USERAGENT,sess->user_agent);
+  curl_easy_setopt(req->curl,CURLOPT_WRITEDATA,req);
+  curl_easy_setopt(req->curl,CURLOPT_WRITEFUNCTION,__RD_SessionCallback);
+  curl_easy_setopt(req->curl,CURLOPT_PRIVATE,req);
+  curl_easy_setopt(req->curl,CURLOPT_URL,sess->url);
+  curl_easy_setopt(req->curl,CURLOPT_POST,1);
+  curl_easy_setopt(req->curl,CURLOPT_HTTPPOST,req->first);
+  curl_easy_setopt(req->curl,CURLOPT_NOPROGRESS,1);
+
+  if(sess->queue_tail==NULL) {
+    sess->queue_head=req;
+  }
+  else {
+    sess->queue_tail->next=req;
+  }
+  sess->queue_tail=req;
+
+  return 0;
+}
+
+
+int RD_SessionRun(struct rd_session *sess)
+{
+  struct __rd_session_request *req=NULL;
+  CURLMsg *msg=NULL;
+  int running=0;
+  int left=0;
+  long response_code=0;
+
+  __RD_SessionStartRequests(sess);
+  while(sess->active>0) {
+    if(curl_multi_perform(sess->multi,&running)!=CURLM_OK) {
+      return -1;
+    }
+    while((msg=curl_multi_info_read(sess->multi,&left))!=NULL) {
+      if(msg->msg!=CURLMSG_DONE) {
+	continue;
+      }
+      curl_easy_getinfo(msg->easy_handle,CURLINFO_PRIVATE,(char **)&req);
+      curl_multi_remove_handle(sess->multi,req->curl);
+      sess->active--;
+      if(msg->data.result==CURLE_OK) {
+	curl_easy_getinfo(req->curl,CURLINFO_RESPONSE_CODE,&response_code);
+	req->callback(req->userdata,(int)response_code,
+		      (req->data==NULL)?"":req->data,req->len);
+      }
+      else {
+        #ifdef RIVC_DEBUG_OUT
+            fprintf(stderr,"libcurl error: %s\n",
+		    curl_easy_strerror(msg->data.result));
+        #endif
+	req->callback(req->userdata,-1,"",0);
+      }
+      __RD_SessionFreeRequest(req);
+    }
+    __RD_SessionStartRequests(sess);
+    if(sess->active>0) {
+      curl_multi_wait(sess->multi,NULL,0,1000*RD_SESSION_WAIT_TIMEOUT,NULL);
+    }
+  }
+
+  return 0;
+}
+
+
+unsigned RD_SessionPending(struct rd_session *sess)
+{
+  struct __rd_session_request *req=sess->queue_head;
+  unsigned ret=sess->active;
+
+  while(req!=NULL) {
+    ret++;
+    req=req->next;
+  }
+
+  return ret;
+}
+
+
+void RD_FreeSession(struct rd_session *sess)
+{
+  struct __rd_session_request *req=NULL;
+
+  while(sess->queue_head!=NULL) {
+    req=sess->queue_head;
+    sess->queue_head=req->next;
+    __RD_SessionFreeRequest(req);
+  }
+  curl_multi_cleanup(sess->multi);
+  free(sess);
+}
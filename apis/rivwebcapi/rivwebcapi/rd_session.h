@@ -0,0 +1,78 @@
+/* rd_session.h
+ *
+ * Header for the Session Rivendell Access Library
+ *
+ * (C) Copyright 2021 Fred Gleason <fredg@paravelsystems.com>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef RD_SESSION_H
+#define RD_SESSION_H
+
+#include <curl/curl.h>
+
+#include <rivwebcapi/rd_common.h>
+
+_MYRIVLIB_INIT_DECL
+
+/*
+ * Seconds an RD_SessionRun() call waits for network activity before
+ * checking its requests again
+ */
+#define RD_SESSION_WAIT_TIMEOUT 1
+
+/*
+ * A session holds a set of connections to one rdxport server open
+ * between calls, and can keep several requests to it in flight at once.
+ * Requests are queued with RD_SessionPost() and then executed by
+ * RD_SessionRun(), which invokes the callback of each request as it
+ * completes. The 'response_code' passed to the callback is the HTTP
+ * status, or -1 if the request could not be made at all; 'data' is the
+ * response body (normally an XML document) with a terminating NUL.
+ *
+ * A session must only be used by one thread at a time.
+ */
+struct rd_session;
+
+typedef void (*rd_session_cb)(void *userdata,int response_code,
+			      const char *data,size_t len);
+
+struct rd_session *RD_CreateSession(const char hostname[],
+				    const char username[],
+				    const char passwd[],
+				    const char ticket[],
+				    const char user_agent[],
+				    unsigned max_requests);
+int RD_SessionPost(struct rd_session *sess,
+		   const char *fields[],
+		   rd_session_cb callback,
+		   void *userdata);
+int RD_SessionRun(struct rd_session *sess);
+unsigned RD_SessionPending(struct rd_session *sess);
+void RD_FreeSession(struct rd_session *sess);
+
+/*
+ * Returns a new CURL easy handle that shares its connection cache, DNS
+ * cache and TLS sessions with every other handle created this way, so
+ * that consecutive synchronous calls (RD_ListCart(), RD_Export() etc.)
+ * reuse kept-alive connections rather than opening a new one each time.
+ * Free the handle with curl_easy_cleanup() as usual.
+ */
+CURL *RD_CurlInit(void);
+
+_MYRIVLIB_FINI_DECL
+
+
+#endif  // RD_SESSION_H
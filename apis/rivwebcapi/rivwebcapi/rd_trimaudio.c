@@ -28,6 +28,7 @@
 #include "rd_trimaudio.h"
 #include "rd_getuseragent.h"
 #include "rd_common.h"
+#include "rd_session.h"
 
 struct xml_data {
   char elem_name[256];
@@ -114,7 +115,7 @@ int RD_TrimAudio(struct rd_trimaudio *trimaudio[],
   struct curl_httppost *first=NULL;
   struct curl_httppost *last=NULL;
 
-  if((curl=curl_easy_init())==NULL) {
+  if((curl=RD_CurlInit())==NULL) {
     curl_easy_cleanup(curl);
     return -1;
   }
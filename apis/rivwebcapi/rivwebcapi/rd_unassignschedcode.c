@@ -28,6 +28,7 @@
 #include "rd_unassignschedcode.h"
 #include "rd_common.h"
 #include "rd_getuseragent.h"
+#include "rd_session.h"
 
 struct xml_data {
   char elem_name[256];
@@ -107,7 +108,7 @@ int RD_UnassignSchedCode( const char hostname[],
     return -1;
   }
 
-  if((curl=curl_easy_init())==NULL) {
+  if((curl=RD_CurlInit())==NULL) {
     curl_easy_cleanup(curl);
     return -1;
   }
@@ -0,0 +1,193 @@
+/* session_test.c
+ *
+ * Measure request throughput with and without a session.
+ *
+ * (C) Copyright 2021 Fred Gleason <fredg@paravelsystems.com>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public
+ *   License along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include <rivwebcapi/rd_listcart.h>
+#include <rivwebcapi/rd_getuseragent.h>
+#include <rivwebcapi/rd_getversion.h>
+#include <rivwebcapi/rd_session.h>
+
+struct results {
+  unsigned ok;
+  unsigned failed;
+};
+
+
+static double Now()
+{
+  struct timeval tv;
+
+  gettimeofday(&tv,NULL);
+  return (double)tv.tv_sec+(double)tv.tv_usec/1000000.0;
+}
+
+
+static void Report(const char *label,unsigned reqs,unsigned failed,
+		   double secs)
+{
+  printf("%-28s %6u requests  %4u failed  %8.3f s  %8.1f req/s\n",
+	 label,reqs,failed,secs,(double)reqs/secs);
+}
+
+
+static void SessionCallback(void *userdata,int response_code,
+			    const char *data,size_t len)
+{
+  struct results *results=(struct results *)userdata;
+
+  if((response_code>=200)&&(response_code<300)) {
+    results->ok++;
+  }
+  else {
+    results->failed++;
+  }
+}
+
+
+int main(int argc,char *argv[])
+{
+  char buf[BUFSIZ];
+  char *p;
+  long int cart=0;
+  long int count=0;
+  unsigned numrecs;
+  char *host;
+  char *user;
+  char *passwd;
+  char ticket[41]="";
+  char user_agent[255]={0};
+  char cart_str[11];
+  const char *fields[]={"COMMAND","7","CART_NUMBER",cart_str,NULL};
+  unsigned in_flight[]={1,4,16,0};
+  char label[64];
+  struct rd_cart *carts=NULL;
+  struct rd_session *sess=NULL;
+  struct results results;
+  unsigned failed=0;
+  double start;
+  int result;
+  int i;
+  int j;
+
+  /*      Get the Rivendell Host, User and Password if set in env */
+  if (getenv("RIVHOST")!=NULL) {
+    host = getenv("RIVHOST");
+  }
+  else {
+    host="localhost";
+  }
+
+  if (getenv("RIVUSER")!=NULL) {
+    user = getenv("RIVUSER");
+  }
+  else {
+    user="USER";
+  }
+
+  if (getenv("RIVPASS")!=NULL) {
+    passwd = getenv("RIVPASS");
+  }
+  else {
+    passwd = "";
+  }
+
+  printf("Please enter the Cart Number ==> ");
+  if (fgets(buf,sizeof(buf),stdin) != NULL)
+  {
+    cart = strtol(buf, &p,10);
+
+    if ( (buf[0] != '\n') &&
+         ((*p != '\n') && (*p != '\0')))
+    {
+        fprintf(stderr," Illegal Characters detected! Exiting.\n");
+	exit(0);
+    }
+  }
+  snprintf(cart_str,11,"%ld",cart);
+
+  printf("Please enter the Number of Requests ==> ");
+  if (fgets(buf,sizeof(buf),stdin) != NULL)
+  {
+    count = strtol(buf, &p,10);
+
+    if ( (buf[0] != '\n') &&
+         ((*p != '\n') && (*p != '\0')))
+    {
+        fprintf(stderr," Illegal Characters detected! Exiting.\n");
+	exit(0);
+    }
+  }
+  if(count<=0) {
+    count=1000;
+  }
+
+  // Add the User Agent and Version
+  strcat(user_agent,RD_GetUserAgent());
+  strcat(user_agent,RD_GetVersion());
+  strcat(user_agent," (Test Suite)");
+
+  //
+  // Synchronous calls, one at a time
+  //
+  start=Now();
+  for(i=0;i<count;i++) {
+    result=RD_ListCart(&carts,
+		       host,
+		       user,
+		       passwd,
+		       ticket,
+		       (unsigned)cart,
+		       user_agent,
+		       &numrecs);
+    if(result==0) {
+      free(carts);
+    }
+    else {
+      failed++;
+    }
+  }
+  Report("RD_ListCart()",count,failed,Now()-start);
+
+  //
+  // Session calls, with increasing numbers of requests in flight
+  //
+  for(i=0;in_flight[i]>0;i++) {
+    sess=RD_CreateSession(host,user,passwd,ticket,user_agent,in_flight[i]);
+    if(sess==NULL) {
+      fprintf(stderr,"Error: unable to create session\n");
+      exit(256);
+    }
+    memset(&results,0,sizeof(results));
+    start=Now();
+    for(j=0;j<count;j++) {
+      RD_SessionPost(sess,fields,SessionCallback,&results);
+    }
+    RD_SessionRun(sess);
+    snprintf(label,64,"RD_SessionRun(), %u in flight",in_flight[i]);
+    Report(label,count,results.failed,Now()-start);
+    RD_FreeSession(sess);
+  }
+
+  exit(0);
+}
@@ -36,6 +36,7 @@
 #include <QDir>
 
 #include <rdapplication.h>
+#include <rdaudioanalysis.h>
 #include <rdaudio_port.h>
 #include <rdcmd_switch.h>
 #include <rdconf.h>
@@ -730,6 +731,8 @@ void MainObject::loadRecordingData(int id,unsigned card,unsigned port,
     wavename=rd_config->audioFileName(name);
     unlink(wavename.toUtf8());  // So we don't trainwreck any current playouts!
     unlink((wavename+".energy").toUtf8());
+    RDAudioAnalysis::removeSidecar(wavename);
+    unlink((wavename+".frames").toUtf8());
     switch(cae_driver[card]) {
     case RDStation::Hpi:
       if(!hpiLoadRecord(card,port,coding,channels,samprate,bitrate,
@@ -2081,6 +2084,12 @@ void MainObject::InitMadDecoder(int card,int stream,RDWaveFile *wave)
   mad_synth_init(&mad_synth[card][stream]);
   mad_frame_size[card][stream]=
     144*wave->getHeadBitRate()/wave->getSamplesPerSec();
+  //
+  // Scanning a file for its frame index is far too slow for the play
+  // path, so only an index already built (on import, or by rdmaint(8))
+  // is used
+  //
+  wave->readFrameIndex();
   mad_left_over[card][stream]=0;
   mad_active[card][stream]=true;
 #endif  // HAVE_MAD
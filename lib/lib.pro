@@ -44,6 +44,7 @@ SOURCES += rdairplay_conf.cpp
 SOURCES += rdapplication.cpp
 SOURCES += rdaudio_exists.cpp
 SOURCES += rdaudio_port.cpp
+SOURCES += rdaudioanalysis.cpp
 SOURCES += rdaudiosettings.cpp
 SOURCES += rdbusybar.cpp
 SOURCES += rdbusydialog.cpp
@@ -75,6 +76,7 @@ SOURCES += rdcueeditdialog.cpp
 SOURCES += rdcut.cpp
 SOURCES += rdcut_path.cpp
 SOURCES += rdcut_dialog.cpp
+SOURCES += rdcutdecoder.cpp
 SOURCES += rddatapacer.cpp
 SOURCES += rddatedialog.cpp
 SOURCES += rddatedecode.cpp
@@ -83,6 +85,7 @@ SOURCES += rddatetime.cpp
 SOURCES += rddb.cpp
 SOURCES += rddisclookup.cpp
 SOURCES += rddbheartbeat.cpp
+SOURCES += rddbpool.cpp
 SOURCES += rddebug.cpp
 SOURCES += rddeck.cpp
 SOURCES += rddialog.cpp
@@ -114,6 +117,7 @@ SOURCES += rdgroup.cpp
 SOURCES += rdgroup_list.cpp
 SOURCES += rdgrouplistmodel.cpp
 SOURCES += rdhash.cpp
+SOURCES += rdhashbatch.cpp
 SOURCES += rdhostvarlistmodel.cpp
 SOURCES += rdidvalidator.cpp
 SOURCES += rdiconengine.cpp
@@ -165,11 +169,13 @@ SOURCES += rdpypadlistmodel.cpp
 SOURCES += rdrecording.cpp
 SOURCES += rdrehash.cpp
 SOURCES += rdrenderer.cpp
+SOURCES += rdrendersink.cpp
 SOURCES += rdreplcartlistmodel.cpp
 SOURCES += rdreplicatorlistmodel.cpp
 SOURCES += rdreport.cpp
 SOURCES += rdresourcelistmodel.cpp
 SOURCES += rdripc.cpp
+SOURCES += rdrowcache.cpp
 SOURCES += rdrssschemas.cpp
 SOURCES += rdrsscategorybox.cpp
 SOURCES += rdschedcode.cpp
@@ -183,6 +189,7 @@ SOURCES += rdslider.cpp
 SOURCES += rdsocket.cpp
 SOURCES += rdsocketstrings.cpp
 SOURCES += rdsound_panel.cpp
+SOURCES += rdsqlprofiler.cpp
 SOURCES += rdstation.cpp
 SOURCES += rdstationlistmodel.cpp
 SOURCES += rdstatus.cpp
@@ -222,6 +229,7 @@ HEADERS += rdairplay_conf.h
 HEADERS += rdapplication.h
 HEADERS += rdaudio_exists.h
 HEADERS += rdaudio_port.h
+HEADERS += rdaudioanalysis.h
 HEADERS += rdaudiosettings.h
 HEADERS += rdbusybar.h
 HEADERS += rdbusydialog.h
@@ -255,12 +263,14 @@ HEADERS += rdcueeditdialog.h
 HEADERS += rdcut_dialog.h
 HEADERS += rdcut_path.h
 HEADERS += rdcut.h
+HEADERS += rdcutdecoder.h
 HEADERS += rddatedecode.h
 HEADERS += rddatedialog.h
 HEADERS += rddatepicker.h
 HEADERS += rddatetime.h
 HEADERS += rddb.h
 HEADERS += rddbheartbeat.h
+HEADERS += rddbpool.h
 HEADERS += rddebug.h
 HEADERS += rddeck.h
 HEADERS += rddialog.h
@@ -293,6 +303,7 @@ HEADERS += rdgroup_list.h
 HEADERS += rdgroup.h
 HEADERS += rdgrouplistmodel.h
 HEADERS += rdhash.h
+HEADERS += rdhashbatch.h
 HEADERS += rdhostvarlistmodel.h
 HEADERS += rdiconengine.h
 HEADERS += rdidvalidator.h
@@ -345,11 +356,13 @@ HEADERS += rdpypadlistmodel.h
 HEADERS += rdrecording.h
 HEADERS += rdrehash.h
 HEADERS += rdrenderer.h
+HEADERS += rdrendersink.h
 HEADERS += rdreplcartlistmodel.h
 HEADERS += rdreplicatorlistmodel.h
 HEADERS += rdreport.h
 HEADERS += rdresourcelistmodel.h
 HEADERS += rdripc.h
+HEADERS += rdrowcache.h
 HEADERS += rdrssschemas.h
 HEADERS += rdrsscategorybox.h
 HEADERS += rdschedcode.h
@@ -363,6 +376,7 @@ HEADERS += rdslider.h
 HEADERS += rdsocket.h
 HEADERS += rdsocketstrings.h
 HEADERS += rdsound_panel.h
+HEADERS += rdsqlprofiler.h
 HEADERS += rdstation.h
 HEADERS += rdstationlistmodel.h
 HEADERS += rdstatus.h
@@ -67,6 +67,8 @@
 #define DEFAULT_MYSQL_DRIVER "QMYSQL3"
 #define DEFAULT_MYSQL_HEARTBEAT_INTERVAL 360
 #define DEFAULT_MYSQL_ENGINE "MyISAM"
+#define DEFAULT_MYSQL_REPLICA_MAX_LAG 10
+#define DEFAULT_MYSQL_ROW_CACHE_TTL 60
 #define DEFAULT_MYSQL_CHARSET "utf8mb4"
 #define DEFAULT_MYSQL_COLLATION "utf8mb4_general_ci"
 
@@ -108,6 +110,11 @@
  */
 #define RDCATCHD_TCP_PORT 6006
 
+/*
+ * RDXport Service TCP Port
+ */
+#define RDXPORT_SERVICE_TCP_PORT 6007
+
 /*
  * Minimum event ID for dynamic (RML-controlled) recordings
  */
@@ -615,6 +622,18 @@
  */
 #define RD_DEFAULT_SERVICE_TIMEOUT 30
 
+/*
+ * Defaults for the [RdxportService] section in rd.conf(5)
+ */
+#define RD_DEFAULT_RDXPORT_SERVICE_ADDRESS "127.0.0.1"
+#define RD_DEFAULT_RDXPORT_SERVICE_WORKERS 4
+#define RD_DEFAULT_RDXPORT_SERVICE_MAX_REQUESTS 1000
+
+/*
+ * Default size limit for the [ExportCache] section in rd.conf(5), in MB
+ */
+#define RD_DEFAULT_EXPORT_CACHE_MAX_SIZE 1024
+
 /*
  * File Extension for RSS XML Feed Files
  */
@@ -0,0 +1,523 @@
+// rdaudioanalysis.cpp
+//
+// Single-pass analysis of audio as it is converted.
+//
+//   (C) Copyright 2021 Fred Gleason <fredg@paravelsystems.com>
+//
+//   This program is free software; you can redistribute it and/or modify
+//   it under the terms of the GNU General Public License version 2 as
+//   published by the Free Software Foundation.
+//
+//   This program is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//   GNU General Public License for more details.
+//
+//   You should have received a copy of the GNU General Public
+//   License along with this program; if not, write to the Free Software
+//   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+//
+
+#include <math.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#include <qstringlist.h>
+
+#include "rd.h"
+#include "rdaudioanalysis.h"
+#include "rdhash.h"
+#include "rdprofile.h"
+
+//
+// Frames per energy block, as in the LEVL chunk
+//
+#define RDAUDIOANALYSIS_ENERGY_FRAMES 1152
+
+RDAudioAnalysis::RDAudioAnalysis()
+{
+  clear();
+}
+
+
+RDAudioAnalysis::~RDAudioAnalysis()
+{
+}
+
+
+void RDAudioAnalysis::start(unsigned samprate,unsigned chans)
+{
+  double f0;
+  double g;
+  double q;
+  double k;
+  double vh;
+  double vb;
+  double a0;
+
+  clear();
+  ana_sample_rate=samprate;
+  ana_channels=chans;
+  ana_subblock_frames=samprate/10;
+  ana_subblock_sum.resize(chans,0.0);
+  ana_kweight.resize(4*chans,0.0);
+
+  //
+  // K-weighting filter (ITU-R BS.1770), recalculated for the sample rate
+  //
+  // Stage One -- High Shelf
+  //
+  f0=1681.974450955533;
+  g=3.999843853973347;
+  q=0.7071752369554196;
+  k=tan(M_PI*f0/(double)samprate);
+  vh=pow(10.0,g/20.0);
+  vb=pow(vh,0.4996667741545416);
+  a0=1.0+k/q+k*k;
+  ana_kcoeffs[0]=(vh+vb*k/q+k*k)/a0;
+  ana_kcoeffs[1]=2.0*(k*k-vh)/a0;
+  ana_kcoeffs[2]=(vh-vb*k/q+k*k)/a0;
+  ana_kcoeffs[3]=2.0*(k*k-1.0)/a0;
+  ana_kcoeffs[4]=(1.0-k/q+k*k)/a0;
+
+  //
+  // Stage Two -- High Pass
+  //
+  f0=38.13547087602444;
+  q=0.5003270373238773;
+  k=tan(M_PI*f0/(double)samprate);
+  a0=1.0+k/q+k*k;
+  ana_kcoeffs[5]=1.0;
+  ana_kcoeffs[6]=-2.0;
+  ana_kcoeffs[7]=1.0;
+  ana_kcoeffs[8]=2.0*(k*k-1.0)/a0;
+  ana_kcoeffs[9]=(1.0-k/q+k*k)/a0;
+}
+
+
+void RDAudioAnalysis::addFrames(const float *pcm,unsigned frames)
+{
+  float sample;
+  float level;
+  double x;
+  double y;
+  double *z;
+  double *c;
+  unsigned short energy;
+
+  if(ana_channels==0) {
+    return;
+  }
+  for(unsigned i=0;i<frames;i++) {
+    if(ana_energy_ptr==0) {
+      for(unsigned j=0;j<ana_channels;j++) {
+	ana_energy.push_back(0);
+      }
+    }
+    for(unsigned j=0;j<ana_channels;j++) {
+      sample=pcm[i*ana_channels+j];
+      if(sample>1.0) {
+	sample=1.0;
+      }
+      if(sample<-1.0) {
+	sample=-1.0;
+      }
+
+      //
+      // Peak and Energy
+      //
+      level=fabsf(sample);
+      if(level>ana_peak) {
+	ana_peak=level;
+      }
+      energy=(unsigned short)lrintf(level*32767.0);
+      if(energy>ana_energy[ana_energy.size()-ana_channels+j]) {
+	ana_energy[ana_energy.size()-ana_channels+j]=energy;
+      }
+
+      //
+      // Loudness
+      //
+      z=&ana_kweight[4*j];
+      c=ana_kcoeffs;
+      x=sample;
+      y=c[0]*x+z[0];
+      z[0]=c[1]*x-c[3]*y+z[1];
+      z[1]=c[2]*x-c[4]*y;
+      x=y;
+      y=c[5]*x+z[2];
+      z[2]=c[6]*x-c[8]*y+z[3];
+      z[3]=c[7]*x-c[9]*y;
+      ana_subblock_sum[j]+=y*y;
+    }
+    if(++ana_energy_ptr==RDAUDIOANALYSIS_ENERGY_FRAMES) {
+      ana_energy_ptr=0;
+    }
+    if(++ana_subblock_ptr==ana_subblock_frames) {
+      x=0.0;
+      for(unsigned j=0;j<ana_channels;j++) {
+	x+=ana_subblock_sum[j]/(double)ana_subblock_frames;
+	ana_subblock_sum[j]=0.0;
+      }
+      ana_subblocks.push_back(x);
+      ana_subblock_ptr=0;
+    }
+  }
+  ana_frames+=frames;
+}
+
+
+void RDAudioAnalysis::finish()
+{
+  double sum=0.0;
+  unsigned count=0;
+  double z;
+  double rel_gate;
+  std::vector<double> blocks;
+
+  if(ana_channels==0) {
+    return;
+  }
+
+  //
+  // Peak Level
+  //
+  if(ana_peak>0.0) {
+    ana_peak_level=(int)lrint(2000.0*log10(ana_peak));
+  }
+
+  //
+  // Integrated Loudness (ITU-R BS.1770)
+  //
+  // 400 mS blocks at 75% overlap, absolute gate at -70 LUFS and
+  // relative gate at 10 LU below the absolute-gated loudness.
+  //
+  for(unsigned i=3;i<ana_subblocks.size();i++) {
+    z=(ana_subblocks[i-3]+ana_subblocks[i-2]+
+       ana_subblocks[i-1]+ana_subblocks[i])/4.0;
+    if((-0.691+10.0*log10(z))>-70.0) {
+      blocks.push_back(z);
+      sum+=z;
+    }
+  }
+  if(blocks.size()>0) {
+    rel_gate=-0.691+10.0*log10(sum/(double)blocks.size())-10.0;
+    sum=0.0;
+    for(unsigned i=0;i<blocks.size();i++) {
+      if((-0.691+10.0*log10(blocks[i]))>rel_gate) {
+	sum+=blocks[i];
+	count++;
+      }
+    }
+    if(count>0) {
+      ana_loudness=
+	(int)lrint(100.0*(-0.691+10.0*log10(sum/(double)count)));
+    }
+  }
+
+  //
+  // Trim Points
+  //
+  // These use the same thresholds as RDWaveFile::startTrim() and
+  // RDWaveFile::endTrim().
+  //
+  ana_start_points.clear();
+  ana_end_points.clear();
+  for(int i=0;i<RDAUDIOANALYSIS_TRIM_LEVELS;i++) {
+    ana_start_points.push_back(TrimPoint(REFERENCE_LEVEL+100*i,false));
+    ana_end_points.push_back(TrimPoint(REFERENCE_LEVEL+100*i,true));
+  }
+
+  //
+  // Peak Pyramid
+  //
+  ana_pyramid.clear();
+  ana_pyramid.push_back(ana_energy);
+  while(ana_pyramid.back().size()>ana_channels) {
+    std::vector<unsigned short> *prev=&ana_pyramid.back();
+    std::vector<unsigned short> next;
+    for(unsigned i=0;i<prev->size();i+=2*ana_channels) {
+      for(unsigned j=0;j<ana_channels;j++) {
+	unsigned short val=prev->at(i+j);
+	if(((i+ana_channels+j)<prev->size())&&
+	   (prev->at(i+ana_channels+j)>val)) {
+	  val=prev->at(i+ana_channels+j);
+	}
+	next.push_back(val);
+      }
+    }
+    ana_pyramid.push_back(next);
+  }
+}
+
+
+unsigned RDAudioAnalysis::sampleRate() const
+{
+  return ana_sample_rate;
+}
+
+
+unsigned RDAudioAnalysis::channels() const
+{
+  return ana_channels;
+}
+
+
+unsigned RDAudioAnalysis::frames() const
+{
+  return ana_frames;
+}
+
+
+int RDAudioAnalysis::length() const
+{
+  if(ana_sample_rate==0) {
+    return 0;
+  }
+  return (int)(1000.0*(double)ana_frames/(double)ana_sample_rate);
+}
+
+
+int RDAudioAnalysis::peakLevel() const
+{
+  return ana_peak_level;
+}
+
+
+int RDAudioAnalysis::loudness() const
+{
+  return ana_loudness;
+}
+
+
+bool RDAudioAnalysis::hasTrimLevel(int level) const
+{
+  return (level<=0)&&((level%100)==0)&&
+    ((-level/100)<(int)ana_start_points.size());
+}
+
+
+int RDAudioAnalysis::startPoint(int level) const
+{
+  if(!hasTrimLevel(level)) {
+    return -1;
+  }
+  return ana_start_points[-level/100];
+}
+
+
+int RDAudioAnalysis::endPoint(int level) const
+{
+  if(!hasTrimLevel(level)) {
+    return -1;
+  }
+  return ana_end_points[-level/100];
+}
+
+
+unsigned RDAudioAnalysis::pyramidLevels() const
+{
+  return ana_pyramid.size();
+}
+
+
+std::vector<unsigned short> RDAudioAnalysis::pyramid(unsigned level) const
+{
+  if(level<ana_pyramid.size()) {
+    return ana_pyramid[level];
+  }
+  return std::vector<unsigned short>();
+}
+
+
+QString RDAudioAnalysis::sha1Hash() const
+{
+  return ana_sha1_hash;
+}
+
+
+void RDAudioAnalysis::setSha1Hash(const QString &str)
+{
+  ana_sha1_hash=str;
+}
+
+
+bool RDAudioAnalysis::load(const QString &filename)
+{
+  RDProfile *p=new RDProfile();
+  bool ok=false;
+  QString str;
+
+  clear();
+  if(!p->setSource(RDAudioAnalysis::sidecarName(filename))) {
+    delete p;
+    return false;
+  }
+
+  //
+  // Make sure we still describe the same audio
+  //
+  str=p->stringValue("Analysis","Fingerprint","",&ok);
+  if((!ok)||(str!=RDFileFingerprint(filename))) {
+    delete p;
+    return false;
+  }
+  ana_sha1_hash=p->stringValue("Analysis","Sha1Hash");
+  ana_sample_rate=p->intValue("Analysis","SampleRate");
+  ana_channels=p->intValue("Analysis","Channels");
+  ana_frames=p->intValue("Analysis","Frames");
+  ana_peak_level=
+    p->intValue("Analysis","PeakLevel",RDAUDIOANALYSIS_NO_LEVEL);
+  ana_loudness=p->intValue("Analysis","Loudness",RDAUDIOANALYSIS_NO_LEVEL);
+  if((ana_sample_rate==0)||(ana_channels==0)) {
+    clear();
+    delete p;
+    return false;
+  }
+
+  for(int i=0;i<RDAUDIOANALYSIS_TRIM_LEVELS;i++) {
+    ana_start_points.push_back(p->intValue("Trim",
+				 QString().sprintf("StartPoint%d",i),-1,&ok));
+    if(!ok) {
+      ana_start_points.pop_back();
+      break;
+    }
+    ana_end_points.push_back(p->intValue("Trim",
+			       QString().sprintf("EndPoint%d",i),-1));
+  }
+
+  //
+  // Only the coarser pyramid levels are stored
+  //
+  int first=p->intValue("Pyramid","FirstLevel");
+  int levels=p->intValue("Pyramid","Levels");
+  for(int i=0;i<levels;i++) {
+    ana_pyramid.push_back(std::vector<unsigned short>());
+    if(i>=first) {
+      QStringList f0=p->stringValue("Pyramid",QString().sprintf("Level%d",i)).
+	split(",",QString::SkipEmptyParts);
+      for(int j=0;j<f0.size();j++) {
+	ana_pyramid.back().push_back(f0.at(j).toUShort());
+      }
+    }
+  }
+  delete p;
+
+  return true;
+}
+
+
+bool RDAudioAnalysis::save(const QString &filename) const
+{
+  FILE *f=NULL;
+  QString sidecar=RDAudioAnalysis::sidecarName(filename);
+  QString tempname=sidecar+QString().sprintf(".%d",getpid());
+
+  if((f=fopen(tempname.toUtf8(),"w"))==NULL) {
+    return false;
+  }
+  fprintf(f,"[Analysis]\n");
+  fprintf(f,"Fingerprint=%s\n",
+	  RDFileFingerprint(filename).toUtf8().constData());
+  fprintf(f,"Sha1Hash=%s\n",ana_sha1_hash.toUtf8().constData());
+  fprintf(f,"SampleRate=%u\n",ana_sample_rate);
+  fprintf(f,"Channels=%u\n",ana_channels);
+  fprintf(f,"Frames=%u\n",ana_frames);
+  fprintf(f,"PeakLevel=%d\n",ana_peak_level);
+  fprintf(f,"Loudness=%d\n",ana_loudness);
+  fprintf(f,"\n");
+
+  fprintf(f,"[Trim]\n");
+  for(unsigned i=0;i<ana_start_points.size();i++) {
+    fprintf(f,"StartPoint%u=%d\n",i,ana_start_points[i]);
+    fprintf(f,"EndPoint%u=%d\n",i,ana_end_points[i]);
+  }
+  fprintf(f,"\n");
+
+  fprintf(f,"[Pyramid]\n");
+  fprintf(f,"FirstLevel=%d\n",RDAUDIOANALYSIS_PYRAMID_FIRST_LEVEL);
+  fprintf(f,"Levels=%u\n",(unsigned)ana_pyramid.size());
+  for(unsigned i=RDAUDIOANALYSIS_PYRAMID_FIRST_LEVEL;i<ana_pyramid.size();
+      i++) {
+    fprintf(f,"Level%u=",i);
+    for(unsigned j=0;j<ana_pyramid[i].size();j++) {
+      fprintf(f,"%s%u",j==0?"":",",ana_pyramid[i][j]);
+    }
+    fprintf(f,"\n");
+  }
+  if(fclose(f)!=0) {
+    unlink(tempname.toUtf8());
+    return false;
+  }
+  if(rename(tempname.toUtf8(),sidecar.toUtf8())!=0) {
+    unlink(tempname.toUtf8());
+    return false;
+  }
+
+  return true;
+}
+
+
+void RDAudioAnalysis::clear()
+{
+  ana_sample_rate=0;
+  ana_channels=0;
+  ana_frames=0;
+  ana_peak=0.0;
+  ana_peak_level=RDAUDIOANALYSIS_NO_LEVEL;
+  ana_loudness=RDAUDIOANALYSIS_NO_LEVEL;
+  ana_energy.clear();
+  ana_energy_ptr=0;
+  ana_kweight.clear();
+  for(unsigned i=0;i<10;i++) {
+    ana_kcoeffs[i]=0.0;
+  }
+  ana_subblock_sum.clear();
+  ana_subblock_ptr=0;
+  ana_subblock_frames=0;
+  ana_subblocks.clear();
+  ana_start_points.clear();
+  ana_end_points.clear();
+  ana_pyramid.clear();
+  ana_sha1_hash="";
+}
+
+
+QString RDAudioAnalysis::sidecarName(const QString &filename)
+{
+  return filename+".analysis";
+}
+
+
+void RDAudioAnalysis::removeSidecar(const QString &filename)
+{
+  unlink(RDAudioAnalysis::sidecarName(filename).toUtf8());
+}
+
+
+int RDAudioAnalysis::TrimPoint(unsigned threshold,bool from_end) const
+{
+  double ratio=pow(10,-(double)threshold/2000.0)*32768.0;
+  int point=-1;
+
+  if(from_end) {
+    for(int i=ana_energy.size()-1;i>=0;i--) {
+      if((double)ana_energy[i]>=ratio) {
+	point=i*RDAUDIOANALYSIS_ENERGY_FRAMES/ana_channels;
+	break;
+      }
+    }
+  }
+  else {
+    for(unsigned i=0;i<ana_energy.size();i++) {
+      if((double)ana_energy[i]>=ratio) {
+	point=i*RDAUDIOANALYSIS_ENERGY_FRAMES/ana_channels;
+	break;
+      }
+    }
+  }
+  if(point>=0) {
+    point=(int)(1000.0*(double)point/(double)ana_sample_rate);
+  }
+  return point;
+}
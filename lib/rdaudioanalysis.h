@@ -0,0 +1,95 @@
+// rdaudioanalysis.h
+//
+// Single-pass analysis of audio as it is converted.
+//
+//   (C) Copyright 2021 Fred Gleason <fredg@paravelsystems.com>
+//
+//   This program is free software; you can redistribute it and/or modify
+//   it under the terms of the GNU General Public License version 2 as
+//   published by the Free Software Foundation.
+//
+//   This program is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//   GNU General Public License for more details.
+//
+//   You should have received a copy of the GNU General Public
+//   License along with this program; if not, write to the Free Software
+//   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+//
+
+#ifndef RDAUDIOANALYSIS_H
+#define RDAUDIOANALYSIS_H
+
+#include <vector>
+
+#include <qstring.h>
+
+//
+// Value returned for a level that could not be determined
+// (e.g. the peak of digital silence).
+//
+#define RDAUDIOANALYSIS_NO_LEVEL -100000
+
+//
+// Trim points are precomputed for every whole dB from 0 to this level.
+//
+#define RDAUDIOANALYSIS_TRIM_LEVELS 100
+
+//
+// Coarsest energy data (in powers of two of 1152 frame blocks)
+// written to the sidecar file.
+//
+#define RDAUDIOANALYSIS_PYRAMID_FIRST_LEVEL 4
+
+class RDAudioAnalysis
+{
+ public:
+  RDAudioAnalysis();
+  ~RDAudioAnalysis();
+  void start(unsigned samprate,unsigned chans);
+  void addFrames(const float *pcm,unsigned frames);
+  void finish();
+  unsigned sampleRate() const;
+  unsigned channels() const;
+  unsigned frames() const;
+  int length() const;
+  int peakLevel() const;
+  int loudness() const;
+  bool hasTrimLevel(int level) const;
+  int startPoint(int level) const;
+  int endPoint(int level) const;
+  unsigned pyramidLevels() const;
+  std::vector<unsigned short> pyramid(unsigned level) const;
+  QString sha1Hash() const;
+  void setSha1Hash(const QString &str);
+  bool load(const QString &filename);
+  bool save(const QString &filename) const;
+  void clear();
+  static QString sidecarName(const QString &filename);
+  static void removeSidecar(const QString &filename);
+
+ private:
+  int TrimPoint(unsigned threshold,bool from_end) const;
+  unsigned ana_sample_rate;
+  unsigned ana_channels;
+  unsigned ana_frames;
+  float ana_peak;
+  int ana_peak_level;
+  int ana_loudness;
+  std::vector<unsigned short> ana_energy;
+  unsigned ana_energy_ptr;
+  std::vector<double> ana_kweight;
+  double ana_kcoeffs[10];
+  std::vector<double> ana_subblock_sum;
+  unsigned ana_subblock_ptr;
+  unsigned ana_subblock_frames;
+  std::vector<double> ana_subblocks;
+  std::vector<int> ana_start_points;
+  std::vector<int> ana_end_points;
+  std::vector<std::vector<unsigned short> > ana_pyramid;
+  QString ana_sha1_hash;
+};
+
+
+#endif  // RDAUDIOANALYSIS_H
@@ -59,6 +59,7 @@
 #include <mpegfile.h>
 #include <qfile.h>
 
+#define STAGE1_MPEG_PREROLL 2304
 #define STAGE2_XFER_SIZE 2048
 #define STAGE2_BUFFER_SIZE 49152
 
@@ -69,6 +70,7 @@ RDAudioConvert::RDAudioConvert(QObject *parent)
   conv_end_point=-1;
   conv_speed_ratio=1.0;
   conv_peak_sample=0.0;
+  conv_analysis=NULL;
   conv_settings=NULL;
   conv_src_wavedata=new RDWaveData();
   conv_dst_wavedata=NULL;
@@ -145,6 +147,12 @@ void RDAudioConvert::setSpeedRatio(float ratio)
 }
 
 
+void RDAudioConvert::setAnalysis(RDAudioAnalysis *ana)
+{
+  conv_analysis=ana;
+}
+
+
 RDAudioConvert::ErrorCode RDAudioConvert::convert()
 {
   RDAudioConvert::ErrorCode err;
@@ -562,6 +570,7 @@ RDAudioConvert::ErrorCode RDAudioConvert::Stage1Mpeg(const QString &dstfile,
   sf_count_t start=0;
   int64_t end=-1;
   sf_count_t frames=0;
+  int pcm_length=0;
 
   //
   // Load MAD
@@ -599,6 +608,17 @@ RDAudioConvert::ErrorCode RDAudioConvert::Stage1Mpeg(const QString &dstfile,
   if(conv_end_point>=0) {
     end=(double)conv_end_point*(double)wave->getSamplesPerSec()/1000.0;
   }
+
+  //
+  // Seek straight to the start point, allowing a few frames of preroll
+  // for the decoder to settle
+  //
+  if(start>STAGE1_MPEG_PREROLL) {
+    int pos=wave->seekMpegSample(start-STAGE1_MPEG_PREROLL);
+    if(pos>0) {
+      frames=pos;
+    }
+  }
   while((n=wave->readWave(buffer+left_over,fsize))>0) {
     if((buffer[left_over]==0xff)&&(buffer[2+left_over]&0x02)!=0) {
        n+=wave->readWave(buffer+left_over+n,1);  // Padding slot
@@ -612,27 +632,38 @@ RDAudioConvert::ErrorCode RDAudioConvert::Stage1Mpeg(const QString &dstfile,
 	if(!MAD_RECOVERABLE(mad_stream.error)) {
 	  break;
 	}
-	else {
+	if(mad_stream.error<MAD_ERROR_BADCRC) {  // No frame here
 	  continue;
 	}
+
+	//
+	// A damaged frame (such as one whose bit reservoir lies before
+	// the point we seeked to) still takes up its share of the
+	// timeline, so substitute silence for it
+	//
+	pcm_length=32*MAD_NSBSAMPLES(&mad_frame.header);
+	memset(sf_buffer,0,pcm_length*wave->getChannels()*sizeof(float));
       }
-      mad_synth_frame(&mad_synth,&mad_frame);
-      for(int i=0;i<mad_synth.pcm.length;i++) {
-	for(int j=0;j<mad_synth.pcm.channels;j++) {
-	  sf_buffer[i*mad_synth.pcm.channels+j]=
-	    (float)mad_f_todouble(mad_synth.pcm.samples[j][i]);
+      else {
+	mad_synth_frame(&mad_synth,&mad_frame);
+	pcm_length=mad_synth.pcm.length;
+	for(int i=0;i<mad_synth.pcm.length;i++) {
+	  for(int j=0;j<mad_synth.pcm.channels;j++) {
+	    sf_buffer[i*mad_synth.pcm.channels+j]=
+	      (float)mad_f_todouble(mad_synth.pcm.samples[j][i]);
+	  }
 	}
       }
       if(frames>=start) {
-	if((end<0)||((frames+mad_synth.pcm.length)<end)) { // Write full buffer 
-	  UpdatePeak(sf_buffer,mad_synth.pcm.length*wave->getChannels());
-	  sf_writef_float(sf_dst,sf_buffer,mad_synth.pcm.length);
+	if((end<0)||((frames+pcm_length)<end)) { // Write full buffer 
+	  UpdatePeak(sf_buffer,pcm_length*wave->getChannels());
+	  sf_writef_float(sf_dst,sf_buffer,pcm_length);
 	}
 	else {
-	  if(frames<(frames+mad_synth.pcm.length)) {  // Write start of buffer
+	  if(frames<(frames+pcm_length)) {  // Write start of buffer
 	    UpdatePeak(sf_buffer,
-		       (frames+mad_synth.pcm.length-end)*wave->getChannels());
-	    sf_writef_float(sf_dst,sf_buffer,frames+mad_synth.pcm.length-end);
+		       (frames+pcm_length-end)*wave->getChannels());
+	    sf_writef_float(sf_dst,sf_buffer,frames+pcm_length-end);
 	    //
 	    // Done -- no need to decode the rest
 	    //
@@ -646,14 +677,13 @@ RDAudioConvert::ErrorCode RDAudioConvert::Stage1Mpeg(const QString &dstfile,
 	}
       }
       else {
-	int diff=frames+mad_synth.pcm.length-start;
+	int diff=frames+pcm_length-start;
 	if(diff>0) {   // Write end of buffer
-	  UpdatePeak(sf_buffer+diff,
-		     (mad_synth.pcm.length-diff)*wave->getChannels());
-	  sf_writef_float(sf_dst,sf_buffer+diff,mad_synth.pcm.length-diff);
+	  UpdatePeak(sf_buffer+diff,(pcm_length-diff)*wave->getChannels());
+	  sf_writef_float(sf_dst,sf_buffer+diff,pcm_length-diff);
 	}
       }
-      frames+=mad_synth.pcm.length;
+      frames+=pcm_length;
 
     }
     left_over=mad_stream.bufend-mad_stream.next_frame;
@@ -1006,6 +1036,13 @@ RDAudioConvert::ErrorCode RDAudioConvert::Stage2Convert(const QString &srcfile,
     ratio=exp10f(gain/20.0);
   }
 
+  //
+  // Initialize Analysis
+  //
+  if(conv_analysis!=NULL) {
+    conv_analysis->start(dst_info.samplerate,dst_info.channels);
+  }
+
   //
   // Convert
   //
@@ -1074,8 +1111,11 @@ RDAudioConvert::ErrorCode RDAudioConvert::Stage2Convert(const QString &srcfile,
     }
 
     //
-    // Write Output
+    // Analyze and Write Output
     //
+    if(conv_analysis!=NULL) {
+      conv_analysis->addFrames(pcm[2],n);
+    }
     if(sf_writef_float(dst_sf,pcm[2],n)!=n) {
       for(unsigned i=0;i<3;i++) {
 	if(free_pcm[i]) {
@@ -1100,6 +1140,9 @@ RDAudioConvert::ErrorCode RDAudioConvert::Stage2Convert(const QString &srcfile,
     while((n=st_conv->
 	   receiveSamples((soundtouch::SAMPLETYPE *)pcm[2],
 			  STAGE2_BUFFER_SIZE/dst_info.channels))>0) {
+      if(conv_analysis!=NULL) {
+	conv_analysis->addFrames(pcm[2],n);
+      }
       if(sf_writef_float(dst_sf,pcm[2],n)!=n) {
 	for(unsigned i=0;i<3;i++) {
 	  if(free_pcm[i]) {
@@ -1131,6 +1174,9 @@ RDAudioConvert::ErrorCode RDAudioConvert::Stage2Convert(const QString &srcfile,
   }
   sf_close(src_sf);
   sf_close(dst_sf);
+  if(conv_analysis!=NULL) {
+    conv_analysis->finish();
+  }
 
   return RDAudioConvert::ErrorOk;
 }
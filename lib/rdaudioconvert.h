@@ -38,6 +38,7 @@
 
 #include <qobject.h>
 
+#include "rdaudioanalysis.h"
 #include "rdconfig.h"
 #include "rdsettings.h"
 #include "rdwavedata.h"
@@ -62,6 +63,7 @@ class RDAudioConvert : public QObject
   void setDestinationRdxl(const QString &xml);
   void setRange(int start_pt,int end_pt);
   void setSpeedRatio(float ratio);
+  void setAnalysis(RDAudioAnalysis *ana);
   RDAudioConvert::ErrorCode convert();
   static bool settingsValid(RDSettings *settings);
   static QString errorText(RDAudioConvert::ErrorCode err);
@@ -119,6 +121,7 @@ class RDAudioConvert : public QObject
   QString conv_src_rdxl;
   QString conv_dst_rdxl;
   float conv_peak_sample;
+  RDAudioAnalysis *conv_analysis;
   int conv_src_converter;
   void *conv_mad_handle;
   void *conv_lame_handle;
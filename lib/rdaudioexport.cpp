@@ -126,6 +126,18 @@ void RDAudioExport::setEnableMetadata(bool state)
 }
 
 
+QString RDAudioExport::webServiceUrl() const
+{
+  return conv_web_service_url;
+}
+
+
+void RDAudioExport::setWebServiceUrl(const QString &url)
+{
+  conv_web_service_url=url;
+}
+
+
 RDAudioExport::ErrorCode RDAudioExport::runExport(const QString &username,
 						  const QString &password,
 					 RDAudioConvert::ErrorCode *conv_err)
@@ -210,7 +222,11 @@ RDAudioExport::ErrorCode RDAudioExport::runExport(const QString &username,
   // error.
   //
   //  strncpy(url,rda->station()->webServiceUrl(rda->config()),1024);
-  curl_easy_setopt(curl,CURLOPT_URL,rda->station()->webServiceUrl(rda->config()).toUtf8().constData());
+  QString url=conv_web_service_url;
+  if(url.isEmpty()) {
+    url=rda->station()->webServiceUrl(rda->config());
+  }
+  curl_easy_setopt(curl,CURLOPT_URL,url.toUtf8().constData());
   curl_easy_setopt(curl,CURLOPT_HTTPPOST,first);
   curl_easy_setopt(curl,CURLOPT_WRITEDATA,f);
   curl_easy_setopt(curl,CURLOPT_USERAGENT,
@@ -45,6 +45,8 @@ class RDAudioExport : public QObject
   void setDestinationSettings(RDSettings *settings);
   void setRange(int start_pt,int end_pt);
   void setEnableMetadata(bool state);
+  QString webServiceUrl() const;
+  void setWebServiceUrl(const QString &url);
   RDAudioExport::ErrorCode runExport(const QString &username,
 				     const QString &password,
 				     RDAudioConvert::ErrorCode *conv_err);
@@ -65,6 +67,7 @@ class RDAudioExport : public QObject
   int conv_start_point;
   int conv_end_point;
   bool conv_enable_metadata;
+  QString conv_web_service_url;
   RDSettings *conv_settings;
   bool conv_aborting;
 };
@@ -27,6 +27,7 @@
 
 #include <qstringlist.h>
 #include <qobject.h>
+#include <qsqlrecord.h>
 
 #include <rd.h>
 #include <rdapplication.h>
@@ -60,23 +61,55 @@ RDCart::RDCart(unsigned number)
 {
   cart_number=number;
   metadata_changed=false;
+  cart_snapshot=false;
+  cart_row_valid=false;
 }
 
 
 RDCart::~RDCart()
 {
-  if(metadata_changed) {
-    writeTimestamp();
+  if(metadata_changed||(cart_dirty.size()>0)) {
+    commit();
   }
 }
 
 
 bool RDCart::exists() const
 {
+  if(cart_row_valid) {
+    return true;
+  }
   return RDDoesRowExist("CART","NUMBER",cart_number);
 }
 
 
+bool RDCart::loadSnapshot()
+{
+  cart_snapshot=true;
+
+  return LoadRow();
+}
+
+
+bool RDCart::hasSnapshot() const
+{
+  return cart_snapshot;
+}
+
+
+bool RDCart::commit()
+{
+  bool ret=FlushRow(metadata_changed);
+
+  if(metadata_changed) {
+    cart_row_valid=false;  // Pick up the new METADATA_DATETIME
+    metadata_changed=false;
+  }
+
+  return ret;
+}
+
+
 bool RDCart::selectCut(QString *cut) const
 {
   return selectCut(cut,QTime::currentTime());
@@ -117,14 +150,14 @@ bool RDCart::selectCut(QString *cut,const QTime &time) const
       "LOCAL_COUNTER,"+
       "LAST_PLAY_DATETIME "+
       "from CUTS  where ("+
-      "((START_DATETIME<=\""+datetime_str+"\")&&"+
-      "(END_DATETIME>=\""+datetime_str+"\"))||"+
+      "((START_DATETIME<=?)&&"+
+      "(END_DATETIME>=?))||"+
       "(START_DATETIME is null))&&"+
-      "(((START_DAYPART<=\""+time_str+"\")&&"+
-      "(END_DAYPART>=\""+time_str+"\")||"+
+      "(((START_DAYPART<=?)&&"+
+      "(END_DAYPART>=?)||"+
       "START_DAYPART is null))&&"+
       "("+RDGetShortDayNameEN(current_date.dayOfWeek()).toUpper()+"=\"Y\")&&"+
-      QString().sprintf("(CART_NUMBER=%u)&&(EVERGREEN=\"N\")&&",cart_number)+
+      "(CART_NUMBER=?)&&(EVERGREEN=\"N\")&&"+
       "(LENGTH>0)";
     if(useWeighting()) {
       sql+=" order by LOCAL_COUNTER ASC, ISNULL(END_DATETIME), END_DATETIME ASC, \
@@ -133,7 +166,8 @@ bool RDCart::selectCut(QString *cut,const QTime &time) const
     else {
       sql+=" order by LAST_PLAY_DATETIME desc, PLAY_ORDER desc";
     }
-    q=new RDSqlQuery(sql);
+    q=new RDSqlQuery(sql,QList<QVariant>()<<datetime_str<<datetime_str<<
+		     time_str<<time_str<<cart_number);
     cutname=GetNextCut(q);
     delete q;
     break;
@@ -150,7 +184,7 @@ bool RDCart::selectCut(QString *cut,const QTime &time) const
       "LOCAL_COUNTER "+
       "LAST_PLAY_DATETIME "+
       "from CUTS where "+
-      QString().sprintf("(CART_NUMBER=%u)&&",cart_number)+
+      "(CART_NUMBER=?)&&"+
       "(EVERGREEN=\"Y\")&&"+
       "(LENGTH>0)";
     if(useWeighting()) {
@@ -159,7 +193,7 @@ bool RDCart::selectCut(QString *cut,const QTime &time) const
     else {
       sql+=" order by LAST_PLAY_DATETIME desc";
     }
-    q=new RDSqlQuery(sql);
+    q=new RDSqlQuery(sql,QList<QVariant>()<<cart_number);
     cutname=GetNextCut(q);
     delete q;
   }
@@ -178,8 +212,7 @@ unsigned RDCart::number() const
 
 QString RDCart::groupName() const
 {
-  return RDGetSqlValue("CART","NUMBER",cart_number,"GROUP_NAME").
-    toString();
+  return GetRow("GROUP_NAME").toString();
 }
 
 
@@ -192,8 +225,7 @@ void RDCart::setGroupName(const QString &name)
 
 RDCart::Type RDCart::type() const
 {
-  return (RDCart::Type)RDGetSqlValue("CART","NUMBER",cart_number,
-				    "TYPE").toUInt();
+  return (RDCart::Type)GetRow("TYPE").toUInt();
 }
 
 
@@ -206,7 +238,7 @@ void RDCart::setType(RDCart::Type type)
 
 QString RDCart::title() const
 {
-  return RDGetSqlValue("CART","NUMBER",cart_number,"TITLE").toString();
+  return GetRow("TITLE").toString();
 }
 
 
@@ -219,7 +251,7 @@ void RDCart::setTitle(const QString &title)
 
 QString RDCart::artist() const
 {
-  return RDGetSqlValue("CART","NUMBER",cart_number,"ARTIST").toString();
+  return GetRow("ARTIST").toString();
 }
 
 
@@ -232,7 +264,7 @@ void RDCart::setArtist(const QString &artist)
 
 QString RDCart::album() const
 {
-  return RDGetSqlValue("CART","NUMBER",cart_number,"ALBUM").toString();
+  return GetRow("ALBUM").toString();
 }
 
 
@@ -245,8 +277,7 @@ void RDCart::setAlbum(const QString &album)
 
 int RDCart::year() const
 {
-  QStringList f0=
-    RDGetSqlValue("CART","NUMBER",cart_number,"YEAR").toString().split("-");
+  QStringList f0=GetRow("YEAR").toString().split("-");
   return f0[0].toInt();
 }
 
@@ -373,7 +404,7 @@ void RDCart::updateSchedCodes(const QString &add_codes,const QString &remove_cod
 
 QString RDCart::label() const
 {
-  return RDGetSqlValue("CART","NUMBER",cart_number,"LABEL").toString();
+  return GetRow("LABEL").toString();
 }
 
 
@@ -386,7 +417,7 @@ void RDCart::setLabel(const QString &label)
 
 QString RDCart::conductor() const
 {
-  return RDGetSqlValue("CART","NUMBER",cart_number,"CONDUCTOR").toString();
+  return GetRow("CONDUCTOR").toString();
 }
 
 
@@ -399,7 +430,7 @@ void RDCart::setConductor(const QString &cond)
 
 QString RDCart::client() const
 {
-  return RDGetSqlValue("CART","NUMBER",cart_number,"CLIENT").toString();
+  return GetRow("CLIENT").toString();
 }
 
 
@@ -412,7 +443,7 @@ void RDCart::setClient(const QString &client)
 
 QString RDCart::agency() const
 {
-  return RDGetSqlValue("CART","NUMBER",cart_number,"AGENCY").toString();
+  return GetRow("AGENCY").toString();
 }
 
 
@@ -425,8 +456,7 @@ void RDCart::setAgency(const QString &agency)
 
 QString RDCart::publisher() const
 {
-  return RDGetSqlValue("CART","NUMBER",cart_number,
-		      "PUBLISHER").toString();
+  return GetRow("PUBLISHER").toString();
 }
 
 
@@ -439,8 +469,7 @@ void RDCart::setPublisher(const QString &publisher)
 
 QString RDCart::composer() const
 {
-  return RDGetSqlValue("CART","NUMBER",cart_number,
-		      "COMPOSER").toString();
+  return GetRow("COMPOSER").toString();
 }
 
 
@@ -453,8 +482,7 @@ void RDCart::setComposer(const QString &composer)
 
 QString RDCart::userDefined() const
 {
-  return RDGetSqlValue("CART","NUMBER",cart_number,
-		      "USER_DEFINED").toString();
+  return GetRow("USER_DEFINED").toString();
 }
 
 
@@ -467,7 +495,7 @@ void RDCart::setUserDefined(const QString &string)
 
 QString RDCart::songId() const
 {
-  return RDGetSqlValue("CART","NUMBER",cart_number,"SONG_ID").toString();
+  return GetRow("SONG_ID").toString();
 }
 
 
@@ -480,7 +508,7 @@ void RDCart::setSongId(const QString &id)
 
 unsigned RDCart::beatsPerMinute() const
 {
-  return RDGetSqlValue("CART","NUMBER",cart_number,"BPM").toUInt();
+  return GetRow("BPM").toUInt();
 }
 
 
@@ -493,8 +521,7 @@ void RDCart::setBeatsPerMinute(unsigned bpm)
 
 RDCart::UsageCode RDCart::usageCode() const
 {
-  return (RDCart::UsageCode) RDGetSqlValue("CART","NUMBER",cart_number,
-		      "USAGE_CODE").toInt();
+  return (RDCart::UsageCode) GetRow("USAGE_CODE").toInt();
 }
 
 
@@ -507,7 +534,7 @@ void RDCart::setUsageCode(RDCart::UsageCode code)
 
 QString RDCart::notes() const
 {
-  return RDGetSqlValue("CART","NUMBER",cart_number,"NOTES").toString();
+  return GetRow("NOTES").toString();
 }
 
 
@@ -520,8 +547,7 @@ void RDCart::setNotes(const QString &notes)
 
 unsigned RDCart::forcedLength() const
 {
-  return RDGetSqlValue("CART","NUMBER",cart_number,
-		      "FORCED_LENGTH").toUInt();
+  return GetRow("FORCED_LENGTH").toUInt();
 }
 
 
@@ -534,8 +560,7 @@ void RDCart::setForcedLength(unsigned length)
 
 unsigned RDCart::lengthDeviation() const
 {
-  return RDGetSqlValue("CART","NUMBER",cart_number,
-		      "LENGTH_DEVIATION").toUInt();
+  return GetRow("LENGTH_DEVIATION").toUInt();
 }
 
 
@@ -608,8 +633,7 @@ unsigned RDCart::calculateAverageLength(unsigned *max_dev) const
 
 unsigned RDCart::averageLength() const
 {
-  return RDGetSqlValue("CART","NUMBER",cart_number,
-		      "AVERAGE_LENGTH").toUInt();
+  return GetRow("AVERAGE_LENGTH").toUInt();
 }
 
 
@@ -621,8 +645,7 @@ void RDCart::setAverageLength(unsigned length) const
 
 unsigned RDCart::minimumTalkLength() const
 {
-  return RDGetSqlValue("CART","NUMBER",cart_number,
-		      "MINIMUM_TALK_LENGTH").toUInt();
+  return GetRow("MINIMUM_TALK_LENGTH").toUInt();
 }
 
 
@@ -634,8 +657,7 @@ void RDCart::setMinimumTalkLength(unsigned length) const
 
 unsigned RDCart::maximumTalkLength() const
 {
-  return RDGetSqlValue("CART","NUMBER",cart_number,
-		      "MAXIMUM_TALK_LENGTH").toUInt();
+  return GetRow("MAXIMUM_TALK_LENGTH").toUInt();
 }
 
 
@@ -647,8 +669,7 @@ void RDCart::setMaximumTalkLength(unsigned length) const
 
 unsigned RDCart::averageSegueLength() const
 {
-  return RDGetSqlValue("CART","NUMBER",cart_number,
-		      "AVERAGE_SEGUE_LENGTH").toUInt();
+  return GetRow("AVERAGE_SEGUE_LENGTH").toUInt();
 }
 
 
@@ -660,8 +681,7 @@ void RDCart::setAverageSegueLength(unsigned length) const
 
 unsigned RDCart::averageHookLength() const
 {
-  return RDGetSqlValue("CART","NUMBER",cart_number,
-		      "AVERAGE_HOOK_LENGTH").toUInt();
+  return GetRow("AVERAGE_HOOK_LENGTH").toUInt();
 }
 
 
@@ -673,8 +693,7 @@ void RDCart::setAverageHookLength(unsigned length) const
 
 unsigned RDCart::cutQuantity() const
 {
-  return RDGetSqlValue("CART","NUMBER",cart_number,
-		      "CUT_QUANTITY").toUInt();
+  return GetRow("CUT_QUANTITY").toUInt();
 }
 
 
@@ -686,8 +705,7 @@ void RDCart::setCutQuantity(unsigned quan) const
 
 unsigned RDCart::lastCutPlayed() const
 {
-  return RDGetSqlValue("CART","NUMBER",cart_number,
-		      "LAST_CUT_PLAYED").toUInt();
+  return GetRow("LAST_CUT_PLAYED").toUInt();
 }
 
 
@@ -699,8 +717,7 @@ void RDCart::setLastCutPlayed(unsigned cut) const
 
 RDCart::PlayOrder RDCart::playOrder() const
 {
-  return (RDCart::PlayOrder)RDGetSqlValue("CART","NUMBER",cart_number,
-					 "PLAY_ORDER").toUInt();
+  return (RDCart::PlayOrder)GetRow("PLAY_ORDER").toUInt();
 }
 
 
@@ -712,8 +729,7 @@ void RDCart::setPlayOrder(RDCart::PlayOrder order) const
 
 RDCart::Validity RDCart::validity() const
 {
-  return (RDCart::Validity)RDGetSqlValue("CART","NUMBER",cart_number,
-					 "VALIDITY").toUInt();
+  return (RDCart::Validity)GetRow("VALIDITY").toUInt();
 }
 
 
@@ -726,8 +742,7 @@ void RDCart::setValidity(RDCart::Validity state)
 QDateTime RDCart::startDateTime() const
 {
   QDateTime value;
-  value=RDGetSqlValue("CART","NUMBER",cart_number,
-		     "START_DATETIME").toDateTime();
+  value=GetRow("START_DATETIME").toDateTime();
   if(value.isValid()) {
     return value;
   }
@@ -752,8 +767,7 @@ void RDCart::setStartDateTime()
 QDateTime RDCart::endDateTime() const
 {
   QDateTime value;
-  value=RDGetSqlValue("CART","NUMBER",cart_number,
-		     "END_DATETIME").toDateTime();
+  value=GetRow("END_DATETIME").toDateTime();
   if(value.isValid()) {
     return value;
   }
@@ -777,8 +791,7 @@ void RDCart::setEndDateTime()
 
 bool RDCart::enforceLength() const
 {
-  return RDBool(RDGetSqlValue("CART","NUMBER",cart_number,
-			    "ENFORCE_LENGTH").toString());
+  return RDBool(GetRow("ENFORCE_LENGTH").toString());
 }
 
 
@@ -791,8 +804,7 @@ void RDCart::setEnforceLength(bool state)
 
 bool RDCart::useWeighting() const
 {
-  return RDBool(RDGetSqlValue("CART","NUMBER",cart_number,
-			    "USE_WEIGHTING").toString());
+  return RDBool(GetRow("USE_WEIGHTING").toString());
 }
 
 
@@ -805,8 +817,7 @@ void RDCart::setUseWeighting(bool state)
 
 bool RDCart::preservePitch() const
 {
-  return RDBool(RDGetSqlValue("CART","NUMBER",cart_number,
-			    "PRESERVE_PITCH").toString());
+  return RDBool(GetRow("PRESERVE_PITCH").toString());
 }
 
 
@@ -818,8 +829,7 @@ void RDCart::setPreservePitch(bool state) const
 
 bool RDCart::asyncronous() const
 {
-  return RDBool(RDGetSqlValue("CART","NUMBER",cart_number,
-			      "ASYNCRONOUS").toString());
+  return RDBool(GetRow("ASYNCRONOUS").toString());
 }
 
 
@@ -831,7 +841,7 @@ void RDCart::setAsyncronous(bool state) const
 
 QString RDCart::owner() const
 {
-  return RDGetSqlValue("CART","NUMBER",cart_number,"OWNER").toString();
+  return GetRow("OWNER").toString();
 }
 
 
@@ -843,8 +853,7 @@ void RDCart::setOwner(const QString &owner) const
 
 bool RDCart::useEventLength() const
 {
-  return RDBool(RDGetSqlValue("CART","NUMBER",cart_number,
-			      "USE_EVENT_LENGTH").toString());
+  return RDBool(GetRow("USE_EVENT_LENGTH").toString());
 }
 
 
@@ -857,34 +866,30 @@ void RDCart::setUseEventLength(bool state) const
 void RDCart::setPending(const QString &station_name)
 {
   QString sql;
-  RDSqlQuery *q;
 
   sql=QString("update CART set PENDING_STATION=\"")+
     RDEscapeString(station_name)+"\","+
     "PENDING_DATETIME=now(),"+
     "PENDING_PID="+QString().sprintf("%d ",getpid())+
     QString().sprintf("where NUMBER=%u",cart_number);
-  q=new RDSqlQuery(sql);
-  delete q;
+  UpdateRow(sql);
 }
 
 
 void RDCart::clearPending() const
 {
   QString sql;
-  RDSqlQuery *q;
 
   sql=QString("update CART set PENDING_STATION=NULL,")+
     "PENDING_DATETIME=NULL "+
     QString().sprintf("where NUMBER=%u",cart_number);
-  q=new RDSqlQuery(sql);
-  delete q;
+  UpdateRow(sql);
 }
 
 
 QString RDCart::macros() const
 {
-  return RDGetSqlValue("CART","NUMBER",cart_number,"MACROS").toString();
+  return GetRow("MACROS").toString();
 }
 
 
@@ -989,8 +994,7 @@ void RDCart::setMetadata(const RDWaveData *data)
   if(sql.right(1)==",") {
     sql=sql.left(sql.length()-1);
     sql+=QString().sprintf(" where NUMBER=%u",cart_number);
-    RDSqlQuery *q=new RDSqlQuery(sql);
-    delete q;
+    UpdateRow(sql);
   }
   setSchedCodesList(data->schedCodes());
   metadata_changed=true;
@@ -1206,8 +1210,7 @@ void RDCart::updateLength(bool enforce_length,unsigned length)
   }
   sql+=QString().sprintf("VALIDITY=%u where NUMBER=%u",
 			 cart_validity,cart_number);
-  q=new RDSqlQuery(sql);
-  delete q;
+  UpdateRow(sql);
 }
 
 
@@ -1221,15 +1224,16 @@ void RDCart::resetRotation() const
 }
 
 
+QDateTime RDCart::metadataDatetime() const
+{
+  return GetRow("METADATA_DATETIME").toDateTime();
+}
+
+
 void RDCart::writeTimestamp()
 {
-  QString sql;
-  RDSqlQuery *q;
-  sql=QString().sprintf("update CART set METADATA_DATETIME=now() \
-                         where NUMBER=%u",cart_number);
-  q=new RDSqlQuery(sql);
-  delete q;
-  metadata_changed=false;
+  metadata_changed=true;
+  commit();
 }
 
 
@@ -1476,104 +1480,228 @@ QString RDCart::xmlSql(bool include_cuts)
 QString RDCart::xml(RDSqlQuery *q,bool include_cuts,
 		    bool absolute,RDSettings *settings,int cutnum)
 {
+  QString xml="";
+
+  while(q->next()) {
+    xml+=RDCart::xmlCart(q,include_cuts,absolute,settings);
+  }
+
+  return xml;
+}
+
+
+QString RDCart::xmlCart(RDSqlQuery *q,bool include_cuts,bool absolute,
+			RDSettings *settings)
+{
+  //
+  // Render the cart at the current row of 'q', leaving 'q' positioned
+  // on its last cut row.
+  //
   QStringList mlist;
   unsigned cartnum;
   QString xml="";
 
-  while(q->next()) {
-    xml+="<cart>\n";
-    xml+="  "+RDXmlField("number",q->value(0).toUInt());
-    switch((RDCart::Type)q->value(1).toUInt()) {
-    case RDCart::Audio:
-      xml+="  "+RDXmlField("type","audio");
-      break;
+  xml+="<cart>\n";
+  xml+="  "+RDXmlField("number",q->value(0).toUInt());
+  switch((RDCart::Type)q->value(1).toUInt()) {
+  case RDCart::Audio:
+    xml+="  "+RDXmlField("type","audio");
+    break;
 
-    case RDCart::Macro:
-      xml+="  "+RDXmlField("type","macro");
-      break;
+  case RDCart::Macro:
+    xml+="  "+RDXmlField("type","macro");
+    break;
 
-    case RDCart::All:
-      break;
-    }
-    xml+="  "+RDXmlField("groupName",q->value(2).toString());
-    xml+="  "+RDXmlField("title",q->value(3).toString());
-    xml+="  "+RDXmlField("artist",q->value(4).toString());
-    xml+="  "+RDXmlField("album",q->value(5).toString());
-    xml+="  "+RDXmlField("year",q->value(6).toDate().toString("yyyy"));
-    xml+="  "+RDXmlField("label",q->value(7).toString());
-    xml+="  "+RDXmlField("client",q->value(8).toString());
-    xml+="  "+RDXmlField("agency",q->value(9).toString());
-    xml+="  "+RDXmlField("publisher",q->value(10).toString());
-    xml+="  "+RDXmlField("composer",q->value(11).toString());
-    xml+="  "+RDXmlField("conductor",q->value(26).toString());
-    xml+="  "+RDXmlField("userDefined",q->value(12).toString());
-    xml+="  "+RDXmlField("usageCode",q->value(13).toInt());
-    xml+="  "+RDXmlField("forcedLength",
-			 "0"+RDGetTimeLength(q->value(14).toUInt(),true));
-    xml+="  "+RDXmlField("averageLength",
-			 "0"+RDGetTimeLength(q->value(15).toUInt(),true));
-    xml+="  "+RDXmlField("lengthDeviation",
-			 "0"+RDGetTimeLength(q->value(16).toUInt(),true));
-    xml+="  "+RDXmlField("averageSegueLength",
-			 "0"+RDGetTimeLength(q->value(17).toUInt(),true));
-    xml+="  "+RDXmlField("averageHookLength",
-			 "0"+RDGetTimeLength(q->value(18).toUInt(),true));
-    xml+="  "+RDXmlField("minimumTalkLength",
-			 "0"+RDGetTimeLength(q->value(19).toUInt(),true));
-    xml+="  "+RDXmlField("maximumTalkLength",
-			 "0"+RDGetTimeLength(q->value(20).toUInt(),true));
-    xml+="  "+RDXmlField("cutQuantity",q->value(21).toUInt());
-    xml+="  "+RDXmlField("lastCutPlayed",q->value(22).toUInt());
-    xml+="  "+RDXmlField("enforceLength",RDBool(q->value(24).toString()));
-    xml+="  "+RDXmlField("asyncronous",RDBool(q->value(25).toString()));
-    xml+="  "+RDXmlField("owner",q->value(26).toString());
-    xml+="  "+RDXmlField("metadataDatetime",q->value(27).toDateTime());
-    xml+="  "+RDXmlField("songId",q->value(30).toString());
-    switch((RDCart::Type)q->value(1).toInt()) {
-    case RDCart::Audio:
-      if(include_cuts) {
-	cartnum=q->value(0).toUInt();
-	if(q->value(31).toString().isEmpty()) {
-	  xml+="  <cutList/>\n";
-	}
-	else {
-	  xml+="  <cutList>\n";
-	  xml+="  "+RDCut::xml(q,absolute,settings);
-	  while(q->next()) {
-	    if(q->value(0).toUInt()==cartnum) {
-	      xml+="  "+RDCut::xml(q,absolute,settings);
-	    }
-	    else {
-	      q->previous();
-	      break;
-	    }
+  case RDCart::All:
+    break;
+  }
+  xml+="  "+RDXmlField("groupName",q->value(2).toString());
+  xml+="  "+RDXmlField("title",q->value(3).toString());
+  xml+="  "+RDXmlField("artist",q->value(4).toString());
+  xml+="  "+RDXmlField("album",q->value(5).toString());
+  xml+="  "+RDXmlField("year",q->value(6).toDate().toString("yyyy"));
+  xml+="  "+RDXmlField("label",q->value(7).toString());
+  xml+="  "+RDXmlField("client",q->value(8).toString());
+  xml+="  "+RDXmlField("agency",q->value(9).toString());
+  xml+="  "+RDXmlField("publisher",q->value(10).toString());
+  xml+="  "+RDXmlField("composer",q->value(11).toString());
+  xml+="  "+RDXmlField("conductor",q->value(26).toString());
+  xml+="  "+RDXmlField("userDefined",q->value(12).toString());
+  xml+="  "+RDXmlField("usageCode",q->value(13).toInt());
+  xml+="  "+RDXmlField("forcedLength",
+		       "0"+RDGetTimeLength(q->value(14).toUInt(),true));
+  xml+="  "+RDXmlField("averageLength",
+		       "0"+RDGetTimeLength(q->value(15).toUInt(),true));
+  xml+="  "+RDXmlField("lengthDeviation",
+		       "0"+RDGetTimeLength(q->value(16).toUInt(),true));
+  xml+="  "+RDXmlField("averageSegueLength",
+		       "0"+RDGetTimeLength(q->value(17).toUInt(),true));
+  xml+="  "+RDXmlField("averageHookLength",
+		       "0"+RDGetTimeLength(q->value(18).toUInt(),true));
+  xml+="  "+RDXmlField("minimumTalkLength",
+		       "0"+RDGetTimeLength(q->value(19).toUInt(),true));
+  xml+="  "+RDXmlField("maximumTalkLength",
+		       "0"+RDGetTimeLength(q->value(20).toUInt(),true));
+  xml+="  "+RDXmlField("cutQuantity",q->value(21).toUInt());
+  xml+="  "+RDXmlField("lastCutPlayed",q->value(22).toUInt());
+  xml+="  "+RDXmlField("enforceLength",RDBool(q->value(24).toString()));
+  xml+="  "+RDXmlField("asyncronous",RDBool(q->value(25).toString()));
+  xml+="  "+RDXmlField("owner",q->value(26).toString());
+  xml+="  "+RDXmlField("metadataDatetime",q->value(27).toDateTime());
+  xml+="  "+RDXmlField("songId",q->value(30).toString());
+  switch((RDCart::Type)q->value(1).toInt()) {
+  case RDCart::Audio:
+    if(include_cuts) {
+      cartnum=q->value(0).toUInt();
+      if(q->value(31).toString().isEmpty()) {
+	xml+="  <cutList/>\n";
+      }
+      else {
+	xml+="  <cutList>\n";
+	xml+="  "+RDCut::xml(q,absolute,settings);
+	while(q->next()) {
+	  if(q->value(0).toUInt()==cartnum) {
+	    xml+="  "+RDCut::xml(q,absolute,settings);
+	  }
+	  else {
+	    q->previous();
+	    break;
 	  }
-	  xml+="  </cutList>\n";
 	}
+	xml+="  </cutList>\n";
       }
-      break;
+    }
+    break;
 
-    case RDCart::Macro:
-      mlist=q->value(29).toString().split("!");
-      if(mlist.size()==0) {
-	xml+="  <macroList/>\n";
+  case RDCart::Macro:
+    mlist=q->value(29).toString().split("!");
+    if(mlist.size()==0) {
+      xml+="  <macroList/>\n";
+    }
+    else {
+      xml+="  <macroList>\n";
+      for(int i=0;i<mlist.size();i++) {
+	xml+="    "+RDXmlField(QString().sprintf("macro%d",i),mlist[i]+"!");
       }
-      else {
-	xml+="  <macroList>\n";
-	for(int i=0;i<mlist.size();i++) {
-	  xml+="    "+RDXmlField(QString().sprintf("macro%d",i),mlist[i]+"!");
+      xml+="  </macroList>\n";
+    }
+    break;
+
+  case RDCart::All:
+    break;
+  }
+  xml+="</cart>\n";
+
+  return xml;
+}
+
+
+QString RDCart::jsonCart(RDSqlQuery *q,bool include_cuts,bool absolute,
+			 int padding)
+{
+  //
+  // As for RDCart::xmlCart(), but rendered as a JSON object with lengths
+  // in milliseconds. The closing brace is not terminated, leaving the
+  // caller to add any separator.
+  //
+  QStringList mlist;
+  unsigned cartnum;
+  bool list=false;
+  QString pad=RDJsonPadding(padding);
+  QString json="";
+
+  json+=pad+"{\r\n";
+  json+=RDJsonField("number",q->value(0).toUInt(),4+padding);
+  switch((RDCart::Type)q->value(1).toInt()) {
+  case RDCart::Audio:
+    json+=RDJsonField("type",QString("audio"),4+padding);
+    list=include_cuts;
+    break;
+
+  case RDCart::Macro:
+    json+=RDJsonField("type",QString("macro"),4+padding);
+    list=true;
+    break;
+
+  case RDCart::All:
+    json+=RDJsonNullField("type",4+padding);
+    break;
+  }
+  json+=RDJsonField("groupName",q->value(2).toString(),4+padding);
+  json+=RDJsonField("title",q->value(3).toString(),4+padding);
+  json+=RDJsonField("artist",q->value(4).toString(),4+padding);
+  json+=RDJsonField("album",q->value(5).toString(),4+padding);
+  if(q->value(6).toDate().isValid()) {
+    json+=RDJsonField("year",q->value(6).toDate().year(),4+padding);
+  }
+  else {
+    json+=RDJsonNullField("year",4+padding);
+  }
+  json+=RDJsonField("label",q->value(7).toString(),4+padding);
+  json+=RDJsonField("client",q->value(8).toString(),4+padding);
+  json+=RDJsonField("agency",q->value(9).toString(),4+padding);
+  json+=RDJsonField("publisher",q->value(10).toString(),4+padding);
+  json+=RDJsonField("composer",q->value(11).toString(),4+padding);
+  json+=RDJsonField("conductor",q->value(28).toString(),4+padding);
+  json+=RDJsonField("userDefined",q->value(12).toString(),4+padding);
+  json+=RDJsonField("usageCode",q->value(13).toInt(),4+padding);
+  json+=RDJsonField("forcedLength",q->value(14).toUInt(),4+padding);
+  json+=RDJsonField("averageLength",q->value(15).toUInt(),4+padding);
+  json+=RDJsonField("lengthDeviation",q->value(16).toUInt(),4+padding);
+  json+=RDJsonField("averageSegueLength",q->value(17).toUInt(),4+padding);
+  json+=RDJsonField("averageHookLength",q->value(18).toUInt(),4+padding);
+  json+=RDJsonField("minimumTalkLength",q->value(19).toUInt(),4+padding);
+  json+=RDJsonField("maximumTalkLength",q->value(20).toUInt(),4+padding);
+  json+=RDJsonField("cutQuantity",q->value(21).toUInt(),4+padding);
+  json+=RDJsonField("lastCutPlayed",q->value(22).toUInt(),4+padding);
+  json+=RDJsonField("enforceLength",RDBool(q->value(24).toString()),
+		    4+padding);
+  json+=RDJsonField("asyncronous",RDBool(q->value(25).toString()),4+padding);
+  json+=RDJsonField("owner",q->value(26).toString(),4+padding);
+  json+=RDJsonField("metadataDatetime",q->value(27).toDateTime(),4+padding);
+  json+=RDJsonField("songId",q->value(30).toString(),4+padding,!list);
+  if(!list) {
+    json+=pad+"}";
+    return json;
+  }
+  switch((RDCart::Type)q->value(1).toInt()) {
+  case RDCart::Audio:
+    cartnum=q->value(0).toUInt();
+    if(q->value(31).toString().isEmpty()) {
+      json+=RDJsonPadding(4+padding)+"\"cutList\": []\r\n";
+    }
+    else {
+      json+=RDJsonPadding(4+padding)+"\"cutList\": [\r\n";
+      json+=RDCut::json(q,absolute,8+padding);
+      while(q->next()) {
+	if(q->value(0).toUInt()==cartnum) {
+	  json+=",\r\n"+RDCut::json(q,absolute,8+padding);
+	}
+	else {
+	  q->previous();
+	  break;
 	}
-	xml+="  </macroList>\n";
       }
-      break;
-	
-    case RDCart::All:
-      break;
+      json+="\r\n"+RDJsonPadding(4+padding)+"]\r\n";
+    }
+    break;
+
+  case RDCart::Macro:
+    mlist=q->value(29).toString().split("!",QString::SkipEmptyParts);
+    json+=RDJsonPadding(4+padding)+"\"macroList\": {\r\n";
+    for(int i=0;i<mlist.size();i++) {
+      json+=RDJsonField(QString().sprintf("macro%d",i),mlist[i]+"!",
+			8+padding,i==(mlist.size()-1));
     }
-    xml+="</cart>\n";
+    json+=RDJsonPadding(4+padding)+"}\r\n";
+    break;
+
+  case RDCart::All:
+    break;
   }
+  json+=pad+"}";
 
-  return xml;
+  return json;
 }
 
 
@@ -1718,6 +1846,8 @@ bool RDCart::removeCutAudio(RDStation *station,RDUser *user,unsigned cart_num,
   if(user==NULL) { 
     unlink(RDCut::pathName(cutname).toUtf8());
     unlink((RDCut::pathName(cutname)+".energy").toUtf8());
+    RDAudioAnalysis::removeSidecar(RDCut::pathName(cutname));
+    unlink((RDCut::pathName(cutname)+".frames").toUtf8());
     sql=QString("delete from CUT_EVENTS where ")+
       "CUT_NAME=\""+cutname+"\"";
     q=new RDSqlQuery(sql);
@@ -2376,65 +2506,116 @@ QString RDCart::VerifyTitle(const QString &title) const
 }
 
 
-void RDCart::SetRow(const QString &param,const QString &value) const
+QVariant RDCart::GetRow(const QString &param) const
+{
+  if(!cart_snapshot) {
+    return RDGetSqlValue("CART","NUMBER",cart_number,param);
+  }
+  if(!cart_row_valid) {
+    LoadRow();
+  }
+  return cart_row.value(param);
+}
+
+
+bool RDCart::LoadRow() const
 {
-  RDSqlQuery *q;
   QString sql;
+  RDSqlQuery *q=NULL;
 
-  sql=QString("update CART set ")+
-    param+"=\""+RDEscapeString(value)+"\" where "+
-    QString().sprintf("NUMBER=%u",cart_number);
-  q=new RDSqlQuery(sql);
+  FlushRow(false);
+  cart_row.clear();
+  sql="select * from CART where NUMBER=?";
+  q=new RDSqlQuery(sql,QList<QVariant>()<<cart_number);
+  if((cart_row_valid=q->first())) {
+    QSqlRecord rec=q->record();
+    for(int i=0;i<rec.count();i++) {
+      cart_row[rec.fieldName(i)]=q->value(i);
+    }
+  }
   delete q;
+
+  return cart_row_valid;
 }
 
 
-void RDCart::SetRow(const QString &param,unsigned value) const
+bool RDCart::FlushRow(bool timestamp) const
 {
-  RDSqlQuery *q;
   QString sql;
 
-  sql=QString("update CART set ")+
-    param+QString().sprintf("=%d where NUMBER=%u",value,cart_number);
-  q=new RDSqlQuery(sql);
-  delete q;
+  if((cart_dirty.size()==0)&&(!timestamp)) {
+    return true;
+  }
+  sql="update CART set ";
+  for(QMap<QString,QString>::const_iterator ci=cart_dirty.begin();
+      ci!=cart_dirty.end();ci++) {
+    sql+=ci.key()+"="+ci.value()+",";
+  }
+  if(timestamp) {
+    sql+="METADATA_DATETIME=now(),";
+  }
+  sql=sql.left(sql.length()-1)+
+    QString().sprintf(" where NUMBER=%u",cart_number);
+  cart_dirty.clear();
+
+  return RDSqlQuery::apply(sql);
 }
 
 
-void RDCart::SetRow(const QString &param,const QDateTime &value) const
+void RDCart::UpdateRow(const QString &sql) const
+{
+  FlushRow(false);
+  RDSqlQuery::apply(sql);
+  cart_row_valid=false;
+}
+
+
+void RDCart::WriteRow(const QString &param,const QString &sql_value,
+		      const QVariant &value) const
 {
-  RDSqlQuery *q;
   QString sql;
 
+  if(cart_snapshot) {
+    cart_dirty[param]=sql_value;
+    if(cart_row_valid) {
+      cart_row[param]=value;
+    }
+    return;
+  }
   sql=QString("update CART set ")+
-    param+"="+RDCheckDateTime(value,"yyyy-MM-dd hh:mm:ss")+" where "+
+    param+"="+sql_value+" where "+
     QString().sprintf("NUMBER=%u",cart_number);
-  q=new RDSqlQuery(sql);
-  delete q;
+  RDSqlQuery::apply(sql);
 }
 
 
-void RDCart::SetRow(const QString &param,const QDate &value) const
+void RDCart::SetRow(const QString &param,const QString &value) const
 {
-  RDSqlQuery *q;
-  QString sql;
+  WriteRow(param,"\""+RDEscapeString(value)+"\"",value);
+}
 
-  sql=QString("update CART set ")+
-    param+"="+RDCheckDateTime(value,"yyyy-MM-dd")+" where "+
-    QString().sprintf("NUMBER=%u",cart_number);
-  q=new RDSqlQuery(sql);
-  delete q;
+
+void RDCart::SetRow(const QString &param,unsigned value) const
+{
+  WriteRow(param,QString().sprintf("%d",value),value);
 }
 
 
-void RDCart::SetRow(const QString &param) const
+void RDCart::SetRow(const QString &param,const QDateTime &value) const
 {
-  RDSqlQuery *q;
-  QString sql;
+  WriteRow(param,RDCheckDateTime(value,"yyyy-MM-dd hh:mm:ss"),
+	   value.isValid()?QVariant(value):QVariant());
+}
 
-  sql=QString("update CART set ")+
-    param+"=NULL where "+
-    QString().sprintf("NUMBER=%u",cart_number);
-  q=new RDSqlQuery(sql);
-  delete q;
+
+void RDCart::SetRow(const QString &param,const QDate &value) const
+{
+  WriteRow(param,RDCheckDateTime(value,"yyyy-MM-dd"),
+	   value.isValid()?QVariant(value):QVariant());
+}
+
+
+void RDCart::SetRow(const QString &param) const
+{
+  WriteRow(param,"NULL",QVariant());
 }
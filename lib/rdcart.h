@@ -19,6 +19,7 @@
 //
 
 #include <qdatetime.h>
+#include <qmap.h>
 #include <qstringlist.h>
 #include <qvariant.h>
 
@@ -35,6 +36,16 @@
 
 #define MAX_SERVICES 16
 
+//
+// RDCart
+//
+// By default, every getter reads its field with a separate query and
+// every setter writes it at once. After loadSnapshot(), the whole CART
+// row is read with a single query and served from memory, and setters
+// collect their changes until commit() (or the destructor) writes all
+// of them with one UPDATE. Methods that run their own queries against
+// the row (xml(), getMetadata(), etc) only see committed changes.
+//
 class RDCart
 {
  public:
@@ -47,6 +58,9 @@ class RDCart
   RDCart(unsigned number);
   ~RDCart();
   bool exists() const;
+  bool loadSnapshot();
+  bool hasSnapshot() const;
+  bool commit();
   bool selectCut(QString *cut) const;
   bool selectCut(QString *cut,const QTime &time) const;
   RDCart::Type type() const;
@@ -145,6 +159,7 @@ class RDCart
   void updateLength();
   void updateLength(bool enforce_length,unsigned length);
   void resetRotation() const;
+  QDateTime metadataDatetime() const;
   void writeTimestamp();
   int addCut(unsigned format,unsigned bitrate,unsigned chans,
 	     const QString &isci="",QString desc="");
@@ -159,6 +174,10 @@ class RDCart
   static QString xmlSql(bool include_cuts);
   static QString xml(RDSqlQuery *q,bool include_cuts,bool absolute,
 		     RDSettings *settings=NULL,int cutnum=-1);
+  static QString xmlCart(RDSqlQuery *q,bool include_cuts,bool absolute,
+			 RDSettings *settings=NULL);
+  static QString jsonCart(RDSqlQuery *q,bool include_cuts,bool absolute,
+			  int padding=0);
   static QString cutXml(unsigned cartnum,int cutnum,bool absolute,
 			RDSettings *settings=NULL);
   static bool exists(unsigned cartnum);
@@ -183,6 +202,12 @@ class RDCart
   RDCut::Validity ValidateCut(RDSqlQuery *q,bool enforce_length,
 			      unsigned length,bool *time_ok) const;
   QString VerifyTitle(const QString &title) const;
+  QVariant GetRow(const QString &param) const;
+  bool LoadRow() const;
+  bool FlushRow(bool timestamp) const;
+  void UpdateRow(const QString &sql) const;
+  void WriteRow(const QString &param,const QString &sql_value,
+		const QVariant &value) const;
   void SetRow(const QString &param,const QString &value) const;
   void SetRow(const QString &param,unsigned value) const;
   void SetRow(const QString &param,const QDateTime &value) const;
@@ -190,6 +215,10 @@ class RDCart
   void SetRow(const QString &param) const;
   unsigned cart_number;
   bool metadata_changed;
+  bool cart_snapshot;
+  mutable bool cart_row_valid;
+  mutable QMap<QString,QVariant> cart_row;
+  mutable QMap<QString,QString> cart_dirty;
 };
 
 
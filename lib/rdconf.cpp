@@ -2,7 +2,7 @@
 //
 //  Small library for handling common configuration file tasks
 // 
-//   (C) Copyright 1996-2018 Fred Gleason <fredg@paravelsystems.com>
+//   (C) Copyright 1996-2021 Fred Gleason <fredg@paravelsystems.com>
 //
 //   This program is free software; you can redistribute it and/or modify
 //   it under the terms of the GNU Library General Public License 
@@ -41,6 +41,7 @@
 #include "rdconf.h"
 #include "rddatetime.h"
 #include "rdescape_string.h"
+#include "rdrowcache.h"
 
 #define BUFFER_SIZE 1024
 
@@ -490,9 +491,8 @@ bool RDDoesRowExist(const QString &table,const QString &name,
   RDSqlQuery *q;
   QString sql;
 
-  sql="select `"+name+"` from `"+table+"` where `"+name+"`="+
-    "\""+RDEscapeString(test)+"\"";
-  q=new RDSqlQuery(sql);
+  sql="select `"+name+"` from `"+table+"` where `"+name+"`=?";
+  q=new RDSqlQuery(sql,QList<QVariant>()<<test);
   if(q->first()) {
     delete q;
     return true;
@@ -508,9 +508,8 @@ bool RDDoesRowExist(const QString &table,const QString &name,unsigned test,
   RDSqlQuery *q;
   QString sql;
 
-  sql="select `"+name+"` from `"+table+"` where `"+name+"`="+
-    QString().sprintf("%d",test);
-  q=new RDSqlQuery(sql);
+  sql="select `"+name+"` from `"+table+"` where `"+name+"`=?";
+  q=new RDSqlQuery(sql,QList<QVariant>()<<test);
   if(q->size()>0) {
     delete q;
     return true;
@@ -528,9 +527,11 @@ QVariant RDGetSqlValue(const QString &table,const QString &name,
   QString sql;
   QVariant v;
 
-  sql="select `"+param+"` from `"+table+"` where `"+name+"`="+
-    "\""+RDEscapeString(test)+"\"";
-  q=new RDSqlQuery(sql);
+  if(RDRowCache::value(table,name,test,param,&v,valid)) {
+    return v;
+  }
+  sql="select `"+param+"` from `"+table+"` where `"+name+"`=?";
+  q=new RDSqlQuery(sql,QList<QVariant>()<<test);
   if(q->isActive()) {
     q->first();
     v=q->value(0);
@@ -551,9 +552,8 @@ bool RDIsSqlNull(const QString &table,const QString &name,const QString &test,
   RDSqlQuery *q;
   QString sql;
 
-  sql="select `"+param+"` from `"+table+"` where `"+name+"`="+
-    "\""+RDEscapeString(test)+"\"";
-  q=new RDSqlQuery(sql);
+  sql="select `"+param+"` from `"+table+"` where `"+name+"`=?";
+  q=new RDSqlQuery(sql,QList<QVariant>()<<test);
   if(q->isActive()) {
     q->first();
     if(q->isNull(0)) {
@@ -576,9 +576,8 @@ bool RDIsSqlNull(const QString &table,const QString &name,unsigned test,
   RDSqlQuery *q;
   QString sql;
 
-  sql="select `"+param+"` from `"+table+"` where `"+name+"`="+
-    QString().sprintf("%d",test);
-  q=new RDSqlQuery(sql);
+  sql="select `"+param+"` from `"+table+"` where `"+name+"`=?";
+  q=new RDSqlQuery(sql,QList<QVariant>()<<test);
   if(q->isActive()) {
     q->first();
     if(q->isNull(0)) {
@@ -602,9 +601,11 @@ QVariant RDGetSqlValue(const QString &table,const QString &name,unsigned test,
   QString sql;
   QVariant v;
 
-  sql="select `"+param+"` from `"+table+"` where `"+name+"`="+
-    QString().sprintf("%u",test);
-  q=new RDSqlQuery(sql);
+  if(RDRowCache::value(table,name,test,param,&v,valid)) {
+    return v;
+  }
+  sql="select `"+param+"` from `"+table+"` where `"+name+"`=?";
+  q=new RDSqlQuery(sql,QList<QVariant>()<<test);
   if(q->first()) {
     v=q->value(0);
     if(valid!=NULL) {
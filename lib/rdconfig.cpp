@@ -223,6 +223,66 @@ QString RDConfig::createTablePostfix() const
 }
 
 
+bool RDConfig::mysqlProfileQueries() const
+{
+  return conf_mysql_profile_queries;
+}
+
+
+QString RDConfig::mysqlProfileDirectory() const
+{
+  return conf_mysql_profile_directory;
+}
+
+
+int RDConfig::mysqlSlowQueryThreshold() const
+{
+  return conf_mysql_slow_query_threshold;
+}
+
+
+QString RDConfig::mysqlReplicaHostname() const
+{
+  return conf_mysql_replica_hostname;
+}
+
+
+int RDConfig::mysqlReplicaPort() const
+{
+  return conf_mysql_replica_port;
+}
+
+
+QString RDConfig::mysqlReplicaUsername() const
+{
+  return conf_mysql_replica_username;
+}
+
+
+QString RDConfig::mysqlReplicaDbname() const
+{
+  return conf_mysql_replica_dbname;
+}
+
+
+QString RDConfig::mysqlReplicaPassword() const
+{
+  return conf_mysql_replica_password;
+}
+
+
+int RDConfig::mysqlReplicaMaxLag() const
+{
+  return conf_mysql_replica_max_lag;
+}
+
+
+int RDConfig::mysqlRowCacheTtl() const
+{
+  return conf_mysql_row_cache_ttl;
+}
+
+
 bool RDConfig::logXloadDebugData() const
 {
   return conf_log_xload_debug_data;
@@ -465,6 +525,48 @@ QString RDConfig::tempDirectory()
   return conf_temp_directory;
 }
 
+
+bool RDConfig::rdxportServiceEnabled() const
+{
+  return conf_rdxport_service_enabled;
+}
+
+
+QString RDConfig::rdxportServiceAddress() const
+{
+  return conf_rdxport_service_address;
+}
+
+
+uint16_t RDConfig::rdxportServicePort() const
+{
+  return conf_rdxport_service_port;
+}
+
+
+int RDConfig::rdxportServiceWorkers() const
+{
+  return conf_rdxport_service_workers;
+}
+
+
+int RDConfig::rdxportServiceMaxRequests() const
+{
+  return conf_rdxport_service_max_requests;
+}
+
+
+QString RDConfig::exportCacheDirectory() const
+{
+  return conf_export_cache_directory;
+}
+
+
+int RDConfig::exportCacheMaxSize() const
+{
+  return conf_export_cache_max_size;
+}
+
 QString RDConfig::sasStation() const
 {
   return conf_sas_station;
@@ -587,6 +689,25 @@ bool RDConfig::load()
     profile->stringValue("mySQL","Engine",DEFAULT_MYSQL_ENGINE);
   conf_create_table_postfix=
     RDConfig::createTablePostfix(conf_mysql_engine);
+  conf_mysql_profile_queries=
+    profile->boolValue("mySQL","ProfileQueries",false);
+  conf_mysql_profile_directory=
+    profile->stringValue("mySQL","ProfileDirectory","");
+  conf_mysql_slow_query_threshold=
+    profile->intValue("mySQL","SlowQueryThreshold",0);
+  conf_mysql_replica_hostname=
+    profile->stringValue("mySQL","ReplicaHostname","");
+  conf_mysql_replica_port=profile->intValue("mySQL","ReplicaPort",0);
+  conf_mysql_replica_username=
+    profile->stringValue("mySQL","ReplicaLoginname",conf_mysql_username);
+  conf_mysql_replica_dbname=
+    profile->stringValue("mySQL","ReplicaDatabase",conf_mysql_dbname);
+  conf_mysql_replica_password=
+    profile->stringValue("mySQL","ReplicaPassword",conf_mysql_password);
+  conf_mysql_replica_max_lag=
+    profile->intValue("mySQL","ReplicaMaxLag",DEFAULT_MYSQL_REPLICA_MAX_LAG);
+  conf_mysql_row_cache_ttl=
+    profile->intValue("mySQL","RowCacheTtl",DEFAULT_MYSQL_ROW_CACHE_TTL);
 
   conf_log_xload_debug_data=profile->
     boolValue("Logs","LogXloadDebugData",false);
@@ -637,6 +758,24 @@ bool RDConfig::load()
   conf_service_timeout=
     profile->intValue("Tuning","ServiceTimeout",RD_DEFAULT_SERVICE_TIMEOUT);
   conf_temp_directory=profile->stringValue("Tuning","TempDirectory","");
+  conf_rdxport_service_enabled=
+    profile->boolValue("RdxportService","Enabled",false);
+  conf_rdxport_service_address=
+    profile->stringValue("RdxportService","Address",
+			 RD_DEFAULT_RDXPORT_SERVICE_ADDRESS);
+  conf_rdxport_service_port=
+    profile->intValue("RdxportService","Port",RDXPORT_SERVICE_TCP_PORT);
+  conf_rdxport_service_workers=
+    profile->intValue("RdxportService","Workers",
+		      RD_DEFAULT_RDXPORT_SERVICE_WORKERS);
+  conf_rdxport_service_max_requests=
+    profile->intValue("RdxportService","MaxRequests",
+		      RD_DEFAULT_RDXPORT_SERVICE_MAX_REQUESTS);
+  conf_export_cache_directory=
+    profile->stringValue("ExportCache","Directory","");
+  conf_export_cache_max_size=
+    profile->intValue("ExportCache","MaxSize",
+		      RD_DEFAULT_EXPORT_CACHE_MAX_SIZE);
   conf_sas_station=profile->stringValue("SASFilter","Station","");
   conf_sas_matrix=profile->intValue("SASFilter","Matrix",0);
   conf_sas_base_cart=profile->intValue("SASFilter","BaseCart",0);
@@ -690,6 +829,16 @@ void RDConfig::clear()
   conf_mysql_driver="";
   conf_mysql_heartbeat_interval=DEFAULT_MYSQL_HEARTBEAT_INTERVAL;
   conf_mysql_engine=DEFAULT_MYSQL_ENGINE;
+  conf_mysql_profile_queries=false;
+  conf_mysql_profile_directory="";
+  conf_mysql_slow_query_threshold=0;
+  conf_mysql_replica_hostname="";
+  conf_mysql_replica_port=0;
+  conf_mysql_replica_username="";
+  conf_mysql_replica_dbname="";
+  conf_mysql_replica_password="";
+  conf_mysql_replica_max_lag=DEFAULT_MYSQL_REPLICA_MAX_LAG;
+  conf_mysql_row_cache_ttl=DEFAULT_MYSQL_ROW_CACHE_TTL;
   conf_create_table_postfix="";
   conf_log_xload_debug_data=false;
   conf_provisioning_create_host=false;
@@ -742,6 +891,13 @@ void RDConfig::clear()
   conf_transcoding_delay=0;
   conf_service_timeout=RD_DEFAULT_SERVICE_TIMEOUT;
   conf_temp_directory="";
+  conf_rdxport_service_enabled=false;
+  conf_rdxport_service_address=RD_DEFAULT_RDXPORT_SERVICE_ADDRESS;
+  conf_rdxport_service_port=RDXPORT_SERVICE_TCP_PORT;
+  conf_rdxport_service_workers=RD_DEFAULT_RDXPORT_SERVICE_WORKERS;
+  conf_rdxport_service_max_requests=RD_DEFAULT_RDXPORT_SERVICE_MAX_REQUESTS;
+  conf_export_cache_directory="";
+  conf_export_cache_max_size=RD_DEFAULT_EXPORT_CACHE_MAX_SIZE;
   conf_sas_station="";
   conf_sas_matrix=-1;
   conf_sas_base_cart=1;
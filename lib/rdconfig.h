@@ -21,6 +21,7 @@
 #ifndef RDCONFIG_H
 #define RDCONFIG_H
 
+#include <stdint.h>
 #include <unistd.h>
 
 #include <vector>
@@ -63,6 +64,16 @@ class RDConfig
   int mysqlHeartbeatInterval() const;
   QString mysqlEngine() const;
   QString createTablePostfix() const;
+  bool mysqlProfileQueries() const;
+  QString mysqlProfileDirectory() const;
+  int mysqlSlowQueryThreshold() const;
+  QString mysqlReplicaHostname() const;
+  int mysqlReplicaPort() const;
+  QString mysqlReplicaUsername() const;
+  QString mysqlReplicaDbname() const;
+  QString mysqlReplicaPassword() const;
+  int mysqlReplicaMaxLag() const;
+  int mysqlRowCacheTtl() const;
   bool logXloadDebugData() const;
   bool provisioningCreateHost() const;
   QString provisioningHostTemplate() const;
@@ -114,6 +125,13 @@ class RDConfig
   int transcodingDelay() const;
   int serviceTimeout() const;
   QString tempDirectory();
+  bool rdxportServiceEnabled() const;
+  QString rdxportServiceAddress() const;
+  uint16_t rdxportServicePort() const;
+  int rdxportServiceWorkers() const;
+  int rdxportServiceMaxRequests() const;
+  QString exportCacheDirectory() const;
+  int exportCacheMaxSize() const;
   QString sasStation() const;
   int sasMatrix() const;
   unsigned sasBaseCart() const;
@@ -135,6 +153,16 @@ class RDConfig
   QString conf_mysql_engine;
   QString conf_create_table_postfix;
   int conf_mysql_heartbeat_interval;
+  bool conf_mysql_profile_queries;
+  QString conf_mysql_profile_directory;
+  int conf_mysql_slow_query_threshold;
+  QString conf_mysql_replica_hostname;
+  int conf_mysql_replica_port;
+  QString conf_mysql_replica_username;
+  QString conf_mysql_replica_dbname;
+  QString conf_mysql_replica_password;
+  int conf_mysql_replica_max_lag;
+  int conf_mysql_row_cache_ttl;
   bool conf_provisioning_create_host;
   QString conf_provisioning_host_template;
   QHostAddress conf_provisioning_host_ip_address;
@@ -187,6 +215,13 @@ class RDConfig
   int conf_realtime_priority;
   int conf_service_timeout;
   QString conf_temp_directory;
+  bool conf_rdxport_service_enabled;
+  QString conf_rdxport_service_address;
+  uint16_t conf_rdxport_service_port;
+  int conf_rdxport_service_workers;
+  int conf_rdxport_service_max_requests;
+  QString conf_export_cache_directory;
+  int conf_export_cache_max_size;
   QString conf_sas_station;
   int conf_sas_matrix;
   unsigned conf_sas_base_cart;
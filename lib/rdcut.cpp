@@ -24,16 +24,19 @@
 #include <fcntl.h>
 
 #include <qobject.h>
+#include <qsqlrecord.h>
 
 #include "rd.h"
 #include "rdconf.h"
 #include "rdconfig.h"
 #include "rdcopyaudio.h"
 #include "rdcut.h"
+#include "rddatetime.h"
 #include "rddb.h"
 #include "rddisclookup.h"
 #include "rdescape_string.h"
 #include "rdgroup.h"
+#include "rdhash.h"
 #include "rdtextvalidator.h"
 #include "rdtrimaudio.h"
 #include "rdwavefile.h"
@@ -45,6 +48,8 @@
 RDCut::RDCut(const QString &name,bool create)
 {
   cut_name=name;
+  cut_snapshot=false;
+  cut_row_valid=false;
 
   if(name.isEmpty()) {
     cut_number=0;
@@ -63,6 +68,8 @@ RDCut::RDCut(const QString &name,bool create)
 RDCut::RDCut(unsigned cartnum,int cutnum,bool create)
 {
   cut_name=RDCut::cutName(cartnum,cutnum);
+  cut_snapshot=false;
+  cut_row_valid=false;
 
   if(create) {
     RDCut::create(cut_name);
@@ -74,15 +81,39 @@ RDCut::RDCut(unsigned cartnum,int cutnum,bool create)
 
 RDCut::~RDCut()
 {
+  FlushRow();
 }
 
 
 bool RDCut::exists() const
 {
+  if(cut_row_valid) {
+    return true;
+  }
   return RDDoesRowExist("CUTS","CUT_NAME",cut_name);
 }
 
 
+bool RDCut::loadSnapshot()
+{
+  cut_snapshot=true;
+
+  return LoadRow();
+}
+
+
+bool RDCut::hasSnapshot() const
+{
+  return cut_snapshot;
+}
+
+
+bool RDCut::commit()
+{
+  return FlushRow();
+}
+
+
 bool RDCut::isValid() const
 {
   return isValid(QDateTime(QDate::currentDate(),QTime::currentTime()));
@@ -175,8 +206,7 @@ void RDCut::setCartNumber(unsigned num) const
 
 bool RDCut::evergreen() const
 {
-  return RDBool(RDGetSqlValue("CUTS","CUT_NAME",cut_name,"EVERGREEN").
-	       toString());
+  return RDBool(GetRow("EVERGREEN").toString());
 }
 
 
@@ -188,8 +218,7 @@ void RDCut::setEvergreen(bool state) const
 
 QString RDCut::description() const
 {
-  return RDGetSqlValue("CUTS","CUT_NAME",cut_name,"DESCRIPTION").
-    toString();
+  return GetRow("DESCRIPTION").toString();
 }
 
 
@@ -201,7 +230,7 @@ void RDCut::setDescription(const QString &string) const
 
 QString RDCut::outcue() const
 {
-  return RDGetSqlValue("CUTS","CUT_NAME",cut_name,"OUTCUE").toString();
+  return GetRow("OUTCUE").toString();
 }
 
 
@@ -213,8 +242,7 @@ void RDCut::setOutcue(const QString &string) const
 
 QString RDCut::isrc(IsrcFormat fmt) const
 {
-  QString str= RDGetSqlValue("CUTS","CUT_NAME",cut_name,"ISRC").
-    toString();
+  QString str=GetRow("ISRC").toString();
   if((fmt==RDCut::RawIsrc)||(!RDDiscLookup::isrcIsValid(str))) {
     return str;
   }
@@ -230,13 +258,13 @@ void RDCut::setIsrc(const QString &isrc) const
 
 QString RDCut::isci() const
 {
-  return RDGetSqlValue("CUTS","CUT_NAME",cut_name,"ISCI").toString();
+  return GetRow("ISCI").toString();
 }
 
 
 QString RDCut::recordingMbId() const
 {
-  return RDGetSqlValue("CUTS","CUT_NAME",cut_name,"RECORDING_MBID").toString();
+  return GetRow("RECORDING_MBID").toString();
 }
 
 
@@ -248,7 +276,7 @@ void RDCut::setRecordingMbId(const QString &mbid)
 
 QString RDCut::releaseMbId() const
 {
-  return RDGetSqlValue("CUTS","CUT_NAME",cut_name,"RELEASE_MBID").toString();
+  return GetRow("RELEASE_MBID").toString();
 }
 
 
@@ -266,8 +294,7 @@ void RDCut::setIsci(const QString &isci) const
 
 QString RDCut::sha1Hash() const
 {
-  return RDGetSqlValue("CUTS","CUT_NAME",cut_name,"SHA1_HASH").
-    toString();
+  return GetRow("SHA1_HASH").toString();
 }
 
 
@@ -277,10 +304,90 @@ void RDCut::setSha1Hash(const QString &str)
 }
 
 
+QString RDCut::sha1Fingerprint() const
+{
+  return GetRow("SHA1_FINGERPRINT").toString();
+}
+
+
+void RDCut::setSha1Fingerprint(const QString &str)
+{
+  SetRow("SHA1_FINGERPRINT",str);
+}
+
+
+int RDCut::peakLevel() const
+{
+  QVariant v=GetRow("PEAK_LEVEL");
+  if(v.isNull()) {
+    return RDAUDIOANALYSIS_NO_LEVEL;
+  }
+  return v.toInt();
+}
+
+
+void RDCut::setPeakLevel(int level)
+{
+  if(level==RDAUDIOANALYSIS_NO_LEVEL) {
+    SetRow("PEAK_LEVEL");
+  }
+  else {
+    SetRow("PEAK_LEVEL",level);
+  }
+}
+
+
+int RDCut::loudness() const
+{
+  QVariant v=GetRow("LOUDNESS");
+  if(v.isNull()) {
+    return RDAUDIOANALYSIS_NO_LEVEL;
+  }
+  return v.toInt();
+}
+
+
+void RDCut::setLoudness(int level)
+{
+  if(level==RDAUDIOANALYSIS_NO_LEVEL) {
+    SetRow("LOUDNESS");
+  }
+  else {
+    SetRow("LOUDNESS",level);
+  }
+}
+
+
+void RDCut::setAnalysis(RDAudioAnalysis *ana)
+{
+  QString sql;
+
+  sql=QString("update CUTS set ");
+  if(!ana->sha1Hash().isEmpty()) {
+    sql+="SHA1_HASH=\""+RDEscapeString(ana->sha1Hash())+"\","+
+      "SHA1_FINGERPRINT=\""+
+      RDEscapeString(RDFileFingerprint(RDCut::pathName(cut_name)))+"\",";
+  }
+  if(ana->peakLevel()==RDAUDIOANALYSIS_NO_LEVEL) {
+    sql+="PEAK_LEVEL=null,";
+  }
+  else {
+    sql+=QString().sprintf("PEAK_LEVEL=%d,",ana->peakLevel());
+  }
+  if(ana->loudness()==RDAUDIOANALYSIS_NO_LEVEL) {
+    sql+="LOUDNESS=null ";
+  }
+  else {
+    sql+=QString().sprintf("LOUDNESS=%d ",ana->loudness());
+  }
+  sql+="where CUT_NAME=\""+RDEscapeString(cut_name)+"\"";
+  UpdateRow(sql);
+}
+
+
 unsigned RDCut::length() const
 {
-  return RDGetSqlValue("CUTS","CUT_NAME",cut_name,"LENGTH").
-    toUInt();
+  return GetRow("LENGTH").toUInt();
 }
 
 
@@ -292,9 +399,7 @@ void RDCut::setLength(int length) const
 
 QDateTime RDCut::originDatetime(bool *valid) const
 {
-  return 
-    RDGetSqlValue("CUTS","CUT_NAME",cut_name,"ORIGIN_DATETIME",valid).
-    toDateTime();
+  return GetRow("ORIGIN_DATETIME",valid).toDateTime();
 }
 
 
@@ -306,9 +411,7 @@ void RDCut::setOriginDatetime(const QDateTime &datetime) const
 
 QDateTime RDCut::startDatetime(bool *valid) const
 {
-  return 
-    RDGetSqlValue("CUTS","CUT_NAME",cut_name,"START_DATETIME",valid).
-    toDateTime();
+  return GetRow("START_DATETIME",valid).toDateTime();
 }
 
 
@@ -325,9 +428,7 @@ void RDCut::setStartDatetime(const QDateTime &datetime,bool valid) const
 
 QDateTime RDCut::endDatetime(bool *valid) const
 {
-  return 
-    RDGetSqlValue("CUTS","CUT_NAME",cut_name,"END_DATETIME",valid).
-    toDateTime();
+  return GetRow("END_DATETIME",valid).toDateTime();
 }
 
 
@@ -344,9 +445,7 @@ void RDCut::setEndDatetime(const QDateTime &datetime,bool valid) const
 
 QTime RDCut::startDaypart(bool *valid) const
 {
-  return 
-    RDGetSqlValue("CUTS","CUT_NAME",cut_name,"START_DAYPART",valid).
-    toTime();
+  return GetRow("START_DAYPART",valid).toTime();
 }
 
 
@@ -363,9 +462,7 @@ void RDCut::setStartDaypart(const QTime &time,bool valid) const
 
 bool RDCut::weekPart(int dayofweek) const
 {
-  return RDBool(RDGetSqlValue("CUTS","CUT_NAME",cut_name,
-			    RDGetShortDayNameEN(dayofweek).toUpper()).
-	       toString());
+  return RDBool(GetRow(RDGetShortDayNameEN(dayofweek).toUpper()).toString());
 }
 
 
@@ -377,9 +474,7 @@ void RDCut::setWeekPart(int dayofweek,bool state) const
 
 QTime RDCut::endDaypart(bool *valid) const
 {
-  return 
-    RDGetSqlValue("CUTS","CUT_NAME",cut_name,"END_DAYPART",valid).
-    toTime();
+  return GetRow("END_DAYPART",valid).toTime();
 }
 
 
@@ -396,8 +491,7 @@ void RDCut::setEndDaypart(const QTime &time,bool valid) const
 
 QString RDCut::originName() const
 {
-  return RDGetSqlValue("CUTS","CUT_NAME",cut_name,"ORIGIN_NAME").
-    toString();
+  return GetRow("ORIGIN_NAME").toString();
 }
 
 
@@ -409,8 +503,7 @@ void RDCut::setOriginName(const QString &name) const
 
 QString RDCut::originLoginName() const
 {
-  return RDGetSqlValue("CUTS","CUT_NAME",cut_name,"ORIGIN_LOGIN_NAME").
-    toString();
+  return GetRow("ORIGIN_LOGIN_NAME").toString();
 }
 
 
@@ -422,8 +515,7 @@ void RDCut::setOriginLoginName(const QString &name) const
 
 QString RDCut::sourceHostname() const
 {
-  return RDGetSqlValue("CUTS","CUT_NAME",cut_name,"SOURCE_HOSTNAME").
-    toString();
+  return GetRow("SOURCE_HOSTNAME").toString();
 }
 
 
@@ -435,8 +527,7 @@ void RDCut::setSourceHostname(const QString &name) const
 
 unsigned RDCut::weight() const
 {
-  return RDGetSqlValue("CUTS","CUT_NAME",cut_name,"WEIGHT").
-    toUInt();
+  return GetRow("WEIGHT").toUInt();
 }
 
 
@@ -448,8 +539,7 @@ void RDCut::setWeight(int value) const
 
 int RDCut::playOrder() const
 {
-  return RDGetSqlValue("CUTS","CUT_NAME",cut_name,"PLAY_ORDER").
-    toInt();
+  return GetRow("PLAY_ORDER").toInt();
 }
 
 
@@ -461,9 +551,7 @@ void RDCut::setPlayOrder(int order) const
 
 QDateTime RDCut::lastPlayDatetime(bool *valid) const
 {
-  return 
-    RDGetSqlValue("CUTS","CUT_NAME",cut_name,"LAST_PLAY_DATETIME",valid).
-    toDateTime();
+  return GetRow("LAST_PLAY_DATETIME",valid).toDateTime();
 }
 
 
@@ -480,9 +568,7 @@ void RDCut::setLastPlayDatetime(const QDateTime &datetime,bool valid) const
 
 QDateTime RDCut::uploadDatetime(bool *valid) const
 {
-  return 
-    RDGetSqlValue("CUTS","CUT_NAME",cut_name,"UPLOAD_DATETIME",valid).
-    toDateTime();
+  return GetRow("UPLOAD_DATETIME",valid).toDateTime();
 }
 
 
@@ -499,8 +585,7 @@ void RDCut::setUploadDatetime(const QDateTime &datetime,bool valid) const
 
 unsigned RDCut::playCounter() const
 {
-  return RDGetSqlValue("CUTS","CUT_NAME",cut_name,"PLAY_COUNTER").
-    toUInt();
+  return GetRow("PLAY_COUNTER").toUInt();
 }
 
 
@@ -512,8 +597,7 @@ void RDCut::setPlayCounter(unsigned count) const
 
 RDCut::Validity RDCut::validity() const
 {
-  return (RDCut::Validity)
-    RDGetSqlValue("CUTS","CUT_NAME",cut_name,"VALIDITY").toUInt();
+  return (RDCut::Validity)GetRow("VALIDITY").toUInt();
 }
 
 
@@ -525,8 +609,7 @@ void RDCut::setValidity(RDCut::Validity state)
 
 unsigned RDCut::localCounter() const
 {
-  return RDGetSqlValue("CUTS","CUT_NAME",cut_name,"LOCAL_COUNTER").
-    toUInt();
+  return GetRow("LOCAL_COUNTER").toUInt();
 }
 
 
@@ -538,8 +621,7 @@ void RDCut::setLocalCounter(unsigned count) const
 
 unsigned RDCut::codingFormat() const
 {
-  return RDGetSqlValue("CUTS","CUT_NAME",cut_name,"CODING_FORMAT").
-    toUInt();
+  return GetRow("CODING_FORMAT").toUInt();
 }
 
 
@@ -551,8 +633,7 @@ void RDCut::setCodingFormat(unsigned format) const
 
 unsigned RDCut::sampleRate() const
 {
-  return RDGetSqlValue("CUTS","CUT_NAME",cut_name,"SAMPLE_RATE").
-    toUInt();
+  return GetRow("SAMPLE_RATE").toUInt();
 }
 
 
@@ -564,8 +645,7 @@ void RDCut::setSampleRate(unsigned rate) const
 
 unsigned RDCut::bitRate() const
 {
-  return RDGetSqlValue("CUTS","CUT_NAME",cut_name,"BIT_RATE").
-    toUInt();
+  return GetRow("BIT_RATE").toUInt();
 }
 
 
@@ -577,8 +657,7 @@ void RDCut::setBitRate(unsigned rate) const
 
 unsigned RDCut::channels() const
 {
-  return RDGetSqlValue("CUTS","CUT_NAME",cut_name,"CHANNELS").
-    toUInt();
+  return GetRow("CHANNELS").toUInt();
 }
 
 
@@ -590,8 +669,7 @@ void RDCut::setChannels(unsigned chan) const
 
 int RDCut::playGain() const
 {
-  return RDGetSqlValue("CUTS","CUT_NAME",cut_name,"PLAY_GAIN").
-    toInt();
+  return GetRow("PLAY_GAIN").toInt();
 }
 
 
@@ -606,11 +684,9 @@ int RDCut::startPoint(bool calc) const
   int n;
 
   if(!calc) {
-    return RDGetSqlValue("CUTS","CUT_NAME",cut_name,"START_POINT").
-      toInt();
+    return GetRow("START_POINT").toInt();
   }
-  if((n=RDGetSqlValue("CUTS","CUT_NAME",cut_name,"START_POINT").
-      toInt())!=-1) {
+  if((n=GetRow("START_POINT").toInt())!=-1) {
     return n;
   }
   return 0;
@@ -628,11 +704,9 @@ int RDCut::endPoint(bool calc) const
   int n;
 
   if(!calc) {
-    return RDGetSqlValue("CUTS","CUT_NAME",cut_name,"END_POINT").
-      toInt();
+    return GetRow("END_POINT").toInt();
   }
-  if((n=RDGetSqlValue("CUTS","CUT_NAME",cut_name,"END_POINT").
-      toInt())!=-1) {
+  if((n=GetRow("END_POINT").toInt())!=-1) {
     return n;
   }
   return (int)length();
@@ -650,11 +724,9 @@ int RDCut::fadeupPoint(bool calc) const
   int n;
 
   if(!calc) {
-    return RDGetSqlValue("CUTS","CUT_NAME",cut_name,"FADEUP_POINT").
-      toInt();
+    return GetRow("FADEUP_POINT").toInt();
   }
-  if((n=RDGetSqlValue("CUTS","CUT_NAME",cut_name,"FADEUP_POINT").
-      toInt())!=-1) {
+  if((n=GetRow("FADEUP_POINT").toInt())!=-1) {
     return n;
   }
   return 0;
@@ -672,11 +744,9 @@ int RDCut::fadedownPoint(bool calc) const
   int n;
 
   if(!calc) {
-    return RDGetSqlValue("CUTS","CUT_NAME",cut_name,"FADEDOWN_POINT").
-      toInt();
+    return GetRow("FADEDOWN_POINT").toInt();
   }
-  if((n=RDGetSqlValue("CUTS","CUT_NAME",cut_name,"FADEDOWN_POINT").
-      toInt())!=-1) {
+  if((n=GetRow("FADEDOWN_POINT").toInt())!=-1) {
     return n;
   }
   return effectiveEnd();
@@ -694,11 +764,9 @@ int RDCut::segueStartPoint(bool calc) const
   int n;
 
   if(!calc) {
-    return RDGetSqlValue("CUTS","CUT_NAME",cut_name,"SEGUE_START_POINT").
-      toInt();
+    return GetRow("SEGUE_START_POINT").toInt();
   }
-  if((n=RDGetSqlValue("CUTS","CUT_NAME",cut_name,"SEGUE_START_POINT").
-      toInt())!=-1) {
+  if((n=GetRow("SEGUE_START_POINT").toInt())!=-1) {
     return n;
   }
   return 0;
@@ -716,11 +784,9 @@ int RDCut::segueEndPoint(bool calc) const
   int n;
 
   if(!calc) {
-    return RDGetSqlValue("CUTS","CUT_NAME",cut_name,"SEGUE_END_POINT").
-      toInt();
+    return GetRow("SEGUE_END_POINT").toInt();
   }
-  if((n=RDGetSqlValue("CUTS","CUT_NAME",cut_name,"SEGUE_END_POINT").
-      toInt())!=-1) {
+  if((n=GetRow("SEGUE_END_POINT").toInt())!=-1) {
     return n;
   }
   return effectiveEnd();
@@ -735,7 +801,7 @@ void RDCut::setSegueEndPoint(int point) const
 
 int RDCut::segueGain() const
 {
-  return RDGetSqlValue("CUTS","CUT_NAME",cut_name,"SEGUE_GAIN").toInt();
+  return GetRow("SEGUE_GAIN").toInt();
 }
 
 
@@ -750,11 +816,9 @@ int RDCut::hookStartPoint(bool calc) const
   int n;
 
   if(!calc) {
-    return RDGetSqlValue("CUTS","CUT_NAME",cut_name,"HOOK_START_POINT").
-      toInt();
+    return GetRow("HOOK_START_POINT").toInt();
   }
-  if((n=RDGetSqlValue("CUTS","CUT_NAME",cut_name,"HOOK_START_POINT").
-      toInt())!=-1) {
+  if((n=GetRow("HOOK_START_POINT").toInt())!=-1) {
     return n;
   }
   return 0;
@@ -772,11 +836,9 @@ int RDCut::hookEndPoint(bool calc) const
   int n;
 
   if(!calc) {
-    return RDGetSqlValue("CUTS","CUT_NAME",cut_name,"HOOK_END_POINT").
-      toInt();
+    return GetRow("HOOK_END_POINT").toInt();
   }
-  if((n=RDGetSqlValue("CUTS","CUT_NAME",cut_name,"HOOK_END_POINT").
-      toInt())!=-1) {
+  if((n=GetRow("HOOK_END_POINT").toInt())!=-1) {
     return n;
   }
   return effectiveEnd();
@@ -794,11 +856,9 @@ int RDCut::talkStartPoint(bool calc) const
   int n;
 
   if(!calc) {
-    return RDGetSqlValue("CUTS","CUT_NAME",cut_name,"TALK_START_POINT").
-      toInt();
+    return GetRow("TALK_START_POINT").toInt();
   }
-  if((n=RDGetSqlValue("CUTS","CUT_NAME",cut_name,"TALK_START_POINT").
-      toInt())!=-1) {
+  if((n=GetRow("TALK_START_POINT").toInt())!=-1) {
     return n;
   }
   return 0;
@@ -816,11 +876,9 @@ int RDCut::talkEndPoint(bool calc) const
   int n;
 
   if(!calc) {
-    return RDGetSqlValue("CUTS","CUT_NAME",cut_name,"TALK_END_POINT").
-      toInt();
+    return GetRow("TALK_END_POINT").toInt();
   }
-  if((n=RDGetSqlValue("CUTS","CUT_NAME",cut_name,"TALK_END_POINT").
-      toInt())!=-1) {
+  if((n=GetRow("TALK_END_POINT").toInt())!=-1) {
     return n;
   }
   return effectiveEnd();
@@ -837,8 +895,7 @@ int RDCut::effectiveStart() const
 {
   int n;
 
-  if((n=RDGetSqlValue("CUTS","CUT_NAME",cut_name,"START_POINT").
-      toInt())!=-1) {
+  if((n=GetRow("START_POINT").toInt())!=-1) {
     return n;
   }
   return 0;
@@ -849,8 +906,7 @@ int RDCut::effectiveEnd() const
 {
   int n;
 
-  if((n=RDGetSqlValue("CUTS","CUT_NAME",cut_name,"END_POINT").
-      toInt())!=-1) {
+  if((n=GetRow("END_POINT").toInt())!=-1) {
     return n;
   }
   return (int)length();
@@ -865,8 +921,7 @@ void RDCut::logPlayout() const
     QString().sprintf("PLAY_COUNTER=%d,",playCounter()+1)+
     QString().sprintf("LOCAL_COUNTER=%d ",localCounter()+1)+
     "where CUT_NAME=\""+RDEscapeString(cut_name)+"\"";
-  RDSqlQuery *q=new RDSqlQuery(sql);
-  delete q;
+  UpdateRow(sql);
 }
 
 
@@ -881,6 +936,7 @@ bool RDCut::copyTo(RDStation *station,RDUser *user,
   //
   // Copy the Database Record
   //
+  FlushRow();
   sql=QString("select ")+
     "DESCRIPTION,"+        // 00
     "OUTCUE,"+             // 01
@@ -926,7 +982,9 @@ bool RDCut::copyTo(RDStation *station,RDUser *user,
     "WED,"+                // 40
     "THU,"+                // 41
     "FRI,"+                // 42
-    "SAT "+                // 43
+    "SAT,"+                // 43
+    "PEAK_LEVEL,"+         // 44
+    "LOUDNESS "+           // 45
     "from CUTS where "+
     "CUT_NAME=\""+RDEscapeString(cut_name)+"\"";
   q=new RDSqlQuery(sql);
@@ -959,6 +1017,11 @@ bool RDCut::copyTo(RDStation *station,RDUser *user,
       "RELEASE_MBID=\""+RDEscapeString(q->value(22).toString())+"\","+
       "EVERGREEN=\""+q->value(23).toString()+"\","+
       "SHA1_HASH=\""+RDEscapeString(q->value(24).toString())+"\","+
+      "SHA1_FINGERPRINT=null,"+
+      "PEAK_LEVEL="+(q->value(44).isNull()?QString("null"):
+		     QString().sprintf("%d",q->value(44).toInt()))+","+
+      "LOUDNESS="+(q->value(45).isNull()?QString("null"):
+		   QString().sprintf("%d",q->value(45).toInt()))+","+
       "ORIGIN_DATETIME="+
       RDCheckDateTime(q->value(25).toDateTime(),"yyyy-MM-dd hh:mm:ss")+","+
       "START_DATETIME="+
@@ -1229,15 +1292,14 @@ void RDCut::setMetadata(RDWaveData *data) const
     sql=sql.left(sql.length()-1);
   }
   sql+=QString(" where CUT_NAME=\"")+RDEscapeString(cut_name)+"\"";
-  RDSqlQuery *q=new RDSqlQuery(sql);
-  delete q;
+  UpdateRow(sql);
 
   //
   // Sanity Check: NEVER permit the 'description' field to be empty.
   //
   sql=QString("select DESCRIPTION from CUTS where ")+
     "CUT_NAME=\""+RDEscapeString(cut_name)+"\"";
-  q=new RDSqlQuery(sql);
+  RDSqlQuery *q=new RDSqlQuery(sql);
   if(q->first()) {
     if(q->value(0).toString().isEmpty()) {
       sql=QString("update CUTS set ")+
@@ -1330,8 +1392,7 @@ bool RDCut::checkInRecording(const QString &station_name,
     "SOURCE_HOSTNAME=\""+RDEscapeString(src_hostname)+"\","+
     "UPLOAD_DATETIME=null "+
     "where CUT_NAME=\""+cut_name+"\"";
-  q=new RDSqlQuery(sql);
-  delete q;
+  UpdateRow(sql);
   return true;
 }
 
@@ -1341,42 +1402,72 @@ void RDCut::autoTrim(RDCut::AudioEnd end,int level)
   int point;
   int start_point=0;
   int end_point=-1;
+  int length=0;
+  int head_point=-1;
+  int tail_point=-1;
 
   if(!exists()) {
     return;
   }
   QString wavename=RDCut::pathName(cut_name); 
-  RDWaveFile *wave=new RDWaveFile(wavename);
-  if(!wave->openWave()) {
+
+  //
+  // Use the import analysis if it is still current, otherwise
+  // scan the energy data
+  //
+  RDAudioAnalysis *ana=new RDAudioAnalysis();
+  if(ana->load(wavename)&&((level>=0)||ana->hasTrimLevel(level))) {
+    length=ana->length();
+    head_point=ana->startPoint(level);
+    tail_point=ana->endPoint(level);
+  }
+  else {
+    RDWaveFile *wave=new RDWaveFile(wavename);
+    if(!wave->openWave()) {
+      delete wave;
+      delete ana;
+      return;
+    }
+    length=wave->getExtTimeLength();
+    if(level<0) {
+      if((point=wave->startTrim(REFERENCE_LEVEL-level))>-1) {
+	head_point=
+	  (int)(1000.0*(double)point/(double)wave->getSamplesPerSec());
+      }
+      if((point=wave->endTrim(+REFERENCE_LEVEL-level))>-1) {
+	tail_point=
+	  (int)(1000.0*(double)point/(double)wave->getSamplesPerSec());
+      }
+    }
     delete wave;
-    return;
   }
+  delete ana;
+
   if(level>=0) {
     if((end==RDCut::AudioHead)||(end==RDCut::AudioBoth)) {
       setStartPoint(0);
     }
     if((end==RDCut::AudioTail)||(end==RDCut::AudioBoth)) {
-      setEndPoint(wave->getExtTimeLength());
+      setEndPoint(length);
     }
     setLength(endPoint()-startPoint());
-    delete wave;
     return;
   }
   if((end==RDCut::AudioHead)||(end==RDCut::AudioBoth)) {
-    if((point=wave->startTrim(REFERENCE_LEVEL-level))>-1) {
-      start_point=(int)(1000.0*(double)point/(double)wave->getSamplesPerSec());
+    if(head_point>-1) {
+      start_point=head_point;
     }
   }
   if((end==RDCut::AudioTail)||(end==RDCut::AudioBoth)) {
-    if((point=wave->endTrim(+REFERENCE_LEVEL-level))>-1) {
-      end_point=(int)(1000.0*(double)point/(double)wave->getSamplesPerSec());
+    if(tail_point>-1) {
+      end_point=tail_point;
     }
     else {
-      end_point=wave->getExtTimeLength();
+      end_point=length;
     }
   }
   else {
-    end_point=wave->getExtTimeLength();
+    end_point=length;
   }
   setStartPoint(start_point);
   setEndPoint(end_point);
@@ -1388,7 +1479,6 @@ void RDCut::autoTrim(RDCut::AudioEnd end,int level)
     setSegueEndPoint(-1);
   }
   setLength(end_point-start_point);
-  delete wave;
 }
 
 
@@ -1402,6 +1492,28 @@ void RDCut::autoSegue(int level,int length,RDStation *station,RDUser *user,
     return;
   }
   QString wavename=RDCut::pathName(cut_name); 
+
+  //
+  // Use the import analysis if it is still current
+  //
+  if(level<0) {
+    RDAudioAnalysis *ana=new RDAudioAnalysis();
+    if(ana->load(wavename)&&ana->hasTrimLevel(100*level)) {
+      if((point=ana->endPoint(100*level))>=0) {
+	setSegueStartPoint(point);
+	if(length>0 && (point+length)<endPoint()){
+	  setSegueEndPoint(point+length);
+	}
+	else {
+	  setSegueEndPoint(endPoint());
+	}
+      }
+      delete ana;
+      return;
+    }
+    delete ana;
+  }
+
   RDWaveFile *wave=new RDWaveFile(wavename);
   if(!wave->openWave()) {
     delete wave;
@@ -1444,7 +1556,6 @@ void RDCut::autoSegue(int level,int length,RDStation *station,RDUser *user,
 void RDCut::reset() const
 {
   QString sql;
-  RDSqlQuery *q;
   int format;
 
   if(!exists()) {
@@ -1509,8 +1620,7 @@ void RDCut::reset() const
       "TALK_END_POINT=-1 "+
       "where CUT_NAME=\""+RDEscapeString(cut_name)+"\"";
   }
-  q=new RDSqlQuery(sql);
-  delete q;
+  UpdateRow(sql);
   wave->closeWave();
   delete wave;
 }
@@ -1663,6 +1773,92 @@ QString RDCut::xml(RDSqlQuery *q,bool absolute,RDSettings *settings)
 }
 
 
+QString RDCut::json(RDSqlQuery *q,bool absolute,int padding)
+{
+  //
+  // As for RDCut::xml(), but rendered as a JSON object with lengths and
+  // points in milliseconds. The closing brace is not terminated, leaving
+  // the caller to add any separator.
+  //
+  QString json="";
+  QString pad=RDJsonPadding(padding);
+  int offset=0;
+
+  json+=pad+"{\r\n";
+  json+=RDJsonField("cutName",q->value(31).toString(),4+padding);
+  json+=RDJsonField("cartNumber",RDCut::cartNumber(q->value(31).toString()),
+		    4+padding);
+  json+=RDJsonField("cutNumber",RDCut::cutNumber(q->value(31).toString()),
+		    4+padding);
+  json+=RDJsonField("evergreen",RDBool(q->value(32).toString()),4+padding);
+  json+=RDJsonField("description",q->value(33).toString(),4+padding);
+  json+=RDJsonField("outcue",q->value(34).toString(),4+padding);
+  json+=RDJsonField("isrc",q->value(35).toString(),4+padding);
+  json+=RDJsonField("isci",q->value(36).toString(),4+padding);
+  json+=RDJsonField("recordingMbId",q->value(74).toString(),4+padding);
+  json+=RDJsonField("releaseMbId",q->value(75).toString(),4+padding);
+  json+=RDJsonField("length",q->value(37).toUInt(),4+padding);
+  json+=RDJsonField("originDatetime",q->value(38).toDateTime(),4+padding);
+  json+=RDJsonField("startDatetime",q->value(39).toDateTime(),4+padding);
+  json+=RDJsonField("endDatetime",q->value(40).toDateTime(),4+padding);
+  json+=RDJsonField("sun",RDBool(q->value(41).toString()),4+padding);
+  json+=RDJsonField("mon",RDBool(q->value(42).toString()),4+padding);
+  json+=RDJsonField("tue",RDBool(q->value(43).toString()),4+padding);
+  json+=RDJsonField("wed",RDBool(q->value(44).toString()),4+padding);
+  json+=RDJsonField("thu",RDBool(q->value(45).toString()),4+padding);
+  json+=RDJsonField("fri",RDBool(q->value(46).toString()),4+padding);
+  json+=RDJsonField("sat",RDBool(q->value(47).toString()),4+padding);
+  if(q->value(48).isNull()) {
+    json+=RDJsonNullField("startDaypart",4+padding);
+  }
+  else {
+    json+=RDJsonField("startDaypart",RDWriteXmlTime(q->value(48).toTime()),
+		      4+padding);
+  }
+  if(q->value(49).isNull()) {
+    json+=RDJsonNullField("endDaypart",4+padding);
+  }
+  else {
+    json+=RDJsonField("endDaypart",RDWriteXmlTime(q->value(49).toTime()),
+		      4+padding);
+  }
+  json+=RDJsonField("originName",q->value(50).toString(),4+padding);
+  json+=RDJsonField("originLoginName",q->value(51).toString(),4+padding);
+  json+=RDJsonField("sourceHostname",q->value(52).toString(),4+padding);
+  json+=RDJsonField("weight",q->value(53).toUInt(),4+padding);
+  json+=RDJsonField("lastPlayDatetime",q->value(54).toDateTime(),4+padding);
+  json+=RDJsonField("playCounter",q->value(55).toUInt(),4+padding);
+  json+=RDJsonField("codingFormat",q->value(58).toUInt(),4+padding);
+  json+=RDJsonField("sampleRate",q->value(59).toUInt(),4+padding);
+  json+=RDJsonField("bitRate",q->value(60).toUInt(),4+padding);
+  json+=RDJsonField("channels",q->value(61).toUInt(),4+padding);
+  json+=RDJsonField("playGain",q->value(62).toInt(),4+padding);
+  json+=RDJsonField("segueGain",q->value(69).toInt(),4+padding);
+
+  //
+  // Points, relative to the start point unless 'absolute' is set.
+  // Unset points (-1) are rendered as null.
+  //
+  if(!absolute) {
+    offset=q->value(63).toInt();
+  }
+  json+=JsonPoint("startPoint",q->value(63).toInt(),offset,4+padding);
+  json+=JsonPoint("endPoint",q->value(64).toInt(),offset,4+padding);
+  json+=JsonPoint("fadeupPoint",q->value(65).toInt(),offset,4+padding);
+  json+=JsonPoint("fadedownPoint",q->value(66).toInt(),offset,4+padding);
+  json+=JsonPoint("segueStartPoint",q->value(67).toInt(),offset,4+padding);
+  json+=JsonPoint("segueEndPoint",q->value(68).toInt(),offset,4+padding);
+  json+=JsonPoint("hookStartPoint",q->value(70).toInt(),offset,4+padding);
+  json+=JsonPoint("hookEndPoint",q->value(71).toInt(),offset,4+padding);
+  json+=JsonPoint("talkStartPoint",q->value(72).toInt(),offset,4+padding);
+  json+=JsonPoint("talkEndPoint",q->value(73).toInt(),offset,4+padding,
+		  true);
+  json+=pad+"}";
+
+  return json;
+}
+
+
 QString RDCut::cutName(unsigned cartnum,unsigned cutnum)
 {
   if((cartnum<1)||(cartnum>RD_MAX_CART_NUMBER)||
@@ -1773,6 +1969,16 @@ void RDCut::GetDefaultDateTimes(QString *start_dt,QString *end_dt,
 }
 
 
+QString RDCut::JsonPoint(const QString &name,int value,int offset,
+			 int padding,bool final)
+{
+  if(value<0) {
+    return RDJsonNullField(name,padding,final);
+  }
+  return RDJsonField(name,value-offset,padding,final);
+}
+
+
 bool RDCut::FileCopy(const QString &srcfile,const QString &destfile) const
 {
   int src_fd;
@@ -1819,90 +2025,132 @@ bool RDCut::FileCopy(const QString &srcfile,const QString &destfile) const
 }
 
 
-void RDCut::SetRow(const QString &param,const QString &value) const
+QVariant RDCut::GetRow(const QString &param,bool *valid) const
 {
-  RDSqlQuery *q;
-  QString sql;
+  QVariant ret;
 
-  sql=QString("update CUTS set ")+
-    param+"=\""+RDEscapeString(value)+"\" where "+
-    "CUT_NAME=\""+RDEscapeString(cut_name)+"\"";
-  q=new RDSqlQuery(sql);
-  delete q;
+  if(!cut_snapshot) {
+    return RDGetSqlValue("CUTS","CUT_NAME",cut_name,param,valid);
+  }
+  if(!cut_row_valid) {
+    LoadRow();
+  }
+  ret=cut_row.value(param);
+  if(valid!=NULL) {
+    *valid=!ret.isNull();
+  }
+  return ret;
 }
 
 
-void RDCut::SetRow(const QString &param,unsigned value) const
+bool RDCut::LoadRow() const
 {
-  RDSqlQuery *q;
   QString sql;
-
-  sql=QString("update CUTS set ")+
-    param+QString().sprintf("=%u where ",value)+
-    "CUT_NAME=\""+RDEscapeString(cut_name)+"\"";
-  q=new RDSqlQuery(sql);
+  RDSqlQuery *q=NULL;
+
+  FlushRow();
+  cut_row.clear();
+  sql="select * from CUTS where CUT_NAME=?";
+  q=new RDSqlQuery(sql,QList<QVariant>()<<cut_name);
+  if((cut_row_valid=q->first())) {
+    QSqlRecord rec=q->record();
+    for(int i=0;i<rec.count();i++) {
+      cut_row[rec.fieldName(i)]=q->value(i);
+    }
+  }
   delete q;
+
+  return cut_row_valid;
 }
 
 
-void RDCut::SetRow(const QString &param,int value) const
+bool RDCut::FlushRow() const
 {
-  RDSqlQuery *q;
   QString sql;
 
-  sql=QString("update CUTS set ")+
-    param+QString().sprintf("=%d where ",value)+
-    "CUT_NAME=\""+RDEscapeString(cut_name)+"\"";
-  q=new RDSqlQuery(sql);
-  delete q;
+  if(cut_dirty.size()==0) {
+    return true;
+  }
+  sql="update CUTS set ";
+  for(QMap<QString,QString>::const_iterator ci=cut_dirty.begin();
+      ci!=cut_dirty.end();ci++) {
+    sql+=ci.key()+"="+ci.value()+",";
+  }
+  sql=sql.left(sql.length()-1)+
+    " where CUT_NAME=\""+RDEscapeString(cut_name)+"\"";
+  cut_dirty.clear();
+
+  return RDSqlQuery::apply(sql);
 }
 
 
-void RDCut::SetRow(const QString &param,const QDateTime &value) const
+void RDCut::UpdateRow(const QString &sql) const
+{
+  FlushRow();
+  RDSqlQuery::apply(sql);
+  cut_row_valid=false;
+}
+
+
+void RDCut::WriteRow(const QString &param,const QString &sql_value,
+		     const QVariant &value) const
 {
-  RDSqlQuery *q;
   QString sql;
 
+  if(cut_snapshot) {
+    cut_dirty[param]=sql_value;
+    if(cut_row_valid) {
+      cut_row[param]=value;
+    }
+    return;
+  }
   sql=QString("update CUTS set ")+
-    param+"="+RDCheckDateTime(value,"yyyy-MM-dd hh:mm:ss")+" where "+
+    param+"="+sql_value+" where "+
     "CUT_NAME=\""+RDEscapeString(cut_name)+"\"";
-  q=new RDSqlQuery(sql);
-  delete q;
+  RDSqlQuery::apply(sql);
 }
 
 
-void RDCut::SetRow(const QString &param,const QDate &value) const
+void RDCut::SetRow(const QString &param,const QString &value) const
 {
-  RDSqlQuery *q;
-  QString sql;
+  WriteRow(param,"\""+RDEscapeString(value)+"\"",value);
+}
 
-  sql=QString("update CUTS set ")+
-    param+"="+RDCheckDateTime(value,"yyyy-MM-dd")+" where "+
-    "CUT_NAME=\""+RDEscapeString(cut_name)+"\"";
-  q=new RDSqlQuery(sql);
-  delete q;
+
+void RDCut::SetRow(const QString &param,unsigned value) const
+{
+  WriteRow(param,QString().sprintf("%u",value),value);
+}
+
+
+void RDCut::SetRow(const QString &param,int value) const
+{
+  WriteRow(param,QString().sprintf("%d",value),value);
+}
+
+
+void RDCut::SetRow(const QString &param,const QDateTime &value) const
+{
+  WriteRow(param,RDCheckDateTime(value,"yyyy-MM-dd hh:mm:ss"),
+	   value.isValid()?QVariant(value):QVariant());
+}
+
+
+void RDCut::SetRow(const QString &param,const QDate &value) const
+{
+  WriteRow(param,RDCheckDateTime(value,"yyyy-MM-dd"),
+	   value.isValid()?QVariant(value):QVariant());
 }
 
 
 void RDCut::SetRow(const QString &param,const QTime &value) const
 {
-  RDSqlQuery *q;
-  QString sql;
-  sql=QString("update CUTS set ")+
-    param+"="+RDCheckDateTime(value,"hh:mm:ss")+" where "+
-    "CUT_NAME=\""+RDEscapeString(cut_name)+"\"";
-  q=new RDSqlQuery(sql);
-  delete q;
+  WriteRow(param,RDCheckDateTime(value,"hh:mm:ss"),
+	   value.isValid()?QVariant(value):QVariant());
 }
 
 
 void RDCut::SetRow(const QString &param) const
 {
-  RDSqlQuery *q;
-  QString sql;
-  sql=QString("update CUTS set ")+
-    param+"=NULL where "+
-    "CUT_NAME=\""+RDEscapeString(cut_name)+"\"";
-  q=new RDSqlQuery(sql);
-  delete q;
+  WriteRow(param,"NULL",QVariant());
 }
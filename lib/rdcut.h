@@ -18,8 +18,10 @@
 //   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 //
 
+#include <QMap>
 #include <QObject>
 
+#include <rdaudioanalysis.h>
 #include <rdconfig.h>
 #include <rddb.h>
 #include <rdwavedata.h>
@@ -30,6 +32,14 @@
 #ifndef RDCUT_H
 #define RDCUT_H
 
+//
+// RDCut
+//
+// Reads and writes the CUTS row field by field unless loadSnapshot()
+// has been called, in which case the row is read once and changes are
+// held until commit() (or the destructor) writes them with one UPDATE,
+// as with RDCart.
+//
 class RDCut
 {
  public:
@@ -40,6 +50,9 @@ class RDCut
   RDCut(unsigned cartnum,int cutnum,bool create=false);
   ~RDCut();
   bool exists() const;
+  bool loadSnapshot();
+  bool hasSnapshot() const;
+  bool commit();
   bool isValid() const;
   bool isValid(const QTime &time) const;
   bool isValid(const QDateTime &datetime) const;
@@ -63,6 +76,13 @@ class RDCut
   void setReleaseMbId(const QString &mbid);
   QString sha1Hash() const;
   void setSha1Hash(const QString &str);
+  QString sha1Fingerprint() const;
+  void setSha1Fingerprint(const QString &str);
+  int peakLevel() const;
+  void setPeakLevel(int level);
+  int loudness() const;
+  void setLoudness(int level);
+  void setAnalysis(RDAudioAnalysis *ana);
   unsigned length() const;
   void setLength(int length) const;
   QDateTime originDatetime(bool *valid) const;
@@ -144,6 +164,7 @@ class RDCut
 		 RDConfig *config);
   void reset() const;
   static QString xml(RDSqlQuery *q,bool absolute,RDSettings *settings=NULL);
+  static QString json(RDSqlQuery *q,bool absolute,int padding=0);
   static QString cutName(unsigned cartnum,unsigned cutnum);
   static unsigned cartNumber(const QString &cutname);
   static unsigned cutNumber(const QString &cutname);
@@ -156,6 +177,12 @@ class RDCut
 
  private:
   bool FileCopy(const QString &srcfile,const QString &destfile) const;
+  QVariant GetRow(const QString &param,bool *valid=NULL) const;
+  bool LoadRow() const;
+  bool FlushRow() const;
+  void UpdateRow(const QString &sql) const;
+  void WriteRow(const QString &param,const QString &sql_value,
+		const QVariant &value) const;
   void SetRow(const QString &param,const QString &value) const;
   void SetRow(const QString &param,unsigned value) const;
   void SetRow(const QString &param,int value) const;
@@ -165,9 +192,15 @@ class RDCut
   void SetRow(const QString &param) const;
   static void GetDefaultDateTimes(QString *start_dt,QString *end_dt,
 				  const QString &cutname);
+  static QString JsonPoint(const QString &name,int value,int offset,
+			   int padding,bool final=false);
   QString cut_name;
   unsigned cart_number;
   unsigned cut_number;
+  bool cut_snapshot;
+  mutable bool cut_row_valid;
+  mutable QMap<QString,QVariant> cut_row;
+  mutable QMap<QString,QString> cut_dirty;
 };
 
 
@@ -0,0 +1,467 @@
+// rdcutdecoder.cpp
+//
+// Decode a range of cut audio directly from the audio store.
+//
+//   (C) Copyright 2021 Fred Gleason <fredg@paravelsystems.com>
+//
+//   This program is free software; you can redistribute it and/or modify
+//   it under the terms of the GNU General Public License version 2 as
+//   published by the Free Software Foundation.
+//
+//   This program is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//   GNU General Public License for more details.
+//
+//   You should have received a copy of the GNU General Public
+//   License along with this program; if not, write to the Free Software
+//   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+//
+
+#include <dlfcn.h>
+#include <string.h>
+
+#include "rdcutdecoder.h"
+
+//
+// Frames decoded ahead of the start point so that the MPEG decoder
+// has settled by the time audio is kept.
+//
+#define RDCUTDECODER_MPEG_PREROLL 2304
+#define RDCUTDECODER_BUFSIZE 16384
+
+RDCutDecoder::RDCutDecoder()
+{
+  dec_pos=0;
+  dec_channels=0;
+  dec_sf=NULL;
+  dec_sf_channels=0;
+  dec_wave=NULL;
+  dec_frames=0;
+  dec_start=0;
+  dec_end=-1;
+  dec_done=true;
+#ifdef HAVE_MAD
+  dec_mpeg_buffer=NULL;
+  dec_mpeg_left_over=0;
+  dec_mpeg_fsize=0;
+#endif  // HAVE_MAD
+  dec_mad_handle=dlopen("libmad.so.0",RTLD_LAZY);
+}
+
+
+RDCutDecoder::~RDCutDecoder()
+{
+  close();
+  if(dec_mad_handle!=NULL) {
+    dlclose(dec_mad_handle);
+  }
+}
+
+
+bool RDCutDecoder::canDecode(const QString &filename,unsigned samprate) const
+{
+  bool ret=false;
+
+  RDWaveFile *wave=new RDWaveFile(filename);
+  if(wave->openWave()) {
+    if((wave->type()==RDWaveFile::Wave)&&
+       (wave->getSamplesPerSec()==samprate)) {
+      switch(wave->getFormatTag()) {
+      case WAVE_FORMAT_PCM:
+	ret=true;
+	break;
+
+      case WAVE_FORMAT_MPEG:
+#ifdef HAVE_MAD
+	ret=dec_mad_handle!=NULL;
+#endif  // HAVE_MAD
+	break;
+      }
+    }
+    wave->closeWave();
+  }
+  delete wave;
+
+  return ret;
+}
+
+
+bool RDCutDecoder::open(const QString &filename,unsigned samprate,
+			unsigned chans,int start_pt,int end_pt)
+{
+  SF_INFO sf_info;
+
+  close();
+  dec_channels=chans;
+  dec_done=false;
+
+  RDWaveFile *wave=new RDWaveFile(filename);
+  if(!wave->openWave()) {
+    delete wave;
+    close();
+    return false;
+  }
+  if(wave->getSamplesPerSec()!=samprate) {
+    delete wave;
+    close();
+    return false;
+  }
+  if((wave->type()==RDWaveFile::Wave)&&
+     (wave->getFormatTag()==WAVE_FORMAT_MPEG)) {
+    dec_wave=wave;
+    if(!OpenMpeg(start_pt,end_pt)) {
+      close();
+      return false;
+    }
+    return true;
+  }
+  wave->closeWave();
+  delete wave;
+
+  memset(&sf_info,0,sizeof(sf_info));
+  if((dec_sf=sf_open(filename.toUtf8(),SFM_READ,&sf_info))==NULL) {
+    close();
+    return false;
+  }
+  if((unsigned)sf_info.samplerate!=samprate) {
+    close();
+    return false;
+  }
+  dec_sf_channels=sf_info.channels;
+  dec_end=sf_info.frames;
+  if(start_pt>0) {
+    dec_start=(double)start_pt*(double)sf_info.samplerate/1000.0;
+    if(sf_seek(dec_sf,dec_start,SEEK_SET)<0) {
+      close();
+      return false;
+    }
+  }
+  if((end_pt>=0)&&
+     ((sf_count_t)((double)end_pt*(double)sf_info.samplerate/1000.0)<
+      dec_end)) {
+    dec_end=(double)end_pt*(double)sf_info.samplerate/1000.0;
+  }
+  dec_frames=dec_start;
+  dec_done=dec_end<=dec_start;
+
+  return true;
+}
+
+
+unsigned RDCutDecoder::channels() const
+{
+  return dec_channels;
+}
+
+
+sf_count_t RDCutDecoder::read(float *pcm,sf_count_t frames)
+{
+  sf_count_t ret=0;
+  sf_count_t n=0;
+
+  while(ret<frames) {
+    if((size_t)(dec_pos*dec_channels)>=dec_pcm.size()) {
+      if(!ReadBlock()) {
+	break;
+      }
+      continue;
+    }
+    n=dec_pcm.size()/dec_channels-dec_pos;
+    if(n>(frames-ret)) {
+      n=frames-ret;
+    }
+    memcpy(pcm+ret*dec_channels,dec_pcm.data()+dec_pos*dec_channels,
+	   n*dec_channels*sizeof(float));
+    dec_pos+=n;
+    ret+=n;
+  }
+
+  return ret;
+}
+
+
+void RDCutDecoder::decodeAhead(sf_count_t frames)
+{
+  while((dec_channels>0)&&
+	((sf_count_t)(dec_pcm.size()/dec_channels-dec_pos)<frames)) {
+    if(!ReadBlock()) {
+      break;
+    }
+  }
+}
+
+
+void RDCutDecoder::close()
+{
+  if(dec_sf!=NULL) {
+    sf_close(dec_sf);
+    dec_sf=NULL;
+  }
+  if(dec_wave!=NULL) {
+#ifdef HAVE_MAD
+    if(dec_mpeg_buffer!=NULL) {
+      mad_synth_finish(&dec_mad_synth);
+      mad_frame_finish(&dec_mad_frame);
+      mad_stream_finish(&dec_mad_stream);
+      delete[] dec_mpeg_buffer;
+      dec_mpeg_buffer=NULL;
+    }
+#endif  // HAVE_MAD
+    dec_wave->closeWave();
+    delete dec_wave;
+    dec_wave=NULL;
+  }
+  std::vector<float>().swap(dec_pcm);
+  dec_pos=0;
+  dec_frames=0;
+  dec_start=0;
+  dec_end=-1;
+  dec_done=true;
+}
+
+
+bool RDCutDecoder::OpenMpeg(int start_pt,int end_pt)
+{
+#ifdef HAVE_MAD
+  if(!LoadMad()) {
+    return false;
+  }
+  if(start_pt>0) {
+    dec_start=(double)start_pt*(double)dec_wave->getSamplesPerSec()/1000.0;
+  }
+  if(end_pt>=0) {
+    dec_end=(double)end_pt*(double)dec_wave->getSamplesPerSec()/1000.0;
+    if(dec_end<=dec_start) {
+      dec_done=true;
+    }
+  }
+
+  //
+  // Seek straight to the start point
+  //
+  if(dec_start>RDCUTDECODER_MPEG_PREROLL) {
+    int pos=dec_wave->seekMpegSample(dec_start-RDCUTDECODER_MPEG_PREROLL);
+    if(pos>0) {
+      dec_frames=pos;
+    }
+  }
+
+  dec_mpeg_buffer=new unsigned char[RDCUTDECODER_BUFSIZE];
+  dec_mpeg_left_over=0;
+  dec_mpeg_fsize=
+    144*dec_wave->getHeadBitRate()/dec_wave->getSamplesPerSec();
+  mad_stream_init(&dec_mad_stream);
+  mad_frame_init(&dec_mad_frame);
+  mad_synth_init(&dec_mad_synth);
+
+  return true;
+#else
+  return false;
+#endif  // HAVE_MAD
+}
+
+
+bool RDCutDecoder::ReadBlock()
+{
+  //
+  // Discard what has been read, then decode the next block
+  //
+  if((size_t)(dec_pos*dec_channels)>=dec_pcm.size()) {
+    dec_pcm.clear();
+    dec_pos=0;
+  }
+  if(dec_done) {
+    return false;
+  }
+  if(dec_sf!=NULL) {
+    return ReadSndFileBlock();
+  }
+  if(dec_wave!=NULL) {
+    return ReadMpegBlock();
+  }
+  return false;
+}
+
+
+bool RDCutDecoder::ReadSndFileBlock()
+{
+  sf_count_t buffer_size=RDCUTDECODER_BUFSIZE/dec_sf_channels;
+  float buffer[RDCUTDECODER_BUFSIZE];
+  sf_count_t n=0;
+
+  if((dec_end-dec_frames)<buffer_size) {
+    buffer_size=dec_end-dec_frames;
+  }
+  if((n=sf_readf_float(dec_sf,buffer,buffer_size))<=0) {
+    dec_done=true;
+    return false;
+  }
+  Append(buffer,n,dec_sf_channels);
+  dec_frames+=n;
+  dec_done=dec_frames>=dec_end;
+
+  return true;
+}
+
+
+bool RDCutDecoder::ReadMpegBlock()
+{
+#ifdef HAVE_MAD
+  unsigned char *buffer=dec_mpeg_buffer;
+  float pcm[1152*2];
+  sf_count_t len=0;
+  unsigned chans=0;
+  int n;
+
+  if((n=dec_wave->readWave(buffer+dec_mpeg_left_over,dec_mpeg_fsize))<=0) {
+    //
+    // End of the stream, so flush the last frame
+    //
+    memset(buffer+dec_mpeg_left_over,0,MAD_BUFFER_GUARD);
+    mad_stream_buffer(&dec_mad_stream,buffer,
+		      MAD_BUFFER_GUARD+dec_mpeg_left_over);
+    if(mad_frame_decode(&dec_mad_frame,&dec_mad_stream)==0) {
+      mad_synth_frame(&dec_mad_synth,&dec_mad_frame);
+      chans=dec_mad_synth.pcm.channels;
+      for(int i=0;i<dec_mad_synth.pcm.length;i++) {
+	for(unsigned j=0;j<chans;j++) {
+	  pcm[i*chans+j]=
+	    (float)mad_f_todouble(dec_mad_synth.pcm.samples[j][i]);
+	}
+      }
+      AppendRange(pcm,dec_mad_synth.pcm.length,chans);
+    }
+    dec_done=true;
+    return true;
+  }
+  if((buffer[dec_mpeg_left_over]==0xff)&&
+     (buffer[2+dec_mpeg_left_over]&0x02)!=0) {
+    n+=dec_wave->readWave(buffer+dec_mpeg_left_over+n,1);  // Padding slot
+  }
+  mad_stream_buffer(&dec_mad_stream,buffer,n+dec_mpeg_left_over);
+  while(!dec_done) {
+    if(mad_frame_decode(&dec_mad_frame,&dec_mad_stream)!=0) {
+      if(!MAD_RECOVERABLE(dec_mad_stream.error)) {
+	break;
+      }
+      if(dec_mad_stream.error<MAD_ERROR_BADCRC) {  // No frame here
+	continue;
+      }
+
+      //
+      // A damaged frame (such as one whose bit reservoir lies before
+      // the point we seeked to) still takes up its share of the
+      // timeline, so substitute silence for it
+      //
+      len=32*MAD_NSBSAMPLES(&dec_mad_frame.header);
+      chans=MAD_NCHANNELS(&dec_mad_frame.header);
+      memset(pcm,0,len*chans*sizeof(float));
+    }
+    else {
+      mad_synth_frame(&dec_mad_synth,&dec_mad_frame);
+      len=dec_mad_synth.pcm.length;
+      chans=dec_mad_synth.pcm.channels;
+      for(int i=0;i<dec_mad_synth.pcm.length;i++) {
+	for(unsigned j=0;j<chans;j++) {
+	  pcm[i*chans+j]=
+	    (float)mad_f_todouble(dec_mad_synth.pcm.samples[j][i]);
+	}
+      }
+    }
+    AppendRange(pcm,len,chans);
+  }
+  dec_mpeg_left_over=dec_mad_stream.bufend-dec_mad_stream.next_frame;
+  if((dec_mpeg_left_over+dec_mpeg_fsize+1)>RDCUTDECODER_BUFSIZE) {
+    dec_done=true;  // Malformed file
+    return false;
+  }
+  memmove(buffer,dec_mad_stream.next_frame,dec_mpeg_left_over);
+
+  return true;
+#else
+  dec_done=true;
+  return false;
+#endif  // HAVE_MAD
+}
+
+
+void RDCutDecoder::AppendRange(const float *pcm,sf_count_t frames,
+			       unsigned chans)
+{
+  //
+  // Keep only the part of a decoded MPEG frame that lies between the
+  // start and end points
+  //
+  sf_count_t first=0;
+  sf_count_t last=frames;
+
+  if(dec_frames<dec_start) {
+    first=dec_start-dec_frames;
+  }
+  if((dec_end>=0)&&((dec_frames+frames)>=dec_end)) {
+    last=dec_end-dec_frames;
+    dec_done=true;
+  }
+  if(last>first) {
+    Append(pcm+first*chans,last-first,chans);
+  }
+  dec_frames+=frames;
+}
+
+
+void RDCutDecoder::Append(const float *pcm,sf_count_t frames,unsigned chans)
+{
+  size_t offset=dec_pcm.size();
+
+  dec_pcm.resize(offset+frames*dec_channels);
+  float *out=dec_pcm.data()+offset;
+  if(chans==dec_channels) {
+    memcpy(out,pcm,frames*chans*sizeof(float));
+    return;
+  }
+  if(chans<dec_channels) {  // Upmix by repeating source channels
+    for(sf_count_t i=0;i<frames;i++) {
+      for(unsigned j=0;j<dec_channels;j++) {
+	out[i*dec_channels+j]=pcm[i*chans+j%chans];
+      }
+    }
+    return;
+  }
+  float scale=(float)dec_channels/(float)chans;  // Downmix by averaging
+  memset(out,0,frames*dec_channels*sizeof(float));
+  for(sf_count_t i=0;i<frames;i++) {
+    for(unsigned j=0;j<chans;j++) {
+      out[i*dec_channels+j%dec_channels]+=scale*pcm[i*chans+j];
+    }
+  }
+}
+
+
+bool RDCutDecoder::LoadMad()
+{
+#ifdef HAVE_MAD
+  if(dec_mad_handle==NULL) {
+    return false;
+  }
+  *(void **)(&mad_stream_init)=
+    dlsym(dec_mad_handle,"mad_stream_init");
+  *(void **)(&mad_frame_init)=
+    dlsym(dec_mad_handle,"mad_frame_init");
+  *(void **)(&mad_synth_init)=
+    dlsym(dec_mad_handle,"mad_synth_init");
+  *(void **)(&mad_stream_buffer)=
+    dlsym(dec_mad_handle,"mad_stream_buffer");
+  *(void **)(&mad_frame_decode)=
+    dlsym(dec_mad_handle,"mad_frame_decode");
+  *(void **)(&mad_synth_frame)=
+    dlsym(dec_mad_handle,"mad_synth_frame");
+  *(void **)(&mad_frame_finish)=
+    dlsym(dec_mad_handle,"mad_frame_finish");
+  *(void **)(&mad_stream_finish)=
+    dlsym(dec_mad_handle,"mad_stream_finish");
+  return true;
+#else
+  return false;
+#endif  // HAVE_MAD
+}
@@ -0,0 +1,109 @@
+// rdcutdecoder.h
+//
+// Decode a range of cut audio directly from the audio store.
+//
+//   (C) Copyright 2021 Fred Gleason <fredg@paravelsystems.com>
+//
+//   This program is free software; you can redistribute it and/or modify
+//   it under the terms of the GNU General Public License version 2 as
+//   published by the Free Software Foundation.
+//
+//   This program is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//   GNU General Public License for more details.
+//
+//   You should have received a copy of the GNU General Public
+//   License along with this program; if not, write to the Free Software
+//   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+//
+
+#ifndef RDCUTDECODER_H
+#define RDCUTDECODER_H
+
+#include <vector>
+
+#include <sndfile.h>
+#ifdef HAVE_MAD
+#include <mad.h>
+#endif  // HAVE_MAD
+
+#include <qstring.h>
+
+#include <rdwavefile.h>
+
+//
+// Frames buffered by decodeAhead() when getting a decoder ready for use
+//
+#define RDCUTDECODER_PREFETCH_FRAMES 262144
+
+//
+// RDCutDecoder
+//
+// Decodes the audio between two points of a file in the audio store
+// as floating point PCM with a given channel count, without making a
+// round trip through rdxport(8). Linear PCM is read through libsndfile
+// and MPEG through libmad, seeking via the RDWaveFile frame index.
+// open() positions the decoder at the start point, and read() then
+// decodes a block at a time as the audio is consumed, so only a
+// bounded amount of PCM is ever held in memory; decodeAhead() can be
+// used to fill that buffer beforehand. Nothing here touches the
+// database, so a decoder may be opened and read from a worker thread.
+//
+// Files that would need sample rate conversion (or are in a format
+// not handled here) are rejected by canDecode(), in which case the
+// caller should fall back to RDAudioExport.
+//
+class RDCutDecoder
+{
+ public:
+  RDCutDecoder();
+  ~RDCutDecoder();
+  bool canDecode(const QString &filename,unsigned samprate) const;
+  bool open(const QString &filename,unsigned samprate,unsigned chans,
+	    int start_pt,int end_pt);
+  unsigned channels() const;
+  sf_count_t read(float *pcm,sf_count_t frames);
+  void decodeAhead(sf_count_t frames);
+  void close();
+
+ private:
+  bool OpenMpeg(int start_pt,int end_pt);
+  bool ReadBlock();
+  bool ReadSndFileBlock();
+  bool ReadMpegBlock();
+  void AppendRange(const float *pcm,sf_count_t frames,unsigned chans);
+  void Append(const float *pcm,sf_count_t frames,unsigned chans);
+  bool LoadMad();
+  std::vector<float> dec_pcm;
+  sf_count_t dec_pos;
+  unsigned dec_channels;
+  SNDFILE *dec_sf;
+  unsigned dec_sf_channels;
+  RDWaveFile *dec_wave;
+  sf_count_t dec_frames;
+  sf_count_t dec_start;
+  sf_count_t dec_end;
+  bool dec_done;
+  void *dec_mad_handle;
+#ifdef HAVE_MAD
+  struct mad_stream dec_mad_stream;
+  struct mad_frame dec_mad_frame;
+  struct mad_synth dec_mad_synth;
+  unsigned char *dec_mpeg_buffer;
+  int dec_mpeg_left_over;
+  int dec_mpeg_fsize;
+  void (*mad_stream_init)(struct mad_stream *);
+  void (*mad_frame_init)(struct mad_frame *);
+  void (*mad_synth_init)(struct mad_synth *);
+  void (*mad_stream_buffer)(struct mad_stream *,unsigned char const *,
+			    unsigned long);
+  int (*mad_frame_decode)(struct mad_frame *, struct mad_stream *);
+  void (*mad_synth_frame)(struct mad_synth *, struct mad_frame const *);
+  void (*mad_frame_finish)(struct mad_frame *);
+  void (*mad_stream_finish)(struct mad_stream *);
+#endif  // HAVE_MAD
+};
+
+
+#endif  // RDCUTDECODER_H
@@ -27,9 +27,9 @@
 #include "rddatetime.h"
 
 QString __rddatetime_month_names[]=
-  {"Jan","Feb","Mar","Apr","Mar","Jun","Jul","Aug","Sep","Oct","Nov","Dec"};
+  {"Jan","Feb","Mar","Apr","May","Jun","Jul","Aug","Sep","Oct","Nov","Dec"};
 QString __rddatetime_dow_names[]=
-  {"Mod","Tue","Wed","Thu","Fri","Sat","Sun"};
+  {"Mon","Tue","Wed","Thu","Fri","Sat","Sun"};
 
 //
 // Auto-detect the format (XML xs:dateTime or RFC822)
@@ -253,7 +253,7 @@ QDateTime RDParseRfc822DateTime(const QString &str,bool *ok)
   // Read Date
   //
   int month=-1;
-  for(int i=0;i<7;i++) {
+  for(int i=0;i<12;i++) {
     if(f0.at(1).toLower()==__rddatetime_month_names[i].toLower()) {
       month=i;
     }
@@ -359,6 +359,18 @@ QString RDWriteRfc822DateTime(const QDateTime &dt)
 }
 
 
+QString RDWriteHttpDateTime(const QDateTime &dt)
+{
+  QDateTime utc=dt.toUTC();
+
+  return __rddatetime_dow_names[utc.date().dayOfWeek()-1]+", "+
+    QString().sprintf("%02d ",utc.date().day())+
+    __rddatetime_month_names[utc.date().month()-1]+" "+
+    QString().sprintf("%04d ",utc.date().year())+
+    utc.toString("hh:mm:ss")+" GMT";
+}
+
+
 //
 // Returns the UTC offset of the curently configured timezone (seconds)
 //
@@ -57,6 +57,12 @@ QString RDWriteXmlDateTime(const QDateTime &dt);
 QDateTime RDParseRfc822DateTime(const QString &str,bool *ok);
 QString RDWriteRfc822DateTime(const QDateTime &dt);
 
+//
+// HTTP date/time format (RFC7231 IMF-fixdate). Parse with
+// RDParseRfc822DateTime().
+//
+QString RDWriteHttpDateTime(const QDateTime &dt);
+
 //
 // Returns the UTC offset of the curently configured timezone (seconds)
 //
@@ -3,7 +3,7 @@
 //   Database driver with automatic reconnect
 //
 //   (C) Copyright 2007 Dan Mills <dmills@exponent.myzen.co.uk>
-//   (C) Copyright 2018-2019 Fred Gleason <fredg@paravelsystems.com>
+//   (C) Copyright 2018-2021 Fred Gleason <fredg@paravelsystems.com>
 //
 //   This program is free software; you can redistribute it and/or modify
 //   it under the terms of the GNU General Public License version 2 as
@@ -26,73 +26,112 @@
 #include <sys/stat.h>
 #include <sys/types.h>
 
+#include <QElapsedTimer>
 #include <QObject>
 #include <QString>
 #include <QTextCodec>
 #include <QTranslator>
+#include <QMap>
+#include <QMutex>
+#include <QMutexLocker>
 #include <QSqlError>
+#include <QSqlRecord>
 #include <QStringList>
 #include <QVariant>
 
 #include "rdapplication.h"
 #include "rddb.h"
 #include "rddbheartbeat.h"
+#include "rddbpool.h"
+#include "rdrowcache.h"
+#include "rdsqlprofiler.h"
 
-RDSqlQuery::RDSqlQuery (const QString &query,bool reconnect):
-  QSqlQuery(query)
+//
+// Prepared statement caches, by connection name
+//
+class __RDSqlStatement
 {
-  QSqlDatabase db;
-  QString err;
-  sql_columns=0;
+ public:
+  __RDSqlStatement()
+  {
+    owner=NULL;
+  }
+  QSqlQuery query;
+  RDSqlQuery *owner;
+};
 
-  if (!isActive() && reconnect) {
-    db = QSqlDatabase::database();
 
-    if (db.open()) {
-      clear();
-      exec(query);
-      err=QObject::tr("DB connection re-established");
-    }
-    else {
-      err=QObject::tr("Could not re-establish DB connection")+
-      +"["+db.lastError().text()+"]";
-    }
+class __RDSqlStatementCache
+{
+ public:
+  QMap<QString,__RDSqlStatement> statements;
+  QStringList order;  // Most recently used first
+};
 
-    fprintf(stderr,"%s\n",err.toUtf8().constData());
-    if(rda!=NULL) {
-      rda->syslog(LOG_ERR,err.toUtf8().constData());
-    }
-  }
+static QMutex __rd_statement_mutex;
+static QMap<QString,__RDSqlStatementCache> __rd_statement_caches;
+static int __rd_statement_cache_size=RDSQLQUERY_STATEMENT_CACHE_SIZE;
 
-  if(isActive()) {
-    //printf("QUERY: %s\n",(const char *)query.toUtf8());
-    QStringList f0=query.split(" ");
-    if(f0[0].toLower()=="select") {
-      for(int i=1;i<f0.size();i++) {
-	if(f0[i].toLower()=="from") {
-	  QString fields;
-	  for(int j=1;j<i;j++) {
-	    fields+=f0[j];
-	  }
-	  QStringList f1=fields.split(",");
-	  sql_columns=f1.size();
-	  continue;
-	}
-      }
-    }
-  }
-  else {
-    err=QObject::tr("invalid SQL or failed DB connection")+
-      +"["+lastError().text()+"]: "+query;
+//
+// Statements inherited from a parent process by abandonStatementCache().
+// Destroying a QSqlQuery closes its statement on the server, which
+// would pull it out from under the parent, so these are parked here
+// and deliberately never destroyed, not even by static destructors.
+//
+static QList<__RDSqlStatementCache> *__rd_inherited_statements=NULL;
 
-    fprintf(stderr,"%s\n",err.toUtf8().constData());
-    if(rda!=NULL) {
-      rda->syslog(LOG_ERR,err.toUtf8().constData());
+
+static void __RDSqlTrimStatements(__RDSqlStatementCache *cache,int size)
+{
+  for(int i=cache->order.size()-1;i>=0;i--) {
+    if(cache->order.size()<=size) {
+      return;
+    }
+    if(cache->statements.value(cache->order.at(i)).owner==NULL) {
+      cache->statements.remove(cache->order.at(i));
+      cache->order.removeAt(i);
     }
   }
 }
 
 
+RDSqlQuery::RDSqlQuery (const QString &query,bool reconnect):
+  QSqlQuery(QString(),RDDbPool::database())
+{
+  Init(query,NULL,RDDbPool::database(),reconnect);
+}
+
+
+RDSqlQuery::RDSqlQuery(const QString &query,const QSqlDatabase &db,
+		       bool reconnect):
+  QSqlQuery(QString(),db)
+{
+  Init(query,NULL,db,reconnect);
+}
+
+
+RDSqlQuery::RDSqlQuery(const QString &query,const QList<QVariant> &values,
+		       bool reconnect):
+  QSqlQuery(QString(),RDDbPool::database())
+{
+  Init(query,&values,RDDbPool::database(),reconnect);
+}
+
+
+RDSqlQuery::RDSqlQuery(const QString &query,const QList<QVariant> &values,
+		       const QSqlDatabase &db,bool reconnect):
+  QSqlQuery(QString(),db)
+{
+  Init(query,&values,db,reconnect);
+}
+
+
+RDSqlQuery::~RDSqlQuery()
+{
+  ReleaseStatement();
+}
+
+
 int RDSqlQuery::columns() const
 {
   return sql_columns;
@@ -153,6 +192,229 @@ int RDSqlQuery::rows(const QString &sql)
 }
 
 
+int RDSqlQuery::statementCacheSize()
+{
+  QMutexLocker locker(&__rd_statement_mutex);
+
+  return __rd_statement_cache_size;
+}
+
+
+void RDSqlQuery::setStatementCacheSize(int size)
+{
+  QString conn_name=RDDbPool::database().connectionName();
+  QMutexLocker locker(&__rd_statement_mutex);
+
+  __rd_statement_cache_size=size;
+  if(__rd_statement_caches.contains(conn_name)) {
+    __RDSqlTrimStatements(&__rd_statement_caches[conn_name],size);
+  }
+}
+
+
+void RDSqlQuery::clearStatementCache(const QString &conn_name)
+{
+  //
+  // Statements still in use are left to be freed by their queries.
+  // Only the thread that owns a connection may clear its cache.
+  //
+  QString name=conn_name;
+  if(name.isEmpty()) {
+    name=RDDbPool::database().connectionName();
+  }
+  QMutexLocker locker(&__rd_statement_mutex);
+
+  __rd_statement_caches.remove(name);
+}
+
+
+void RDSqlQuery::abandonStatementCache()
+{
+  //
+  // For a child process sharing its parent's connection. The inherited
+  // statements belong to the parent, so they are parked rather than
+  // closed. Nothing further is cached, so every statement the child
+  // prepares is closed when its query is deleted instead of being left
+  // open on the shared connection.
+  //
+  QMutexLocker locker(&__rd_statement_mutex);
+
+  if(__rd_inherited_statements==NULL) {
+    __rd_inherited_statements=new QList<__RDSqlStatementCache>();
+  }
+  for(QMap<QString,__RDSqlStatementCache>::const_iterator it=
+	__rd_statement_caches.begin();it!=__rd_statement_caches.end();it++) {
+    __rd_inherited_statements->push_back(it.value());
+  }
+  __rd_statement_caches.clear();
+  __rd_statement_cache_size=0;
+}
+
+
+void RDSqlQuery::Init(const QString &query,const QList<QVariant> *values,
+		      QSqlDatabase db,bool reconnect)
+{
+  bool ok=false;
+  QElapsedTimer timer;
+
+  sql_columns=0;
+  if(query.isEmpty()) {
+    return;
+  }
+  if(RDSqlProfiler::isActive()) {
+    timer.start();
+  }
+  if(RDDbPool::isReplica(db)&&(!RDDbPool::replicaCanRead(query))) {
+    //
+    // Read our own recent writes from the primary
+    //
+    db=RDDbPool::database();
+    QSqlQuery::operator=(QSqlQuery(QString(),db));
+  }
+  if(values==NULL) {
+    ok=exec(query);
+  }
+  else {
+    ok=ExecPrepared(query,*values,db);
+  }
+  if((!ok)&&RDDbPool::isReplica(db)) {
+    //
+    // Fall back to the primary
+    //
+    if((!db.isOpen())||RDDbPool::isConnectionError(lastError())) {
+      RDDbPool::replicaFailed();
+    }
+    db=RDDbPool::database();
+    if(values==NULL) {
+      QSqlQuery::operator=(QSqlQuery(QString(),db));
+      ok=exec(query);
+    }
+    else {
+      ok=ExecPrepared(query,*values,db);
+    }
+  }
+  if((!ok)&&reconnect&&
+     ((!db.isOpen())||RDDbPool::isConnectionError(lastError()))) {
+    if(RDDbPool::reconnect(db)) {
+      if(values==NULL) {
+	clear();
+	exec(query);
+      }
+      else {
+	ExecPrepared(query,*values,db);
+      }
+    }
+  }
+  if(RDSqlProfiler::isActive()) {
+    RDSqlProfiler::record(query,timer.nsecsElapsed()/1000,
+			  isSelect()?size():numRowsAffected());
+  }
+
+  if(isActive()) {
+    //printf("QUERY: %s\n",(const char *)query.toUtf8());
+    sql_columns=record().count();
+    if((!isSelect())&&(numRowsAffected()>0)) {
+      RDDbPool::noteWrite(query);
+      RDRowCache::noteWrite(query);
+    }
+  }
+  else {
+    LogError(QObject::tr("invalid SQL or failed DB connection")+
+	     +"["+lastError().text()+"]: "+query);
+  }
+}
+
+
+bool RDSqlQuery::ExecPrepared(const QString &query,
+			      const QList<QVariant> &values,QSqlDatabase db)
+{
+  QString conn_name=db.connectionName();
+  __RDSqlStatementCache *cache=NULL;
+  QMap<QString,__RDSqlStatement>::iterator it;
+  bool cached=false;
+
+  ReleaseStatement();
+  __rd_statement_mutex.lock();
+  cache=&__rd_statement_caches[conn_name];
+  it=cache->statements.find(query);
+  if((it!=cache->statements.end())&&(it.value().owner==NULL)) {
+    //
+    // Reuse the cached statement
+    //
+    QSqlQuery::operator=(it.value().query);
+    it.value().owner=this;
+    sql_statement=query;
+    sql_connection=conn_name;
+    cache->order.removeOne(query);
+    cache->order.push_front(query);
+    cached=true;
+  }
+  __rd_statement_mutex.unlock();
+
+  if(!cached) {
+    QSqlQuery::operator=(QSqlQuery(QString(),db));
+    if(!prepare(query)) {
+      return false;
+    }
+    QMutexLocker locker(&__rd_statement_mutex);
+    cache=&__rd_statement_caches[conn_name];
+    if(!cache->statements.contains(query)) {
+      if(__rd_statement_cache_size>0) {
+	__RDSqlTrimStatements(cache,__rd_statement_cache_size-1);
+      }
+      else {
+	__RDSqlTrimStatements(cache,0);
+      }
+      if(cache->order.size()<__rd_statement_cache_size) {
+	__RDSqlStatement stmt;
+	stmt.query=*this;
+	stmt.owner=this;
+	cache->statements[query]=stmt;
+	cache->order.push_front(query);
+	sql_statement=query;
+	sql_connection=conn_name;
+      }
+    }
+  }
+  for(int i=0;i<values.size();i++) {
+    bindValue(i,values.at(i));
+  }
+
+  return exec();
+}
+
+
+void RDSqlQuery::ReleaseStatement()
+{
+  QMap<QString,__RDSqlStatementCache>::iterator cache;
+  QMap<QString,__RDSqlStatement>::iterator it;
+
+  if(sql_statement.isEmpty()) {
+    return;
+  }
+  QMutexLocker locker(&__rd_statement_mutex);
+  cache=__rd_statement_caches.find(sql_connection);
+  if(cache!=__rd_statement_caches.end()) {
+    it=cache.value().statements.find(sql_statement);
+    if((it!=cache.value().statements.end())&&(it.value().owner==this)) {
+      finish();
+      it.value().owner=NULL;
+    }
+  }
+  sql_statement=QString();
+  sql_connection=QString();
+}
+
+
+void RDSqlQuery::LogError(const QString &err) const
+{
+  fprintf(stderr,"%s\n",err.toUtf8().constData());
+  if(rda!=NULL) {
+    rda->syslog(LOG_ERR,"%s",err.toUtf8().constData());
+  }
+}
+
+
 bool RDOpenDb (int *schema,QString *err_str,RDConfig *config)
 {
   QSqlDatabase db;
@@ -177,6 +439,9 @@ bool RDOpenDb (int *schema,QString *err_str,RDConfig *config)
       return false;
     }
   }
+  RDDbPool::setConfig(config);
+  RDSqlProfiler::setConfig(config);
+  RDRowCache::setConfig(config);
   new RDDbHeartbeat(config->mysqlHeartbeatInterval());
   sql=QString("set NAMES utf8mb4 collate utf8mb4_general_ci");
   q=new QSqlQuery(sql);
@@ -22,24 +22,69 @@
 #ifndef RDDB_H
 #define RDDB_H
 
+#include <QList>
 #include <QString>
+#include <QSqlDatabase>
 #include <QSqlQuery>
 #include <QVariant>
 
 #include <rdconfig.h>
 
+//
+// Default number of prepared statements kept open on each database
+// connection
+//
+#define RDSQLQUERY_STATEMENT_CACHE_SIZE 128
+
+//
+// RDSqlQuery
+//
+// Queries given with a list of values are prepared, with each '?' in
+// the SQL text bound to the corresponding value, instead of having the
+// values quoted into the text. Prepared statements are kept open in a
+// least recently used cache keyed by their SQL text, so a query that is
+// run again with new values skips the parsing and planning done by the
+// server. The cache is emptied whenever the database connection is
+// re-established. A forked child that shares its parent's connection
+// should call abandonStatementCache() before running any queries.
+//
+// Queries run on the connection returned by RDDbPool::database() unless
+// one is given. When a query fails because the connection has been lost,
+// it is re-opened (see RDDbPool::reconnect()) and the query is retried
+// once. Read-only queries can be given RDDbPool::replica() to run on the
+// read replica, if any.
+//
 class RDSqlQuery : public QSqlQuery
 {
  public:
   RDSqlQuery(const QString &query = QString::null,bool reconnect=true);
+  RDSqlQuery(const QString &query,const QSqlDatabase &db,
+	     bool reconnect=true);
+  RDSqlQuery(const QString &query,const QList<QVariant> &values,
+	     bool reconnect=true);
+  RDSqlQuery(const QString &query,const QList<QVariant> &values,
+	     const QSqlDatabase &db,bool reconnect=true);
+  ~RDSqlQuery();
   int columns() const;
   QVariant value(int index) const;
   static QVariant run(const QString &sql,bool *ok=NULL);
   static bool apply(const QString &sql,QString *err_msg=NULL);
   static int rows(const QString &sql);
+  static int statementCacheSize();
+  static void setStatementCacheSize(int size);
+  static void clearStatementCache(const QString &conn_name=QString());
+  static void abandonStatementCache();
 
  private:
+  void Init(const QString &query,const QList<QVariant> *values,
+	    QSqlDatabase db,bool reconnect);
+  bool ExecPrepared(const QString &query,const QList<QVariant> &values,
+		    QSqlDatabase db);
+  void ReleaseStatement();
+  void LogError(const QString &err) const;
   int sql_columns;
+  QString sql_statement;
+  QString sql_connection;
 };
 
 bool RDOpenDb(int *schema,QString *err_str,RDConfig *config);
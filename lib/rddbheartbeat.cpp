@@ -2,7 +2,7 @@
 //
 // Abstract a Rivendell Cart
 //
-//   (C) Copyright 2002-2006,2016 Fred Gleason <fredg@paravelsystems.com>
+//   (C) Copyright 2002-2006,2016,2021 Fred Gleason <fredg@paravelsystems.com>
 //
 //   This program is free software; you can redistribute it and/or modify
 //   it under the terms of the GNU General Public License version 2 as
@@ -31,9 +31,19 @@ RDDbHeartbeat::RDDbHeartbeat(int interval,QObject *parent)
 }
 
 
-void RDDbHeartbeat::intervalTimeoutData()
+bool RDDbHeartbeat::ping(const QSqlDatabase &db)
 {
-  RDSqlQuery *q=new RDSqlQuery("select DB from VERSION");
-  q->first();
+  bool ret=false;
+
+  RDSqlQuery *q=new RDSqlQuery("select DB from VERSION",db);
+  ret=q->first();
   delete q;
+
+  return ret;
+}
+
+
+void RDDbHeartbeat::intervalTimeoutData()
+{
+  ping(QSqlDatabase::database());
 }
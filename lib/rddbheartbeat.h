@@ -2,7 +2,7 @@
 //
 // Abstract a Rivendell Cart
 //
-//   (C) Copyright 2002-2006,2016 Fred Gleason <fredg@paravelsystems.com>
+//   (C) Copyright 2002-2006,2016,2021 Fred Gleason <fredg@paravelsystems.com>
 //
 //   This program is free software; you can redistribute it and/or modify
 //   it under the terms of the GNU General Public License version 2 as
@@ -30,6 +30,7 @@ class RDDbHeartbeat : public QObject
   Q_OBJECT;
  public:
   RDDbHeartbeat(int interval,QObject *parent=0);
+  static bool ping(const QSqlDatabase &db);
 
  private slots:
   void intervalTimeoutData();
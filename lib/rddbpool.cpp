@@ -0,0 +1,578 @@
+// rddbpool.cpp
+//
+// Per-thread pool of database connections
+//
+//   (C) Copyright 2021 Fred Gleason <fredg@paravelsystems.com>
+//
+//   This program is free software; you can redistribute it and/or modify
+//   it under the terms of the GNU General Public License version 2 as
+//   published by the Free Software Foundation.
+//
+//   This program is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//   GNU General Public License for more details.
+//
+//   You should have received a copy of the GNU General Public
+//   License along with this program; if not, write to the Free Software
+//   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+//
+
+#include <stdio.h>
+#include <syslog.h>
+
+#include <algorithm>
+
+#include <QDateTime>
+#include <QMap>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QObject>
+#include <QRegExp>
+#include <QSqlQuery>
+#include <QSqlRecord>
+#include <QStringList>
+#include <QThread>
+#include <QThreadStorage>
+
+#include "rdapplication.h"
+#include "rddb.h"
+#include "rddbheartbeat.h"
+#include "rddbpool.h"
+
+class __RDDbRetry
+{
+ public:
+  __RDDbRetry()
+  {
+    interval=0;
+  }
+  QDateTime next;
+  int interval;
+};
+
+
+class __RDDbThreadData
+{
+ public:
+  ~__RDDbThreadData();
+  QStringList idle;                    // Oldest first
+  QMap<QString,QDateTime> idle_since;
+  QStringList busy;
+  QStringList scopes;                  // Innermost last
+  QString thread_conn;
+  QString replica_conn;
+  QMap<QString,__RDDbRetry> retries;
+};
+
+
+static QMutex __rd_dbpool_mutex;
+static QThread *__rd_dbpool_main_thread=NULL;
+static QString __rd_dbpool_driver;
+static QString __rd_dbpool_hostname;
+static QString __rd_dbpool_dbname;
+static QString __rd_dbpool_username;
+static QString __rd_dbpool_password;
+static int __rd_dbpool_heartbeat=0;
+static bool __rd_dbpool_replica_active=false;
+static QString __rd_dbpool_replica_hostname;
+static int __rd_dbpool_replica_port=0;
+static QString __rd_dbpool_replica_dbname;
+static QString __rd_dbpool_replica_username;
+static QString __rd_dbpool_replica_password;
+static int __rd_dbpool_replica_max_lag=0;
+static bool __rd_dbpool_replica_ok=false;
+static QDateTime __rd_dbpool_replica_next_check;
+static QMap<QString,QDateTime> __rd_dbpool_writes;  // "*" for unknown
+static unsigned __rd_dbpool_serial=0;
+static int __rd_dbpool_open=0;
+static QThreadStorage<__RDDbThreadData *> __rd_dbpool_threads;
+
+
+static __RDDbThreadData *__RDDbThread()
+{
+  if(!__rd_dbpool_threads.hasLocalData()) {
+    __rd_dbpool_threads.setLocalData(new __RDDbThreadData());
+  }
+  return __rd_dbpool_threads.localData();
+}
+
+
+static void __RDDbLog(const QString &msg)
+{
+  fprintf(stderr,"%s\n",msg.toUtf8().constData());
+  if(rda!=NULL) {
+    rda->syslog(LOG_ERR,"%s",msg.toUtf8().constData());
+  }
+}
+
+
+static void __RDDbInitConnection(QSqlDatabase db)
+{
+  QSqlQuery q("set NAMES utf8mb4 collate utf8mb4_general_ci",db);
+}
+
+
+static void __RDDbRemove(const QString &name)
+{
+  RDSqlQuery::clearStatementCache(name);
+  {
+    QSqlDatabase db=QSqlDatabase::database(name,false);
+    db.close();
+  }
+  QSqlDatabase::removeDatabase(name);
+
+  QMutexLocker locker(&__rd_dbpool_mutex);
+  __rd_dbpool_open--;
+}
+
+
+__RDDbThreadData::~__RDDbThreadData()
+{
+  //
+  // Called in the exiting thread
+  //
+  for(int i=0;i<idle.size();i++) {
+    __RDDbRemove(idle.at(i));
+  }
+  for(int i=0;i<busy.size();i++) {
+    __RDDbRemove(busy.at(i));
+  }
+  if(!replica_conn.isEmpty()) {
+    __RDDbRemove(replica_conn);
+  }
+}
+
+
+static bool __RDDbCheckReplica(QSqlDatabase db,int max_lag,QString *err_msg)
+{
+  int lag=-1;
+  int col=-1;
+
+  QSqlQuery q(QString(),db);
+  if((!q.exec("show slave status"))&&
+     RDDbPool::isConnectionError(q.lastError())) {
+    db.close();
+    if(db.open()) {
+      __RDDbInitConnection(db);
+      q=QSqlQuery(QString(),db);
+      q.exec("show slave status");
+    }
+  }
+  if(!q.isActive()) {
+    *err_msg=QObject::tr("unable to check replication status")+
+      " ["+q.lastError().text()+"] "+
+      QObject::tr("(needs REPLICATION CLIENT or SLAVE MONITOR privilege)");
+    return false;
+  }
+  col=q.record().indexOf("Seconds_Behind_Master");
+  while(q.next()) {  // One row per source
+    if(q.value(col).isNull()) {
+      *err_msg=QObject::tr("replication is stopped");
+      return false;
+    }
+    lag=std::max(lag,q.value(col).toInt());
+  }
+  if(lag<0) {
+    *err_msg=QObject::tr("server is not a replica");
+    return false;
+  }
+  if(lag>max_lag) {
+    *err_msg=QObject::tr("replica is")+QString().sprintf(" %d ",lag)+
+      QObject::tr("seconds behind");
+    return false;
+  }
+  return true;
+}
+
+
+void RDDbPool::setConfig(RDConfig *config)
+{
+  QMutexLocker locker(&__rd_dbpool_mutex);
+
+  __rd_dbpool_main_thread=QThread::currentThread();
+  __rd_dbpool_driver=config->mysqlDriver();
+  __rd_dbpool_hostname=config->mysqlHostname();
+  __rd_dbpool_dbname=config->mysqlDbname();
+  __rd_dbpool_username=config->mysqlUsername();
+  __rd_dbpool_password=config->mysqlPassword();
+  __rd_dbpool_heartbeat=config->mysqlHeartbeatInterval();
+  __rd_dbpool_replica_hostname=config->mysqlReplicaHostname();
+  __rd_dbpool_replica_port=config->mysqlReplicaPort();
+  __rd_dbpool_replica_dbname=config->mysqlReplicaDbname();
+  __rd_dbpool_replica_username=config->mysqlReplicaUsername();
+  __rd_dbpool_replica_password=config->mysqlReplicaPassword();
+  __rd_dbpool_replica_max_lag=config->mysqlReplicaMaxLag();
+  __rd_dbpool_replica_next_check=QDateTime();
+  __rd_dbpool_replica_active=!__rd_dbpool_replica_hostname.isEmpty();
+}
+
+
+QSqlDatabase RDDbPool::database()
+{
+  __RDDbThreadData *data=__RDDbThread();
+  bool main_thread=false;
+
+  if(data->scopes.size()>0) {
+    return QSqlDatabase::database(data->scopes.last(),false);
+  }
+  __rd_dbpool_mutex.lock();
+  main_thread=(__rd_dbpool_main_thread==NULL)||
+    (__rd_dbpool_main_thread==QThread::currentThread());
+  __rd_dbpool_mutex.unlock();
+  if(main_thread) {
+    return QSqlDatabase::database();
+  }
+  if(data->thread_conn.isEmpty()) {
+    data->thread_conn=checkout().connectionName();
+  }
+  return QSqlDatabase::database(data->thread_conn,false);
+}
+
+
+QSqlDatabase RDDbPool::checkout()
+{
+  __RDDbThreadData *data=__RDDbThread();
+  QDateTime now=QDateTime::currentDateTime();
+  QString name;
+  QSqlDatabase db;
+  int heartbeat=0;
+
+  __rd_dbpool_mutex.lock();
+  heartbeat=__rd_dbpool_heartbeat;
+  __rd_dbpool_mutex.unlock();
+
+  //
+  // Close surplus idle connections, then reuse the most recent one
+  //
+  while(data->idle.size()>RDDBPOOL_MAX_IDLE_CONNECTIONS) {
+    name=data->idle.takeFirst();
+    data->idle_since.remove(name);
+    __RDDbRemove(name);
+  }
+  while(data->idle.size()>0) {
+    name=data->idle.takeLast();
+    QDateTime since=data->idle_since.take(name);
+    db=QSqlDatabase::database(name,false);
+    if((heartbeat>0)&&(since.secsTo(now)>=heartbeat)&&
+       (!RDDbHeartbeat::ping(db))) {
+      db=QSqlDatabase();
+      __RDDbRemove(name);
+      continue;
+    }
+    data->busy.push_back(name);
+    return db;
+  }
+
+  //
+  // Open a new one
+  //
+  __rd_dbpool_mutex.lock();
+  name=QString().sprintf("rddbpool%u",__rd_dbpool_serial++);
+  __rd_dbpool_open++;
+  db=QSqlDatabase::addDatabase(__rd_dbpool_driver,name);
+  db.setHostName(__rd_dbpool_hostname);
+  db.setDatabaseName(__rd_dbpool_dbname);
+  db.setUserName(__rd_dbpool_username);
+  db.setPassword(__rd_dbpool_password);
+  __rd_dbpool_mutex.unlock();
+  if(db.open()) {
+    __RDDbInitConnection(db);
+  }
+  else {
+    __RDDbLog(QObject::tr("Could not open DB connection")+
+	      " \""+name+"\" ["+db.lastError().text()+"]");
+  }
+  data->busy.push_back(name);
+
+  return db;
+}
+
+
+void RDDbPool::checkin(const QSqlDatabase &db)
+{
+  __RDDbThreadData *data=__RDDbThread();
+  QString name=db.connectionName();
+
+  if(!data->busy.removeOne(name)) {
+    return;  // Not from the pool, or not this thread's
+  }
+  if(name==data->thread_conn) {
+    data->thread_conn=QString();
+  }
+
+  //
+  // Surplus connections are closed at the next checkout, as the caller
+  // may still hold references to this one
+  //
+  data->idle.push_back(name);
+  data->idle_since[name]=QDateTime::currentDateTime();
+}
+
+
+bool RDDbPool::reconnect(QSqlDatabase db)
+{
+  __RDDbThreadData *data=__RDDbThread();
+  QString name=db.connectionName();
+  QDateTime now=QDateTime::currentDateTime();
+  __RDDbRetry *retry=&data->retries[name];
+
+  if(retry->next.isValid()&&(now<retry->next)) {
+    return false;
+  }
+  RDSqlQuery::clearStatementCache(name);
+  if(db.open()) {
+    __RDDbInitConnection(db);
+    data->retries.remove(name);
+    __RDDbLog(QObject::tr("DB connection re-established"));
+    return true;
+  }
+  if(retry->interval==0) {
+    retry->interval=RDDBPOOL_MIN_RETRY_INTERVAL;
+  }
+  else {
+    retry->interval=2*retry->interval;
+    if(retry->interval>RDDBPOOL_MAX_RETRY_INTERVAL) {
+      retry->interval=RDDBPOOL_MAX_RETRY_INTERVAL;
+    }
+  }
+  retry->next=now.addMSecs(retry->interval);
+  __RDDbLog(QObject::tr("Could not re-establish DB connection")+
+	    " ["+db.lastError().text()+"], "+
+	    QObject::tr("retrying in")+
+	    QString().sprintf(" %d ",retry->interval/1000)+
+	    QObject::tr("seconds"));
+
+  return false;
+}
+
+
+bool RDDbPool::isConnectionError(const QSqlError &err)
+{
+  //
+  // CR_SERVER_GONE_ERROR and CR_SERVER_LOST from MySQL/MariaDB
+  //
+  return (err.type()==QSqlError::ConnectionError)||
+    (err.nativeErrorCode()=="2006")||(err.nativeErrorCode()=="2013");
+}
+
+
+int RDDbPool::openConnections()
+{
+  QMutexLocker locker(&__rd_dbpool_mutex);
+
+  return __rd_dbpool_open;
+}
+
+
+RDDbConnection::RDDbConnection()
+{
+  conn_name=RDDbPool::checkout().connectionName();
+  __RDDbThread()->scopes.push_back(conn_name);
+}
+
+
+RDDbConnection::~RDDbConnection()
+{
+  __RDDbThreadData *data=__RDDbThread();
+
+  data->scopes.removeAt(data->scopes.lastIndexOf(conn_name));
+  RDDbPool::checkin(QSqlDatabase::database(conn_name,false));
+}
+
+
+QSqlDatabase RDDbConnection::database() const
+{
+  return QSqlDatabase::database(conn_name,false);
+}
+
+
+bool RDDbConnection::isValid() const
+{
+  return database().isOpen();
+}
+
+
+QSqlDatabase RDDbPool::replica()
+{
+  __RDDbThreadData *data=__RDDbThread();
+  QDateTime now=QDateTime::currentDateTime();
+  QSqlDatabase db;
+  bool check=false;
+  bool ok=false;
+  int max_lag=0;
+  QString err_msg;
+
+  if(!__rd_dbpool_replica_active) {
+    return database();
+  }
+
+  //
+  // One thread at a time checks the lag, the others going by the last
+  // result meanwhile
+  //
+  __rd_dbpool_mutex.lock();
+  if((!__rd_dbpool_replica_next_check.isValid())||
+     (now>=__rd_dbpool_replica_next_check)) {
+    __rd_dbpool_replica_next_check=
+      now.addSecs(RDDBPOOL_REPLICA_CHECK_INTERVAL);
+    check=true;
+  }
+  ok=__rd_dbpool_replica_ok;
+  max_lag=__rd_dbpool_replica_max_lag;
+  __rd_dbpool_mutex.unlock();
+  if((!ok)&&(!check)) {
+    return database();
+  }
+
+  if(data->replica_conn.isEmpty()) {
+    __rd_dbpool_mutex.lock();
+    data->replica_conn=
+      QString().sprintf("rddbreplica%u",__rd_dbpool_serial++);
+    __rd_dbpool_open++;
+    db=QSqlDatabase::addDatabase(__rd_dbpool_driver,data->replica_conn);
+    db.setHostName(__rd_dbpool_replica_hostname);
+    if(__rd_dbpool_replica_port>0) {
+      db.setPort(__rd_dbpool_replica_port);
+    }
+    db.setDatabaseName(__rd_dbpool_replica_dbname);
+    db.setUserName(__rd_dbpool_replica_username);
+    db.setPassword(__rd_dbpool_replica_password);
+    __rd_dbpool_mutex.unlock();
+  }
+  else {
+    db=QSqlDatabase::database(data->replica_conn,false);
+  }
+  if(!db.isOpen()) {
+    if(db.open()) {
+      __RDDbInitConnection(db);
+    }
+    else {
+      err_msg=QObject::tr("unable to connect")+" ["+db.lastError().text()+"]";
+      check=true;
+      ok=false;
+    }
+  }
+  if(db.isOpen()&&check) {
+    ok=__RDDbCheckReplica(db,max_lag,&err_msg);
+  }
+
+  if(check) {
+    __rd_dbpool_mutex.lock();
+    bool changed=(ok!=__rd_dbpool_replica_ok);
+    __rd_dbpool_replica_ok=ok;
+    __rd_dbpool_mutex.unlock();
+    if(changed&&(!ok)) {
+      __RDDbLog(QObject::tr("not using DB replica at")+" \""+
+		__rd_dbpool_replica_hostname+"\": "+err_msg);
+    }
+  }
+  if(!ok) {
+    return database();
+  }
+  return db;
+}
+
+
+void RDDbPool::disableReplica()
+{
+  QMutexLocker locker(&__rd_dbpool_mutex);
+
+  __rd_dbpool_replica_active=false;
+}
+
+
+bool RDDbPool::isReplica(const QSqlDatabase &db)
+{
+  return __rd_dbpool_replica_active&&
+    db.connectionName().startsWith("rddbreplica");
+}
+
+
+bool RDDbPool::replicaCanRead(const QString &sql)
+{
+  QDateTime now=QDateTime::currentDateTime();
+  QMutexLocker locker(&__rd_dbpool_mutex);
+  QMap<QString,QDateTime>::iterator it=__rd_dbpool_writes.begin();
+
+  //
+  // Forget writes that any usable replica will have by now
+  //
+  while(it!=__rd_dbpool_writes.end()) {
+    if(it.value().secsTo(now)>__rd_dbpool_replica_max_lag) {
+      it=__rd_dbpool_writes.erase(it);
+    }
+    else {
+      it++;
+    }
+  }
+  if(__rd_dbpool_writes.contains("*")) {
+    return false;
+  }
+  for(QMap<QString,QDateTime>::const_iterator ci=__rd_dbpool_writes.begin();
+      ci!=__rd_dbpool_writes.end();ci++) {
+    if(sql.contains(QRegExp("\\b"+ci.key()+"\\b",Qt::CaseInsensitive))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+
+void RDDbPool::replicaFailed()
+{
+  QMutexLocker locker(&__rd_dbpool_mutex);
+
+  if(__rd_dbpool_replica_ok) {
+    __rd_dbpool_replica_ok=false;
+    __rd_dbpool_replica_next_check=
+      QDateTime::currentDateTime().addSecs(RDDBPOOL_REPLICA_CHECK_INTERVAL);
+  }
+}
+
+
+void RDDbPool::noteWrite(const QString &sql)
+{
+  if(!__rd_dbpool_replica_active) {
+    return;
+  }
+  RDDbPool::noteWrittenTable(RDDbPool::writtenTable(sql));
+}
+
+
+void RDDbPool::noteWrittenTable(const QString &table)
+{
+  if(!__rd_dbpool_replica_active) {
+    return;
+  }
+  QMutexLocker locker(&__rd_dbpool_mutex);
+  __rd_dbpool_writes[table]=QDateTime::currentDateTime();
+}
+
+
+QStringList RDDbPool::writtenTables(const QDateTime &since)
+{
+  QStringList ret;
+  QMutexLocker locker(&__rd_dbpool_mutex);
+
+  for(QMap<QString,QDateTime>::const_iterator ci=__rd_dbpool_writes.begin();
+      ci!=__rd_dbpool_writes.end();ci++) {
+    if(ci.value()>=since) {
+      ret.push_back(ci.key());
+    }
+  }
+  return ret;
+}
+
+
+QString RDDbPool::writtenTable(const QString &sql)
+{
+  QRegExp exp("^\\s*(insert|replace|update|delete)\\s+"
+	      "((low_priority|delayed|high_priority|quick|ignore)\\s+)*"
+	      "((into|from)\\s+)?`?(\\w+)",Qt::CaseInsensitive);
+
+  if(exp.indexIn(sql)==0) {
+    return exp.cap(6).toUpper();
+  }
+  return QString("*");
+}
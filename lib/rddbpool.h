@@ -0,0 +1,130 @@
+// rddbpool.h
+//
+// Per-thread pool of database connections
+//
+//   (C) Copyright 2021 Fred Gleason <fredg@paravelsystems.com>
+//
+//   This program is free software; you can redistribute it and/or modify
+//   it under the terms of the GNU General Public License version 2 as
+//   published by the Free Software Foundation.
+//
+//   This program is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//   GNU General Public License for more details.
+//
+//   You should have received a copy of the GNU General Public
+//   License along with this program; if not, write to the Free Software
+//   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+//
+
+#ifndef RDDBPOOL_H
+#define RDDBPOOL_H
+
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QDateTime>
+#include <QString>
+#include <QStringList>
+
+#include <rdconfig.h>
+
+//
+// Maximum number of returned connections kept open by each thread
+//
+#define RDDBPOOL_MAX_IDLE_CONNECTIONS 2
+
+//
+// Delay before retrying a failed reconnection, doubled after each
+// further failure up to the maximum (mS)
+//
+#define RDDBPOOL_MIN_RETRY_INTERVAL 1000
+#define RDDBPOOL_MAX_RETRY_INTERVAL 30000
+
+//
+// Seconds between checks of the replication lag of the read replica
+//
+#define RDDBPOOL_REPLICA_CHECK_INTERVAL 5
+
+//
+// RDDbPool
+//
+// Qt only allows a database connection to be used from the thread that
+// opened it, so the default connection opened by RDOpenDb() serves only
+// the thread that called it. Every other thread gets connections of its
+// own from this pool, opened with the same settings and closed when the
+// thread exits.
+//
+// database() returns the connection that RDSqlQuery uses when none is
+// given: the innermost RDDbConnection held by the calling thread if
+// there is one, else the default connection in the thread that opened
+// it, else a connection kept by the calling thread for its lifetime.
+// Library classes such as RDCart and RDLogModel can thus be used from
+// worker threads as they are.
+//
+// A connection that has been idle for longer than the heartbeat interval
+// is checked before being handed out again, and lost connections are
+// re-opened with an increasing delay between failed attempts.
+//
+// When a read replica is configured, replica() returns a connection to
+// it for queries that can tolerate slightly stale data; passing it to
+// RDSqlQuery is the routing hint. It returns database() instead while
+// the replica is unreachable or more than ReplicaMaxLag seconds behind,
+// and RDSqlQuery sends a query to the primary if the process itself has
+// changed one of the tables it names within that time, or if it fails
+// on the replica. Checking the lag takes the REPLICATION CLIENT (MySQL)
+// or SLAVE MONITOR (MariaDB) privilege on the replica. A process that
+// makes only a few queries before exiting, such as a CGI, should call
+// disableReplica(), as the cost of opening a second connection and
+// checking the lag outweighs anything the replica could save it.
+//
+// writtenTable() returns the table changed by an insert, replace, update
+// or delete statement, or "*" if it cannot be determined.
+// writtenTables() returns the tables the process has changed since a
+// given time, for passing on to another process (such as the one that
+// forked it) that then keeps queries of them on the primary by calling
+// noteWrittenTable().
+//
+class RDDbPool
+{
+ public:
+  static void setConfig(RDConfig *config);
+  static QSqlDatabase database();
+  static QSqlDatabase checkout();
+  static void checkin(const QSqlDatabase &db);
+  static bool reconnect(QSqlDatabase db);
+  static bool isConnectionError(const QSqlError &err);
+  static int openConnections();
+  static QSqlDatabase replica();
+  static void disableReplica();
+  static bool isReplica(const QSqlDatabase &db);
+  static bool replicaCanRead(const QString &sql);
+  static void replicaFailed();
+  static void noteWrite(const QString &sql);
+  static void noteWrittenTable(const QString &table);
+  static QStringList writtenTables(const QDateTime &since);
+  static QString writtenTable(const QString &sql);
+};
+
+
+//
+// RDDbConnection
+//
+// A connection checked out from the pool for the lifetime of the
+// object, and used by default for the queries of the calling thread
+// while it exists.
+//
+class RDDbConnection
+{
+ public:
+  RDDbConnection();
+  ~RDDbConnection();
+  QSqlDatabase database() const;
+  bool isValid() const;
+
+ private:
+  QString conn_name;
+};
+
+
+#endif  // RDDBPOOL_H
@@ -35,6 +35,7 @@
 #include "rdcut.h"
 #include "rdconf.h"
 #include "rddb.h"
+#include "rddbpool.h"
 #include "rddelete.h"
 #include "rdescape_string.h"
 #include "rdfeed.h"
@@ -1582,7 +1583,7 @@ QString RDFeed::rssXml(QString *err_msg,const QDateTime &now,bool *ok)
   sql+="on FEEDS.CHANNEL_IMAGE_ID=FEED_IMAGES.ID ";
   sql+="where ";
   sql+="FEEDS.KEY_NAME=\""+RDEscapeString(keyName())+"\"";
-  chan_q=new RDSqlQuery(sql);
+  chan_q=new RDSqlQuery(sql,RDDbPool::replica());
   if(!chan_q->first()) {
     *err_msg="no feed matches the supplied key name";
     return QString();
@@ -1620,7 +1621,7 @@ QString RDFeed::rssXml(QString *err_msg,const QDateTime &now,bool *ok)
       "MEMBER_FEED_ID "+  // 00
       "from SUPERFEED_MAPS where "+
       QString().sprintf("FEED_ID=%d",chan_q->value(18).toUInt());
-    q=new RDSqlQuery(sql);
+    q=new RDSqlQuery(sql,RDDbPool::replica());
     while(q->next()) {
       where+=QString().sprintf("(PODCASTS.FEED_ID=%u) || ",q->value(0).toUInt());
     }
@@ -1668,7 +1669,7 @@ QString RDFeed::rssXml(QString *err_msg,const QDateTime &now,bool *ok)
     sql+=" desc";
   }
   //  printf("item_sql: %s\n",sql.toUtf8().constData());
-  item_q=new RDSqlQuery(sql);
+  item_q=new RDSqlQuery(sql,RDDbPool::replica());
   while(item_q->next()) {
     ret+="    <item>\r\n";
     ret+=ResolveItemWildcards(item_template,item_q,chan_q);
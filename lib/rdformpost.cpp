@@ -18,13 +18,17 @@
 //   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 //
 
+#include <errno.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
+#include <string.h>
 #include <unistd.h>
 
+#include <openssl/sha.h>
+
 #include "rdapplication.h"
 #include "rdconf.h"
 #include "rddatetime.h"
@@ -43,6 +47,10 @@ RDFormPost::RDFormPost(RDFormPost::Encoding encoding,unsigned maxsize,
   post_auto_delete=auto_delete;
   post_data=NULL;
   post_tempdir=NULL;
+  post_buffer_pos=0;
+  post_eof=false;
+  post_sniff_pos=0;
+  post_sniff_offset=0;
 
   //
   // Client Info
@@ -135,7 +143,7 @@ RDFormPost::~RDFormPost()
       delete post_tempdir;
     }
     if(post_data!=NULL) {
-      delete post_data;
+      delete[] post_data;
     }
   }
 }
@@ -319,6 +327,27 @@ bool RDFormPost::isFile(const QString &name)
 }
 
 
+QString RDFormPost::fileSha1Hash(const QString &name) const
+{
+  //
+  // SHA1 hash of the file data, computed as it was received
+  //
+  return post_file_hashes.value(name);
+}
+
+
+RDWaveFile::Type RDFormPost::fileType(const QString &name) const
+{
+  //
+  // A quick guess at the audio format of the file data, based upon
+  // the signatures checked by RDWaveFile::openWave(). A result other
+  // than RDWaveFile::Unknown is only a hint, but an Unknown file will
+  // not open with RDWaveFile either.
+  //
+  return post_file_types.value(name,RDWaveFile::Unknown);
+}
+
+
 bool RDFormPost::authenticate(bool *used_ticket)
 {
   QString ticket;
@@ -591,28 +620,21 @@ void RDFormPost::LoadUrlEncoding(char first)
 
 void RDFormPost::LoadMultipartEncoding(char first)
 {
-  //
-  // Create Stream Reader
-  //
-  if((post_stream=fdopen(0,"r"))==NULL) {
-    post_error=RDFormPost::ErrorInternal;
-    return;
-  }
-
   /*
    * Uncomment to save raw post to disc
    *
-  FILE *f;
+  int fd;
   QString dumpfile=QString("/var/snd/post-")+
     QTime::currentTime().toString("hhmmsszzz")+".dat";
-  if((f=fopen(dumpfile.toUtf8(),"w"))!=NULL) {
+  if((fd=open(dumpfile.toUtf8(),O_WRONLY|O_CREAT,S_IRUSR|S_IWUSR))>=0) {
     char data[1025];
     int n;
 
-    while((n=fread(data,1,1024,post_stream))>0) {
-      fwrite(data,1,n,f);
+    write(fd,&first,1);
+    while((n=read(0,data,1024))>0) {
+      write(fd,data,n);
     }
-    fclose(f);
+    close(fd);
     printf("Content-type: text/html\n\n");
     printf("Raw post written to \"%s\"\n",(const char *)dumpfile.toUtf8());
     exit(0);
@@ -634,6 +656,9 @@ void RDFormPost::LoadMultipartEncoding(char first)
 
   do {
     again=GetMimePart(&name,&value,&is_file);
+    if(post_error!=RDFormPost::ErrorNotInitialized) {
+      return;
+    }
     post_values[name]=value;
     post_filenames[name]=is_file;
   } while(again);
@@ -643,6 +668,7 @@ void RDFormPost::LoadMultipartEncoding(char first)
 
 bool RDFormPost::GetMimePart(QString *name,QString *value,bool *is_file)
 {
+  QByteArray data;
   QString line;
   int fd=-1;
 
@@ -654,7 +680,11 @@ bool RDFormPost::GetMimePart(QString *name,QString *value,bool *is_file)
   // Headers
   //
   do {
-    line=QString::fromUtf8(GetLine());
+    if((data=GetLine()).isEmpty()) {  // Premature end of data
+      post_error=RDFormPost::ErrorMalformedData;
+      return false;
+    }
+    line=QString::fromUtf8(data);
     QStringList f0=line.split(":");
     if(f0.size()==2) {
       if(f0[0].toLower()=="content-disposition") {
@@ -686,14 +716,15 @@ bool RDFormPost::GetMimePart(QString *name,QString *value,bool *is_file)
   // Value
   //
   if(*is_file) {
-    QByteArray data;
-    data=GetLine();
-    line=QString::fromUtf8(data).trimmed();
-    while(!line.contains(post_separator)) {
-      write(fd,data,data.length());
-      data=GetLine();
-      line=QString::fromUtf8(data).trimmed();
+    bool ok=GetFilePart(*name,fd);
+    if(fd>=0) {
+      close(fd);
+    }
+    if(!ok) {
+      unlink(value->toUtf8());
+      return false;
     }
+    line=QString::fromUtf8(GetLine());
   }
   else {
     line=QString::fromUtf8(GetLine());
@@ -704,22 +735,206 @@ bool RDFormPost::GetMimePart(QString *name,QString *value,bool *is_file)
     *value=value->trimmed();
   }
 
-  if(fd>=0) {
-    ftruncate(fd,lseek(fd,0,SEEK_CUR)-2);  // Remove extraneous final CR/LF
-    close(fd);
+  return line.trimmed().right(2)!="--";
+}
+
+
+bool RDFormPost::GetFilePart(const QString &name,int fd)
+{
+  QByteArray delim=QByteArray("\r\n")+post_separator.toUtf8();
+  SHA_CTX ctx;
+  unsigned char md[SHA_DIGEST_LENGTH];
+  const char *data=NULL;
+  int end=-1;
+  int len=0;
+  QString hash;
+
+  post_sniff_head.clear();
+  post_sniff_body.clear();
+  post_sniff_pos=0;
+  post_sniff_offset=0;
+  SHA1_Init(&ctx);
+
+  //
+  // The file data runs up to the CR/LF preceding the next separator.
+  // It is passed straight from the read buffer to the file, the hash and
+  // the format sniffer, holding back just enough at the end of each read
+  // to catch a separator that is split across two reads.
+  //
+  do {
+    if(!FillBuffer(delim.size())) {
+      post_error=RDFormPost::ErrorMalformedData;
+      return false;
+    }
+    if((end=post_buffer.indexOf(delim,post_buffer_pos))<0) {
+      len=post_buffer.size()-post_buffer_pos-delim.size()+1;
+    }
+    else {
+      len=end-post_buffer_pos;
+    }
+    data=post_buffer.constData()+post_buffer_pos;
+    if((fd>=0)&&(write(fd,data,len)!=len)) {
+      post_error=RDFormPost::ErrorInternal;
+      return false;
+    }
+    SHA1_Update(&ctx,data,len);
+    SniffData(data,len);
+    post_buffer_pos+=len;
+  } while(end<0);
+  post_buffer_pos+=2;  // Leave the separator line for GetLine()
+
+  SHA1_Final(md,&ctx);
+  for(int i=0;i<SHA_DIGEST_LENGTH;i++) {
+    hash+=QString().sprintf("%02x",0xff&md[i]);
   }
+  post_file_hashes[name]=hash;
+  post_file_types[name]=SniffType();
 
-  return line.trimmed().right(2)!="--";
+  return true;
 }
 
 
-QByteArray RDFormPost::GetLine() const
+void RDFormPost::SniffData(const char *data,int len)
 {
-  char *data=NULL;
-  size_t n=0;
+  int n;
+
+  //
+  // Keep the first RDFORMPOST_SNIFF_SIZE bytes of the file
+  //
+  if(post_sniff_head.size()<RDFORMPOST_SNIFF_SIZE) {
+    n=qMin(len,RDFORMPOST_SNIFF_SIZE-post_sniff_head.size());
+    post_sniff_head.append(data,n);
+    if((post_sniff_offset==0)&&(post_sniff_head.size()>=10)&&
+       (post_sniff_head.left(3).toUpper()=="ID3")) {
+      const unsigned char *h=
+	(const unsigned char *)post_sniff_head.constData();
+      post_sniff_offset=(h[9]|(h[8]<<7)|(h[7]<<14)|(h[6]<<21))+10;
+    }
+  }
+
+  //
+  // ...and the same again following any ID3v2 tag, wherever that
+  // extends beyond the first block
+  //
+  if(post_sniff_offset>0) {
+    qint64 from=qMax(post_sniff_offset,(qint64)RDFORMPOST_SNIFF_SIZE)+
+      post_sniff_body.size();
+    qint64 to=
+      qMin(post_sniff_offset+RDFORMPOST_SNIFF_SIZE,post_sniff_pos+len);
+    if((from>=post_sniff_pos)&&(from<to)) {
+      post_sniff_body.append(data+(from-post_sniff_pos),to-from);
+    }
+  }
+  post_sniff_pos+=len;
+}
+
+
+RDWaveFile::Type RDFormPost::SniffType() const
+{
+  const char *h=post_sniff_head.constData();
+  int len=post_sniff_head.size();
+  QByteArray mpeg;
+
+  //
+  // Same order as RDWaveFile::GetType()
+  //
+  if((len>=12)&&(memcmp(h,"RIFF",4)==0)&&(memcmp(h+8,"WAVE",4)==0)) {
+    return RDWaveFile::Wave;
+  }
+  if((len>=12)&&(memcmp(h,"FORM",4)==0)&&(memcmp(h+8,"AIFF",4)==0)) {
+    return RDWaveFile::Aiff;
+  }
+  if((len>=4)&&(memcmp(h,"fLaC",4)==0)) {
+    return RDWaveFile::Flac;
+  }
+  if((len>=5)&&(memcmp(h,"FILE:",5)==0)) {
+    return RDWaveFile::Atx;
+  }
+  if((len>=6)&&((0xFF&h[4])==0xFF)&&((0xF0&h[5])==0xF0)) {
+    return RDWaveFile::Tmc;
+  }
+  if((len>=4)&&(memcmp(h,"OggS",4)==0)) {
+    return RDWaveFile::Ogg;
+  }
+  if((len>=8)&&(memcmp(h+4,"ftyp",4)==0)) {
+    return RDWaveFile::M4A;
+  }
+
+  //
+  // MPEG (or FLAC) following an ID3v2 tag, else a bare MPEG frame sync
+  //
+  if(post_sniff_offset>0) {
+    mpeg=post_sniff_head.mid((int)post_sniff_offset)+post_sniff_body;
+    if(mpeg.left(4)=="fLaC") {
+      return RDWaveFile::Flac;
+    }
+  }
+  else {
+    mpeg=post_sniff_head;
+  }
+  const unsigned char *m=(const unsigned char *)mpeg.constData();
+  if((mpeg.size()>=2)&&(m[0]==0xFF)&&((m[1]&0xE0)==0xE0)) {
+    return RDWaveFile::Mpeg;
+  }
+  for(int i=0;i<(mpeg.size()-1);i++) {
+    if((m[i]==0xFF)&&((m[i+1]&0xF0)==0xF0)) {
+      return RDWaveFile::Mpeg;
+    }
+  }
+
+  return RDWaveFile::Unknown;
+}
+
+
+bool RDFormPost::FillBuffer(int len)
+{
+  //
+  // Ensure that at least 'len' unread bytes are buffered, reading from
+  // the client in blocks of RDFORMPOST_READ_SIZE
+  //
+  int size=0;
+  ssize_t n=0;
+
+  while((post_buffer.size()-post_buffer_pos)<len) {
+    if(post_eof) {
+      return false;
+    }
+    if(post_buffer_pos>0) {
+      post_buffer.remove(0,post_buffer_pos);
+      post_buffer_pos=0;
+    }
+    size=post_buffer.size();
+    post_buffer.resize(size+RDFORMPOST_READ_SIZE);
+    n=read(0,post_buffer.data()+size,RDFORMPOST_READ_SIZE);
+    if(n>0) {
+      post_buffer.resize(size+n);
+    }
+    else {
+      post_buffer.resize(size);
+      if((n==0)||(errno!=EINTR)) {
+	post_eof=true;
+      }
+    }
+  }
+
+  return true;
+}
+
+
+QByteArray RDFormPost::GetLine()
+{
+  QByteArray ret;
+  int end=-1;
+
+  while((end=post_buffer.indexOf('\n',post_buffer_pos))<0) {
+    if(!FillBuffer(post_buffer.size()-post_buffer_pos+1)) {
+      ret=post_buffer.mid(post_buffer_pos);
+      post_buffer_pos=post_buffer.size();
+      return ret;
+    }
+  }
+  ret=post_buffer.mid(post_buffer_pos,end-post_buffer_pos+1);
+  post_buffer_pos=end+1;
 
-  n=getline(&data,&n,post_stream);
-  QByteArray ret(data,n);
-  free(data);
   return ret;
 }
@@ -30,6 +30,17 @@
 
 #include <rdconfig.h>
 #include <rdtempdirectory.h>
+#include <rdwavefile.h>
+
+//
+// Size of the reads used to stream multipart file data from the client
+//
+#define RDFORMPOST_READ_SIZE 262144
+
+//
+// Number of leading bytes of a file part examined by fileType()
+//
+#define RDFORMPOST_SNIFF_SIZE 65536
 
 class RDFormPost
 {
@@ -54,6 +65,8 @@ class RDFormPost
   bool getValue(const QString &name,QTime *time,bool *ok=NULL);
   bool getValue(const QString &name,bool *state,bool *ok=NULL);
   bool isFile(const QString &name);
+  QString fileSha1Hash(const QString &name) const;
+  RDWaveFile::Type fileType(const QString &name) const;
   bool authenticate(bool *used_ticket=NULL);
   QString tempDir() const;
   unsigned headerContentLength() const;
@@ -68,19 +81,31 @@ class RDFormPost
   void LoadUrlEncoding(char first);
   void LoadMultipartEncoding(char first);
   bool GetMimePart(QString *name,QString *value,bool *is_file);
-  QByteArray GetLine() const;
+  bool GetFilePart(const QString &name,int fd);
+  void SniffData(const char *data,int len);
+  RDWaveFile::Type SniffType() const;
+  bool FillBuffer(int len);
+  QByteArray GetLine();
   QHostAddress post_client_address;
   RDFormPost::Encoding post_encoding;
   RDFormPost::Error post_error;
   QMap<QString,QVariant> post_values;
   QMap<QString,bool> post_filenames;
+  QMap<QString,QString> post_file_hashes;
+  QMap<QString,RDWaveFile::Type> post_file_types;
   RDTempDirectory *post_tempdir;
   bool post_auto_delete;
   unsigned post_content_length;
   QString post_content_type;
   char *post_data;
   QString post_separator;
-  FILE *post_stream;
+  QByteArray post_buffer;
+  int post_buffer_pos;
+  bool post_eof;
+  QByteArray post_sniff_head;
+  QByteArray post_sniff_body;
+  qint64 post_sniff_pos;
+  qint64 post_sniff_offset;
 };
 
 
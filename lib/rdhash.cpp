@@ -19,6 +19,8 @@
 //
 
 #include <fcntl.h>
+#include <stdlib.h>
+#include <sys/syscall.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <unistd.h>
@@ -29,26 +31,62 @@
 
 #include "rdhash.h"
 
+//
+// Size of the read buffer used when hashing
+//
+#define RDHASH_BLOCK_SIZE 1048576
+
+//
+// From linux/ioprio.h, which is not exported by glibc
+//
+#define RDHASH_IOPRIO_WHO_PROCESS 1
+#define RDHASH_IOPRIO_CLASS_SHIFT 13
+#define RDHASH_IOPRIO_CLASS_IDLE 3
+
 QString RDSha1Hash(const QString &filename,bool throttle)
 {
   QString ret;
   SHA_CTX ctx;
   int fd=-1;
-  int n;
-  char data[1024];
+  ssize_t n;
+  char *data=NULL;
   unsigned char md[SHA_DIGEST_LENGTH];
+  int prio=-1;
 
   if((fd=open(filename.toUtf8(),O_RDONLY))<0) {
     return ret;
   }
+  if((data=(char *)malloc(RDHASH_BLOCK_SIZE))==NULL) {
+    close(fd);
+    return ret;
+  }
+  posix_fadvise(fd,0,0,POSIX_FADV_SEQUENTIAL);
+
+  //
+  // When throttled, drop this thread into the 'idle' I/O scheduling
+  // class rather than sleeping between reads, so that we get the full
+  // disk bandwidth whenever nothing else wants it.
+  //
+  if(throttle) {
+    prio=syscall(SYS_ioprio_get,RDHASH_IOPRIO_WHO_PROCESS,0);
+    syscall(SYS_ioprio_set,RDHASH_IOPRIO_WHO_PROCESS,0,
+	    RDHASH_IOPRIO_CLASS_IDLE<<RDHASH_IOPRIO_CLASS_SHIFT);
+  }
   SHA1_Init(&ctx);
-  while((n=read(fd,data,1024))>0) {
+  while((n=read(fd,data,RDHASH_BLOCK_SIZE))>0) {
     SHA1_Update(&ctx,data,n);
-    if(throttle) {
-      usleep(1);
+  }
+  if(throttle) {
+    //
+    // Keep bulk scans from evicting everything else from the page cache
+    //
+    posix_fadvise(fd,0,0,POSIX_FADV_DONTNEED);
+    if(prio>=0) {
+      syscall(SYS_ioprio_set,RDHASH_IOPRIO_WHO_PROCESS,0,prio);
     }
   }
   close(fd);
+  free(data);
   SHA1_Final(md,&ctx);
   ret="";
   for(int i=0;i<SHA_DIGEST_LENGTH;i++) {
@@ -57,3 +95,55 @@ QString RDSha1Hash(const QString &filename,bool throttle)
 
   return ret;
 }
+
+
+QString RDFileFingerprint(const QString &filename,bool content)
+{
+  //
+  // A cheap identity for the file, used to decide whether a stored SHA-1
+  // hash can be trusted without reading the entire file again.  Format is
+  // <size>:<mtime-secs>.<mtime-nsecs>:<inode>[:<sha1-of-first-and-last-MB>]
+  //
+  QString ret;
+  struct stat st;
+  SHA_CTX ctx;
+  int fd=-1;
+  ssize_t n;
+  char *data=NULL;
+  unsigned char md[SHA_DIGEST_LENGTH];
+
+  if(stat(filename.toUtf8(),&st)!=0) {
+    return ret;
+  }
+  ret=QString().sprintf("%ld:%ld.%09ld:%lu",(long)st.st_size,
+			(long)st.st_mtim.tv_sec,(long)st.st_mtim.tv_nsec,
+			(unsigned long)st.st_ino);
+  if(content) {
+    if((fd=open(filename.toUtf8(),O_RDONLY))<0) {
+      return QString();
+    }
+    if((data=(char *)malloc(RDHASH_BLOCK_SIZE))==NULL) {
+      close(fd);
+      return QString();
+    }
+    SHA1_Init(&ctx);
+    if((n=pread(fd,data,RDHASH_BLOCK_SIZE,0))>0) {
+      SHA1_Update(&ctx,data,n);
+    }
+    if(st.st_size>(2*RDHASH_BLOCK_SIZE)) {
+      if((n=pread(fd,data,RDHASH_BLOCK_SIZE,
+		  st.st_size-RDHASH_BLOCK_SIZE))>0) {
+	SHA1_Update(&ctx,data,n);
+      }
+    }
+    close(fd);
+    free(data);
+    SHA1_Final(md,&ctx);
+    ret+=":";
+    for(int i=0;i<SHA_DIGEST_LENGTH;i++) {
+      ret+=QString().sprintf("%02x",0xff&md[i]);
+    }
+  }
+
+  return ret;
+}
@@ -24,6 +24,7 @@
 #include <qstring.h>
 
 QString RDSha1Hash(const QString &filename,bool throttle=false);
+QString RDFileFingerprint(const QString &filename,bool content=false);
 
 
 #endif  // RD_H
@@ -0,0 +1,252 @@
+// rdhashbatch.cpp
+//
+// Generate SHA-1 hashes for a list of audio files in parallel.
+//
+//   (C) Copyright 2021 Fred Gleason <fredg@paravelsystems.com>
+//
+//   This program is free software; you can redistribute it and/or modify
+//   it under the terms of the GNU General Public License version 2 as
+//   published by the Free Software Foundation.
+//
+//   This program is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//   GNU General Public License for more details.
+//
+//   You should have received a copy of the GNU General Public
+//   License along with this program; if not, write to the Free Software
+//   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+//
+
+#include <unistd.h>
+
+#include <QSet>
+
+#include "rdcut.h"
+#include "rddb.h"
+#include "rdescape_string.h"
+#include "rdhash.h"
+#include "rdhashbatch.h"
+
+//
+// Maximum number of rows touched by a single UPDATE statement
+//
+#define RDHASHBATCH_UPDATE_QUANTUM 500
+
+RDHashBatch::RDHashBatch(int workers)
+{
+  batch_throttle=false;
+  batch_threaded=false;
+  batch_next=0;
+  setWorkers(workers);
+}
+
+
+int RDHashBatch::workers() const
+{
+  return batch_workers;
+}
+
+
+void RDHashBatch::setWorkers(int n)
+{
+  if(n<=0) {
+    if((n=sysconf(_SC_NPROCESSORS_ONLN))<=0) {
+      n=1;
+    }
+  }
+  batch_workers=n;
+}
+
+
+bool RDHashBatch::throttle() const
+{
+  return batch_throttle;
+}
+
+
+void RDHashBatch::setThrottle(bool state)
+{
+  batch_throttle=state;
+}
+
+
+void RDHashBatch::addFile(const QString &filename)
+{
+  batch_filenames.push_back(filename);
+  batch_cutnames.push_back(QString());
+  batch_hashes.push_back(QString());
+  batch_old_fingerprints.push_back(QString());
+  batch_fingerprints.push_back(QString());
+  batch_skipped.push_back(false);
+}
+
+
+void RDHashBatch::addCut(const QString &cutname,const QString &fingerprint)
+{
+  //
+  // If 'fingerprint' is given and still matches the audio file, the
+  // cut will be skipped rather than hashed.
+  //
+  batch_filenames.push_back(RDCut::pathName(cutname));
+  batch_cutnames.push_back(cutname);
+  batch_hashes.push_back(QString());
+  batch_old_fingerprints.push_back(fingerprint);
+  batch_fingerprints.push_back(QString());
+  batch_skipped.push_back(false);
+}
+
+
+int RDHashBatch::size() const
+{
+  return batch_filenames.size();
+}
+
+
+QString RDHashBatch::filename(int n) const
+{
+  return batch_filenames.at(n);
+}
+
+
+QString RDHashBatch::cutName(int n) const
+{
+  return batch_cutnames.at(n);
+}
+
+
+QString RDHashBatch::hash(int n) const
+{
+  return batch_hashes.at(n);
+}
+
+
+QString RDHashBatch::fingerprint(int n) const
+{
+  return batch_fingerprints.at(n);
+}
+
+
+bool RDHashBatch::skipped(int n) const
+{
+  return batch_skipped.at(n);
+}
+
+
+void RDHashBatch::clear()
+{
+  batch_filenames.clear();
+  batch_cutnames.clear();
+  batch_hashes.clear();
+  batch_old_fingerprints.clear();
+  batch_fingerprints.clear();
+  batch_skipped.clear();
+}
+
+
+void RDHashBatch::run()
+{
+  int workers=batch_workers;
+  if(workers>size()) {
+    workers=size();
+  }
+  batch_next=0;
+  batch_threaded=workers>1;
+  if(!batch_threaded) {
+    WorkerCallback(this);
+    return;
+  }
+  pthread_mutex_init(&batch_mutex,NULL);
+  std::vector<pthread_t> threads(workers);
+  for(int i=0;i<workers;i++) {
+    pthread_create(&threads[i],NULL,RDHashBatch::WorkerCallback,this);
+  }
+  for(int i=0;i<workers;i++) {
+    pthread_join(threads[i],NULL);
+  }
+  pthread_mutex_destroy(&batch_mutex);
+}
+
+
+int RDHashBatch::updateCuts(const QStringList &cutnames) const
+{
+  //
+  // Write the hashes for the specified cuts (or for all cuts in the batch
+  // if none are specified) back to CUTS.SHA1_HASH and
+  // CUTS.SHA1_FINGERPRINT, several hundred rows per statement.
+  //
+  QSet<QString> selected=cutnames.toSet();
+  QString sql;
+  QString cases;
+  QString fp_cases;
+  QString names;
+  int count=0;
+  int ret=0;
+
+  for(unsigned i=0;i<batch_cutnames.size();i++) {
+    if((!batch_cutnames.at(i).isEmpty())&&(!batch_hashes.at(i).isEmpty())&&
+       (!batch_skipped.at(i))&&
+       (selected.isEmpty()||selected.contains(batch_cutnames.at(i)))) {
+      cases+="when \""+RDEscapeString(batch_cutnames.at(i))+"\" then \""+
+	RDEscapeString(batch_hashes.at(i))+"\" ";
+      fp_cases+="when \""+RDEscapeString(batch_cutnames.at(i))+"\" then ";
+      if(batch_fingerprints.at(i).isEmpty()) {
+	fp_cases+="null ";
+      }
+      else {
+	fp_cases+="\""+RDEscapeString(batch_fingerprints.at(i))+"\" ";
+      }
+      names+="\""+RDEscapeString(batch_cutnames.at(i))+"\",";
+      count++;
+    }
+    if((count==RDHASHBATCH_UPDATE_QUANTUM)||
+       ((i==(batch_cutnames.size()-1))&&(count>0))) {
+      names=names.left(names.length()-1);
+      sql=QString("update CUTS set ")+
+	"SHA1_HASH=case CUT_NAME "+cases+"end,"+
+	"SHA1_FINGERPRINT=case CUT_NAME "+fp_cases+"end "+
+	"where CUT_NAME in ("+names+")";
+      if(RDSqlQuery::apply(sql)) {
+	ret+=count;
+      }
+      cases="";
+      fp_cases="";
+      names="";
+      count=0;
+    }
+  }
+
+  return ret;
+}
+
+
+void *RDHashBatch::WorkerCallback(void *priv)
+{
+  RDHashBatch *batch=(RDHashBatch *)priv;
+  unsigned n;
+
+  while(1==1) {
+    if(batch->batch_threaded) {
+      pthread_mutex_lock(&batch->batch_mutex);
+    }
+    n=batch->batch_next++;
+    if(batch->batch_threaded) {
+      pthread_mutex_unlock(&batch->batch_mutex);
+    }
+    if(n>=batch->batch_filenames.size()) {
+      return NULL;
+    }
+    batch->batch_fingerprints[n]=
+      RDFileFingerprint(batch->batch_filenames.at(n));
+    if((!batch->batch_old_fingerprints.at(n).isEmpty())&&
+       (batch->batch_fingerprints.at(n)==batch->batch_old_fingerprints.at(n))) {
+      batch->batch_skipped[n]=true;
+    }
+    else {
+      batch->batch_hashes[n]=
+	RDSha1Hash(batch->batch_filenames.at(n),batch->batch_throttle);
+    }
+  }
+
+  return NULL;
+}
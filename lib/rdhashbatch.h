@@ -0,0 +1,67 @@
+// rdhashbatch.h
+//
+// Generate SHA-1 hashes for a list of audio files in parallel.
+//
+//   (C) Copyright 2021 Fred Gleason <fredg@paravelsystems.com>
+//
+//   This program is free software; you can redistribute it and/or modify
+//   it under the terms of the GNU General Public License version 2 as
+//   published by the Free Software Foundation.
+//
+//   This program is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//   GNU General Public License for more details.
+//
+//   You should have received a copy of the GNU General Public
+//   License along with this program; if not, write to the Free Software
+//   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+//
+
+#ifndef RDHASHBATCH_H
+#define RDHASHBATCH_H
+
+#include <pthread.h>
+
+#include <vector>
+
+#include <qstring.h>
+#include <qstringlist.h>
+
+class RDHashBatch
+{
+ public:
+  RDHashBatch(int workers=0);
+  int workers() const;
+  void setWorkers(int n);
+  bool throttle() const;
+  void setThrottle(bool state);
+  void addFile(const QString &filename);
+  void addCut(const QString &cutname,const QString &fingerprint=QString());
+  int size() const;
+  QString filename(int n) const;
+  QString cutName(int n) const;
+  QString hash(int n) const;
+  QString fingerprint(int n) const;
+  bool skipped(int n) const;
+  void clear();
+  void run();
+  int updateCuts(const QStringList &cutnames=QStringList()) const;
+
+ private:
+  static void *WorkerCallback(void *priv);
+  std::vector<QString> batch_filenames;
+  std::vector<QString> batch_cutnames;
+  std::vector<QString> batch_hashes;
+  std::vector<QString> batch_old_fingerprints;
+  std::vector<QString> batch_fingerprints;
+  std::vector<int> batch_skipped;
+  int batch_workers;
+  bool batch_throttle;
+  bool batch_threaded;
+  unsigned batch_next;
+  pthread_mutex_t batch_mutex;
+};
+
+
+#endif  // RDHASHBATCH_H
@@ -18,17 +18,124 @@
 //   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 //
 
+#include <algorithm>
+
+#include <QMutex>
+#include <QRegExp>
+#include <QSet>
+#include <QWaitCondition>
+
 #include "rdapplication.h"
 #include "rdconf.h"
+#include "rddbpool.h"
 #include "rdescape_string.h"
 #include "rdlibrarymodel.h"
 
+//
+// Finds the carts matching a filter, on a connection of its own. The
+// thread (and so its connections) lasts as long as the model; a filter
+// given while a query is running replaces any still waiting, so only
+// the latest one is run next.
+//
+class __RDLibraryModelLoader : public QThread
+{
+ public:
+  __RDLibraryModelLoader(QObject *model)
+    : QThread()
+  {
+    loader_model=model;
+    loader_serial=0;
+    loader_done_serial=0;
+    loader_quit=false;
+  }
+  unsigned request(const QString &sql)
+  {
+    QMutexLocker locker(&loader_mutex);
+    loader_sql=sql;
+    loader_serial++;
+    loader_cond.wakeAll();
+    return loader_serial;
+  }
+  bool result(unsigned serial,QList<unsigned> *keys,bool wait)
+  {
+    QMutexLocker locker(&loader_mutex);
+    while(wait&&(loader_done_serial<serial)) {
+      loader_cond.wait(&loader_mutex);
+    }
+    if(loader_done_serial!=serial) {
+      return false;
+    }
+    *keys=loader_keys;
+    return true;
+  }
+  void stop()
+  {
+    QMutexLocker locker(&loader_mutex);
+    loader_quit=true;
+    loader_cond.wakeAll();
+  }
+
+ protected:
+  void run()
+  {
+    QMutexLocker locker(&loader_mutex);
+    while(!loader_quit) {
+      if(loader_done_serial==loader_serial) {
+	loader_cond.wait(&loader_mutex);
+	continue;
+      }
+      QString sql=loader_sql;
+      unsigned serial=loader_serial;
+      QList<unsigned> keys;
+      QSet<unsigned> seen;
+      unsigned cartnum;
+
+      locker.unlock();
+      RDSqlQuery *q=new RDSqlQuery(sql,RDDbPool::replica());
+      while(q->next()) {
+	cartnum=q->value(0).toUInt();
+	if(!seen.contains(cartnum)) {  // One row per cut
+	  seen.insert(cartnum);
+	  keys.push_back(cartnum);
+	}
+      }
+      delete q;
+      locker.relock();
+
+      loader_keys=keys;
+      loader_done_serial=serial;
+      loader_cond.wakeAll();
+      if(serial==loader_serial) {
+	QMetaObject::invokeMethod(loader_model,"loaderFinishedData",
+				  Qt::QueuedConnection);
+      }
+    }
+  }
+
+ private:
+  QObject *loader_model;
+  QString loader_sql;
+  unsigned loader_serial;
+  unsigned loader_done_serial;
+  QList<unsigned> loader_keys;
+  bool loader_quit;
+  QMutex loader_mutex;
+  QWaitCondition loader_cond;
+};
+
+
 RDLibraryModel::RDLibraryModel(QObject *parent)
   : QAbstractItemModel(parent)
 {
   d_font_metrics=NULL;
   d_bold_font_metrics=NULL;
   d_show_notes=false;
+  d_filter_set=false;
+  d_sort_column=-1;
+  d_sort_order=Qt::AscendingOrder;
+  d_loader=NULL;
+  d_load_serial=0;
+  d_load_pending=false;
 
   //
   // Column Attributes
@@ -104,6 +211,11 @@ RDLibraryModel::RDLibraryModel(QObject *parent)
 
 RDLibraryModel::~RDLibraryModel()
 {
+  if(d_loader!=NULL) {
+    d_loader->stop();
+    d_loader->wait();
+    delete d_loader;
+  }
 }
 
 
@@ -180,7 +292,10 @@ bool RDLibraryModel::hasChildren(const QModelIndex &parent) const
 {
   if(parent.isValid()) {
     if((parent.internalId()==0)&&(parent.column()==0)) {
-      return d_cut_texts.at(parent.row()).size()>0;
+      if(d_cuts_loaded.at(parent.row())) {
+	return d_cut_texts.at(parent.row()).size()>0;
+      }
+      return d_texts.at(parent.row()).at(16).toUInt()>0;
     }
     return false;
   }
@@ -188,6 +303,43 @@ bool RDLibraryModel::hasChildren(const QModelIndex &parent) const
 }
 
 
+bool RDLibraryModel::canFetchMore(const QModelIndex &parent) const
+{
+  if(parent.isValid()) {
+    return (parent.internalId()==0)&&(!d_cuts_loaded.at(parent.row()));
+  }
+  return d_texts.size()<d_keys.size();
+}
+
+
+void RDLibraryModel::fetchMore(const QModelIndex &parent)
+{
+  if(parent.isValid()) {
+    if(parent.internalId()==0) {
+      LoadCuts(parent.row());
+    }
+    return;
+  }
+  AppendRows(RDLIBRARYMODEL_FETCH_SIZE,true);
+}
+
+
+void RDLibraryModel::sort(int col,Qt::SortOrder order)
+{
+  if((col<0)||(col>=columnCount())) {
+    col=-1;
+  }
+  if((col==d_sort_column)&&(order==d_sort_order)) {
+    return;
+  }
+  d_sort_column=col;
+  d_sort_order=order;
+  if(d_filter_set) {
+    StartLoad();
+  }
+}
+
+
 Qt::ItemFlags RDLibraryModel::flags(const QModelIndex &index) const
 {
   return Qt::ItemIsSelectable|Qt::ItemIsDragEnabled|Qt::ItemIsEnabled;
@@ -323,10 +475,21 @@ QString RDLibraryModel::cutName(const QModelIndex &index) const
 
 QModelIndex RDLibraryModel::cartRow(unsigned cartnum) const
 {
-  int pos=d_cart_numbers.indexOf(cartnum);
-
-  if(pos<0) {
-    return QModelIndex();
+  RDLibraryModel *model=const_cast<RDLibraryModel *>(this);
+  int pos=-1;
+
+  model->WaitForLoad();
+  if((pos=d_cart_numbers.indexOf(cartnum))<0) {
+    //
+    // Not fetched yet?
+    //
+    if((pos=d_keys.indexOf(cartnum))<0) {
+      return QModelIndex();
+    }
+    model->AppendRows(1+pos-d_texts.size(),true);
+    if((pos=d_cart_numbers.indexOf(cartnum))<0) {
+      return QModelIndex();
+    }
   }
   return createIndex(pos,0,(quintptr)0);
 }
@@ -334,11 +497,15 @@ QModelIndex RDLibraryModel::cartRow(unsigned cartnum) const
 
 QModelIndex RDLibraryModel::cutRow(const QString &cutname) const
 {
-  int cartpos=d_cart_numbers.indexOf(RDCut::cartNumber(cutname));
+  QModelIndex cart=cartRow(RDCut::cartNumber(cutname));
+  int cartpos=cart.row();
 
-  if(cartpos<0) {
+  if(!cart.isValid()) {
     return QModelIndex();
   }
+  if(!d_cuts_loaded.at(cartpos)) {
+    const_cast<RDLibraryModel *>(this)->LoadCuts(cartpos);
+  }
   int cutpos=d_cut_cutnames.at(cartpos).indexOf(cutname);
   if(cutpos<0) {
     return QModelIndex();
@@ -378,6 +545,8 @@ QString RDLibraryModel::cartOwnedBy(const QModelIndex &index)
 
 QModelIndex RDLibraryModel::addCart(unsigned cartnum)
 {
+  WaitForLoad();
+
   //
   // Find the insertion offset
   //
@@ -394,14 +563,15 @@ QModelIndex RDLibraryModel::addCart(unsigned cartnum)
   for(int i=0;i<columnCount();i++) {
     list.push_back(QVariant());
   }
-  QList<QList<QVariant> > list_list;
-  list_list.push_back(list);
+  d_keys.removeOne(cartnum);
+  d_keys.insert(offset,cartnum);
   d_icons.insert(offset,list);
   d_texts.insert(offset,list);
   d_notes.insert(offset,QVariant());
   d_cart_numbers.insert(offset,0);
-  d_cut_texts.insert(offset,list_list);
+  d_cut_texts.insert(offset,QList<QList<QVariant> >());
   d_cut_cutnames.insert(offset,QStringList());
+  d_cuts_loaded.insert(offset,false);
   d_background_colors.insert(offset,QVariant());
   d_cart_types.insert(offset,RDCart::All);
 
@@ -414,7 +584,8 @@ QModelIndex RDLibraryModel::addCart(unsigned cartnum)
   }
   delete q;
   endInsertRows();
-  emit rowCountChanged(d_texts.size());
+  LoadCuts(offset);
+  emit rowCountChanged(d_keys.size());
 
   return createIndex(offset,0,(quintptr)0);
 }
@@ -424,6 +595,8 @@ void RDLibraryModel::removeCart(const QModelIndex &index)
 {
   beginRemoveRows(QModelIndex(),index.row(),index.row());
 
+  d_keys.removeAt(index.row());
+  d_cuts_loaded.removeAt(index.row());
   d_texts.removeAt(index.row());
   d_notes.removeAt(index.row());
   d_cart_numbers.removeAt(index.row());
@@ -434,7 +607,7 @@ void RDLibraryModel::removeCart(const QModelIndex &index)
   d_icons.removeAt(index.row());
 
   endRemoveRows();
-  emit rowCountChanged(d_texts.size());
+  emit rowCountChanged(d_keys.size());
 }
 
 
@@ -444,6 +617,8 @@ void RDLibraryModel::removeCart(unsigned cartnum)
     if(d_cart_numbers.at(i)==cartnum) {
       beginRemoveRows(QModelIndex(),i,i);
 
+      d_keys.removeAt(i);
+      d_cuts_loaded.removeAt(i);
       d_texts.removeAt(i);
       d_notes.removeAt(i);
       d_cart_numbers.removeAt(i);
@@ -454,10 +629,11 @@ void RDLibraryModel::removeCart(unsigned cartnum)
       d_icons.removeAt(i);
 
       endRemoveRows();
-      emit rowCountChanged(d_texts.size());
+      emit rowCountChanged(d_keys.size());
       return;
     }
   }
+  d_keys.removeOne(cartnum);  // Not fetched yet
 }
 
 
@@ -495,6 +671,14 @@ void RDLibraryModel::setShowNotes(int state)
 }
 
 
+void RDLibraryModel::loaderFinishedData()
+{
+  if(d_load_pending) {
+    ApplyLoad(false);
+  }
+}
+
+
 void RDLibraryModel::setFilterSql(const QString &sql)
 {
   //  printf("FILTER SQL: %s\n",sql.toUtf8().constData());
@@ -506,18 +690,8 @@ void RDLibraryModel::updateModel(const QString &filter_sql)
 {
   QString sql;
   RDSqlQuery *q=NULL;
-
-  //
-  // Placeholder values
-  //
-  QList<QVariant> list;
-  QList<QVariant> icons;
-  for(int i=0;i<columnCount();i++) {
-    list.push_back(QVariant());
-    icons.push_back(QVariant());
-  }
-  QList<QList<QVariant> > list_list;
-  list_list.push_back(list);
+  int quote=0;
+  int pos=0;
 
   //
   // Reload the color table
@@ -533,37 +707,28 @@ void RDLibraryModel::updateModel(const QString &filter_sql)
   }
   delete q;
 
-  sql=sqlFields()+
-    filter_sql;
-  //  printf("SQL: %s\n",sql.toUtf8().constData());
-  beginResetModel();
-  d_texts.clear();
-  d_notes.clear();
-  d_cart_numbers.clear();
-  d_cut_texts.clear();
-  d_cut_cutnames.clear();
-  d_background_colors.clear();
-  d_cart_types.clear();
-  d_icons.clear();
-  unsigned prev_cartnum=0;
-  q=new RDSqlQuery(sql);
-  while(q->next()) {
-    if(q->value(0).toUInt()!=prev_cartnum) {
-      d_texts.push_back(list);
-      d_notes.push_back(QVariant());
-      d_cart_numbers.push_back(0);
-      d_cut_texts.push_back(list_list);
-      d_cut_cutnames.push_back(QStringList());
-      d_background_colors.push_back(QVariant());
-      d_cart_types.push_back(RDCart::All);
-      d_icons.push_back(icons);
-      updateRow(d_texts.size()-1,q);
-      prev_cartnum=q->value(0).toUInt();
-    }
+  //
+  // Split off any "order by" and "limit" clauses, so that the sort order
+  // can be replaced
+  //
+  d_filter_sql=filter_sql;
+  d_order_sql="";
+  d_limit_sql="";
+  quote=1+std::max(d_filter_sql.lastIndexOf("\""),
+		   d_filter_sql.lastIndexOf("'"));
+  if((pos=d_filter_sql.indexOf(QRegExp("\\blimit\\b",Qt::CaseInsensitive),
+			       quote))>=0) {
+    d_limit_sql=d_filter_sql.right(d_filter_sql.length()-pos);
+    d_filter_sql=d_filter_sql.left(pos);
   }
-  delete q;
-  endResetModel();
-  emit rowCountChanged(d_texts.size());
+  if((pos=d_filter_sql.indexOf(QRegExp("\\border\\s+by\\b",
+				       Qt::CaseInsensitive),quote))>=0) {
+    d_order_sql=d_filter_sql.right(d_filter_sql.length()-pos);
+    d_filter_sql=d_filter_sql.left(pos);
+  }
+  d_filter_set=true;
+
+  StartLoad();
 }
 
 
@@ -579,13 +744,14 @@ void RDLibraryModel::updateCartLine(int cartline)
 		     createIndex(cartline,columnCount(),(quintptr)0));
   }
   delete q;
+  if(d_cuts_loaded.at(cartline)) {
+    ReloadCuts(cartline);
+  }
 }
 
 
 void RDLibraryModel::updateRow(int row,RDSqlQuery *q)
 {
-  unsigned cartnum=q->value(0).toUInt();
-
   //
   // Text Values (Qt::Display)
   //
@@ -686,33 +852,6 @@ void RDLibraryModel::updateRow(int row,RDSqlQuery *q)
     d_background_colors[row]=
       QColor(palette().color(QPalette::Active,QPalette::Base));
   }
-
-  //
-  // Cut Attributes
-  //
-  d_cut_texts[row].clear();
-  d_cut_cutnames[row].clear();
-  QList<QVariant> list;
-  for(int i=0;i<columnCount();i++) {
-    list.push_back(QVariant());
-  }
-
-  do {
-    if(q->value(24).isNull()) {
-      return;  // No cuts!
-    }
-    // Process
-    d_cut_cutnames[row].push_back(q->value(24).toString());
-    d_cut_texts[row].push_back(list);
-    d_cut_texts[row].back()[0]=tr("Cut")+  // Cut Number
-      QString().sprintf(" %03d",RDCut::cutNumber(q->value(24).toString()));
-    d_cut_texts[row].back()[2]=  // Length
-      RDGetTimeLength(q->value(26).toUInt()-q->value(25).toUInt());
-    d_cut_texts[row].back()[3]=  // Talk Length
-      RDGetTimeLength(q->value(28).toUInt()-q->value(27).toUInt());
-    d_cut_texts[row].back()[4]=q->value(29).toString();  // Description
-  } while(q->next()&&(q->value(0).toUInt()==cartnum));
-  q->previous();
 }
 
 
@@ -775,3 +914,282 @@ QByteArray RDLibraryModel::DumpIndex(const QModelIndex &index,const QString &cap
   }
   return ret;
 }
+
+
+void RDLibraryModel::StartLoad()
+{
+  if(d_loader==NULL) {
+    d_loader=new __RDLibraryModelLoader(this);
+    d_loader->start();
+  }
+  d_load_serial=d_loader->request(KeySql());
+  d_load_pending=true;
+}
+
+
+void RDLibraryModel::WaitForLoad()
+{
+  if(d_load_pending) {
+    ApplyLoad(true);
+  }
+}
+
+
+void RDLibraryModel::ApplyLoad(bool wait)
+{
+  QList<unsigned> keys;
+
+  if(!d_loader->result(d_load_serial,&keys,wait)) {
+    return;  // Superseded by a newer filter
+  }
+  d_load_pending=false;
+  beginResetModel();
+  ClearRows();
+  d_keys=keys;
+  AppendRows(RDLIBRARYMODEL_FETCH_SIZE,false);
+  endResetModel();
+  emit rowCountChanged(d_keys.size());
+}
+
+
+void RDLibraryModel::AppendRows(int count,bool notify)
+{
+  int first=d_texts.size();
+  QString sql;
+  RDSqlQuery *q=NULL;
+  QMap<unsigned,int> positions;
+
+  count=std::min(count,d_keys.size()-first);
+  if(count<=0) {
+    return;
+  }
+
+  //
+  // Placeholder values
+  //
+  QList<QVariant> list;
+  for(int i=0;i<columnCount();i++) {
+    list.push_back(QVariant());
+  }
+
+  sql=sqlFields()+"where CART.NUMBER in (";
+  for(int i=0;i<count;i++) {
+    sql+=QString().sprintf("%u,",d_keys.at(first+i));
+  }
+  sql=sql.left(sql.length()-1)+") order by CART.NUMBER";
+  q=new RDSqlQuery(sql,RDDbPool::replica());
+  while(q->next()) {
+    if(!positions.contains(q->value(0).toUInt())) {
+      positions[q->value(0).toUInt()]=q->at();
+    }
+  }
+
+  //
+  // Drop any carts deleted since the keys were loaded
+  //
+  for(int i=count-1;i>=0;i--) {
+    if(!positions.contains(d_keys.at(first+i))) {
+      d_keys.removeAt(first+i);
+      count--;
+    }
+  }
+
+  if(count>0) {
+    if(notify) {
+      beginInsertRows(QModelIndex(),first,first+count-1);
+    }
+    for(int i=first;i<(first+count);i++) {
+      d_texts.push_back(list);
+      d_notes.push_back(QVariant());
+      d_cart_numbers.push_back(0);
+      d_cut_texts.push_back(QList<QList<QVariant> >());
+      d_cut_cutnames.push_back(QStringList());
+      d_cuts_loaded.push_back(false);
+      d_background_colors.push_back(QVariant());
+      d_cart_types.push_back(RDCart::All);
+      d_icons.push_back(list);
+      q->seek(positions.value(d_keys.at(i)));
+      updateRow(i,q);
+    }
+    if(notify) {
+      endInsertRows();
+    }
+  }
+  delete q;
+}
+
+
+void RDLibraryModel::LoadCuts(int row,bool primary)
+{
+  QString sql;
+  RDSqlQuery *q=NULL;
+  QList<QList<QVariant> > texts;
+  QStringList cutnames;
+
+  if(d_cuts_loaded.at(row)) {
+    return;
+  }
+  QList<QVariant> list;
+  for(int i=0;i<columnCount();i++) {
+    list.push_back(QVariant());
+  }
+
+  sql=QString("select ")+
+    "CUT_NAME,"+          // 00
+    "START_POINT,"+       // 01
+    "END_POINT,"+         // 02
+    "TALK_START_POINT,"+  // 03
+    "TALK_END_POINT,"+    // 04
+    "DESCRIPTION "+       // 05
+    "from CUTS where "+
+    "CART_NUMBER=? "+
+    "order by CUT_NAME";
+  if(primary) {
+    q=new RDSqlQuery(sql,QList<QVariant>()<<d_cart_numbers.at(row));
+  }
+  else {
+    q=new RDSqlQuery(sql,QList<QVariant>()<<d_cart_numbers.at(row),
+		     RDDbPool::replica());
+  }
+  while(q->next()) {
+    cutnames.push_back(q->value(0).toString());
+    texts.push_back(list);
+    texts.back()[0]=tr("Cut")+  // Cut Number
+      QString().sprintf(" %03d",RDCut::cutNumber(q->value(0).toString()));
+    texts.back()[2]=  // Length
+      RDGetTimeLength(q->value(2).toUInt()-q->value(1).toUInt());
+    texts.back()[3]=  // Talk Length
+      RDGetTimeLength(q->value(4).toUInt()-q->value(3).toUInt());
+    texts.back()[4]=q->value(5).toString();  // Description
+  }
+  delete q;
+
+  d_cuts_loaded[row]=true;
+  if(texts.size()>0) {
+    beginInsertRows(createIndex(row,0,(quintptr)0),0,texts.size()-1);
+    d_cut_texts[row]=texts;
+    d_cut_cutnames[row]=cutnames;
+    endInsertRows();
+  }
+}
+
+
+void RDLibraryModel::ReloadCuts(int row)
+{
+  if(d_cut_texts.at(row).size()>0) {
+    beginRemoveRows(createIndex(row,0,(quintptr)0),0,
+		    d_cut_texts.at(row).size()-1);
+    d_cut_texts[row].clear();
+    d_cut_cutnames[row].clear();
+    endRemoveRows();
+  }
+  d_cuts_loaded[row]=false;
+  LoadCuts(row,true);
+}
+
+
+void RDLibraryModel::ClearRows()
+{
+  d_keys.clear();
+  d_texts.clear();
+  d_notes.clear();
+  d_cart_numbers.clear();
+  d_cut_texts.clear();
+  d_cut_cutnames.clear();
+  d_cuts_loaded.clear();
+  d_background_colors.clear();
+  d_cart_types.clear();
+  d_icons.clear();
+}
+
+
+QString RDLibraryModel::KeySql() const
+{
+  return QString("select ")+
+    "CART.NUMBER "+  // 00
+    "from CART "+
+    "left join GROUPS on CART.GROUP_NAME=GROUPS.NAME "+
+    "left join CUTS on CART.NUMBER=CUTS.CART_NUMBER "+
+    d_filter_sql+" "+
+    OrderSql()+" "+
+    d_limit_sql;
+}
+
+
+QString RDLibraryModel::OrderSql() const
+{
+  QString dir="asc";
+
+  if(d_sort_column<0) {
+    return d_order_sql;
+  }
+  if(d_sort_order==Qt::DescendingOrder) {
+    dir="desc";
+  }
+  switch(d_sort_column) {
+  case 0:
+    return "order by CART.NUMBER "+dir;
+
+  case 1:
+    return "order by CART.GROUP_NAME "+dir+",CART.NUMBER";
+
+  case 2:
+    return "order by CART.FORCED_LENGTH "+dir+",CART.NUMBER";
+
+  case 3:
+    return "order by CUTS.TALK_END_POINT-CUTS.TALK_START_POINT "+dir+
+      ",CART.NUMBER";
+
+  case 4:
+    return "order by CART.TITLE "+dir+",CART.NUMBER";
+
+  case 5:
+    return "order by CART.ARTIST "+dir+",CART.NUMBER";
+
+  case 6:
+    return "order by CART.START_DATETIME "+dir+",CART.NUMBER";
+
+  case 7:
+    return "order by CART.END_DATETIME "+dir+",CART.NUMBER";
+
+  case 8:
+    return "order by CART.ALBUM "+dir+",CART.NUMBER";
+
+  case 9:
+    return "order by CART.LABEL "+dir+",CART.NUMBER";
+
+  case 10:
+    return "order by CART.COMPOSER "+dir+",CART.NUMBER";
+
+  case 11:
+    return "order by CART.CONDUCTOR "+dir+",CART.NUMBER";
+
+  case 12:
+    return "order by CART.PUBLISHER "+dir+",CART.NUMBER";
+
+  case 13:
+    return "order by CART.CLIENT "+dir+",CART.NUMBER";
+
+  case 14:
+    return "order by CART.AGENCY "+dir+",CART.NUMBER";
+
+  case 15:
+    return "order by CART.USER_DEFINED "+dir+",CART.NUMBER";
+
+  case 16:
+    return "order by CART.CUT_QUANTITY "+dir+",CART.NUMBER";
+
+  case 17:
+    return "order by CART.LAST_CUT_PLAYED "+dir+",CART.NUMBER";
+
+  case 18:
+    return "order by CART.ENFORCE_LENGTH "+dir+",CART.NUMBER";
+
+  case 19:
+    return "order by CART.LENGTH_DEVIATION "+dir+",CART.NUMBER";
+
+  case 20:
+    return "order by CART.OWNER "+dir+",CART.NUMBER";
+  }
+  return d_order_sql;
+}
@@ -27,11 +27,31 @@
 #include <QList>
 #include <QMap>
 #include <QPalette>
+#include <QThread>
 
 #include <rdcart.h>
 #include <rddb.h>
 #include <rdnotification.h>
 
+//
+// Number of carts read each time the view scrolls to the end of the
+// loaded rows
+//
+#define RDLIBRARYMODEL_FETCH_SIZE 200
+
+class __RDLibraryModelLoader;
+
+//
+// RDLibraryModel
+//
+// The carts matching the filter are found by a query made on a worker
+// thread (with a database connection of its own, kept for the life of
+// the model), which returns just their numbers, in order. Their rows are then read in pages of
+// RDLIBRARYMODEL_FETCH_SIZE as the view asks for them with fetchMore(),
+// and the cuts of a cart are read only once its row is expanded.
+// cartRow() and cutRow() load whatever is needed to return the requested
+// row.
+//
 class RDLibraryModel : public QAbstractItemModel
 {
   Q_OBJECT
@@ -47,6 +67,9 @@ class RDLibraryModel : public QAbstractItemModel
   int columnCount(const QModelIndex &parent=QModelIndex()) const;
   int rowCount(const QModelIndex &parent=QModelIndex()) const;
   bool hasChildren(const QModelIndex &parent=QModelIndex()) const;
+  bool canFetchMore(const QModelIndex &parent) const;
+  void fetchMore(const QModelIndex &parent);
+  void sort(int col,Qt::SortOrder order=Qt::AscendingOrder);
   Qt::ItemFlags flags(const QModelIndex &index) const;
   QVariant headerData(int section,Qt::Orientation orient,
 		      int role=Qt::DisplayRole) const;
@@ -73,6 +96,9 @@ class RDLibraryModel : public QAbstractItemModel
   void setShowNotes(int state);
   void setFilterSql(const QString &sql);
 
+ private slots:
+  void loaderFinishedData();
+
  protected:
   void updateModel(const QString &filter_sql);
   void updateCartLine(int cartline);
@@ -81,7 +107,27 @@ class RDLibraryModel : public QAbstractItemModel
 
  private:
   QByteArray DumpIndex(const QModelIndex &index,const QString &caption="") const;
+  void StartLoad();
+  void WaitForLoad();
+  void ApplyLoad(bool wait);
+  void AppendRows(int count,bool notify);
+  void LoadCuts(int row,bool primary=false);
+  void ReloadCuts(int row);
+  void ClearRows();
+  QString KeySql() const;
+  QString OrderSql() const;
   bool d_show_notes;
+  QString d_filter_sql;
+  QString d_order_sql;
+  QString d_limit_sql;
+  bool d_filter_set;
+  int d_sort_column;
+  Qt::SortOrder d_sort_order;
+  __RDLibraryModelLoader *d_loader;
+  unsigned d_load_serial;
+  bool d_load_pending;
+  QList<unsigned> d_keys;
+  QList<bool> d_cuts_loaded;
   QPalette d_palette;
   QFont d_font;
   QFontMetrics *d_font_metrics;
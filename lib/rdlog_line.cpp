@@ -72,6 +72,7 @@ RDLogLine::RDLogLine(unsigned cartnum,int cutnum)
     log_publisher=q->value(9).toString();
     log_user_defined=q->value(10).toString();
     log_cart_notes=q->value(11).toString();
+    log_cart_notes_deferred=false;
   }
   delete q;
 
@@ -165,6 +166,8 @@ void RDLogLine::clear()
   log_outcue="";
   log_description="";
   log_user_defined="";
+  log_cart_notes="";
+  log_cart_notes_deferred=false;
   log_usage_code=RDCart::UsageFeature;
   log_forced_length=0;
   log_cut_quantity=0;
@@ -1102,9 +1105,31 @@ QString RDLogLine::cartNotes() const
 }
 
 
+void RDLogLine::loadCartNotes()
+{
+  if(log_cart_notes_deferred) {
+    log_cart_notes_deferred=false;
+    QString sql=QString("select NOTES from CART where NUMBER=?");
+    RDSqlQuery *q=new RDSqlQuery(sql,QList<QVariant>()<<log_cart_number);
+    if(q->first()) {
+      log_cart_notes=q->value(0).toString();
+    }
+    delete q;
+  }
+}
+
+
 void RDLogLine::setCartNotes(const QString &str)
 {
   log_cart_notes=str;
+  log_cart_notes_deferred=false;
+}
+
+
+void RDLogLine::deferCartNotes()
+{
+  log_cart_notes="";
+  log_cart_notes_deferred=true;
 }
 
 
@@ -2138,6 +2163,7 @@ void RDLogLine::loadCart(int cartnum,int cutnum)
   log_usage_code=(RDCart::UsageCode)q->value(24).toInt();
   log_average_segue_length=q->value(25).toInt();
   log_cart_notes=q->value(26).toString();
+  log_cart_notes_deferred=false;
   log_group_color=QColor(q->value(27).toString());
   log_play_source=RDLogLine::UnknownSource;
   delete q;
@@ -2276,6 +2302,7 @@ void RDLogLine::refreshCart()
       log_start_datetime=q->value(16).toDateTime();
       log_end_datetime=q->value(17).toDateTime();
       log_cart_notes=q->value(18).toString();
+      log_cart_notes_deferred=false;
     }
     delete q;
   }
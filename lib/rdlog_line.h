@@ -166,6 +166,8 @@ class RDLogLine
   void setUserDefined(const QString &string);
   QString cartNotes() const;
   void setCartNotes(const QString &str);
+  void loadCartNotes();
+  void deferCartNotes();
   RDCart::UsageCode usageCode() const;
   void setUsageCode(RDCart::UsageCode code);
   unsigned forcedLength() const;
@@ -330,6 +332,7 @@ class RDLogLine
   QString log_description;
   QString log_user_defined;
   QString log_cart_notes;
+  bool log_cart_notes_deferred;
   RDCart::UsageCode log_usage_code;
   unsigned log_forced_length;
   unsigned log_cut_quantity;
@@ -2,7 +2,7 @@
 //
 // Data model for Rivendell logs
 //
-//   (C) Copyright 2020 Fred Gleason <fredg@paravelsystems.com>
+//   (C) Copyright 2020-2021 Fred Gleason <fredg@paravelsystems.com>
 //
 //   This program is free software; you can redistribute it and/or modify
 //   it under the terms of the GNU General Public License version 2 as
@@ -20,13 +20,59 @@
 
 #include <stdio.h>
 
+#include <QHash>
+
 #include "rdapplication.h"
 #include "rdconf.h"
+#include "rddbpool.h"
 #include "rdescape_string.h"
 #include "rdlog.h"
 #include "rdlog_line.h"
 #include "rdlogmodel.h"
 
+static const char *__rd_log_lines_columns[]={
+  "LOG_NAME",            // 00
+  "LINE_ID",             // 01
+  "COUNT",               // 02
+  "CART_NUMBER",         // 03
+  "START_TIME",          // 04
+  "TIME_TYPE",           // 05
+  "TRANS_TYPE",          // 06
+  "START_POINT",         // 07
+  "END_POINT",           // 08
+  "SEGUE_START_POINT",   // 09
+  "SEGUE_END_POINT",     // 10
+  "TYPE",                // 11
+  "COMMENT",             // 12
+  "LABEL",               // 13
+  "GRACE_TIME",          // 14
+  "SOURCE",              // 15
+  "EXT_START_TIME",      // 16
+  "EXT_LENGTH",          // 17
+  "EXT_DATA",            // 18
+  "EXT_EVENT_ID",        // 19
+  "EXT_ANNC_TYPE",       // 20
+  "EXT_CART_NAME",       // 21
+  "FADEUP_POINT",        // 22
+  "FADEUP_GAIN",         // 23
+  "FADEDOWN_POINT",      // 24
+  "FADEDOWN_GAIN",       // 25
+  "SEGUE_GAIN",          // 26
+  "LINK_EVENT_NAME",     // 27
+  "LINK_START_TIME",     // 28
+  "LINK_LENGTH",         // 29
+  "LINK_ID",             // 30
+  "LINK_EMBEDDED",       // 31
+  "ORIGIN_USER",         // 32
+  "ORIGIN_DATETIME",     // 33
+  "LINK_START_SLOP",     // 34
+  "LINK_END_SLOP",       // 35
+  "DUCK_UP_GAIN",        // 36
+  "DUCK_DOWN_GAIN",      // 37
+  "EVENT_LENGTH",        // 38
+  NULL};
+
+
 RDLogModel::RDLogModel(const QString &logname,bool read_only,QObject *parent)
   : QAbstractTableModel(parent)
 {
@@ -198,6 +244,9 @@ QString RDLogModel::logName() const
 void RDLogModel::setLogName(QString logname)
 {
   RDLog *log=new RDLog(logname);
+  if(log->name()!=d_log_name) {
+    d_saved_valid=false;
+  }
   d_log_name=log->name();  // So we normalize the case
   delete log;
 }
@@ -233,6 +282,7 @@ int RDLogModel::load(bool track_ptrs)
   delete log;
 
   LoadLines(d_log_name,0,track_ptrs);
+  SetSavedState();
 
   endResetModel();
 
@@ -241,56 +291,51 @@ int RDLogModel::load(bool track_ptrs)
 
 void RDLogModel::saveModified(RDConfig *config,bool update_tracks)
 {
+  if(d_log_name.isEmpty()) {
+    return;
+  }
+  if(d_saved_valid) {
+    save(config,update_tracks);  // Writes only the changed lines anyway
+    return;
+  }
   for(int i=0;i<d_log_lines.size();i++) {
     if(d_log_lines[i]->hasBeenModified()) {
-      save(config,update_tracks, i);
+      SaveLine(i);
+      d_log_lines[i]->clearModified();
     }
   }
+  UpdateLog(update_tracks);
 }
 
 void RDLogModel::save(RDConfig *config,bool update_tracks,int line)
 {
-  QString sql;
-  RDSqlQuery *q;
+  int id=-1;
 
   if(d_log_name.isEmpty()) {
     return;
   }
   if(line<0) {
-    if(exists()) {
-      sql=QString("delete from LOG_LINES where ")+
-	"LOG_NAME=\""+RDEscapeString(d_log_name)+"\"";
-      RDSqlQuery::apply(sql);
-    }
-    if (d_log_lines.size() > 0) {
-       QString values = "";
-       for(int i=0;i<d_log_lines.size();i++) {
-         InsertLineValues(&values, i);
-        if (i<d_log_lines.size()-1) {
-           values += ",";
-         }
-       }
-       InsertLines(values);
+    if(!SaveChanges()) {
+      SaveAll();
+    }
+    SetSavedState();
+    for(int i=0;i<d_log_lines.size();i++) {
+      d_log_lines[i]->clearModified();
     }
   }
   else {
-    sql=QString("delete from LOG_LINES where ")+
-      "LOG_NAME=\""+RDEscapeString(d_log_name)+"\" && "+
-      QString().sprintf("COUNT=%d",line);
-    q=new RDSqlQuery(sql);
-    delete q;
     SaveLine(line);
     // BPM - Clear the modified flag
     d_log_lines[line]->clearModified();
+    id=d_log_lines[line]->id();
+    if(d_saved_valid&&(d_saved_counts.value(id,-1)==line)) {
+      d_saved_values[id]=LineValues(line,0);
+    }
+    else {
+      d_saved_valid=false;
+    }
   }
-  RDLog *log=new RDLog(d_log_name);
-  if(log->nextId()<nextId()) {
-    log->setNextId(nextId());
-  }
-  if(update_tracks) {
-    log->updateTracks();
-  }
-  delete log;
+  UpdateLog(update_tracks);
 }
 
 
@@ -310,8 +355,11 @@ void RDLogModel::clear()
     d_log_lines.clear();
     endRemoveRows();
   }
+  d_id_index.clear();
+  d_id_index_valid=0;
   d_log_name="";
   d_max_id=0;
+  d_saved_valid=false;
 }
 
 
@@ -518,12 +566,14 @@ void RDLogModel::insert(int line,int num_lines,bool preserve_trans)
     }
   }
   if(line<lineCount()) {
+    InvalidateIdIndex(line);
     beginInsertRows(QModelIndex(),line,line+num_lines-1);
     for(int i=0;i<num_lines;i++) {
       d_log_lines.insert(line+i,new RDLogLine());
       d_log_lines[line+i]->setId(++d_max_id);
     }
     endInsertRows();
+    CheckIdIndex("insert");
     return;
   }
   if(line>=lineCount()) {
@@ -533,6 +583,7 @@ void RDLogModel::insert(int line,int num_lines,bool preserve_trans)
       d_log_lines.back()->setId(++d_max_id);
     }
     endInsertRows();
+    CheckIdIndex("insert");
     return;
   }
 }
@@ -553,12 +604,14 @@ void RDLogModel::remove(int line,int num_lines,bool preserve_trans)
       emitDataChanged(line+num_lines);
     }
   }  
+  InvalidateIdIndex(line);
   beginRemoveRows(QModelIndex(),line,line+num_lines-1);
   for(int i=0;i<num_lines;i++) {
     delete d_log_lines.at(line);
     d_log_lines.removeAt(line);
   }
   endRemoveRows();
+  CheckIdIndex("remove");
 }
 
 
@@ -587,6 +640,7 @@ void RDLogModel::move(int from_line,int to_line)
   *destline=*srcline;
   destline->clearTrackData(RDLogLine::AllTrans);
   remove(from_line+src_offset,1);
+  CheckIdIndex("move");
 }
 
 
@@ -594,6 +648,7 @@ void RDLogModel::copy(int from_line,int to_line)
 {
   RDLogLine *srcline;
   RDLogLine *destline;
+  int id=-1;
 
   insert(to_line,1);
   if(((destline=logLine(to_line))==NULL)||
@@ -601,10 +656,13 @@ void RDLogModel::copy(int from_line,int to_line)
     remove(to_line,1);
     return;
   }
+  id=destline->id();  // The copy is a new line
   *destline=*srcline;
+  destline->setId(id);
   destline->clearExternalData();
   destline->clearTrackData(RDLogLine::AllTrans);
   destline->setSource(RDLogLine::Manual);
+  CheckIdIndex("copy");
 }
 
 
@@ -798,11 +856,31 @@ RDLogLine *RDLogModel::loglineById(int id, bool ignore_holdovers) const
 
 int RDLogModel::lineById(int id, bool ignore_holdovers) const
 {
-  for(int i=0;i<lineCount();i++) {
-    if(ignore_holdovers && d_log_lines[i]->isHoldover()) {
-      continue;
-    }    
-    if(d_log_lines[i]->id()==id) {
+  UpdateIdIndex();
+  int line=d_id_index.value(id,-1);
+  if((line<0)||(line>=lineCount())||(d_log_lines.at(line)->id()!=id)) {
+    //
+    // Not indexed, or the ID was changed in place with RDLogLine::setId()
+    //
+    for(line=0;line<lineCount();line++) {
+      if(d_log_lines.at(line)->id()==id) {
+	break;
+      }
+    }
+    if(line==lineCount()) {
+      return -1;
+    }
+    d_id_index[id]=line;
+  }
+  if(!ignore_holdovers) {
+    return line;
+  }
+
+  //
+  // Holdovers share the ID of the line they were carried over for
+  //
+  for(int i=line;i<lineCount();i++) {
+    if((d_log_lines.at(i)->id()==id)&&(!d_log_lines.at(i)->isHoldover())) {
       return i;
     }
   }
@@ -810,6 +888,31 @@ int RDLogModel::lineById(int id, bool ignore_holdovers) const
 }
 
 
+bool RDLogModel::checkIdIndex(QString *err_msg) const
+{
+  QHash<int,int> first_lines;
+
+  for(int i=d_id_index_valid-1;i>=0;i--) {
+    first_lines[d_log_lines.at(i)->id()]=i;
+  }
+  for(QHash<int,int>::const_iterator it=first_lines.constBegin();
+      it!=first_lines.constEnd();it++) {
+    if(d_id_index.value(it.key(),-1)!=it.value()) {
+      if(err_msg!=NULL) {
+	*err_msg=QString().sprintf("line ID %d indexed at line %d, ",
+				   it.key(),d_id_index.value(it.key(),-1))+
+	  QString().sprintf("found at line %d",it.value());
+      }
+      return false;
+    }
+  }
+  if(err_msg!=NULL) {
+    *err_msg="OK";
+  }
+  return true;
+}
+
+
 int RDLogModel::lineByStartHour(int hour,RDLogLine::StartTimeType type) const
 {
   for(int i=0;i<lineCount();i++) {
@@ -1009,8 +1112,7 @@ QString RDLogModel::StartTimeString(int line) const
 
 int RDLogModel::LoadLines(const QString &logname,int id_offset,bool track_ptrs)
 {
-  RDLogLine line;
-  RDSqlQuery *q1;
+  RDLogLine *line=NULL;
   QString sql;
   RDSqlQuery *q;
   bool prev_custom=false;
@@ -1018,19 +1120,29 @@ int RDLogModel::LoadLines(const QString &logname,int id_offset,bool track_ptrs)
   unsigned start_line=d_log_lines.size();
 
   //
-  // Load the group color table
+  // Load the group color and now & next tables
   //
-  std::map<QString,QColor> group_colors;
-  sql="select NAME,COLOR from GROUPS";
+  QHash<QString,QColor> group_colors;
+  QHash<QString,bool> group_now_nexts;
+  sql=QString("select ")+
+    "NAME,"+             // 00
+    "COLOR,"+            // 01
+    "ENABLE_NOW_NEXT "+  // 02
+    "from GROUPS";
   q=new RDSqlQuery(sql);
   while(q->next()) {
     group_colors[q->value(0).toString()]=QColor(q->value(1).toString());
+    group_now_nexts[q->value(0).toString()]=RDBool(q->value(2).toString());
   }
   delete q;
 
   //
   // Load log lines
   //
+  // Each column is read once, and tests for NULL use isNull()
+  // rather than constructing the value. The cart notes, seldom needed,
+  // are left to be read by RDLogLine::loadCartNotes().
+  //
   sql=QString("select ")+
     "LOG_LINES.LINE_ID,"+            // 00
     "LOG_LINES.CART_NUMBER,"+        // 01
@@ -1096,174 +1208,184 @@ int RDLogModel::LoadLines(const QString &logname,int id_offset,bool track_ptrs)
     "CART.END_DATETIME,"+            // 61
     "LOG_LINES.EVENT_LENGTH,"+       // 62
     "CART.USE_EVENT_LENGTH,"+        // 63
-    "CART.NOTES	"+                   // 64
+    "LOGS.DESCRIPTION "+             // 64
     "from LOG_LINES left join CART "+
-    "on LOG_LINES.CART_NUMBER=CART.NUMBER where "+
-    "LOG_LINES.LOG_NAME=\""+RDEscapeString(logname)+"\" "+
+    "on LOG_LINES.CART_NUMBER=CART.NUMBER "+
+    "left join LOGS on "+
+    QString().sprintf("(LOG_LINES.TYPE=%d)&&",RDLogLine::Chain)+
+    "(LOGS.NAME=LOG_LINES.LABEL) where "+
+    "LOG_LINES.LOG_NAME=? "+
     "order by COUNT";
-   q=new RDSqlQuery(sql);
+  q=new RDSqlQuery(sql,QList<QVariant>()<<logname);
   if(q->size()<=0) {
     delete q;
     return 0;
   }
-  for(int i=0;i<q->size();i++) {
+  d_log_lines.reserve(start_line+q->size());
+  while(q->next()) {
+    int line_id=q->value(0).toInt()+id_offset;
+    QTime start_time=QTime().addMSecs(q->value(2).toInt());
+    int start_point=q->value(5).toInt();
+    int end_point=q->value(6).toInt();
+    int segue_start_point=q->value(7).toInt();
+    int segue_end_point=q->value(8).toInt();
+    QString group_name=q->value(10).toString();
+    int fadeup_point=q->value(39).toInt();
+    int fadedown_point=q->value(41).toInt();
+
     lines++;
-    line.clear();
-    q->next();
-    line.setType((RDLogLine::Type)q->value(27).toInt());       // Type
-    line.setId(q->value(0).toInt()+id_offset);                 // Log Line ID
-    if((q->value(0).toInt()+id_offset)>d_max_id) {
-      d_max_id=q->value(0).toInt()+id_offset;
-    }
-    line.setStartTime(RDLogLine::Imported,
-		      QTime().addMSecs(q->value(2).toInt())); // Start Time
-    line.setStartTime(RDLogLine::Logged,
-		      QTime().addMSecs(q->value(2).toInt()));
-    line.
+    line=new RDLogLine();
+    line->setType((RDLogLine::Type)q->value(27).toInt());       // Type
+    line->setId(line_id);                                       // Log Line ID
+    if(line_id>d_max_id) {
+      d_max_id=line_id;
+    }
+    line->setStartTime(RDLogLine::Imported,start_time);         // Start Time
+    line->setStartTime(RDLogLine::Logged,start_time);
+    line->
       setTimeType((RDLogLine::TimeType)q->value(3).toInt());   // Time Type
-    line.
+    line->
       setTransType((RDLogLine::TransType)q->value(4).toInt()); // Trans Type
-    line.setMarkerComment(q->value(28).toString());            // Comment
-    line.setMarkerLabel(q->value(29).toString());              // Label
-    line.setGraceTime(q->value(30).toInt());                   // Grace Time
-    line.setUseEventLength(RDBool(q->value(63).toString())); // Use Event Length
-    line.setEventLength(q->value(62).toInt());                 // Event Length
-    line.setSource((RDLogLine::Source)q->value(31).toUInt());
-    line.setLinkEventName(q->value(48).toString());           // Link Event Name
-    line.setLinkStartTime(QTime().addMSecs(q->value(49).toInt())); // Link Start Time
-    line.setLinkLength(q->value(50).toInt());               // Link Length
-    line.setLinkStartSlop(q->value(56).toInt());            // Link Start Slop
-    line.setLinkEndSlop(q->value(57).toInt());              // Link End Slop
-    line.setLinkId(q->value(51).toInt());                   // Link ID
-    line.setLinkEmbedded(RDBool(q->value(52).toString()));  // Link Embedded
-    line.setOriginUser(q->value(53).toString());            // Origin User
-    line.setOriginDateTime(q->value(54).toDateTime());      // Origin DateTime
-    switch(line.type()) {
+    line->setMarkerComment(q->value(28).toString());            // Comment
+    line->setMarkerLabel(q->value(29).toString());              // Label
+    line->setGraceTime(q->value(30).toInt());                   // Grace Time
+    line->setUseEventLength(RDBool(q->value(63).toString())); // Use Evt Length
+    line->setEventLength(q->value(62).toInt());                 // Event Length
+    line->setSource((RDLogLine::Source)q->value(31).toUInt());
+    line->setLinkEventName(q->value(48).toString());        // Link Event Name
+    line->setLinkStartTime(QTime().addMSecs(q->value(49).toInt()));
+    line->setLinkLength(q->value(50).toInt());               // Link Length
+    line->setLinkStartSlop(q->value(56).toInt());            // Link Start Slop
+    line->setLinkEndSlop(q->value(57).toInt());              // Link End Slop
+    line->setLinkId(q->value(51).toInt());                   // Link ID
+    line->setLinkEmbedded(RDBool(q->value(52).toString()));  // Link Embedded
+    line->setOriginUser(q->value(53).toString());            // Origin User
+    line->setOriginDateTime(q->value(54).toDateTime());      // Origin DateTime
+    switch(line->type()) {
     case RDLogLine::Cart:
-      line.setCartNumber(q->value(1).toUInt());          // Cart Number
-      line.setStartPoint(q->value(5).toInt(),RDLogLine::LogPointer);
-      line.setEndPoint(q->value(6).toInt(),RDLogLine::LogPointer);
-      line.setSegueStartPoint(q->value(7).toInt(),RDLogLine::LogPointer);
-      line.setSegueEndPoint(q->value(8).toInt(),RDLogLine::LogPointer);
-      line.setCartType((RDCart::Type)q->value(9).toInt());  // Cart Type
-      line.setGroupName(q->value(10).toString());       // Group Name
-      line.setGroupColor(group_colors[q->value(10).toString()]);
-      line.setTitle(q->value(11).toString());           // Title
-      line.setArtist(q->value(12).toString());          // Artist
-      line.setPublisher(q->value(44).toString());       // Publisher
-      line.setComposer(q->value(45).toString());        // Composer
-      line.setAlbum(q->value(13).toString());           // Album
-      line.setYear(q->value(14).toDate());              // Year
-      line.setLabel(q->value(15).toString());           // Label
-      line.setClient(q->value(16).toString());          // Client
-      line.setAgency(q->value(17).toString());          // Agency
-      line.setUserDefined(q->value(18).toString());     // User Defined
-      line.setCartNotes(q->value(64).toString());       // Cart Notes
-      line.setConductor(q->value(19).toString());       // Conductor
-      line.setSongId(q->value(20).toString());          // Song ID
-      line.setUsageCode((RDCart::UsageCode)q->value(46).toInt());
-      line.setForcedLength(q->value(21).toUInt());      // Forced Length
-      if(q->value(7).toInt()<0) {
-	line.setAverageSegueLength(q->value(47).toInt());
+      line->setCartNumber(q->value(1).toUInt());          // Cart Number
+      line->setStartPoint(start_point,RDLogLine::LogPointer);
+      line->setEndPoint(end_point,RDLogLine::LogPointer);
+      line->setSegueStartPoint(segue_start_point,RDLogLine::LogPointer);
+      line->setSegueEndPoint(segue_end_point,RDLogLine::LogPointer);
+      line->setCartType((RDCart::Type)q->value(9).toInt());  // Cart Type
+      line->setGroupName(group_name);                    // Group Name
+      line->setGroupColor(group_colors.value(group_name));
+      line->setTitle(q->value(11).toString());           // Title
+      line->setArtist(q->value(12).toString());          // Artist
+      line->setPublisher(q->value(44).toString());       // Publisher
+      line->setComposer(q->value(45).toString());        // Composer
+      line->setAlbum(q->value(13).toString());           // Album
+      line->setYear(q->value(14).toDate());              // Year
+      line->setLabel(q->value(15).toString());           // Label
+      line->setClient(q->value(16).toString());          // Client
+      line->setAgency(q->value(17).toString());          // Agency
+      line->setUserDefined(q->value(18).toString());     // User Defined
+      line->deferCartNotes();                            // Cart Notes
+      line->setConductor(q->value(19).toString());       // Conductor
+      line->setSongId(q->value(20).toString());          // Song ID
+      line->setUsageCode((RDCart::UsageCode)q->value(46).toInt());
+      line->setForcedLength(q->value(21).toUInt());      // Forced Length
+      if(segue_start_point<0) {
+	line->setAverageSegueLength(q->value(47).toInt());
       }
       else {
-	line.
-	  setAverageSegueLength(q->value(7).toInt()-q->value(5).toInt());
+	line->setAverageSegueLength(segue_start_point-start_point);
       }
-      line.setCutQuantity(q->value(22).toUInt());       // Cut Quantity
-      line.setLastCutPlayed(q->value(23).toUInt());     // Last Cut Played
-      line.
+      line->setCutQuantity(q->value(22).toUInt());       // Cut Quantity
+      line->setLastCutPlayed(q->value(23).toUInt());     // Last Cut Played
+      line->
 	setPlayOrder((RDCart::PlayOrder)q->value(24).toUInt()); // Play Ord
-      line.
+      line->
 	setEnforceLength(RDBool(q->value(25).toString())); // Enforce Length
-      line.
+      line->
 	setPreservePitch(RDBool(q->value(26).toString())); // Preserve Pitch
-      if(!q->value(32).isNull()) {                      // Ext Start Time
-	line.setExtStartTime(q->value(32).toTime());
+      if(!q->isNull(32)) {                              // Ext Start Time
+	line->setExtStartTime(q->value(32).toTime());
       }
-      if(!q->value(33).isNull()) {                      // Ext Length
-	line.setExtLength(q->value(33).toInt());
+      if(!q->isNull(33)) {                              // Ext Length
+	line->setExtLength(q->value(33).toInt());
       }
-      if(!q->value(34).isNull()) {                      // Ext Data
-	line.setExtData(q->value(34).toString());
+      if(!q->isNull(34)) {                              // Ext Data
+	line->setExtData(q->value(34).toString());
       }
-      if(!q->value(35).isNull()) {                      // Ext Event ID
-	line.setExtEventId(q->value(35).toString());
+      if(!q->isNull(35)) {                              // Ext Event ID
+	line->setExtEventId(q->value(35).toString());
       }
-      if(!q->value(36).isNull()) {                      // Ext Annc. Type
-	line.setExtAnncType(q->value(36).toString());
+      if(!q->isNull(36)) {                              // Ext Annc. Type
+	line->setExtAnncType(q->value(36).toString());
       }
-      if(!q->value(37).isNull()) {                      // Ext Cart Name
-	line.setExtCartName(q->value(37).toString());
+      if(!q->isNull(37)) {                              // Ext Cart Name
+	line->setExtCartName(q->value(37).toString());
       }
-      if(!q->value(39).isNull()) {                      // FadeUp Point
-	line.setFadeupPoint(q->value(39).toInt(),RDLogLine::LogPointer);
+      if(!q->isNull(39)) {                              // FadeUp Point
+	line->setFadeupPoint(fadeup_point,RDLogLine::LogPointer);
       }
-      if(!q->value(40).isNull()) {                      // FadeUp Gain
-	line.setFadeupGain(q->value(40).toInt());
+      if(!q->isNull(40)) {                              // FadeUp Gain
+	line->setFadeupGain(q->value(40).toInt());
       }
-      if(!q->value(41).isNull()) {                      // FadeDown Point
-	line.setFadedownPoint(q->value(41).toInt(),RDLogLine::LogPointer);
+      if(!q->isNull(41)) {                              // FadeDown Point
+	line->setFadedownPoint(fadedown_point,RDLogLine::LogPointer);
       }
-      if(!q->value(42).isNull()) {                      // FadeDown Gain
-	line.setFadedownGain(q->value(42).toInt());
+      if(!q->isNull(42)) {                              // FadeDown Gain
+	line->setFadedownGain(q->value(42).toInt());
       }
-      if(!q->value(43).isNull()) {                      // Segue Gain
-	line.setSegueGain(q->value(43).toInt());
+      if(!q->isNull(43)) {                              // Segue Gain
+	line->setSegueGain(q->value(43).toInt());
       }
-      if(!q->value(58).isNull()) {                      // Duck Up Gain
-	line.setDuckUpGain(q->value(58).toInt());
+      if(!q->isNull(58)) {                              // Duck Up Gain
+	line->setDuckUpGain(q->value(58).toInt());
       }
-      if(!q->value(59).isNull()) {                      // Duck Down Gain
-	line.setDuckDownGain(q->value(59).toInt());
+      if(!q->isNull(59)) {                              // Duck Down Gain
+	line->setDuckDownGain(q->value(59).toInt());
       }
-      if(!q->value(60).isNull()) {                      // Start Datetime
-	line.setStartDatetime(q->value(60).toDateTime());
+      if(!q->isNull(60)) {                              // Start Datetime
+	line->setStartDatetime(q->value(60).toDateTime());
       }
-      if(!q->value(61).isNull()) {                      // End Datetime
-	line.setEndDatetime(q->value(61).toDateTime());
+      if(!q->isNull(61)) {                              // End Datetime
+	line->setEndDatetime(q->value(61).toDateTime());
       }
-      line.setValidity((RDCart::Validity)q->value(55).toInt()); // Validity
+      line->setValidity((RDCart::Validity)q->value(55).toInt()); // Validity
       break;
 
     case RDLogLine::Macro:
-      line.setCartNumber(q->value(1).toUInt());          // Cart Number
-      line.setCartType((RDCart::Type)q->value(9).toInt());  // Cart Type
-      line.setGroupName(q->value(10).toString());       // Group Name
-      line.setGroupColor(group_colors[q->value(10).toString()]);
-      line.setTitle(q->value(11).toString());           // Title
-      line.setArtist(q->value(12).toString());          // Artist
-      line.setPublisher(q->value(44).toString());       // Publisher
-      line.setComposer(q->value(45).toString());        // Composer
-      line.setAlbum(q->value(13).toString());           // Album
-      line.setYear(q->value(14).toDate());              // Year
-      line.setLabel(q->value(15).toString());           // Label
-      line.setClient(q->value(16).toString());          // Client
-      line.setAgency(q->value(17).toString());          // Agency
-      line.setUserDefined(q->value(18).toString());     // User Defined
-      line.setCartNotes(q->value(64).toString());       // Cart Notes
-      line.setForcedLength(q->value(21).toUInt());      // Forced Length
-      line.setAverageSegueLength(q->value(21).toInt());
-      if(!q->value(32).isNull()) {                      // Ext Start Time
-	line.setExtStartTime(q->value(32).toTime());
+      line->setCartNumber(q->value(1).toUInt());          // Cart Number
+      line->setCartType((RDCart::Type)q->value(9).toInt());  // Cart Type
+      line->setGroupName(group_name);                    // Group Name
+      line->setGroupColor(group_colors.value(group_name));
+      line->setTitle(q->value(11).toString());           // Title
+      line->setArtist(q->value(12).toString());          // Artist
+      line->setPublisher(q->value(44).toString());       // Publisher
+      line->setComposer(q->value(45).toString());        // Composer
+      line->setAlbum(q->value(13).toString());           // Album
+      line->setYear(q->value(14).toDate());              // Year
+      line->setLabel(q->value(15).toString());           // Label
+      line->setClient(q->value(16).toString());          // Client
+      line->setAgency(q->value(17).toString());          // Agency
+      line->setUserDefined(q->value(18).toString());     // User Defined
+      line->deferCartNotes();                            // Cart Notes
+      line->setForcedLength(q->value(21).toUInt());      // Forced Length
+      line->setAverageSegueLength(q->value(21).toInt());
+      if(!q->isNull(32)) {                              // Ext Start Time
+	line->setExtStartTime(q->value(32).toTime());
       }
-      if(!q->value(33).isNull()) {                      // Ext Length
-	line.setExtLength(q->value(33).toInt());
+      if(!q->isNull(33)) {                              // Ext Length
+	line->setExtLength(q->value(33).toInt());
       }
-      if(!q->value(34).isNull()) {                      // Ext Data
-	line.setExtData(q->value(34).toString());
+      if(!q->isNull(34)) {                              // Ext Data
+	line->setExtData(q->value(34).toString());
       }
-      if(!q->value(35).isNull()) {                      // Ext Event ID
-	line.setExtEventId(q->value(35).toString());
+      if(!q->isNull(35)) {                              // Ext Event ID
+	line->setExtEventId(q->value(35).toString());
       }
-      if(!q->value(36).isNull()) {                      // Ext Annc. Type
-	line.setExtAnncType(q->value(36).toString());
+      if(!q->isNull(36)) {                              // Ext Annc. Type
+	line->setExtAnncType(q->value(36).toString());
       }
-      if(!q->value(37).isNull()) {                      // Ext Cart Name
-	line.setExtCartName(q->value(37).toString());
+      if(!q->isNull(37)) {                              // Ext Cart Name
+	line->setExtCartName(q->value(37).toString());
       }
-      if(!q->value(38).isNull()) {                      // Asyncronous
-	line.setAsyncronous(RDBool(q->value(38).toString()));
+      if(!q->isNull(38)) {                              // Asyncronous
+	line->setAsyncronous(RDBool(q->value(38).toString()));
       }
       break;
 
@@ -1274,34 +1396,32 @@ int RDLogModel::LoadLines(const QString &logname,int id_offset,bool track_ptrs)
       break;
 
     case RDLogLine::Chain:
-      sql=QString("select DESCRIPTION from LOGS where ")+
-	"NAME=\""+RDEscapeString(line.markerLabel())+"\"";
-      q1=new RDSqlQuery(sql);
-      if(q1->first()) {
-	line.setMarkerComment(q1->value(0).toString());
+      if(!q->isNull(64)) {                              // Log Description
+	line->setMarkerComment(q->value(64).toString());
       }
-      delete q1;
       break;
 
     default:
       break;
     }
+    if(group_now_nexts.contains(line->groupName())) {
+      line->setNowNextEnabled(group_now_nexts.value(line->groupName()));
+    }
 
-    line.setHasCustomTransition(prev_custom||(q->value(5).toInt()>=0)||\
-				(q->value(39).toInt()>=0));
-    if(line.type()==RDLogLine::Cart) {
-      prev_custom=(q->value(6).toInt()>=0)||(q->value(7).toInt()>=0)||
-	(q->value(8).toInt()>=0)||(q->value(41).toInt()>=0);
+    line->setHasCustomTransition(prev_custom||(start_point>=0)||
+				 (fadeup_point>=0));
+    if(line->type()==RDLogLine::Cart) {
+      prev_custom=(end_point>=0)||(segue_start_point>=0)||
+	(segue_end_point>=0)||(fadedown_point>=0);
     }
     else {
       prev_custom=false;
     }
-    line.clearModified();
-    d_log_lines.push_back(new RDLogLine(line));
+    line->clearModified();
+    d_log_lines.push_back(line);
   }
   delete q;
-
-  LoadNowNext(start_line);
+  CheckIdIndex("load");
 
   if(track_ptrs) {
     //
@@ -1326,9 +1446,9 @@ int RDLogModel::LoadLines(const QString &logname,int id_offset,bool track_ptrs)
 	  "ORIGIN_NAME,"+        // 11
 	  "ORIGIN_DATETIME "+    // 12
 	  "from CUTS where "+
-	  QString().sprintf("CART_NUMBER=%u ",ll->cartNumber())+
+	  "CART_NUMBER=? "+
 	  "order by CUT_NAME";
-	q=new RDSqlQuery(sql);
+	q=new RDSqlQuery(sql,QList<QVariant>()<<ll->cartNumber());
 	if(q->first()) {
 	  ll->setStartPoint(q->value(0).toInt(),RDLogLine::CartPointer);
 	  ll->setEndPoint(q->value(1).toInt(),RDLogLine::CartPointer);
@@ -1353,64 +1473,44 @@ int RDLogModel::LoadLines(const QString &logname,int id_offset,bool track_ptrs)
 }
 
 
-void RDLogModel::InsertLines(QString values) {
+bool RDLogModel::InsertLines(QString values,bool upsert)
+{
   QString sql;
-  RDSqlQuery *q;
 
-  sql = QString("insert into LOG_LINES (")+
-    "LOG_NAME,"+           // 00
-    "LINE_ID,"+            // 01
-    "COUNT,"+              // 02
-    "CART_NUMBER,"+        // 03
-    "START_TIME,"+         // 04
-    "TIME_TYPE,"+          // 05
-    "TRANS_TYPE,"+         // 06
-    "START_POINT,"+        // 07
-    "END_POINT,"+          // 08
-    "SEGUE_START_POINT,"+  // 09
-    "SEGUE_END_POINT,"+    // 10
-    "TYPE,"+               // 11
-    "COMMENT,"+            // 12
-    "LABEL,"+              // 13
-    "GRACE_TIME,"+         // 14
-    "SOURCE,"+             // 15
-    "EXT_START_TIME,"+     // 16
-    "EXT_LENGTH,"+         // 17
-    "EXT_DATA,"+           // 18
-    "EXT_EVENT_ID,"+       // 19
-    "EXT_ANNC_TYPE,"+      // 20
-    "EXT_CART_NAME,"+      // 21
-    "FADEUP_POINT,"+       // 22
-    "FADEUP_GAIN,"+        // 23
-    "FADEDOWN_POINT,"+     // 24
-    "FADEDOWN_GAIN,"+      // 25
-    "SEGUE_GAIN,"+         // 26
-    "LINK_EVENT_NAME,"+    // 27
-    "LINK_START_TIME,"+    // 28
-    "LINK_LENGTH,"+        // 29
-    "LINK_ID,"+            // 30
-    "LINK_EMBEDDED,"+      // 31
-    "ORIGIN_USER,"+        // 32
-    "ORIGIN_DATETIME,"+    // 33
-    "LINK_START_SLOP,"+    // 34
-    "LINK_END_SLOP,"+      // 35
-    "DUCK_UP_GAIN,"+       // 36
-    "DUCK_DOWN_GAIN,"+     // 37
-    "EVENT_LENGTH) "+      // 38
-    "values "+values;
-  q=new RDSqlQuery(sql);
-  delete q;
+  sql="insert into LOG_LINES (";
+  for(int i=0;__rd_log_lines_columns[i]!=NULL;i++) {
+    sql+=QString(__rd_log_lines_columns[i])+",";
+  }
+  sql=sql.left(sql.length()-1)+") values "+values;
+  if(upsert) {
+    sql+=" on duplicate key update ";
+    for(int i=0;__rd_log_lines_columns[i]!=NULL;i++) {
+      sql+=QString(__rd_log_lines_columns[i])+"=values("+
+	__rd_log_lines_columns[i]+"),";
+    }
+    sql=sql.left(sql.length()-1);
+  }
+  if(upsert) {
+    return ApplyLines(sql);  // Part of SaveChanges()
+  }
+  return RDSqlQuery::apply(sql);
 }
 
 
 void RDLogModel::InsertLineValues(QString *query, int line)
+{
+  *query+=LineValues(line,line);
+}
+
+
+QString RDLogModel::LineValues(int line,int count) const
 {
   // one line to save query space
   RDLogLine *ll=d_log_lines[line];
-  QString sql=QString("(")+
+  return QString("(")+
     "\""+RDEscapeString(d_log_name)+"\","+
     QString().sprintf("%d,",ll->id())+
-    QString().sprintf("%d,",line)+
+    QString().sprintf("%d,",count)+
     QString().sprintf("%u,",ll->cartNumber())+
     QString().sprintf("%d,",QTime().msecsTo(ll->startTime(RDLogLine::Logged)))+
     QString().sprintf("%d,",ll->timeType())+
@@ -1447,38 +1547,264 @@ void RDLogModel::InsertLineValues(QString *query, int line)
     QString().sprintf("%d,",ll->duckUpGain())+
     QString().sprintf("%d,",ll->duckDownGain())+
     QString().sprintf("%d)",ll->eventLength());
-  *query += sql;
 }
 
 void RDLogModel::SaveLine(int line)
 {
+  QString sql;
   QString values = "";
+
+  sql=QString("delete from LOG_LINES where ")+
+    "LOG_NAME=\""+RDEscapeString(d_log_name)+"\" && "+
+    QString().sprintf("COUNT=%d",line);
+  RDSqlQuery::apply(sql);
   InsertLineValues(&values, line);
   InsertLines(values);
 }
 
 
-void RDLogModel::LoadNowNext(unsigned from_line)
+//
+// LOG_LINES is created with the engine given in rd.conf(5), which is
+// MyISAM by default, and transactions and 'for update' are silently
+// ignored there. Whether the table supports them is checked once.
+//
+static int __rd_logmodel_lines_transactional=-1;
+
+static bool __RDLogModelLinesTransactional()
 {
-  QStringList groups;
-  QList<bool> now_nexts;
+  QString sql;
+  RDSqlQuery *q=NULL;
+
+  if(__rd_logmodel_lines_transactional<0) {
+    sql=QString("select ENGINE from information_schema.TABLES where ")+
+      "(TABLE_SCHEMA=database())&&(TABLE_NAME=\"LOG_LINES\")";
+    q=new RDSqlQuery(sql);
+    if(q->first()) {
+      __rd_logmodel_lines_transactional=
+	q->value(0).toString().compare("InnoDB",Qt::CaseInsensitive)==0;
+    }
+    else {
+      __rd_logmodel_lines_transactional=0;
+    }
+    delete q;
+  }
+  return __rd_logmodel_lines_transactional;
+}
+
 
+bool RDLogModel::SaveChanges()
+{
   //
-  // Load the Lookup Table
+  // Write the differences from the last load or save as one transaction:
+  // deletes for removed lines, COUNT renumbering for moved ones and
+  // upserts for new and modified ones. Where LOG_LINES doesn't support
+  // transactions the table is write locked instead, which keeps other
+  // editors out between the check and the writes, though a save that
+  // fails part way is then left to SaveAll() to put right.
   //
-  RDSqlQuery *q=new RDSqlQuery("select NAME,ENABLE_NOW_NEXT from GROUPS");
-  while(q->next()) {
-    groups.push_back(QString(q->value(0).toString()));
-    now_nexts.push_back(RDBool(q->value(1).toString()));
+  QSqlDatabase db=RDDbPool::database();
+  QMap<int,int> counts;
+  QList<int> deleted;
+  QList<int> moved;
+  QList<int> changed;
+  QString where;
+  QString sql;
+  QString values;
+  bool trans=false;
+  bool locked=false;
+  bool ok=true;
+
+  if(!d_saved_valid) {
+    return false;
+  }
+  for(int i=0;i<d_log_lines.size();i++) {
+    int id=d_log_lines.at(i)->id();
+    if(counts.contains(id)) {
+      return false;  // Duplicate line IDs, so rewrite the lot
+    }
+    counts[id]=i;
+    if(!d_saved_counts.contains(id)) {
+      changed.push_back(i);
+      continue;
+    }
+    if(d_saved_counts.value(id)!=i) {
+      moved.push_back(id);
+    }
+    if(LineValues(i,0)!=d_saved_values.value(id)) {
+      changed.push_back(i);
+    }
+  }
+  for(QMap<int,int>::const_iterator ci=d_saved_counts.begin();
+      ci!=d_saved_counts.end();ci++) {
+    if(!counts.contains(ci.key())) {
+      deleted.push_back(ci.key());
+    }
+  }
+  if(deleted.isEmpty()&&moved.isEmpty()&&changed.isEmpty()) {
+    return true;
+  }
+
+  where=QString(" where LOG_NAME=\"")+RDEscapeString(d_log_name)+"\"&&"+
+    "LINE_ID in (";
+  if(__RDLogModelLinesTransactional()) {
+    trans=db.transaction();
+  }
+  else {
+    locked=ApplyLines("lock tables LOG_LINES write");
+  }
+  ok=SavedLinesCurrent();
+  for(int i=0;ok&&(i<deleted.size());i+=RDLOGMODEL_SAVE_BATCH_SIZE) {
+    sql="delete from LOG_LINES"+where;
+    for(int j=i;(j<deleted.size())&&(j<(i+RDLOGMODEL_SAVE_BATCH_SIZE));j++) {
+      sql+=QString().sprintf("%d,",deleted.at(j));
+    }
+    ok=ApplyLines(sql.left(sql.length()-1)+")");
+  }
+
+  //
+  // COUNT is unique within a log, so park the moved lines on negative
+  // values before giving them their new ones
+  //
+  for(int i=0;ok&&(i<moved.size());i+=RDLOGMODEL_SAVE_BATCH_SIZE) {
+    sql="update LOG_LINES set COUNT=-1-COUNT"+where;
+    for(int j=i;(j<moved.size())&&(j<(i+RDLOGMODEL_SAVE_BATCH_SIZE));j++) {
+      sql+=QString().sprintf("%d,",moved.at(j));
+    }
+    ok=ApplyLines(sql.left(sql.length()-1)+")");
+  }
+  for(int i=0;ok&&(i<moved.size());i+=RDLOGMODEL_SAVE_BATCH_SIZE) {
+    QString ids;
+    sql="update LOG_LINES set COUNT=case LINE_ID";
+    for(int j=i;(j<moved.size())&&(j<(i+RDLOGMODEL_SAVE_BATCH_SIZE));j++) {
+      sql+=QString().sprintf(" when %d then %d",moved.at(j),
+			     counts.value(moved.at(j)));
+      ids+=QString().sprintf("%d,",moved.at(j));
+    }
+    sql+=" end"+where+ids.left(ids.length()-1)+")";
+    ok=ApplyLines(sql);
+  }
+
+  for(int i=0;ok&&(i<changed.size());i+=RDLOGMODEL_SAVE_BATCH_SIZE) {
+    values="";
+    for(int j=i;(j<changed.size())&&(j<(i+RDLOGMODEL_SAVE_BATCH_SIZE));j++) {
+      if(j>i) {
+	values+=",";
+      }
+      InsertLineValues(&values,changed.at(j));
+    }
+    ok=InsertLines(values,true);
+  }
+
+  if(trans) {
+    if(ok) {
+      ok=db.commit();
+    }
+    else {
+      db.rollback();
+    }
+  }
+  if(locked) {
+    ApplyLines("unlock tables");
+  }
+
+  return ok;
+}
+
+
+bool RDLogModel::SavedLinesCurrent() const
+{
+  //
+  // The differences only apply if the stored lines are still laid out
+  // as they were at the last load or save. If another editor has since
+  // added, removed or moved any, the whole log is rewritten instead.
+  //
+  QString sql;
+  RDSqlQuery *q=NULL;
+  bool ret=false;
+
+  sql=QString("select ")+
+    "LINE_ID,"+  // 00
+    "COUNT "+    // 01
+    "from LOG_LINES where "+
+    "LOG_NAME=\""+RDEscapeString(d_log_name)+"\" "+
+    "for update";
+  q=new RDSqlQuery(sql,false);
+  ret=q->isActive()&&(q->size()==d_saved_counts.size());
+  while(ret&&q->next()) {
+    ret=d_saved_counts.value(q->value(0).toInt(),-1)==q->value(1).toInt();
   }
   delete q;
 
-  for(int i=from_line;i<d_log_lines.size();i++) {
-    for(int j=0;j<groups.size();j++) {
-      if(d_log_lines[i]->groupName()==groups[j]) {
-	d_log_lines[i]->setNowNextEnabled(now_nexts[j]);
+  return ret;
+}
+
+
+void RDLogModel::SaveAll()
+{
+  QString sql;
+  QString values;
+
+  sql=QString("delete from LOG_LINES where ")+
+    "LOG_NAME=\""+RDEscapeString(d_log_name)+"\"";
+  RDSqlQuery::apply(sql);
+  for(int i=0;i<d_log_lines.size();i+=RDLOGMODEL_SAVE_BATCH_SIZE) {
+    values="";
+    for(int j=i;(j<d_log_lines.size())&&(j<(i+RDLOGMODEL_SAVE_BATCH_SIZE));
+	j++) {
+      if(j>i) {
+	values+=",";
       }
+      InsertLineValues(&values,j);
     }
+    InsertLines(values);
+  }
+}
+
+
+bool RDLogModel::ApplyLines(const QString &sql) const
+{
+  //
+  // Inside a transaction or table lock, so not retried on a new
+  // connection
+  //
+  bool ret=false;
+
+  RDSqlQuery *q=new RDSqlQuery(sql,false);
+  ret=q->isActive();
+  delete q;
+
+  return ret;
+}
+
+
+void RDLogModel::UpdateLog(bool update_tracks)
+{
+  RDLog *log=new RDLog(d_log_name);
+  if(log->nextId()<nextId()) {
+    log->setNextId(nextId());
+  }
+  if(update_tracks) {
+    log->updateTracks();
+  }
+  delete log;
+}
+
+
+void RDLogModel::SetSavedState()
+{
+  d_saved_counts.clear();
+  d_saved_values.clear();
+  d_saved_valid=true;
+  for(int i=0;i<d_log_lines.size();i++) {
+    int id=d_log_lines.at(i)->id();
+    if(d_saved_counts.contains(id)) {
+      d_saved_counts.clear();
+      d_saved_values.clear();
+      d_saved_valid=false;
+      return;
+    }
+    d_saved_counts[id]=i;
+    d_saved_values[id]=LineValues(i,0);
   }
 }
 
@@ -1640,12 +1966,59 @@ QColor RDLogModel::rowBackgroundColor(int line,RDLogLine *ll) const
 }
 
 
+void RDLogModel::InvalidateIdIndex(int line)
+{
+  if(line<d_id_index_valid) {
+    d_id_index_valid=line;
+  }
+}
+
+
+void RDLogModel::UpdateIdIndex() const
+{
+  //
+  // Lines ahead of d_id_index_valid have not moved since they were last
+  // indexed, so only the remainder of the log needs to be walked.  Entries
+  // for lines that have since been removed are left behind, and are caught
+  // by the check in lineById().
+  //
+  if(d_id_index.size()>(RDLOGMODEL_ID_INDEX_SLACK*lineCount())) {
+    d_id_index.clear();
+    d_id_index_valid=0;
+  }
+  for(int i=d_id_index_valid;i<lineCount();i++) {
+    int id=d_log_lines.at(i)->id();
+    int line=d_id_index.value(id,-1);
+    if((line<0)||(line>=i)||(d_log_lines.at(line)->id()!=id)) {
+      d_id_index[id]=i;
+    }
+  }
+  d_id_index_valid=lineCount();
+}
+
+
+void RDLogModel::CheckIdIndex(const char *op) const
+{
+#ifdef RDLOGMODEL_DEBUG
+  QString err_msg;
+
+  if(!checkIdIndex(&err_msg)) {
+    fprintf(stderr,"RDLogModel::%s(): ID index is inconsistent: %s\n",
+	    op,err_msg.toUtf8().constData());
+    abort();
+  }
+#endif  // RDLOGMODEL_DEBUG
+}
+
+
 void RDLogModel::MakeModel()
 {
   d_fms=NULL;
   d_bold_fms=NULL;
   d_start_time_style=RDLogModel::Scheduled;
   d_max_id=0;
+  d_id_index_valid=0;
+  d_saved_valid=false;
 
   QStringList headers=headerTexts();
   QList<int> alignments=columnAlignments();
@@ -24,12 +24,25 @@
 #include <QAbstractTableModel>
 #include <QFont>
 #include <QFontMetrics>
+#include <QHash>
 #include <QList>
+#include <QMap>
 #include <QPalette>
 
 #include <rdlog_line.h>
 #include <rdnotification.h>
 
+//
+// Maximum number of lines written by each statement when saving
+//
+#define RDLOGMODEL_SAVE_BATCH_SIZE 500
+
+//
+// Rebuild the line ID index from scratch once it holds more than this many
+// entries per log line (stale entries left behind by removed lines)
+//
+#define RDLOGMODEL_ID_INDEX_SLACK 2
+
 class RDLogModel : public QAbstractTableModel
 {
   Q_OBJECT
@@ -74,6 +87,7 @@ class RDLogModel : public QAbstractTableModel
   void setLogLine(int line,RDLogLine *ll);
   RDLogLine *loglineById(int id, bool ignore_holdovers=false) const;
   int lineById(int id, bool ignore_holdovers=false) const;
+  bool checkIdIndex(QString *err_msg=NULL) const;
   int lineByStartHour(int hour,RDLogLine::StartTimeType type) const;
   int lineByStartHour(int hour) const;
   int nextTimeStart(QTime after);
@@ -103,9 +117,18 @@ class RDLogModel : public QAbstractTableModel
   QString StartTimeString(int line) const;
   int LoadLines(const QString &logname,int id_offset,bool track_ptrs);
   void SaveLine(int line);
-  void InsertLines(QString values);
+  bool SaveChanges();
+  bool SavedLinesCurrent() const;
+  void SaveAll();
+  void UpdateLog(bool update_tracks);
+  void SetSavedState();
+  bool ApplyLines(const QString &sql) const;
+  bool InsertLines(QString values,bool upsert=false);
   void InsertLineValues(QString *query, int line);
-  void LoadNowNext(unsigned from_line);
+  QString LineValues(int line,int count) const;
+  void InvalidateIdIndex(int line);
+  void UpdateIdIndex() const;
+  void CheckIdIndex(const char *op) const;
   void MakeModel();
   QPalette d_palette;
   QFont d_font;
@@ -120,6 +143,11 @@ class RDLogModel : public QAbstractTableModel
   int d_max_id;
   bool d_read_only;
   QList<RDLogLine *> d_log_lines;
+  mutable QHash<int,int> d_id_index;  // Line ID -> line
+  mutable int d_id_index_valid;       // Lines indexed so far
+  bool d_saved_valid;
+  QMap<int,int> d_saved_counts;      // By line ID
+  QMap<int,QString> d_saved_values;  // By line ID
 };
 
 
@@ -86,7 +86,7 @@ bool RDNotification::read(const QString &str)
   notify_id=QVariant();
 
   QStringList args=str.split(" ");
-  if(args.size()==4) {
+  if(args.size()>=4) {
     if(args[0]!="NOTIFY") {
       return false;
     }
@@ -123,6 +123,13 @@ bool RDNotification::read(const QString &str)
 	  notify_id=QVariant(args[3]);
 	  break;
 
+	case RDNotification::StationType:
+	case RDNotification::GroupType:
+	case RDNotification::ServiceType:
+	case RDNotification::UserType:
+	  notify_id=QVariant(str.section(" ",3));  // Names may contain spaces
+	  break;
+
 	case RDNotification::NullType:
 	case RDNotification::LastType:
 	  break;
@@ -182,6 +189,13 @@ QString RDNotification::write() const
     ret+=notify_id.toString();
     break;
 
+  case RDNotification::StationType:
+  case RDNotification::GroupType:
+  case RDNotification::ServiceType:
+  case RDNotification::UserType:
+    ret+=notify_id.toString();
+    break;
+
   case RDNotification::NullType:
   case RDNotification::LastType:
     break;
@@ -223,6 +237,22 @@ QString RDNotification::typeString(RDNotification::Type type)
     ret="FEED";
     break;
 
+  case RDNotification::StationType:
+    ret="STATION";
+    break;
+
+  case RDNotification::GroupType:
+    ret="GROUP";
+    break;
+
+  case RDNotification::ServiceType:
+    ret="SERVICE";
+    break;
+
+  case RDNotification::UserType:
+    ret="USER";
+    break;
+
   case RDNotification::NullType:
   case RDNotification::LastType:
     break;
@@ -28,7 +28,8 @@ class RDNotification
 {
  public:
   enum Type {NullType=0,CartType=1,LogType=2,PypadType=3,DropboxType=4,
-	     CatchEventType=5,FeedItemType=6,FeedType=7,LastType=8};
+	     CatchEventType=5,FeedItemType=6,FeedType=7,StationType=8,
+	     GroupType=9,ServiceType=10,UserType=11,LastType=12};
   enum Action {NoAction=0,AddAction=1,DeleteAction=2,ModifyAction=3,
 	       LastAction=4};
   RDNotification(Type type,Action action,const QVariant &id);
@@ -65,6 +65,9 @@ RDPeaksExport::RDPeaksExport(QObject *parent)
 {
   conv_cart_number=0;
   conv_cut_number=0;
+  conv_start_point=-1;
+  conv_end_point=-1;
+  conv_points=0;
   conv_energy_data=NULL;
   conv_write_ptr=0;
 }
@@ -82,6 +85,19 @@ void RDPeaksExport::setCutNumber(unsigned cutnum)
 }
 
 
+void RDPeaksExport::setRange(int start_pt,int end_pt)
+{
+  conv_start_point=start_pt;
+  conv_end_point=end_pt;
+}
+
+
+void RDPeaksExport::setPoints(unsigned points)
+{
+  conv_points=points;
+}
+
+
 RDPeaksExport::ErrorCode RDPeaksExport::runExport(const QString &username,
 						  const QString &password)
 {
@@ -113,6 +129,24 @@ RDPeaksExport::ErrorCode RDPeaksExport::runExport(const QString &username,
 	       CURLFORM_COPYCONTENTS,
 	       QString().sprintf("%u",conv_cut_number).toUtf8().constData(),
 	       CURLFORM_END);
+  if(conv_start_point>=0) {
+    curl_formadd(&first,&last,CURLFORM_PTRNAME,"START_POINT",
+		 CURLFORM_COPYCONTENTS,
+		 QString().sprintf("%d",conv_start_point).toUtf8().constData(),
+		 CURLFORM_END);
+  }
+  if(conv_end_point>=0) {
+    curl_formadd(&first,&last,CURLFORM_PTRNAME,"END_POINT",
+		 CURLFORM_COPYCONTENTS,
+		 QString().sprintf("%d",conv_end_point).toUtf8().constData(),
+		 CURLFORM_END);
+  }
+  if(conv_points>0) {
+    curl_formadd(&first,&last,CURLFORM_PTRNAME,"POINTS",
+		 CURLFORM_COPYCONTENTS,
+		 QString().sprintf("%u",conv_points).toUtf8().constData(),
+		 CURLFORM_END);
+  }
   if((curl=curl_easy_init())==NULL) {
     curl_formfree(first);
     return RDPeaksExport::ErrorInternal;
@@ -35,6 +35,8 @@ class RDPeaksExport
   ~RDPeaksExport();
   void setCartNumber(unsigned cartnum);
   void setCutNumber(unsigned cutnum);
+  void setRange(int start_pt,int end_pt);
+  void setPoints(unsigned points);
   RDPeaksExport::ErrorCode runExport(const QString &username,
 				     const QString &password);
   unsigned energySize();
@@ -45,6 +47,9 @@ class RDPeaksExport
  private:
   unsigned conv_cart_number;
   unsigned conv_cut_number;
+  int conv_start_point;
+  int conv_end_point;
+  unsigned conv_points;
   unsigned short *conv_energy_data;
   unsigned conv_write_ptr;
   friend size_t RDPeaksExportWrite(void *ptr, size_t size, size_t nmemb, 
@@ -330,6 +330,19 @@ void RDPodcast::setSha1Hash(const QString &str) const
 }
 
 
+QString RDPodcast::sha1Fingerprint() const
+{
+  return RDGetSqlValue("PODCASTS","ID",podcast_id,"SHA1_FINGERPRINT").
+    toString();
+}
+
+
+void RDPodcast::setSha1Fingerprint(const QString &str) const
+{
+  SetRow("SHA1_FINGERPRINT",str);
+}
+
+
 void RDPodcast::setAudioTime(int msecs) const
 {
   SetRow("AUDIO_TIME",msecs);
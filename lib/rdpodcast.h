@@ -70,6 +70,8 @@ class RDPodcast
   void setAudioTime(int msecs) const;
   QString sha1Hash() const;
   void setSha1Hash(const QString &str=QString()) const;
+  QString sha1Fingerprint() const;
+  void setSha1Fingerprint(const QString &str=QString()) const;
   QDateTime expirationDateTime() const;
   void setExpirationDateTime(const QDateTime &dt) const;
   RDPodcast::Status status() const;
@@ -20,6 +20,10 @@
 
 #include <errno.h>
 #include <math.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <QCoreApplication>
 
 #include "rdapplication.h"
 #include "rdaudioconvert.h"
@@ -28,22 +32,49 @@
 #include "rdcart.h"
 #include "rdconf.h"
 #include "rdcut.h"
+#include "rdrendersink.h"
 #include "rdtempdirectory.h"
 
 #include "rdrenderer.h"
 
-__RDRenderLogLine::__RDRenderLogLine(RDLogLine *ll,unsigned chans)
+__RDRenderLogLine::__RDRenderLogLine(RDLogLine *ll,unsigned chans,
+				     unsigned samprate)
   : RDLogLine(*ll)
 {
   ll_cart=NULL;
   ll_cut=NULL;
   ll_handle=NULL;
+  ll_decoder=new RDCutDecoder();
+  ll_selected=false;
+  ll_direct=false;
+  ll_prepared=false;
+  ll_decoded=false;
+  ll_thread_running=false;
+  ll_cut_start_point=-1;
+  ll_cut_end_point=-1;
   ll_channels=chans;
+  ll_sample_rate=samprate;
   ll_ramp_level=0.0;
   ll_ramp_rate=0.0;
 }
 
 
+__RDRenderLogLine::~__RDRenderLogLine()
+{
+  close();
+  if(!ll_export_filename.isEmpty()) {
+    DeleteCutFile(ll_export_filename);
+  }
+  delete ll_decoder;
+  if(ll_cut!=NULL) {
+    delete ll_cut;
+  }
+  if(ll_cart!=NULL) {
+    delete ll_cart;
+  }
+}
+
+
 RDCart *__RDRenderLogLine::cart() const
 {
   return ll_cart;
@@ -56,9 +87,21 @@ RDCut *__RDRenderLogLine::cut() const
 }
 
 
-SNDFILE *__RDRenderLogLine::handle() const
+bool __RDRenderLogLine::isOpen() const
+{
+  return (ll_handle!=NULL)||ll_decoded;
+}
+
+
+sf_count_t __RDRenderLogLine::read(float *pcm,sf_count_t frames)
 {
-  return ll_handle;
+  if(ll_handle!=NULL) {
+    return sf_readf_float(ll_handle,pcm,frames);
+  }
+  if(ll_decoded) {
+    return ll_decoder->read(pcm,frames);
+  }
+  return 0;
 }
 
 
@@ -95,41 +138,129 @@ void __RDRenderLogLine::setRamp(RDLogLine::TransType next_trans,int segue_gain)
 }
 
 
-bool __RDRenderLogLine::open(const QTime &time)
+QTime __RDRenderLogLine::renderTime() const
+{
+  return ll_render_time;
+}
+
+
+void __RDRenderLogLine::setRenderTime(const QTime &time)
+{
+  ll_render_time=time;
+}
+
+
+int __RDRenderLogLine::playLength(RDLogLine::TransType next_trans) const
+{
+  if((next_trans==RDLogLine::Segue)&&(segueStartPoint()>=0)) {
+    if(segueStartPoint()>startPoint()) {
+      return segueStartPoint()-startPoint();
+    }
+    return 0;
+  }
+  if(endPoint()>startPoint()) {
+    return endPoint()-startPoint();
+  }
+  return 0;
+}
+
+
+int __RDRenderLogLine::audioLength() const
+{
+  if(ll_selected&&(ll_cut_end_point>ll_cut_start_point)) {
+    return ll_cut_end_point-ll_cut_start_point;
+  }
+  return 0;
+}
+
+
+bool __RDRenderLogLine::select()
 {
   QString cutname;
-  SF_INFO sf_info;
 
   if(type()==RDLogLine::Cart) {
     ll_cart=new RDCart(cartNumber());
     if(ll_cart->exists()&&(ll_cart->type()==RDCart::Audio)) {
-      if(ll_cart->selectCut(&cutname,time)) {
+      if(ll_cart->selectCut(&cutname,ll_render_time)) {
 	ll_cut=new RDCut(cutname);
 	setStartPoint(ll_cut->startPoint(),RDLogLine::CartPointer);
 	setEndPoint(ll_cut->endPoint(),RDLogLine::CartPointer);
 	setSegueStartPoint(ll_cut->segueStartPoint(),RDLogLine::CartPointer);
 	setSegueEndPoint(ll_cut->segueEndPoint(),RDLogLine::CartPointer);
 	setSegueGain(ll_cut->segueGain());
-	QString filename;
-	if(GetCutFile(cutname,ll_cut->startPoint(),ll_cut->endPoint(),
-		      &filename)) {
-	  ll_handle=sf_open(filename.toUtf8(),SFM_READ,&sf_info);
-	  if(ll_handle!=NULL) {
- 	    DeleteCutFile(filename);
-	    return true;
-	  }
-	}
+	ll_cutname=cutname;
+	ll_pathname=RDCut::pathName(cutname);
+	ll_cut_start_point=ll_cut->startPoint();
+	ll_cut_end_point=ll_cut->endPoint();
+
+	//
+	// Audio that can't be read directly is exported through rdxport
+	// when the line comes within the prefetch window
+	//
+	ll_direct=ll_decoder->canDecode(ll_pathname,ll_sample_rate);
+	ll_selected=true;
       }
     }
   }
-  return false;
+  return ll_selected;
+}
+
+
+void __RDRenderLogLine::setExportService(const QString &url,
+					 const QString &username,
+					 const QString &password)
+{
+  ll_export_url=url;
+  ll_export_username=username;
+  ll_export_password=password;
+}
+
+
+QString __RDRenderLogLine::exportError() const
+{
+  return ll_export_error;
+}
+
+
+void __RDRenderLogLine::prefetch()
+{
+  if(ll_selected&&(!ll_prepared)&&(!ll_thread_running)) {
+    ll_thread_running=
+      pthread_create(&ll_thread,NULL,DecodeCallback,this)==0;
+  }
+}
+
+
+bool __RDRenderLogLine::open()
+{
+  if(!ll_selected) {
+    return false;
+  }
+  if(ll_thread_running) {
+    pthread_join(ll_thread,NULL);
+    ll_thread_running=false;
+  }
+  else {
+    if(!ll_prepared) {
+      Prepare();
+    }
+  }
+  return isOpen();
 }
 
 
 void __RDRenderLogLine::close()
 {
-  sf_close(ll_handle);
-  ll_handle=NULL;
+  if(ll_thread_running) {
+    pthread_join(ll_thread,NULL);
+    ll_thread_running=false;
+  }
+  if(ll_handle!=NULL) {
+    sf_close(ll_handle);
+    ll_handle=NULL;
+  }
+  ll_decoder->close();
+  ll_decoded=false;
 }
 
 
@@ -175,7 +306,8 @@ QString __RDRenderLogLine::summary() const
 
 
 bool __RDRenderLogLine::GetCutFile(const QString &cutname,int start_pt,
-				   int end_pt,QString *dest_filename) const
+				   int end_pt,QString *dest_filename,
+				   QString *err_msg) const
 {
   bool ret=false;
   RDAudioConvert::ErrorCode conv_err;
@@ -191,22 +323,22 @@ bool __RDRenderLogLine::GetCutFile(const QString &cutname,int start_pt,
   conv->setCutNumber(RDCut::cutNumber(cutname));
   RDSettings s;
   s.setFormat(RDSettings::Pcm16);
-  s.setSampleRate(rda->system()->sampleRate());
+  s.setSampleRate(ll_sample_rate);
   s.setChannels(ll_channels);
   s.setNormalizationLevel(0);
   conv->setDestinationSettings(&s);
   conv->setRange(start_pt,end_pt);
   conv->setEnableMetadata(false);
-  switch(export_err=conv->runExport(rda->user()->name(),
-				    rda->user()->password(),&conv_err)) {
+  conv->setWebServiceUrl(ll_export_url);
+  switch(export_err=conv->runExport(ll_export_username,ll_export_password,
+				    &conv_err)) {
   case RDAudioExport::ErrorOk:
     ret=true;
     break;
 
   default:
     ret=false;
-    printf("export err %d [%s]\n",export_err,
-	  (const char *)RDAudioExport::errorText(export_err,conv_err).toUtf8());
+    *err_msg=RDAudioExport::errorText(export_err,conv_err);
     break;
   }
 
@@ -226,7 +358,47 @@ void __RDRenderLogLine::DeleteCutFile(const QString &dest_filename) const
 
 uint64_t __RDRenderLogLine::FramesFromMsec(uint64_t msec)
 {
-  return msec*rda->system()->sampleRate()/1000;
+  return msec*ll_sample_rate/1000;
+}
+
+
+void __RDRenderLogLine::Prepare()
+{
+  SF_INFO sf_info;
+
+  if(ll_direct) {
+    ll_decoded=ll_decoder->open(ll_pathname,ll_sample_rate,ll_channels,
+				ll_cut_start_point,ll_cut_end_point);
+    if(ll_decoded) {
+      ll_decoder->decodeAhead(RDCUTDECODER_PREFETCH_FRAMES);
+    }
+  }
+  else {
+    if(GetCutFile(ll_cutname,ll_cut_start_point,ll_cut_end_point,
+		  &ll_export_filename,&ll_export_error)) {
+      memset(&sf_info,0,sizeof(sf_info));
+      ll_handle=sf_open(ll_export_filename.toUtf8(),SFM_READ,&sf_info);
+    }
+
+    //
+    // The open handle keeps the export readable until it is closed
+    //
+    if(!ll_export_filename.isEmpty()) {
+      DeleteCutFile(ll_export_filename);
+      ll_export_filename="";
+    }
+  }
+  ll_prepared=true;
+}
+
+
+void *__RDRenderLogLine::DecodeCallback(void *priv)
+{
+  __RDRenderLogLine *ll=(__RDRenderLogLine *)priv;
+
+  ll->Prepare();
+
+  return NULL;
 }
 
 
@@ -236,11 +408,22 @@ RDRenderer::RDRenderer(QObject *parent)
   : QObject(parent)
 {
   render_total_passes=0;
+  render_abort=false;
+  render_sample_rate=0;
+  render_channels=0;
+  render_sink=NULL;
+  render_sink_failed=false;
+  render_next_segment=0;
+  pthread_mutex_init(&render_mutex,NULL);
+  pthread_cond_init(&render_cond,NULL);
+  setWorkers(0);
 }
 
 
 RDRenderer::~RDRenderer()
 {
+  pthread_cond_destroy(&render_cond);
+  pthread_mutex_destroy(&render_mutex);
 }
 
 
@@ -281,8 +464,11 @@ bool RDRenderer::renderToFile(const QString &outfile,RDLogModel *model,
     //
     // Render It
     //
-    if(!Render(temp_output_filename,model,s,start_time,ignore_stops,err_msg,
-	       first_line,last_line,first_time,last_time)) {
+    RDRenderFileSink *sink=new RDRenderFileSink(temp_output_filename);
+    ok=Render(sink,model,s,start_time,ignore_stops,err_msg,
+	      first_line,last_line,first_time,last_time);
+    delete sink;
+    if(!ok) {
       return false;
     }
 
@@ -302,8 +488,10 @@ bool RDRenderer::renderToFile(const QString &outfile,RDLogModel *model,
     ProgressMessage(tr("Pass 1 of 1"));
     render_total_passes=1;
 
-    ret=Render(outfile,model,s,start_time,ignore_stops,err_msg,
+    RDRenderFileSink *sink=new RDRenderFileSink(outfile);
+    ret=Render(sink,model,s,start_time,ignore_stops,err_msg,
 	       first_line,last_line,first_time,last_time);
+    delete sink;
     emit lineStarted(model->lineCount(),model->lineCount());
     return ret;
   }
@@ -311,6 +499,29 @@ bool RDRenderer::renderToFile(const QString &outfile,RDLogModel *model,
 }
 
 
+bool RDRenderer::renderToSink(RDRenderSink *sink,RDLogModel *model,
+			      RDSettings *s,const QTime &start_time,
+			      bool ignore_stops,QString *err_msg,
+			      int first_line,int last_line,
+			      const QTime &first_time,const QTime &last_time)
+{
+  bool ret;
+
+  if(((s->format()!=RDSettings::Pcm16)&&(s->format()!=RDSettings::Pcm24))||
+     (s->normalizationLevel()!=0)) {
+    *err_msg=tr("unsupported output format");
+    return false;
+  }
+  ProgressMessage(tr("Pass 1 of 1"));
+  render_total_passes=1;
+  ret=Render(sink,model,s,start_time,ignore_stops,err_msg,
+	     first_line,last_line,first_time,last_time);
+  emit lineStarted(model->lineCount(),model->lineCount());
+
+  return ret;
+}
+
+
 bool RDRenderer::renderToCart(unsigned cartnum,int cutnum,RDLogModel *model,
 			      RDSettings *s,const QTime &start_time,
 			      bool ignore_stops,QString *err_msg,
@@ -319,6 +530,7 @@ bool RDRenderer::renderToCart(unsigned cartnum,int cutnum,RDLogModel *model,
 {
   QString temp_output_filename;
   char tempdir[PATH_MAX];
+  RDSettings::Format format;
   bool ok=false;
 
   if(first_line<0) {
@@ -338,9 +550,6 @@ bool RDRenderer::renderToCart(unsigned cartnum,int cutnum,RDLogModel *model,
     return false;
   }
 
-  ProgressMessage(tr("Pass 1 of 2"));
-  render_total_passes=2;
-
   //
   // Verify Destination
   //
@@ -353,6 +562,26 @@ bool RDRenderer::renderToCart(unsigned cartnum,int cutnum,RDLogModel *model,
     return false;
   }
 
+  //
+  // Write straight into the audio store if we can
+  //
+  if(RDRenderCutSink::canWrite(cartnum,cutnum,&format)) {
+    RDSettings settings=*s;
+    settings.setFormat(format);
+    settings.setNormalizationLevel(0);
+    ProgressMessage(tr("Pass 1 of 1"));
+    render_total_passes=1;
+    RDRenderCutSink *sink=new RDRenderCutSink(cartnum,cutnum);
+    ok=Render(sink,model,&settings,start_time,ignore_stops,err_msg,
+	      first_line,last_line,first_time,last_time);
+    delete sink;
+    emit lineStarted(model->lineCount(),model->lineCount());
+    return ok;
+  }
+
+  ProgressMessage(tr("Pass 1 of 2"));
+  render_total_passes=2;
+
   //
   // Get Temporary File
   //
@@ -365,8 +594,11 @@ bool RDRenderer::renderToCart(unsigned cartnum,int cutnum,RDLogModel *model,
   //
   // Render It
   //
-  if(!Render(temp_output_filename,model,s,start_time,ignore_stops,err_msg,
-	     first_line,last_line,first_time,last_time)) {
+  RDRenderFileSink *sink=new RDRenderFileSink(temp_output_filename);
+  ok=Render(sink,model,s,start_time,ignore_stops,err_msg,
+	    first_line,last_line,first_time,last_time);
+  delete sink;
+  if(!ok) {
     return false;
   }
 
@@ -392,23 +624,45 @@ QStringList RDRenderer::warnings() const
 }
 
 
+int RDRenderer::workers() const
+{
+  return render_workers;
+}
+
+
+void RDRenderer::setWorkers(int n)
+{
+  if(n<=0) {
+    if((n=sysconf(_SC_NPROCESSORS_ONLN))<=0) {
+      n=1;
+    }
+  }
+  render_workers=n;
+}
+
+
 void RDRenderer::abort()
 {
+  pthread_mutex_lock(&render_mutex);
   render_abort=true;
+  pthread_mutex_unlock(&render_mutex);
 }
 
 
-bool RDRenderer::Render(const QString &outfile,RDLogModel *model,RDSettings *s,
+bool RDRenderer::Render(RDRenderSink *sink,RDLogModel *model,RDSettings *s,
 			const QTime &start_time,bool ignore_stops,
 			QString *err_msg,int first_line,int last_line,
 			const QTime &first_time,const QTime &last_time)
 {
-  float *pcm=NULL;
-  QString temp_output_filename;
   QTime current_time;
+  char tempdir[PATH_MAX];
+  QString segment_dir;
+  bool ret=true;
 
   render_warnings.clear();
   render_abort=false;
+  render_sink=sink;
+  render_sink_failed=false;
 
   if(start_time.isNull()) {
     current_time=QTime::currentTime();
@@ -418,33 +672,43 @@ bool RDRenderer::Render(const QString &outfile,RDLogModel *model,RDSettings *s,
   }
 
   //
-  // Open Output File
+  // Open Output
   //
   SF_INFO sf_info;
-  SNDFILE *sf_out;
+  RDSettings::Format format=RDSettings::Pcm24;
 
-  memset(&sf_info,0,sizeof(sf_info));
-  sf_info.samplerate=rda->system()->sampleRate();
-  sf_info.channels=s->channels();
+  render_sample_rate=rda->system()->sampleRate();
+  render_channels=s->channels();
   if(s->format()==RDSettings::Pcm16) {
-    sf_info.format=SF_FORMAT_WAV|SF_FORMAT_PCM_16;
-  }
-  else {
-    sf_info.format=SF_FORMAT_WAV|SF_FORMAT_PCM_24;
+    format=RDSettings::Pcm16;
   }
-  sf_out=sf_open(outfile.toUtf8(),SFM_WRITE,&sf_info);
-  if(sf_out==NULL) {
-    fprintf(stderr,"rdrender: unable to open output file [%s]\n",
-	    sf_strerror(sf_out));
-    return 1;
+  if(!sink->open(render_sample_rate,render_channels,format,err_msg)) {
+    return false;
   }
 
+  //
+  // Segments other than the first are held as floating point, so that
+  // stitching them onto the output is lossless
+  //
+  memset(&sf_info,0,sizeof(sf_info));
+  sf_info.samplerate=render_sample_rate;
+  sf_info.channels=render_channels;
+  sf_info.format=SF_FORMAT_WAV|SF_FORMAT_FLOAT;
+
   //
   // Initialize the log
   //
-  std::vector<__RDRenderLogLine *> lls;
+  // Lines are exported on the worker threads, so everything that takes
+  // a database lookup is read here once beforehand.
+  //
+  QString export_url=rda->station()->webServiceUrl(rda->config());
+  QString export_username=rda->user()->name();
+  QString export_password=rda->user()->password();
+  std::vector<__RDRenderLogLine *> &lls=render_lines;
   for(int i=0;i<model->lineCount();i++) {
-    lls.push_back(new __RDRenderLogLine(model->logLine(i),s->channels()));
+    lls.push_back(new __RDRenderLogLine(model->logLine(i),render_channels,
+					render_sample_rate));
+    lls.back()->setExportService(export_url,export_username,export_password);
     if(ignore_stops&&(lls.back()->transType()==RDLogLine::Stop)) {
       lls.back()->setTransType(RDLogLine::Play);
     }
@@ -471,124 +735,465 @@ bool RDRenderer::Render(const QString &outfile,RDLogModel *model,RDSettings *s,
     *err_msg+=tr("last-time event not found");
   }
   if(!err_msg->isEmpty()) {
+    DeleteLines(&lls);
+    sink->cancel();
     return false;
   }
-  lls.push_back(new __RDRenderLogLine(new RDLogLine(),s->channels()));
+  RDLogLine end_ll;
+  lls.push_back(new __RDRenderLogLine(&end_ll,render_channels,
+				      render_sample_rate));
   lls.back()->setTransType(RDLogLine::Play);
   if((!first_time.isNull())&&(first_line==-1)) {
     first_line=model->lineCount();
   }
+  unsigned range_first=0;
+  unsigned range_last=lls.size()-1;
+  if(first_line>=0) {
+    range_first=first_line;
+  }
+  if((last_line>=0)&&((unsigned)last_line<range_last)) {
+    range_last=last_line;
+  }
+  render_line_messages=std::vector<QStringList>(lls.size());
+  render_line_warnings=std::vector<QStringList>(lls.size());
 
   //
-  // Iterate through it
+  // Select the cuts
   //
-  for(unsigned i=0;i<lls.size();i++) {
-    if(render_abort) {
-      emit lineStarted(model->lineCount()+render_total_passes-1,
-		       model->lineCount()+render_total_passes-1);
-      *err_msg+="Render aborted.\n";
-      sf_close(sf_out);
-      return false;
+  // This is done for the entire log up front, in log order, so that the
+  // start time of every line (and hence the cut chosen for it) is the
+  // same as when the log is played straight through. Along the way, note
+  // every line boundary at which no earlier audio is still sounding;
+  // the log can be split into independently rendered segments there.
+  //
+  std::vector<unsigned> splits;
+  std::vector<sf_count_t> split_offsets;
+  sf_count_t offset=0;
+  sf_count_t tail=0;
+  int stop_line=-1;
+  int end_line=(int)range_first-1;
+  for(unsigned i=range_first;i<=range_last;i++) {
+    __RDRenderLogLine *ll=lls.at(i);
+    ll->setRenderTime(current_time);
+    if(ll->transType()==RDLogLine::Stop) {
+      stop_line=i;
+      break;
+    }
+    if(tail<=offset) {
+      splits.push_back(i);
+      split_offsets.push_back(offset);
     }
-    emit lineStarted(i,model->lineCount()+render_total_passes-1);
-    if(((first_line==-1)||(first_line<=(int)i))&&
-       ((last_line==-1)||(last_line>=(int)i))) {
-      if(lls.at(i)->transType()==RDLogLine::Stop) {
-	ProgressMessage(current_time,i,tr("STOP")+" ",lls.at(i)->summary());
-	render_warnings.
-	  push_back(tr("log render halted at line")+QString().sprintf(" %d ",i)+
-		    tr("due to STOP"));
-	break;
+    if(ll->select()) {
+      int msecs=ll->playLength(lls.at(i+1)->transType());
+      if((offset+(sf_count_t)FramesFromMsec(ll->audioLength())+1)>tail) {
+	tail=offset+FramesFromMsec(ll->audioLength())+1;
       }
-      if(lls.at(i)->open(current_time)) {
-	ProgressMessage(current_time,i,
-			RDLogLine::transText(lls.at(i)->transType()),
-		      QString().sprintf(" cart %06u [",lls.at(i)->cartNumber())+
-			lls.at(i)->title()+"]");
-	sf_count_t frames=0;
-	if((lls.at(i+1)->transType()==RDLogLine::Segue)&&
-	   (lls.at(i)->segueStartPoint()>=0)) {
-	  if(lls.at(i)->segueStartPoint()>lls.at(i)->startPoint()) {
-	    frames=FramesFromMsec(lls.at(i)->segueStartPoint()-
-				  lls.at(i)->startPoint());
-	    current_time=
-	      current_time.addMSecs(lls.at(i)->segueStartPoint()-
-				    lls.at(i)->startPoint());
-	  }
-	  else {
-	    frames=0;
-	  }
+      offset+=FramesFromMsec(msecs);
+      current_time=current_time.addMSecs(msecs);
+    }
+    end_line=i;
+  }
+
+  //
+  // Divide it into segments
+  //
+  sf_count_t quantum=offset/(render_workers*RDRENDERER_SEGMENTS_PER_WORKER)+1;
+  render_segment_firsts.clear();
+  render_segment_lasts.clear();
+  if(end_line>=(int)range_first) {
+    render_segment_firsts.push_back(range_first);
+    sf_count_t segment_offset=0;
+    for(unsigned i=0;i<splits.size();i++) {
+      if((render_workers>1)&&(splits.at(i)>render_segment_firsts.back())&&
+	 ((split_offsets.at(i)-segment_offset)>=quantum)) {
+	render_segment_lasts.push_back(splits.at(i)-1);
+	render_segment_firsts.push_back(splits.at(i));
+	segment_offset=split_offsets.at(i);
+      }
+    }
+    render_segment_lasts.push_back(end_line);
+  }
+  render_segment_lines=render_segment_firsts;
+  render_segment_handles.clear();
+  render_segment_filenames.clear();
+  if(render_segment_firsts.size()>1) {
+    strncpy(tempdir,(RDTempDirectory::basePath()+"/rdrenderXXXXXX").toUtf8(),
+	    PATH_MAX);
+    segment_dir=mkdtemp(tempdir);
+  }
+  for(unsigned i=0;i<render_segment_firsts.size();i++) {
+    if(i==0) {
+      render_segment_filenames.push_back(QString());
+      render_segment_handles.push_back(NULL);
+    }
+    else {
+      render_segment_filenames.
+	push_back(segment_dir+QString().sprintf("/segment%u.wav",i));
+      render_segment_handles.
+	push_back(sf_open(render_segment_filenames.back().toUtf8(),SFM_WRITE,
+			  &sf_info));
+      if(render_segment_handles.back()==NULL) {
+	*err_msg=tr("unable to open temporary file")+" ["+
+	  sf_strerror(NULL)+"]";
+	for(unsigned j=1;j<render_segment_handles.size()-1;j++) {
+	  sf_close(render_segment_handles.at(j));
+	  unlink(render_segment_filenames.at(j).toUtf8());
 	}
-	else {
-	  if(lls.at(i)->endPoint()>lls.at(i)->startPoint()) {
-	    frames=FramesFromMsec(lls.at(i)->endPoint()-
-				  lls.at(i)->startPoint());
-	    current_time=current_time.addMSecs(lls.at(i)->endPoint()-
-					       lls.at(i)->startPoint());
-	  }
-	  else {
-	    frames=0;
-	  }
+	rmdir(segment_dir.toUtf8());
+	DeleteLines(&lls);
+	sink->cancel();
+	return false;
+      }
+    }
+  }
+
+  //
+  // Render the segments
+  //
+  std::vector<pthread_t> threads;
+  render_next_segment=0;
+  for(unsigned i=0;(i<(unsigned)render_workers)&&
+	(i<render_segment_firsts.size());i++) {
+    pthread_t thread;
+    if(pthread_create(&thread,NULL,WorkerCallback,this)==0) {
+      threads.push_back(thread);
+    }
+  }
+  if(threads.size()==0) {
+    WorkerCallback(this);
+  }
+
+  //
+  // Report progress in log order, stitching each segment onto the
+  // output as soon as it and all of the ones before it are done
+  //
+  unsigned final_line=lls.size();
+  if(stop_line>=0) {
+    final_line=stop_line;
+  }
+  unsigned reported=0;
+  int announced=-1;
+  unsigned stitched=1;
+  bool aborted=false;
+  bool done=false;
+  pthread_mutex_lock(&render_mutex);
+  while(!done) {
+    unsigned finished=FinishedLine(final_line);
+    aborted=render_abort;
+    done=finished>=final_line;
+    if((!aborted)&&(!done)&&(finished<=reported)&&
+       ((int)finished<=announced)) {
+      WaitForWorkers();
+      continue;
+    }
+    pthread_mutex_unlock(&render_mutex);
+    while((!aborted)&&(reported<finished)) {
+      if((int)reported>announced) {
+	emit lineStarted(reported,model->lineCount()+render_total_passes-1);
+	announced=reported;
+      }
+      for(int i=0;i<render_line_messages.at(reported).size();i++) {
+	ProgressMessage(render_line_messages.at(reported).at(i));
+      }
+      render_warnings+=render_line_warnings.at(reported);
+      reported++;
+    }
+    while((stitched<render_segment_firsts.size())&&
+	  (finished>render_segment_lasts.at(stitched))) {
+      if(!aborted) {
+	if(!AppendSegment(render_segment_filenames.at(stitched),
+			  render_channels)) {
+	  pthread_mutex_lock(&render_mutex);
+	  render_sink_failed=true;
+	  render_abort=true;
+	  pthread_mutex_unlock(&render_mutex);
+	  aborted=true;
 	}
-	pcm=new float[frames*s->channels()];
-	memset(pcm,0,frames*s->channels()*sizeof(float));
+      }
+      unlink(render_segment_filenames.at(stitched).toUtf8());
+      stitched++;
+    }
+    if((!aborted)&&(!done)&&((int)finished>announced)) {
+      emit lineStarted(finished,model->lineCount()+render_total_passes-1);
+      announced=finished;
+    }
+    pthread_mutex_lock(&render_mutex);
+    if(aborted&&(!done)) {
+      WaitForWorkers();
+    }
+  }
+  pthread_mutex_unlock(&render_mutex);
+  for(unsigned i=0;i<threads.size();i++) {
+    pthread_join(threads.at(i),NULL);
+  }
+  if(!segment_dir.isEmpty()) {
+    rmdir(segment_dir.toUtf8());
+  }
+
+  if(render_sink_failed) {
+    *err_msg+=tr("unable to write output")+"\n";
+  }
+  if(aborted) {
+    emit lineStarted(model->lineCount()+render_total_passes-1,
+		     model->lineCount()+render_total_passes-1);
+    *err_msg+="Render aborted.\n";
+    ret=false;
+  }
+  else {
+    if(stop_line>=0) {
+      emit lineStarted(stop_line,model->lineCount()+render_total_passes-1);
+      ProgressMessage(lls.at(stop_line)->renderTime(),stop_line,
+		      tr("STOP")+" ",lls.at(stop_line)->summary());
+      render_warnings.
+	push_back(tr("log render halted at line")+
+		  QString().sprintf(" %d ",stop_line)+tr("due to STOP"));
+    }
+  }
+  DeleteLines(&lls);
+  if(ret) {
+    ret=sink->close(err_msg);
+  }
+  else {
+    sink->cancel();
+  }
+  render_sink=NULL;
+
+  return ret;
+}
 
-	for(unsigned j=0;j<i;j++) {
-	  Sum(pcm,lls.at(j),frames,s->channels());
+
+void RDRenderer::RenderSegment(unsigned seg)
+{
+  std::vector<__RDRenderLogLine *> &lls=render_lines;
+  SNDFILE *sf=render_segment_handles.at(seg);
+  unsigned first=render_segment_firsts.at(seg);
+  unsigned last=render_segment_lasts.at(seg);
+  float *pcm=NULL;
+
+  for(unsigned i=first;i<=last;i++) {
+    pthread_mutex_lock(&render_mutex);
+    render_segment_lines[seg]=i;
+    pthread_cond_signal(&render_cond);
+    if(render_abort) {
+      pthread_mutex_unlock(&render_mutex);
+      break;
+    }
+    pthread_mutex_unlock(&render_mutex);
+
+    //
+    // Keep the decoders for the next few lines busy while this one
+    // is mixed
+    //
+    for(unsigned j=i;(j<=last)&&(j<=(i+RDRENDERER_PREFETCH_LINES));j++) {
+      lls.at(j)->prefetch();
+    }
+
+    QTime current_time=lls.at(i)->renderTime();
+    if(lls.at(i)->open()) {
+      render_line_messages[i].
+	push_back(ProgressText(current_time,i,
+			       RDLogLine::transText(lls.at(i)->transType()),
+		      QString().sprintf(" cart %06u [",lls.at(i)->cartNumber())+
+				   lls.at(i)->title()+"]"));
+      sf_count_t frames=
+	FramesFromMsec(lls.at(i)->playLength(lls.at(i+1)->transType()));
+      pcm=new float[frames*render_channels];
+      memset(pcm,0,frames*render_channels*sizeof(float));
+
+      for(unsigned j=first;j<i;j++) {
+	Sum(pcm,lls.at(j),frames,render_channels);
+      }
+      Sum(pcm,lls.at(i),frames,render_channels);
+      if(sf==NULL) {
+	if(!render_sink->write(pcm,frames)) {
+	  pthread_mutex_lock(&render_mutex);
+	  render_sink_failed=true;
+	  render_abort=true;
+	  pthread_mutex_unlock(&render_mutex);
 	}
-	Sum(pcm,lls.at(i),frames,s->channels());
-	sf_writef_float(sf_out,pcm,frames);
-	delete pcm;
-	pcm=NULL;
-	lls.at(i)->setRamp(lls.at(i+1)->transType(),lls.at(i)->segueGain());
       }
       else {
-	if(i<(lls.size()-1)) {
-	  if(lls.at(i)->type()==RDLogLine::Cart) {
-	    ProgressMessage(current_time,i,tr("FAIL"),lls.at(i)->summary()+
-			    " ("+tr("NO AUDIO AVAILABLE")+")");
-	    render_warnings.
-	      push_back(lls.at(i)->summary()+tr("at line")+
-			QString().sprintf(" %d ",i)+
-			tr("failed to play (NO AUDIO AVAILABLE)"));
-	  }
-	  else {
-	    ProgressMessage(current_time,i,tr("SKIP"),lls.at(i)->summary());
+	sf_writef_float(sf,pcm,frames);
+      }
+      delete[] pcm;
+      pcm=NULL;
+      lls.at(i)->setRamp(lls.at(i+1)->transType(),lls.at(i)->segueGain());
+    }
+    else {
+      if(i<(lls.size()-1)) {
+	if(lls.at(i)->type()==RDLogLine::Cart) {
+	  QString reason=tr("NO AUDIO AVAILABLE");
+	  if(!lls.at(i)->exportError().isEmpty()) {
+	    reason=tr("EXPORT FAILED")+": "+lls.at(i)->exportError();
 	  }
+	  render_line_messages[i].
+	    push_back(ProgressText(current_time,i,tr("FAIL"),
+				   lls.at(i)->summary()+" ("+reason+")"));
+	  render_line_warnings[i].
+	    push_back(lls.at(i)->summary()+tr("at line")+
+		      QString().sprintf(" %d ",i)+
+		      tr("failed to play")+" ("+reason+")");
 	}
 	else {
-	  ProgressMessage(current_time,lls.size()-1,
-			  tr("STOP"),tr("--- end of log ---"));
+	  render_line_messages[i].
+	    push_back(ProgressText(current_time,i,tr("SKIP"),
+				   lls.at(i)->summary()));
 	}
       }
+      else {
+	render_line_messages[i].
+	  push_back(ProgressText(current_time,lls.size()-1,
+				 tr("STOP"),tr("--- end of log ---")));
+      }
     }
   }
-  sf_close(sf_out);
 
-  return true;
+  //
+  // Release any audio left over and mark the segment complete
+  //
+  for(unsigned i=first;i<=last;i++) {
+    lls.at(i)->close();
+  }
+  if(seg>0) {
+    sf_close(sf);
+  }
+  pthread_mutex_lock(&render_mutex);
+  render_segment_lines[seg]=last+1;
+  pthread_cond_signal(&render_cond);
+  pthread_mutex_unlock(&render_mutex);
+}
+
+
+void RDRenderer::WaitForWorkers()
+{
+  //
+  // Called with render_mutex held.  Rather than blocking outright, keep
+  // the event loop of the calling thread going, so that progress is
+  // shown and abort() can be invoked while the workers run.
+  //
+  struct timeval tv;
+  struct timespec ts;
+
+  gettimeofday(&tv,NULL);
+  ts.tv_sec=tv.tv_sec;
+  ts.tv_nsec=1000*tv.tv_usec+1000000*RDRENDERER_EVENT_INTERVAL;
+  if(ts.tv_nsec>=1000000000) {
+    ts.tv_sec+=ts.tv_nsec/1000000000;
+    ts.tv_nsec=ts.tv_nsec%1000000000;
+  }
+  if(pthread_cond_timedwait(&render_cond,&render_mutex,&ts)==ETIMEDOUT) {
+    pthread_mutex_unlock(&render_mutex);
+    QCoreApplication::processEvents();
+    pthread_mutex_lock(&render_mutex);
+  }
+}
+
+
+unsigned RDRenderer::FinishedLine(unsigned final_line) const
+{
+  //
+  // Every line before the returned one has been rendered
+  //
+  for(unsigned i=0;i<render_segment_firsts.size();i++) {
+    if(render_segment_lines.at(i)<=render_segment_lasts.at(i)) {
+      return render_segment_lines.at(i);
+    }
+  }
+  return final_line;
 }
 
 
 void RDRenderer::Sum(float *pcm_out,__RDRenderLogLine *ll,sf_count_t frames,
-		     unsigned chans)
+		     unsigned chans) const
 {
-  if(ll->handle()!=NULL) {
+  if(ll->isOpen()) {
     float *pcm=new float[frames*chans];
-
-    memset(pcm,0,frames*chans);
-    sf_count_t n=sf_readf_float(ll->handle(),pcm,frames);
-    for(sf_count_t i=0;i<n;i+=chans) {
-      double ratio=exp10(((double)i*ll->rampRate()+ll->rampLevel())/2000.0);
-      for(sf_count_t j=0;j<chans;j++) {
-	pcm_out[i*chans+j]+=ratio*pcm[i*chans+j];
+    sf_count_t n=ll->read(pcm,frames);
+    double rate=ll->rampRate();
+    double level=ll->rampLevel();
+
+    if(rate==0.0) {
+      //
+      // Constant gain
+      //
+      float ratio=exp10(level/2000.0);
+      float *__restrict out=pcm_out;
+      const float *__restrict in=pcm;
+      for(sf_count_t i=0;i<(n*chans);i++) {
+	out[i]+=ratio*in[i];
+      }
+    }
+    else {
+      //
+      // Gain ramp, evaluated exactly at the start of each block and
+      // stepped geometrically within it
+      //
+      float ratios[RDRENDERER_RAMP_BLOCK];
+      double step=exp10(rate/2000.0);
+      for(sf_count_t i=0;i<n;i+=RDRENDERER_RAMP_BLOCK) {
+	sf_count_t len=n-i;
+	if(len>RDRENDERER_RAMP_BLOCK) {
+	  len=RDRENDERER_RAMP_BLOCK;
+	}
+	double ratio=exp10(((double)i*rate+level)/2000.0);
+	for(sf_count_t j=0;j<len;j++) {
+	  ratios[j]=ratio;
+	  ratio*=step;
+	}
+	float *__restrict out=pcm_out+i*chans;
+	const float *__restrict in=pcm+i*chans;
+	if(chans==2) {
+	  for(sf_count_t j=0;j<len;j++) {
+	    out[2*j]+=ratios[j]*in[2*j];
+	    out[2*j+1]+=ratios[j]*in[2*j+1];
+	  }
+	}
+	else {
+	  for(sf_count_t j=0;j<len;j++) {
+	    for(unsigned k=0;k<chans;k++) {
+	      out[j*chans+k]+=ratios[j]*in[j*chans+k];
+	    }
+	  }
+	}
       }
     }
-    ll->setRampLevel((double)n*ll->rampRate()+ll->rampLevel());
+    ll->setRampLevel((double)n*rate+level);
     if(n<frames) {
       ll->close();
     }
-    delete pcm;
+    delete[] pcm;
+  }
+}
+
+
+bool RDRenderer::AppendSegment(const QString &filename,unsigned chans) const
+{
+  SF_INFO sf_info;
+  SNDFILE *sf=NULL;
+  sf_count_t n;
+  bool ret=true;
+
+  memset(&sf_info,0,sizeof(sf_info));
+  if((sf=sf_open(filename.toUtf8(),SFM_READ,&sf_info))==NULL) {
+    return false;
+  }
+  float *pcm=new float[RDRENDERER_SEGMENT_BLOCK*chans];
+  while(ret&&((n=sf_readf_float(sf,pcm,RDRENDERER_SEGMENT_BLOCK))>0)) {
+    ret=render_sink->write(pcm,n);
   }
+  delete[] pcm;
+  sf_close(sf);
+
+  return ret;
+}
+
+
+void RDRenderer::DeleteLines(std::vector<__RDRenderLogLine *> *lls) const
+{
+  for(unsigned i=0;i<lls->size();i++) {
+    delete lls->at(i);
+  }
+  lls->clear();
 }
 
 
@@ -644,7 +1249,7 @@ void RDRenderer::DeleteTempFile(const QString &filename) const
 
 uint64_t RDRenderer::FramesFromMsec(uint64_t msec) const
 {
-  return msec*rda->system()->sampleRate()/1000;
+  return msec*render_sample_rate/1000;
 }
 
 
@@ -657,8 +1262,32 @@ void RDRenderer::ProgressMessage(const QString &msg)
 void RDRenderer::ProgressMessage(const QTime &time,int line,
 				 const QString &trans,const QString &msg)
 {
-  QString str=QString().sprintf("%04d : ",line)+
+  emit progressMessageSent(ProgressText(time,line,trans,msg));
+}
+
+
+QString RDRenderer::ProgressText(const QTime &time,int line,
+				 const QString &trans,const QString &msg) const
+{
+  return QString().sprintf("%04d : ",line)+
     time.toString("hh:mm:ss")+" : "+
     QString().sprintf("%-5s",trans.toUtf8().constData())+msg;
-  emit progressMessageSent(str);
+}
+
+
+void *RDRenderer::WorkerCallback(void *priv)
+{
+  RDRenderer *r=(RDRenderer *)priv;
+  unsigned seg;
+
+  while(1) {
+    pthread_mutex_lock(&r->render_mutex);
+    seg=r->render_next_segment++;
+    pthread_mutex_unlock(&r->render_mutex);
+    if(seg>=r->render_segment_firsts.size()) {
+      return NULL;
+    }
+    r->RenderSegment(seg);
+  }
+  return NULL;
 }
@@ -21,42 +21,103 @@
 #ifndef RDRENDERER_H
 #define RDRENDERER_H
 
+#include <pthread.h>
 #include <stdint.h>
 
+#include <vector>
+
 #include <sndfile.h>
 
 #include <qobject.h>
 #include <qstringlist.h>
 
+#include <rdcutdecoder.h>
 #include <rdlogmodel.h>
+#include <rdrendersink.h>
 #include <rdsettings.h>
 
+//
+// Number of log lines decoded (or exported) ahead of the one being mixed
+//
+#define RDRENDERER_PREFETCH_LINES 3
+
+//
+// Number of segments into which the log is split for each worker thread
+//
+#define RDRENDERER_SEGMENTS_PER_WORKER 4
+
+//
+// Frames over which a gain ramp is stepped between exact evaluations
+//
+#define RDRENDERER_RAMP_BLOCK 1024
+
+//
+// Interval at which events are processed while waiting for the
+// workers (mS)
+//
+#define RDRENDERER_EVENT_INTERVAL 100
+
+//
+// Frames copied at a time when stitching segments onto the output
+//
+#define RDRENDERER_SEGMENT_BLOCK 16384
+
 class __RDRenderLogLine : public RDLogLine
 {
  public:
-  __RDRenderLogLine(RDLogLine *ll,unsigned chans);
+  __RDRenderLogLine(RDLogLine *ll,unsigned chans,unsigned samprate);
+  ~__RDRenderLogLine();
   RDCart *cart() const;
   RDCut *cut() const;
-  SNDFILE *handle() const;
+  bool isOpen() const;
+  sf_count_t read(float *pcm,sf_count_t frames);
   double rampLevel() const;
   void setRampLevel(double lvl);
   double rampRate() const;
   void setRampRate(double lvl);
   void setRamp(RDLogLine::TransType next_trans,int segue_gain);
-  bool open(const QTime &time);
+  QTime renderTime() const;
+  void setRenderTime(const QTime &time);
+  int playLength(RDLogLine::TransType next_trans) const;
+  int audioLength() const;
+  bool select();
+  void setExportService(const QString &url,const QString &username,
+			const QString &password);
+  QString exportError() const;
+  void prefetch();
+  bool open();
   void close();
   QString summary() const;
 
  private:
+  void Prepare();
+  static void *DecodeCallback(void *priv);
   bool GetCutFile(const QString &cutname,int start_pt,int end_pt,
-		  QString *dest_filename) const;
+		  QString *dest_filename,QString *err_msg) const;
   void DeleteCutFile(const QString &dest_filename) const;
   uint64_t FramesFromMsec(uint64_t msec);
   RDCart *ll_cart;
   RDCut *ll_cut;
   SNDFILE *ll_handle;
-  RDLogLine *ll_logline;
+  RDCutDecoder *ll_decoder;
+  bool ll_selected;
+  bool ll_direct;
+  bool ll_prepared;
+  bool ll_decoded;
+  pthread_t ll_thread;
+  bool ll_thread_running;
+  QString ll_cutname;
+  QString ll_pathname;
+  QString ll_export_filename;
+  QString ll_export_url;
+  QString ll_export_username;
+  QString ll_export_password;
+  QString ll_export_error;
+  int ll_cut_start_point;
+  int ll_cut_end_point;
+  QTime ll_render_time;
   unsigned ll_channels;
+  unsigned ll_sample_rate;
   double ll_ramp_level;
   double ll_ramp_rate;
 };
@@ -80,7 +141,14 @@ class RDRenderer : public QObject
 		    QString *err_msg,int first_line,int last_line,
 		    const QTime &first_time=QTime(),
 		    const QTime &last_time=QTime());
+  bool renderToSink(RDRenderSink *sink,RDLogModel *model,RDSettings *s,
+		    const QTime &start_time,bool ignore_stops,
+		    QString *err_msg,int first_line,int last_line,
+		    const QTime &first_time=QTime(),
+		    const QTime &last_time=QTime());
   QStringList warnings() const;
+  int workers() const;
+  void setWorkers(int n);
 
  public slots:
   void abort();
@@ -90,12 +158,18 @@ class RDRenderer : public QObject
   void lineStarted(int linno,int totallines);
 
  private:
-  bool Render(const QString &outfile,RDLogModel *model,RDSettings *s,
+  bool Render(RDRenderSink *sink,RDLogModel *model,RDSettings *s,
 	      const QTime &start_time,bool ignore_stops,
 	      QString *err_msg,int first_line,int last_line,
 	      const QTime &first_time,const QTime &last_time);
+  void RenderSegment(unsigned seg);
+  void WaitForWorkers();
+  unsigned FinishedLine(unsigned final_line) const;
   void Sum(float *pcm_out,__RDRenderLogLine *ll,sf_count_t frames,
-	   unsigned chans);
+	   unsigned chans) const;
+  bool AppendSegment(const QString &filename,unsigned chans) const;
+  void DeleteLines(std::vector<__RDRenderLogLine *> *lls) const;
+  static void *WorkerCallback(void *priv);
   bool ConvertAudio(const QString &srcfile,const QString &dstfile,
 		    RDSettings *s,QString *err_msg);
   bool ImportCart(const QString &srcfile,unsigned cartnum,int cutnum,
@@ -105,9 +179,27 @@ class RDRenderer : public QObject
   void ProgressMessage(const QString &msg);
   void ProgressMessage(const QTime &time,int line,const QString &trans,
 		       const QString &msg);
+  QString ProgressText(const QTime &time,int line,const QString &trans,
+		       const QString &msg) const;
   QStringList render_warnings;
   bool render_abort;
   int render_total_passes;
+  int render_workers;
+  unsigned render_sample_rate;
+  unsigned render_channels;
+  RDRenderSink *render_sink;
+  bool render_sink_failed;
+  std::vector<__RDRenderLogLine *> render_lines;
+  std::vector<QStringList> render_line_messages;
+  std::vector<QStringList> render_line_warnings;
+  std::vector<unsigned> render_segment_firsts;
+  std::vector<unsigned> render_segment_lasts;
+  std::vector<unsigned> render_segment_lines;
+  std::vector<SNDFILE *> render_segment_handles;
+  std::vector<QString> render_segment_filenames;
+  unsigned render_next_segment;
+  pthread_mutex_t render_mutex;
+  pthread_cond_t render_cond;
 };
 
 
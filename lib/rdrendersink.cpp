@@ -0,0 +1,693 @@
+// rdrendersink.cpp
+//
+// Destinations for audio rendered by RDRenderer.
+//
+//   (C) Copyright 2021 Fred Gleason <fredg@paravelsystems.com>
+//
+//   This program is free software; you can redistribute it and/or modify
+//   it under the terms of the GNU General Public License version 2 as
+//   published by the Free Software Foundation.
+//
+//   This program is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//   GNU General Public License for more details.
+//
+//   You should have received a copy of the GNU General Public
+//   License along with this program; if not, write to the Free Software
+//   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+//
+
+#include <errno.h>
+#include <math.h>
+#include <netdb.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <qfileinfo.h>
+#include <qobject.h>
+
+#include "rdapplication.h"
+#include "rdcart.h"
+#include "rdcut.h"
+#include "rdhash.h"
+#include "rdlibrary_conf.h"
+#include "rdrendersink.h"
+
+RDRenderSink::RDRenderSink()
+{
+  sink_sample_rate=0;
+  sink_channels=0;
+  sink_format=RDSettings::Pcm16;
+  sink_frames=0;
+  sink_open=false;
+}
+
+
+RDRenderSink::~RDRenderSink()
+{
+}
+
+
+unsigned RDRenderSink::sampleRate() const
+{
+  return sink_sample_rate;
+}
+
+
+unsigned RDRenderSink::channels() const
+{
+  return sink_channels;
+}
+
+
+RDSettings::Format RDRenderSink::format() const
+{
+  return sink_format;
+}
+
+
+sf_count_t RDRenderSink::frames() const
+{
+  return sink_frames;
+}
+
+
+bool RDRenderSink::open(unsigned samprate,unsigned chans,
+			RDSettings::Format fmt,QString *err_msg)
+{
+  if((fmt!=RDSettings::Pcm16)&&(fmt!=RDSettings::Pcm24)) {
+    *err_msg=QObject::tr("unsupported output format");
+    return false;
+  }
+  sink_sample_rate=samprate;
+  sink_channels=chans;
+  sink_format=fmt;
+  sink_frames=0;
+  if(!OpenSink(err_msg)) {
+    return false;
+  }
+  sink_open=true;
+  return true;
+}
+
+
+bool RDRenderSink::write(const float *pcm,sf_count_t frames)
+{
+  if(!sink_open) {
+    return false;
+  }
+  if(frames==0) {
+    return true;
+  }
+  sink_frames+=frames;
+  return WriteSink(pcm,frames);
+}
+
+
+bool RDRenderSink::close(QString *err_msg)
+{
+  if(!sink_open) {
+    return false;
+  }
+  sink_open=false;
+  return CloseSink(err_msg);
+}
+
+
+void RDRenderSink::cancel()
+{
+  if(sink_open) {
+    sink_open=false;
+    CancelSink();
+  }
+}
+
+
+void RDRenderSink::CancelSink()
+{
+  QString err_msg;
+
+  CloseSink(&err_msg);
+}
+
+
+int RDRenderSink::SfFormat() const
+{
+  if(sink_format==RDSettings::Pcm24) {
+    return SF_FORMAT_WAV|SF_FORMAT_PCM_24;
+  }
+  return SF_FORMAT_WAV|SF_FORMAT_PCM_16;
+}
+
+
+unsigned RDRenderSink::BytesPerSample() const
+{
+  if(sink_format==RDSettings::Pcm24) {
+    return 3;
+  }
+  return 2;
+}
+
+
+void RDRenderSink::ToPcm(const float *pcm,sf_count_t frames,
+			 std::vector<unsigned char> *data) const
+{
+  sf_count_t samples=frames*sink_channels;
+  int32_t sample;
+
+  data->resize(samples*BytesPerSample());
+  unsigned char *out=data->data();
+  if(sink_format==RDSettings::Pcm24) {
+    for(sf_count_t i=0;i<samples;i++) {
+      if(pcm[i]>=1.0) {
+	sample=0x7FFFFF;
+      }
+      else {
+	if(pcm[i]<-1.0) {
+	  sample=-0x800000;
+	}
+	else {
+	  sample=lrintf(pcm[i]*(float)0x800000);
+	}
+      }
+      out[3*i]=0xFF&sample;
+      out[3*i+1]=0xFF&(sample>>8);
+      out[3*i+2]=0xFF&(sample>>16);
+    }
+  }
+  else {
+    for(sf_count_t i=0;i<samples;i++) {
+      if(pcm[i]>=1.0) {
+	sample=0x7FFF;
+      }
+      else {
+	if(pcm[i]<-1.0) {
+	  sample=-0x8000;
+	}
+	else {
+	  sample=lrintf(pcm[i]*(float)0x8000);
+	}
+      }
+      out[2*i]=0xFF&sample;
+      out[2*i+1]=0xFF&(sample>>8);
+    }
+  }
+}
+
+
+
+
+RDRenderFileSink::RDRenderFileSink(const QString &filename)
+  : RDRenderSink()
+{
+  file_filename=filename;
+  file_handle=NULL;
+}
+
+
+bool RDRenderFileSink::OpenSink(QString *err_msg)
+{
+  SF_INFO sf_info;
+
+  memset(&sf_info,0,sizeof(sf_info));
+  sf_info.samplerate=sampleRate();
+  sf_info.channels=channels();
+  sf_info.format=SfFormat();
+  if((file_handle=sf_open(file_filename.toUtf8(),SFM_WRITE,&sf_info))==NULL) {
+    *err_msg=QObject::tr("unable to open output file")+" ["+
+      sf_strerror(NULL)+"]";
+    return false;
+  }
+  return true;
+}
+
+
+bool RDRenderFileSink::WriteSink(const float *pcm,sf_count_t frames)
+{
+  return sf_writef_float(file_handle,pcm,frames)==frames;
+}
+
+
+bool RDRenderFileSink::CloseSink(QString *err_msg)
+{
+  sf_close(file_handle);
+  file_handle=NULL;
+  return true;
+}
+
+
+
+
+RDRenderStreamSink::RDRenderStreamSink(int fd)
+  : RDRenderSink()
+{
+  stream_fd=fd;
+}
+
+
+bool RDRenderStreamSink::OpenSink(QString *err_msg)
+{
+  unsigned char hdr[44];
+  uint32_t block_align=channels()*BytesPerSample();
+  uint32_t byte_rate=sampleRate()*block_align;
+
+  if(stream_fd<0) {
+    *err_msg=QObject::tr("no output stream");
+    return false;
+  }
+  memcpy(hdr,"RIFF",4);
+  memset(hdr+4,0xFF,4);
+  memcpy(hdr+8,"WAVEfmt ",8);
+  hdr[16]=16;
+  hdr[17]=0;
+  hdr[18]=0;
+  hdr[19]=0;
+  hdr[20]=1;  // WAVE_FORMAT_PCM
+  hdr[21]=0;
+  hdr[22]=0xFF&channels();
+  hdr[23]=0;
+  for(int i=0;i<4;i++) {
+    hdr[24+i]=0xFF&(sampleRate()>>(8*i));
+    hdr[28+i]=0xFF&(byte_rate>>(8*i));
+  }
+  hdr[32]=0xFF&block_align;
+  hdr[33]=0xFF&(block_align>>8);
+  hdr[34]=8*BytesPerSample();
+  hdr[35]=0;
+  memcpy(hdr+36,"data",4);
+  memset(hdr+40,0xFF,4);
+  if(!WriteData(hdr,44)) {
+    *err_msg=QObject::tr("unable to write to output stream")+" ["+
+      strerror(errno)+"]";
+    return false;
+  }
+  return true;
+}
+
+
+bool RDRenderStreamSink::WriteSink(const float *pcm,sf_count_t frames)
+{
+  ToPcm(pcm,frames,&stream_buffer);
+  return WriteData(stream_buffer.data(),stream_buffer.size());
+}
+
+
+bool RDRenderStreamSink::CloseSink(QString *err_msg)
+{
+  std::vector<unsigned char>().swap(stream_buffer);
+  return true;
+}
+
+
+void RDRenderStreamSink::setDescriptor(int fd)
+{
+  stream_fd=fd;
+}
+
+
+bool RDRenderStreamSink::WriteData(const unsigned char *data,size_t len)
+{
+  ssize_t n;
+
+  while(len>0) {
+    if((n=::write(stream_fd,data,len))<0) {
+      if(errno==EINTR) {
+	continue;
+      }
+      return false;
+    }
+    data+=n;
+    len-=n;
+  }
+  return true;
+}
+
+
+
+
+RDRenderSocketSink::RDRenderSocketSink(const QString &hostname,uint16_t port)
+  : RDRenderStreamSink()
+{
+  socket_hostname=hostname;
+  socket_port=port;
+  socket_fd=-1;
+}
+
+
+bool RDRenderSocketSink::OpenSink(QString *err_msg)
+{
+  struct addrinfo hints;
+  struct addrinfo *addrs=NULL;
+  int err;
+
+  memset(&hints,0,sizeof(hints));
+  hints.ai_family=AF_UNSPEC;
+  hints.ai_socktype=SOCK_STREAM;
+  if((err=getaddrinfo(socket_hostname.toUtf8(),
+		      QString().sprintf("%u",socket_port).toUtf8(),
+		      &hints,&addrs))!=0) {
+    *err_msg=QObject::tr("unable to resolve host")+" \""+socket_hostname+
+      "\" ["+gai_strerror(err)+"]";
+    return false;
+  }
+  for(struct addrinfo *addr=addrs;addr!=NULL;addr=addr->ai_next) {
+    if((socket_fd=socket(addr->ai_family,addr->ai_socktype,
+			 addr->ai_protocol))<0) {
+      continue;
+    }
+    if(connect(socket_fd,addr->ai_addr,addr->ai_addrlen)==0) {
+      break;
+    }
+    ::close(socket_fd);
+    socket_fd=-1;
+  }
+  freeaddrinfo(addrs);
+  if(socket_fd<0) {
+    *err_msg=QObject::tr("unable to connect to")+" "+socket_hostname+
+      QString().sprintf(":%u",socket_port)+" ["+strerror(errno)+"]";
+    return false;
+  }
+  setDescriptor(socket_fd);
+  if(!RDRenderStreamSink::OpenSink(err_msg)) {
+    ::close(socket_fd);
+    socket_fd=-1;
+    return false;
+  }
+  return true;
+}
+
+
+bool RDRenderSocketSink::CloseSink(QString *err_msg)
+{
+  bool ret=RDRenderStreamSink::CloseSink(err_msg);
+
+  shutdown(socket_fd,SHUT_WR);
+  ::close(socket_fd);
+  socket_fd=-1;
+  setDescriptor(-1);
+
+  return ret;
+}
+
+
+void RDRenderSocketSink::CancelSink()
+{
+  ::close(socket_fd);
+  socket_fd=-1;
+  setDescriptor(-1);
+}
+
+
+
+
+RDRenderChunkSink::RDRenderChunkSink(const QString &basename,int chunk_secs)
+  : RDRenderSink()
+{
+  chunk_basename=basename;
+  chunk_length=chunk_secs;
+  if(chunk_length<=0) {
+    chunk_length=RDRENDERSINK_DEFAULT_CHUNK_LENGTH;
+  }
+  chunk_handle=NULL;
+  chunk_frames=0;
+}
+
+
+bool RDRenderChunkSink::OpenSink(QString *err_msg)
+{
+  chunk_lengths.clear();
+  if(!OpenChunk()) {
+    *err_msg=QObject::tr("unable to open output file")+" \""+
+      ChunkName(0)+"\" ["+sf_strerror(NULL)+"]";
+    return false;
+  }
+  if(!WritePlaylist(false)) {
+    *err_msg=QObject::tr("unable to write playlist")+" ["+
+      strerror(errno)+"]";
+    return false;
+  }
+  return true;
+}
+
+
+bool RDRenderChunkSink::WriteSink(const float *pcm,sf_count_t frames)
+{
+  sf_count_t max_frames=(sf_count_t)chunk_length*sampleRate();
+
+  while(frames>0) {
+    sf_count_t n=max_frames-chunk_frames;
+    if(n>frames) {
+      n=frames;
+    }
+    if(sf_writef_float(chunk_handle,pcm,n)!=n) {
+      return false;
+    }
+    chunk_frames+=n;
+    pcm+=n*channels();
+    frames-=n;
+    if(chunk_frames==max_frames) {
+      if((!CloseChunk(false))||(!OpenChunk())) {
+	return false;
+      }
+    }
+  }
+  return true;
+}
+
+
+bool RDRenderChunkSink::CloseSink(QString *err_msg)
+{
+  if(!CloseChunk(true)) {
+    *err_msg=QObject::tr("unable to write playlist")+" ["+
+      strerror(errno)+"]";
+    return false;
+  }
+  return true;
+}
+
+
+bool RDRenderChunkSink::OpenChunk()
+{
+  SF_INFO sf_info;
+
+  memset(&sf_info,0,sizeof(sf_info));
+  sf_info.samplerate=sampleRate();
+  sf_info.channels=channels();
+  sf_info.format=SfFormat();
+  chunk_frames=0;
+  chunk_handle=sf_open(ChunkName(chunk_lengths.size()).toUtf8(),SFM_WRITE,
+		       &sf_info);
+  return chunk_handle!=NULL;
+}
+
+
+bool RDRenderChunkSink::CloseChunk(bool last)
+{
+  sf_close(chunk_handle);
+  chunk_handle=NULL;
+  if(last&&(chunk_frames==0)&&(chunk_lengths.size()>0)) {
+    unlink(ChunkName(chunk_lengths.size()).toUtf8());
+  }
+  else {
+    chunk_lengths.push_back((double)chunk_frames/(double)sampleRate());
+  }
+  return WritePlaylist(last);
+}
+
+
+bool RDRenderChunkSink::WritePlaylist(bool last) const
+{
+  FILE *f=NULL;
+  QString filename=chunk_basename+".m3u8";
+  QString tempname=filename+".tmp";
+
+  if((f=fopen(tempname.toUtf8(),"w"))==NULL) {
+    return false;
+  }
+  fprintf(f,"#EXTM3U\n");
+  fprintf(f,"#EXT-X-VERSION:3\n");
+  fprintf(f,"#EXT-X-TARGETDURATION:%d\n",chunk_length);
+  fprintf(f,"#EXT-X-MEDIA-SEQUENCE:0\n");
+  fprintf(f,"#EXT-X-PLAYLIST-TYPE:%s\n",last ? "VOD" : "EVENT");
+  for(unsigned i=0;i<chunk_lengths.size();i++) {
+    fprintf(f,"#EXTINF:%.3f,\n",chunk_lengths.at(i));
+    fprintf(f,"%s\n",QFileInfo(ChunkName(i)).fileName().toUtf8().constData());
+  }
+  if(last) {
+    fprintf(f,"#EXT-X-ENDLIST\n");
+  }
+  if(fclose(f)!=0) {
+    unlink(tempname.toUtf8());
+    return false;
+  }
+  return rename(tempname.toUtf8(),filename.toUtf8())==0;
+}
+
+
+QString RDRenderChunkSink::ChunkName(unsigned n) const
+{
+  return chunk_basename+QString().sprintf("-%05u.wav",n);
+}
+
+
+
+
+RDRenderCutSink::RDRenderCutSink(unsigned cartnum,int cutnum)
+  : RDRenderSink()
+{
+  cut_cart_number=cartnum;
+  cut_cut_number=cutnum;
+  cut_wave=NULL;
+  cut_analysis=new RDAudioAnalysis();
+}
+
+
+RDRenderCutSink::~RDRenderCutSink()
+{
+  if(cut_wave!=NULL) {
+    delete cut_wave;
+  }
+  delete cut_analysis;
+}
+
+
+bool RDRenderCutSink::canWrite(unsigned cartnum,int cutnum,
+			       RDSettings::Format *fmt)
+{
+  RDLibraryConf *conf=new RDLibraryConf(rda->config()->stationName());
+  switch(conf->defaultFormat()) {
+  case 0:
+    *fmt=RDSettings::Pcm16;
+    break;
+
+  case 2:
+    *fmt=RDSettings::Pcm24;
+    break;
+
+  default:
+    delete conf;
+    return false;
+  }
+  delete conf;
+  QFileInfo info(RDCut::pathName(cartnum,cutnum));
+
+  return access(info.path().toUtf8(),W_OK)==0;
+}
+
+
+bool RDRenderCutSink::OpenSink(QString *err_msg)
+{
+  RDWaveData wavedata;
+
+  cut_temp_filename=RDCut::pathName(cut_cart_number,cut_cut_number)+
+    QString().sprintf(".%d.tmp",getpid());
+
+  //
+  // Cart metadata, as for an import. The cut markers are left out, as
+  // they will be reset when the new audio is checked in.
+  //
+  RDCart *cart=new RDCart(cut_cart_number);
+  cart->getMetadata(&wavedata);
+  delete cart;
+  wavedata.setCutName(RDCut::cutName(cut_cart_number,cut_cut_number));
+  wavedata.setCutNumber(cut_cut_number);
+
+  cut_wave=new RDWaveFile(cut_temp_filename);
+  cut_wave->setFormatTag(WAVE_FORMAT_PCM);
+  cut_wave->setChannels(channels());
+  cut_wave->setSamplesPerSec(sampleRate());
+  cut_wave->setBitsPerSample(8*BytesPerSample());
+  cut_wave->setBextChunk(true);
+  cut_wave->setCartChunk(true);
+  cut_wave->setLevlChunk(true);
+  unlink(cut_temp_filename.toUtf8());
+  if(!cut_wave->createWave(&wavedata)) {
+    *err_msg=QObject::tr("unable to open audio store file")+" ["+
+      strerror(errno)+"]";
+    delete cut_wave;
+    cut_wave=NULL;
+    return false;
+  }
+  chown(cut_temp_filename.toUtf8(),rda->config()->uid(),
+	rda->config()->gid());
+  cut_analysis->start(sampleRate(),channels());
+  return true;
+}
+
+
+bool RDRenderCutSink::WriteSink(const float *pcm,sf_count_t frames)
+{
+  cut_analysis->addFrames(pcm,frames);
+  ToPcm(pcm,frames,&cut_buffer);
+  return cut_wave->writeWave(cut_buffer.data(),cut_buffer.size())==
+    (int)cut_buffer.size();
+}
+
+
+bool RDRenderCutSink::CloseSink(QString *err_msg)
+{
+  QString cutname=RDCut::cutName(cut_cart_number,cut_cut_number);
+  QString filename=RDCut::pathName(cutname);
+  RDSettings settings;
+  int length_deviation=0;
+
+  cut_wave->closeWave();
+  delete cut_wave;
+  cut_wave=NULL;
+  std::vector<unsigned char>().swap(cut_buffer);
+  cut_analysis->finish();
+
+  //
+  // Move the new audio into place
+  //
+  RDAudioAnalysis::removeSidecar(filename);
+  unlink((filename+".energy").toUtf8());
+  unlink((filename+".frames").toUtf8());
+  if(rename(cut_temp_filename.toUtf8(),filename.toUtf8())!=0) {
+    *err_msg=QObject::tr("unable to write audio store file")+" ["+
+      strerror(errno)+"]";
+    unlink(cut_temp_filename.toUtf8());
+    return false;
+  }
+
+  //
+  // Check it in
+  //
+  settings.setFormat(format());
+  settings.setChannels(channels());
+  settings.setSampleRate(sampleRate());
+  settings.setNormalizationLevel(0);
+  RDCart *cart=new RDCart(cut_cart_number);
+  RDCut *cut=new RDCut(cutname);
+  cut->checkInRecording(rda->config()->stationName(),rda->user()->name(),
+			rda->config()->stationName(),&settings,
+			cut_analysis->length());
+  cut_analysis->setSha1Hash(RDSha1Hash(filename));
+  cut_analysis->save(filename);
+  cut->setAnalysis(cut_analysis);
+  cart->updateLength();
+  cart->resetRotation();
+  cart->calculateAverageLength(&length_deviation);
+  cart->setLengthDeviation(length_deviation);
+  rda->ripc()->sendNotification(RDNotification::CartType,
+				RDNotification::ModifyAction,
+				QVariant(cut_cart_number));
+  delete cut;
+  delete cart;
+
+  return true;
+}
+
+
+void RDRenderCutSink::CancelSink()
+{
+  cut_wave->closeWave();
+  delete cut_wave;
+  cut_wave=NULL;
+  std::vector<unsigned char>().swap(cut_buffer);
+  unlink(cut_temp_filename.toUtf8());
+}
@@ -0,0 +1,229 @@
+// rdrendersink.h
+//
+// Destinations for audio rendered by RDRenderer.
+//
+//   (C) Copyright 2021 Fred Gleason <fredg@paravelsystems.com>
+//
+//   This program is free software; you can redistribute it and/or modify
+//   it under the terms of the GNU General Public License version 2 as
+//   published by the Free Software Foundation.
+//
+//   This program is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//   GNU General Public License for more details.
+//
+//   You should have received a copy of the GNU General Public
+//   License along with this program; if not, write to the Free Software
+//   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+//
+
+#ifndef RDRENDERSINK_H
+#define RDRENDERSINK_H
+
+#include <stdint.h>
+
+#include <vector>
+
+#include <sndfile.h>
+
+#include <qstring.h>
+
+#include <rdaudioanalysis.h>
+#include <rdsettings.h>
+#include <rdwavefile.h>
+
+//
+// Default length of the files written by RDRenderChunkSink
+//
+#define RDRENDERSINK_DEFAULT_CHUNK_LENGTH 10
+
+//
+// RDRenderSink
+//
+// Base class for a destination of rendered audio. The renderer calls
+// open() and close() from the main thread; write() is called in log
+// order as soon as audio has been mixed, possibly from a worker thread
+// but never from more than one thread at a time. Only the Pcm16 and
+// Pcm24 formats are supported.
+//
+class RDRenderSink
+{
+ public:
+  RDRenderSink();
+  virtual ~RDRenderSink();
+  unsigned sampleRate() const;
+  unsigned channels() const;
+  RDSettings::Format format() const;
+  sf_count_t frames() const;
+  bool open(unsigned samprate,unsigned chans,RDSettings::Format fmt,
+	    QString *err_msg);
+  bool write(const float *pcm,sf_count_t frames);
+  bool close(QString *err_msg);
+  void cancel();
+
+ protected:
+  virtual bool OpenSink(QString *err_msg)=0;
+  virtual bool WriteSink(const float *pcm,sf_count_t frames)=0;
+  virtual bool CloseSink(QString *err_msg)=0;
+  virtual void CancelSink();
+  int SfFormat() const;
+  unsigned BytesPerSample() const;
+  void ToPcm(const float *pcm,sf_count_t frames,
+	     std::vector<unsigned char> *data) const;
+
+ private:
+  unsigned sink_sample_rate;
+  unsigned sink_channels;
+  RDSettings::Format sink_format;
+  sf_count_t sink_frames;
+  bool sink_open;
+};
+
+
+
+
+//
+// RDRenderFileSink
+//
+// Write a WAV file.
+//
+class RDRenderFileSink : public RDRenderSink
+{
+ public:
+  RDRenderFileSink(const QString &filename);
+
+ protected:
+  bool OpenSink(QString *err_msg);
+  bool WriteSink(const float *pcm,sf_count_t frames);
+  bool CloseSink(QString *err_msg);
+
+ private:
+  QString file_filename;
+  SNDFILE *file_handle;
+};
+
+
+
+
+//
+// RDRenderStreamSink
+//
+// Write a WAV stream to a file descriptor (e.g. standard output or a
+// pipe). Since the length is not known when the header is sent, the
+// RIFF and data chunk sizes are set to their maximum values, as is
+// customary for streamed WAV.
+//
+class RDRenderStreamSink : public RDRenderSink
+{
+ public:
+  RDRenderStreamSink(int fd=-1);
+
+ protected:
+  bool OpenSink(QString *err_msg);
+  bool WriteSink(const float *pcm,sf_count_t frames);
+  bool CloseSink(QString *err_msg);
+  void setDescriptor(int fd);
+  bool WriteData(const unsigned char *data,size_t len);
+
+ private:
+  int stream_fd;
+  std::vector<unsigned char> stream_buffer;
+};
+
+
+
+
+//
+// RDRenderSocketSink
+//
+// Write a WAV stream to a TCP connection.
+//
+class RDRenderSocketSink : public RDRenderStreamSink
+{
+ public:
+  RDRenderSocketSink(const QString &hostname,uint16_t port);
+
+ protected:
+  bool OpenSink(QString *err_msg);
+  bool CloseSink(QString *err_msg);
+  void CancelSink();
+
+ private:
+  QString socket_hostname;
+  uint16_t socket_port;
+  int socket_fd;
+};
+
+
+
+
+//
+// RDRenderChunkSink
+//
+// Write a series of fixed-length WAV files named
+// '<basename>-<nnnnn>.wav', along with a '<basename>.m3u8' playlist
+// that is updated as each one is completed, for downstream segmenters
+// and encoders to pick up while rendering is still in progress.
+//
+class RDRenderChunkSink : public RDRenderSink
+{
+ public:
+  RDRenderChunkSink(const QString &basename,
+		    int chunk_secs=RDRENDERSINK_DEFAULT_CHUNK_LENGTH);
+
+ protected:
+  bool OpenSink(QString *err_msg);
+  bool WriteSink(const float *pcm,sf_count_t frames);
+  bool CloseSink(QString *err_msg);
+
+ private:
+  bool OpenChunk();
+  bool CloseChunk(bool last);
+  bool WritePlaylist(bool last) const;
+  QString ChunkName(unsigned n) const;
+  QString chunk_basename;
+  int chunk_length;
+  SNDFILE *chunk_handle;
+  sf_count_t chunk_frames;
+  std::vector<double> chunk_lengths;
+};
+
+
+
+
+//
+// RDRenderCutSink
+//
+// Write straight into the audio store file for a cut, analyzing the
+// audio on the way through, then check the cut in as a new recording.
+// The file is written through RDWaveFile, with the same cart, bext and
+// levl chunks as an import, to a temporary file alongside the cut and
+// only moved into place once rendering succeeds. Requires write access to
+// the audio store and a library default format of PCM16 or PCM24;
+// see canWrite().
+//
+class RDRenderCutSink : public RDRenderSink
+{
+ public:
+  RDRenderCutSink(unsigned cartnum,int cutnum);
+  ~RDRenderCutSink();
+  static bool canWrite(unsigned cartnum,int cutnum,RDSettings::Format *fmt);
+
+ protected:
+  bool OpenSink(QString *err_msg);
+  bool WriteSink(const float *pcm,sf_count_t frames);
+  bool CloseSink(QString *err_msg);
+  void CancelSink();
+
+ private:
+  unsigned cut_cart_number;
+  int cut_cut_number;
+  QString cut_temp_filename;
+  RDWaveFile *cut_wave;
+  std::vector<unsigned char> cut_buffer;
+  RDAudioAnalysis *cut_analysis;
+};
+
+
+#endif  // RDRENDERSINK_H
@@ -24,6 +24,7 @@
 
 #include "rdapplication.h"
 #include "rdconf.h"
+#include "rddbpool.h"
 #include "rddatedecode.h"
 #include "rdescape_string.h"
 #include "rdlog_line.h"
@@ -529,7 +530,7 @@ bool RDReport::generateReport(const QDate &startdate,const QDate &enddate,
       }
       sql=sql.left(sql.length()-2);
       sql+=")";
-      q1=new RDSqlQuery(sql);
+      q1=new RDSqlQuery(sql,RDDbPool::replica());
       while(q1->next()) {
 	sql=QString("insert into ELR_LINES set ")+
 	  "SERVICE_NAME=\""+RDEscapeString(mixname)+"\","+
@@ -30,6 +30,7 @@
 #include "rddb.h"
 #include "rdescape_string.h"
 #include "rdripc.h"
+#include "rdrowcache.h"
 
 RDRipc::RDRipc(RDStation *station,RDConfig *config,QObject *parent)
   : QObject(parent)
@@ -78,6 +79,12 @@ bool RDRipc::onairFlag() const
 }
 
 
+int RDRipc::socketDescriptor() const
+{
+  return ripc_socket->socketDescriptor();
+}
+
+
 void RDRipc::setUser(QString user)
 {
   SendCommand(QString("SU ")+user+"!");
@@ -415,6 +422,7 @@ void RDRipc::DispatchCommand()
       delete notify;
       return;
     }
+    RDRowCache::processNotification(notify);
     emit notificationReceived(notify);
     delete notify;
   }
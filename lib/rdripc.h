@@ -46,6 +46,7 @@ class RDRipc : public QObject
   QString user() const;
   QString station() const;
   bool onairFlag() const;
+  int socketDescriptor() const;
   void setUser(QString user);
   void setIgnoreMask(bool state);
   void connectHost(QString hostname,uint16_t hostport,QString password);
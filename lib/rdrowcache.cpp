@@ -0,0 +1,249 @@
+// rdrowcache.cpp
+//
+// Process-wide cache of configuration table rows
+//
+//   (C) Copyright 2021 Fred Gleason <fredg@paravelsystems.com>
+//
+//   This program is free software; you can redistribute it and/or modify
+//   it under the terms of the GNU General Public License version 2 as
+//   published by the Free Software Foundation.
+//
+//   This program is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//   GNU General Public License for more details.
+//
+//   You should have received a copy of the GNU General Public
+//   License along with this program; if not, write to the Free Software
+//   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+//
+
+#include <QDateTime>
+#include <QMap>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSqlRecord>
+#include <QStringList>
+
+#include "rd.h"
+#include "rddb.h"
+#include "rddbpool.h"
+#include "rdrowcache.h"
+
+class __RDRowCacheEntry
+{
+ public:
+  QSqlRecord record;
+  QDateTime loaded;
+};
+
+
+static QMutex __rd_rowcache_mutex;
+static int __rd_rowcache_ttl=DEFAULT_MYSQL_ROW_CACHE_TTL;
+static QMap<QString,__RDRowCacheEntry> __rd_rowcache_rows;
+static unsigned __rd_rowcache_generation=0;
+static quint64 __rd_rowcache_hits=0;
+static quint64 __rd_rowcache_misses=0;
+
+
+void RDRowCache::setConfig(RDConfig *config)
+{
+  RDRowCache::setTtl(config->mysqlRowCacheTtl());
+}
+
+
+void RDRowCache::setTtl(int secs)
+{
+  QMutexLocker locker(&__rd_rowcache_mutex);
+
+  __rd_rowcache_ttl=secs;
+  if(secs<=0) {
+    __rd_rowcache_rows.clear();
+    __rd_rowcache_generation++;
+  }
+}
+
+
+int RDRowCache::ttl()
+{
+  QMutexLocker locker(&__rd_rowcache_mutex);
+
+  return __rd_rowcache_ttl;
+}
+
+
+bool RDRowCache::isCacheable(const QString &table)
+{
+  return (table=="STATIONS")||(table=="RDAIRPLAY")||(table=="RDPANEL")||
+    (table=="GROUPS")||(table=="SERVICES")||(table=="USERS");
+}
+
+
+bool RDRowCache::value(const QString &table,const QString &name,
+		       const QVariant &test,const QString &param,
+		       QVariant *v,bool *valid)
+{
+  QString key=table+"\t"+name+"\t"+test.toString();
+  QDateTime now=QDateTime::currentDateTime();
+  QSqlRecord record;
+  unsigned generation=0;
+  bool found=false;
+
+  if(!RDRowCache::isCacheable(table)) {
+    return false;
+  }
+
+  __rd_rowcache_mutex.lock();
+  if(__rd_rowcache_ttl<=0) {
+    __rd_rowcache_mutex.unlock();
+    return false;
+  }
+  QMap<QString,__RDRowCacheEntry>::const_iterator ci=
+    __rd_rowcache_rows.constFind(key);
+  if((ci!=__rd_rowcache_rows.end())&&
+     (ci.value().loaded.secsTo(now)<__rd_rowcache_ttl)) {
+    record=ci.value().record;
+    __rd_rowcache_hits++;
+    found=true;
+  }
+  else {
+    __rd_rowcache_misses++;
+  }
+  generation=__rd_rowcache_generation;
+  __rd_rowcache_mutex.unlock();
+
+  if(!found) {
+    //
+    // Read the whole row, without holding the lock
+    //
+    QString sql=QString("select * from `")+table+"` where `"+name+"`=?";
+    RDSqlQuery *q=new RDSqlQuery(sql,QList<QVariant>()<<test);
+    if(!q->first()) {
+      delete q;
+      *v=QVariant();
+      if(valid!=NULL) {
+	*valid=false;
+      }
+      return true;
+    }
+    record=q->record();
+    delete q;
+
+    //
+    // Don't keep the row if the table changed while it was being read
+    //
+    __rd_rowcache_mutex.lock();
+    if(generation==__rd_rowcache_generation) {
+      if(__rd_rowcache_rows.size()>=RDROWCACHE_MAX_ROWS) {
+	__rd_rowcache_rows.clear();
+      }
+      __rd_rowcache_rows[key].record=record;
+      __rd_rowcache_rows[key].loaded=now;
+    }
+    __rd_rowcache_mutex.unlock();
+  }
+
+  int col=record.indexOf(param);
+  if(col<0) {
+    return false;
+  }
+  *v=record.value(col);
+  if(valid!=NULL) {
+    *valid=!record.isNull(col);
+  }
+  return true;
+}
+
+
+void RDRowCache::invalidate(const QString &table)
+{
+  QMutexLocker locker(&__rd_rowcache_mutex);
+  QStringList keys;
+
+  if(table.isEmpty()) {
+    __rd_rowcache_rows.clear();
+  }
+  else {
+    for(QMap<QString,__RDRowCacheEntry>::const_iterator ci=
+	  __rd_rowcache_rows.begin();ci!=__rd_rowcache_rows.end();ci++) {
+      if(ci.key().startsWith(table+"\t")) {
+	keys.push_back(ci.key());
+      }
+    }
+    for(int i=0;i<keys.size();i++) {
+      __rd_rowcache_rows.remove(keys.at(i));
+    }
+  }
+  __rd_rowcache_generation++;
+}
+
+
+void RDRowCache::noteWrite(const QString &sql)
+{
+  QString table=RDDbPool::writtenTable(sql);
+
+  if(table=="*") {
+    RDRowCache::invalidate();
+  }
+  else {
+    if(RDRowCache::isCacheable(table)) {
+      RDRowCache::invalidate(table);
+    }
+  }
+}
+
+
+void RDRowCache::processNotification(RDNotification *notify)
+{
+  //
+  // Drop the whole table, as names are matched without regard to case
+  // and RDAIRPLAY and RDPANEL rows are keyed by ID rather than by station
+  //
+  switch(notify->type()) {
+  case RDNotification::StationType:
+    RDRowCache::invalidate("STATIONS");
+    RDRowCache::invalidate("RDAIRPLAY");
+    RDRowCache::invalidate("RDPANEL");
+    break;
+
+  case RDNotification::GroupType:
+    RDRowCache::invalidate("GROUPS");
+    break;
+
+  case RDNotification::ServiceType:
+    RDRowCache::invalidate("SERVICES");
+    break;
+
+  case RDNotification::UserType:
+    RDRowCache::invalidate("USERS");
+    break;
+
+  default:
+    break;
+  }
+}
+
+
+quint64 RDRowCache::hits()
+{
+  QMutexLocker locker(&__rd_rowcache_mutex);
+
+  return __rd_rowcache_hits;
+}
+
+
+quint64 RDRowCache::misses()
+{
+  QMutexLocker locker(&__rd_rowcache_mutex);
+
+  return __rd_rowcache_misses;
+}
+
+
+void RDRowCache::resetCounters()
+{
+  QMutexLocker locker(&__rd_rowcache_mutex);
+
+  __rd_rowcache_hits=0;
+  __rd_rowcache_misses=0;
+}
@@ -0,0 +1,71 @@
+// rdrowcache.h
+//
+// Process-wide cache of configuration table rows
+//
+//   (C) Copyright 2021 Fred Gleason <fredg@paravelsystems.com>
+//
+//   This program is free software; you can redistribute it and/or modify
+//   it under the terms of the GNU General Public License version 2 as
+//   published by the Free Software Foundation.
+//
+//   This program is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//   GNU General Public License for more details.
+//
+//   You should have received a copy of the GNU General Public
+//   License along with this program; if not, write to the Free Software
+//   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+//
+
+#ifndef RDROWCACHE_H
+#define RDROWCACHE_H
+
+#include <QString>
+#include <QVariant>
+
+#include <rdconfig.h>
+#include <rdnotification.h>
+
+//
+// Maximum number of rows held before the cache is emptied
+//
+#define RDROWCACHE_MAX_ROWS 1000
+
+//
+// RDRowCache
+//
+// Holds whole rows of the STATIONS, RDAIRPLAY, RDPANEL, GROUPS, SERVICES
+// and USERS tables, keyed by table and primary key, so that the getters
+// of RDStation, RDAirPlayConf, RDGroup, RDSvc and RDUser (which all read
+// through RDGetSqlValue()) do not each cost a query. value() returns
+// false for any other table, and the caller queries the database as
+// before.
+//
+// A table is dropped from the cache when the process writes to it
+// through RDSqlQuery, and when a notification of a change to it is
+// received from ripcd(8); programs that change these tables send one.
+// No row is used for more than RowCacheTtl seconds after it was read, in
+// case such a notification is missed. Setting RowCacheTtl to 0 in
+// rd.conf(5) disables the cache.
+//
+class RDRowCache
+{
+ public:
+  static void setConfig(RDConfig *config);
+  static void setTtl(int secs);
+  static int ttl();
+  static bool isCacheable(const QString &table);
+  static bool value(const QString &table,const QString &name,
+		    const QVariant &test,const QString &param,
+		    QVariant *v,bool *valid=NULL);
+  static void invalidate(const QString &table=QString());
+  static void noteWrite(const QString &sql);
+  static void processNotification(RDNotification *notify);
+  static quint64 hits();
+  static quint64 misses();
+  static void resetCounters();
+};
+
+
+#endif  // RDROWCACHE_H
@@ -0,0 +1,367 @@
+// rdsqlprofiler.cpp
+//
+// Query statistics and slow query logging for RDSqlQuery
+//
+//   (C) Copyright 2021 Fred Gleason <fredg@paravelsystems.com>
+//
+//   This program is free software; you can redistribute it and/or modify
+//   it under the terms of the GNU General Public License version 2 as
+//   published by the Free Software Foundation.
+//
+//   This program is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//   GNU General Public License for more details.
+//
+//   You should have received a copy of the GNU General Public
+//   License along with this program; if not, write to the Free Software
+//   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+//
+
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syslog.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <vector>
+
+#include <QFile>
+#include <QMap>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QRegExp>
+#include <QStringList>
+#include <QTextStream>
+
+#include "rdsqlprofiler.h"
+
+class __RDSqlProfileEntry
+{
+ public:
+  __RDSqlProfileEntry()
+  {
+    count=0;
+    total_usecs=0;
+    max_usecs=0;
+    rows=0;
+  }
+  qint64 count;
+  qint64 total_usecs;
+  qint64 max_usecs;
+  qint64 rows;
+};
+
+
+class __RDSqlProfileLine
+{
+ public:
+  QString module;
+  QString sql;
+  __RDSqlProfileEntry entry;
+};
+
+static QMutex __rd_sqlprofiler_mutex;
+static QMap<QString,__RDSqlProfileEntry> __rd_sqlprofiler_entries;
+static QString __rd_sqlprofiler_module;
+static QString __rd_sqlprofiler_dirname;
+static qint64 __rd_sqlprofiler_threshold=0;
+static int __rd_sqlprofiler_facility=LOG_USER;
+static bool __rd_sqlprofiler_collect=false;
+static volatile sig_atomic_t __rd_sqlprofiler_dump_pending=0;
+static RDSqlProfiler::SortKey __rd_sqlprofiler_sort_key=
+  RDSqlProfiler::TotalTime;
+
+bool RDSqlProfiler::profiler_active=false;
+
+
+static void __RDSqlProfilerSignal(int signo)
+{
+  __rd_sqlprofiler_dump_pending=1;
+}
+
+
+static void __RDSqlProfilerExit()
+{
+  RDSqlProfiler::dump();
+}
+
+
+static qint64 __RDSqlProfilerValue(const __RDSqlProfileEntry &e,
+				   RDSqlProfiler::SortKey key)
+{
+  switch(key) {
+  case RDSqlProfiler::Count:
+    return e.count;
+
+  case RDSqlProfiler::MaxTime:
+    return e.max_usecs;
+
+  case RDSqlProfiler::Rows:
+    return e.rows;
+
+  case RDSqlProfiler::TotalTime:
+    break;
+  }
+  return e.total_usecs;
+}
+
+
+static bool __RDSqlProfilerCompare(const __RDSqlProfileLine &lhs,
+				   const __RDSqlProfileLine &rhs)
+{
+  return __RDSqlProfilerValue(lhs.entry,__rd_sqlprofiler_sort_key)>
+    __RDSqlProfilerValue(rhs.entry,__rd_sqlprofiler_sort_key);
+}
+
+
+void RDSqlProfiler::setConfig(RDConfig *config)
+{
+  static bool handlers_installed=false;
+  struct sigaction sa;
+
+  __rd_sqlprofiler_mutex.lock();
+  __rd_sqlprofiler_module=config->moduleName();
+  if(__rd_sqlprofiler_module.isEmpty()) {
+    __rd_sqlprofiler_module="unknown";
+  }
+  __rd_sqlprofiler_dirname=config->mysqlProfileDirectory();
+  __rd_sqlprofiler_threshold=config->mysqlSlowQueryThreshold();
+  __rd_sqlprofiler_facility=config->syslogFacility();
+  __rd_sqlprofiler_mutex.unlock();
+
+  __rd_sqlprofiler_collect=config->mysqlProfileQueries();
+  profiler_active=__rd_sqlprofiler_collect||(__rd_sqlprofiler_threshold>0);
+  if(config->mysqlProfileQueries()&&(!handlers_installed)) {
+    memset(&sa,0,sizeof(sa));
+    sa.sa_handler=__RDSqlProfilerSignal;
+    sa.sa_flags=SA_RESTART;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGUSR2,&sa,NULL);
+    atexit(__RDSqlProfilerExit);
+    handlers_installed=true;
+  }
+}
+
+
+void RDSqlProfiler::record(const QString &sql,qint64 usecs,int rows)
+{
+  QString msg;
+  QString key;
+
+  if((__rd_sqlprofiler_threshold>0)&&
+     (usecs>=(1000*__rd_sqlprofiler_threshold))) {
+    msg=sql.simplified();
+    if(msg.length()>RDSQLPROFILER_MAX_SQL_LENGTH) {
+      msg=msg.left(RDSQLPROFILER_MAX_SQL_LENGTH)+"...";
+    }
+    Log(LOG_WARNING,QString().sprintf("slow query: %lld mS, %d rows: ",
+				      usecs/1000,rows)+msg);
+  }
+  if(!__rd_sqlprofiler_collect) {
+    return;
+  }
+
+  key=sqlTemplate(sql);
+  __rd_sqlprofiler_mutex.lock();
+  key=__rd_sqlprofiler_module+"\t"+key;
+  __RDSqlProfileEntry &e=__rd_sqlprofiler_entries[key];
+  e.count++;
+  e.total_usecs+=usecs;
+  if(usecs>e.max_usecs) {
+    e.max_usecs=usecs;
+  }
+  if(rows>0) {
+    e.rows+=rows;
+  }
+  __rd_sqlprofiler_mutex.unlock();
+
+  if(__rd_sqlprofiler_dump_pending) {
+    __rd_sqlprofiler_dump_pending=0;
+    dump();
+  }
+}
+
+
+bool RDSqlProfiler::dump(QString *err_msg)
+{
+  QString module;
+  QString dirname;
+  QStringList lines;
+
+  __rd_sqlprofiler_mutex.lock();
+  module=__rd_sqlprofiler_module;
+  dirname=__rd_sqlprofiler_dirname;
+  __rd_sqlprofiler_mutex.unlock();
+
+  if(dirname.isEmpty()) {
+    lines=report(RDSQLPROFILER_SYSLOG_ENTRIES).split("\n",
+						     QString::SkipEmptyParts);
+    for(int i=0;i<lines.size();i++) {
+      Log(LOG_INFO,"sql profile: "+lines.at(i));
+    }
+    return true;
+  }
+  return save(dirname+"/"+module+QString().sprintf("-%d.sqlprofile",getpid()),
+	      err_msg);
+}
+
+
+bool RDSqlProfiler::save(const QString &filename,QString *err_msg)
+{
+  QString tempname=filename+".tmp";
+  FILE *f=NULL;
+
+  if((f=fopen(tempname.toUtf8(),"w"))==NULL) {
+    if(err_msg!=NULL) {
+      *err_msg=QString("unable to write \"")+tempname+"\" ["+
+	strerror(errno)+"]";
+    }
+    return false;
+  }
+  fprintf(f,"# RDSqlProfiler 1\n");
+  __rd_sqlprofiler_mutex.lock();
+  for(QMap<QString,__RDSqlProfileEntry>::const_iterator ci=
+	__rd_sqlprofiler_entries.begin();
+      ci!=__rd_sqlprofiler_entries.end();ci++) {
+    fprintf(f,"%lld\t%lld\t%lld\t%lld\t%s\n",ci.value().count,
+	    ci.value().total_usecs,ci.value().max_usecs,ci.value().rows,
+	    ci.key().toUtf8().constData());
+  }
+  __rd_sqlprofiler_mutex.unlock();
+  if(fclose(f)!=0) {
+    if(err_msg!=NULL) {
+      *err_msg=QString("unable to write \"")+tempname+"\" ["+
+	strerror(errno)+"]";
+    }
+    unlink(tempname.toUtf8());
+    return false;
+  }
+  if(rename(tempname.toUtf8(),filename.toUtf8())!=0) {
+    if(err_msg!=NULL) {
+      *err_msg=QString("unable to rename \"")+tempname+"\" ["+
+	strerror(errno)+"]";
+    }
+    unlink(tempname.toUtf8());
+    return false;
+  }
+  return true;
+}
+
+
+bool RDSqlProfiler::merge(const QString &filename,QString *err_msg)
+{
+  QFile file(filename);
+  QString line;
+  QStringList f0;
+
+  if(!file.open(QIODevice::ReadOnly)) {
+    if(err_msg!=NULL) {
+      *err_msg=QString("unable to read \"")+filename+"\" ["+
+	file.errorString()+"]";
+    }
+    return false;
+  }
+  QTextStream strm(&file);
+  strm.setCodec("UTF-8");
+  line=strm.readLine();
+  if(line.trimmed()!="# RDSqlProfiler 1") {
+    if(err_msg!=NULL) {
+      *err_msg=QString("\"")+filename+"\" is not an SQL profile";
+    }
+    return false;
+  }
+  QMutexLocker locker(&__rd_sqlprofiler_mutex);
+  while(!(line=strm.readLine()).isNull()) {
+    f0=line.split("\t");
+    if(f0.size()!=6) {
+      continue;
+    }
+    __RDSqlProfileEntry &e=
+      __rd_sqlprofiler_entries[f0.at(4)+"\t"+f0.at(5)];
+    e.count+=f0.at(0).toLongLong();
+    e.total_usecs+=f0.at(1).toLongLong();
+    if(f0.at(2).toLongLong()>e.max_usecs) {
+      e.max_usecs=f0.at(2).toLongLong();
+    }
+    e.rows+=f0.at(3).toLongLong();
+  }
+  return true;
+}
+
+
+QString RDSqlProfiler::report(int entries,SortKey key,const QString &module)
+{
+  std::vector<__RDSqlProfileLine> lines;
+  __RDSqlProfileLine line;
+  QString ret;
+  int index;
+
+  QMutexLocker locker(&__rd_sqlprofiler_mutex);
+  for(QMap<QString,__RDSqlProfileEntry>::const_iterator ci=
+	__rd_sqlprofiler_entries.begin();
+      ci!=__rd_sqlprofiler_entries.end();ci++) {
+    index=ci.key().indexOf("\t");
+    line.module=ci.key().left(index);
+    line.sql=ci.key().right(ci.key().length()-index-1);
+    line.entry=ci.value();
+    if(module.isEmpty()||(line.module==module)) {
+      lines.push_back(line);
+    }
+  }
+  __rd_sqlprofiler_sort_key=key;
+  std::sort(lines.begin(),lines.end(),__RDSqlProfilerCompare);
+
+  ret=QString().sprintf("%8s %10s %9s %9s %9s  %-12s %s\n",
+			"COUNT","TOTAL(mS)","MEAN(mS)","MAX(mS)","ROWS",
+			"MODULE","QUERY");
+  for(unsigned i=0;(i<lines.size())&&((int)i<entries);i++) {
+    const __RDSqlProfileEntry &e=lines.at(i).entry;
+    ret+=QString().sprintf("%8lld %10.1lf %9.2lf %9.1lf %9lld  %-12s ",
+			   e.count,(double)e.total_usecs/1000.0,
+			   (double)e.total_usecs/(1000.0*(double)e.count),
+			   (double)e.max_usecs/1000.0,e.rows,
+			   lines.at(i).module.toUtf8().constData())+
+      lines.at(i).sql+"\n";
+  }
+  return ret;
+}
+
+
+void RDSqlProfiler::clear()
+{
+  QMutexLocker locker(&__rd_sqlprofiler_mutex);
+
+  __rd_sqlprofiler_entries.clear();
+}
+
+
+QString RDSqlProfiler::sqlTemplate(const QString &sql)
+{
+  QString ret=sql;
+
+  //
+  // Literal values
+  //
+  ret.replace(QRegExp("'([^'\\\\]|\\\\.|'')*'"),"?");
+  ret.replace(QRegExp("\"([^\"\\\\]|\\\\.)*\""),"?");
+  ret.replace(QRegExp("\\b[0-9]+(\\.[0-9]+)?\\b"),"?");
+  ret=ret.simplified();
+
+  //
+  // Value lists, such as in "in (...)" and multi-row inserts
+  //
+  ret.replace(QRegExp("\\?( ?, ?\\?)+"),"?,...");
+  ret.replace(QRegExp("(\\([^()]*\\))( ?, ?\\([^()]*\\))+"),"\\1,...");
+
+  return ret;
+}
+
+
+void RDSqlProfiler::Log(int priority,const QString &msg)
+{
+  ::syslog(priority|__rd_sqlprofiler_facility,"%s",msg.toUtf8().constData());
+}
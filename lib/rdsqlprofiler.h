@@ -0,0 +1,76 @@
+// rdsqlprofiler.h
+//
+// Query statistics and slow query logging for RDSqlQuery
+//
+//   (C) Copyright 2021 Fred Gleason <fredg@paravelsystems.com>
+//
+//   This program is free software; you can redistribute it and/or modify
+//   it under the terms of the GNU General Public License version 2 as
+//   published by the Free Software Foundation.
+//
+//   This program is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//   GNU General Public License for more details.
+//
+//   You should have received a copy of the GNU General Public
+//   License along with this program; if not, write to the Free Software
+//   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+//
+
+#ifndef RDSQLPROFILER_H
+#define RDSQLPROFILER_H
+
+#include <QString>
+
+#include <rdconfig.h>
+
+//
+// Number of queries listed when statistics are written to syslog
+//
+#define RDSQLPROFILER_SYSLOG_ENTRIES 20
+
+//
+// Maximum length of the SQL text written to the slow query log
+//
+#define RDSQLPROFILER_MAX_SQL_LENGTH 1024
+
+//
+// RDSqlProfiler
+//
+// Collects statistics for every query made through RDSqlQuery when
+// enabled by the [mySQL] section of rd.conf(5). Queries are counted
+// together when they differ only in their values: quoted strings and
+// numbers in the SQL text are replaced by '?' to give the template that
+// they are filed under, along with the name of the calling module.
+//
+// The statistics are written out when the process exits or receives
+// SIGUSR2, either to a file per process in the profile directory, in
+// which case rdsqlprofile(8) can merge and summarize them, or as a
+// top-N list to syslog. Queries slower than the slow query threshold
+// are logged to syslog as they complete.
+//
+// When disabled, the cost to each query is the test of isActive().
+//
+class RDSqlProfiler
+{
+ public:
+  enum SortKey {TotalTime=0,Count=1,MaxTime=2,Rows=3};
+  static bool isActive() {return profiler_active;}
+  static void setConfig(RDConfig *config);
+  static void record(const QString &sql,qint64 usecs,int rows);
+  static bool dump(QString *err_msg=NULL);
+  static bool save(const QString &filename,QString *err_msg=NULL);
+  static bool merge(const QString &filename,QString *err_msg=NULL);
+  static QString report(int entries,SortKey key=RDSqlProfiler::TotalTime,
+			const QString &module=QString());
+  static void clear();
+  static QString sqlTemplate(const QString &sql);
+
+ private:
+  static void Log(int priority,const QString &msg);
+  static bool profiler_active;
+};
+
+
+#endif  // RDSQLPROFILER_H
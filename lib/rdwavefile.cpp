@@ -34,6 +34,7 @@
 #include <assert.h>
 #include <arpa/inet.h>
 
+#include <algorithm>
 #include <typeinfo>
 
 #include <id3/tag.h>
@@ -49,9 +50,11 @@
 #endif  // HAVE_FLAC
 
 #include <rd.h>
+#include <rdaudioanalysis.h>
 #include <rdcart.h>
 #include <rdwavefile.h>
 #include <rdconf.h>
+#include <rdhash.h>
 #include <rdmp4.h>
 
 #ifdef HAVE_MP4_LIBS
@@ -86,6 +89,13 @@ RDWaveFile::RDWaveFile(QString file_name)
   pts=0;
   mpeg_id=RDWaveFile::NonMpeg;
   mpeg_frame_size=0;
+  frame_index_interval=0;
+  frame_index_samples_per_frame=0;
+  frame_index_frames=0;
+  frame_index_samples=0;
+  frame_index_loaded=false;
+  frame_index_build=true;
+  frame_index_missing=false;
   id3v1_tag=false;
   id3v2_tag[0]=false;
   id3v2_tag[1]=false;
@@ -537,6 +547,8 @@ bool RDWaveFile::createWave(RDWaveData *data,unsigned ptr_offset)
         prev_mask = umask(0113);      // Set umask so files are user and group writable.
         rc=wave_file.open(QIODevice::ReadWrite|QIODevice::Truncate);
 	unlink((wave_file_name+".energy").toUtf8());
+	RDAudioAnalysis::removeSidecar(wave_file_name);
+	unlink((wave_file_name+".frames").toUtf8());
         umask(prev_mask);
 	if(rc==false) {
 	  return false;
@@ -871,6 +883,10 @@ void RDWaveFile::closeWave(int samples)
   levl_block_size=DEFAULT_LEVL_BLOCK_SIZE;
   energy_loaded=false;
   energy_data.clear();
+  frame_index_offset.clear();
+  frame_index_sample.clear();
+  frame_index_loaded=false;
+  frame_index_missing=false;
   free(cook_buffer);
   cook_buffer=NULL;
   cook_buffer_size=0;
@@ -1233,6 +1249,75 @@ int RDWaveFile::readEnergy(unsigned short buf[],int count)
 }
 
 
+int RDWaveFile::seekMpegSample(unsigned sample)
+{
+  unsigned char hdr[4];
+  unsigned samples=0;
+  unsigned offset;
+  unsigned pos;
+  unsigned entry;
+  int len;
+
+  if(!loadFrameIndex()) {
+    return -1;
+  }
+  entry=std::upper_bound(frame_index_sample.begin(),frame_index_sample.end(),
+			 sample)-frame_index_sample.begin();
+  if(entry>0) {
+    entry--;
+  }
+  offset=frame_index_offset[entry];
+  pos=frame_index_sample[entry];
+  for(unsigned i=1;i<frame_index_interval;i++) {
+    if(pread(wave_file.handle(),hdr,4,data_start+offset)!=4) {
+      break;
+    }
+    if((len=MpegFrameLength(hdr,&samples))<=0) {
+      break;
+    }
+    if(((pos+samples)>sample)||((offset+len)>=data_length)) {
+      break;
+    }
+    offset+=len;
+    pos+=samples;
+  }
+  if(lseek(wave_file.handle(),data_start+offset,SEEK_SET)<0) {
+    return -1;
+  }
+  return pos;
+}
+
+
+bool RDWaveFile::loadFrameIndex()
+{
+  if(frame_index_loaded) {
+    return true;
+  }
+  if((!IsMpeg())||frame_index_missing) {
+    return false;
+  }
+  if(ReadFrameIndex()) {
+    return true;
+  }
+  if(!frame_index_build) {
+    frame_index_missing=true;
+    return false;
+  }
+  if(BuildFrameIndex()) {
+    WriteFrameIndex();
+    return true;
+  }
+  return false;
+}
+
+
+bool RDWaveFile::readFrameIndex()
+{
+  frame_index_build=false;
+  return loadFrameIndex();
+}
+
+
 int RDWaveFile::startTrim(int level)
 {
   double ratio=pow(10,-(double)level/2000.0)*32768.0;
@@ -1312,6 +1397,24 @@ int RDWaveFile::seekWave(int offset,int whence)
 {
   int pos;
   unsigned abspos;
+  int frame_size;
+
+  //
+  // Use the frame index for MPEG seeks to a frame boundary, as the
+  // nominal frame size is not exact for padded, VBR or free-format streams
+  //
+  if((whence==SEEK_SET)&&(offset>0)&&IsMpeg()) {
+    frame_size=block_align;
+    if(frame_size==0) {
+      frame_size=mpeg_frame_size;
+    }
+    if((frame_size>0)&&((offset%frame_size)==0)&&loadFrameIndex()) {
+      if(seekMpegSample((offset/frame_size)*
+			frame_index_samples_per_frame)>=0) {
+	return lseek(wave_file.handle(),0,SEEK_CUR)-data_start;
+      }
+    }
+  }
 
   switch(wave_type) {
       case RDWaveFile::Ogg:
@@ -5019,3 +5122,296 @@ unsigned RDWaveFile::FrameOffset(int msecs) const
   }
   return (unsigned)((double)msecs*(double)samples_per_sec/1000.0);
 }
+
+
+bool RDWaveFile::IsMpeg() const
+{
+  switch(wave_type) {
+  case RDWaveFile::Wave:
+    return format_tag==WAVE_FORMAT_MPEG;
+
+  case RDWaveFile::Mpeg:
+  case RDWaveFile::Atx:
+  case RDWaveFile::Tmc:
+    return true;
+
+  default:
+    break;
+  }
+  return false;
+}
+
+
+bool RDWaveFile::BuildFrameIndex()
+{
+  int fd=wave_file.handle();
+  std::vector<unsigned char> scan(FRAME_INDEX_SCAN_SIZE);
+  unsigned scan_start=0;
+  unsigned scan_length=0;
+  unsigned char *hdr=NULL;
+  unsigned char buffer[4096];
+  std::vector<unsigned> offsets;
+  std::vector<unsigned> starts;
+  unsigned offset=0;
+  unsigned pos;
+  unsigned sample=0;
+  unsigned samples=0;
+  bool free_format=false;
+  bool found;
+  ssize_t n;
+  int len;
+
+  //
+  // Walk the frame headers, reading the stream a block at a time
+  //
+  frame_index_samples_per_frame=0;
+  while((offset+4)<=data_length) {
+    if((offset<scan_start)||((offset+4)>(scan_start+scan_length))) {
+      scan_start=offset;
+      scan_length=data_length-offset;
+      if(scan_length>FRAME_INDEX_SCAN_SIZE) {
+	scan_length=FRAME_INDEX_SCAN_SIZE;
+      }
+      if((n=pread(fd,scan.data(),scan_length,data_start+offset))<4) {
+	break;
+      }
+      scan_length=n;
+    }
+    hdr=scan.data()+offset-scan_start;
+    if((len=MpegFrameLength(hdr,&samples))<0) {
+      //
+      // Lost sync, so look for the next sync word in what we have
+      //
+      offset++;
+      while(((offset+2)<=(scan_start+scan_length))&&
+	    ((scan[offset-scan_start]!=0xFF)||
+	     ((scan[offset-scan_start+1]&0xE0)!=0xE0))) {
+	offset++;
+      }
+      continue;
+    }
+    if(len==0) {  // Free format, so look for the next sync word
+      free_format=true;
+      found=false;
+      pos=offset+4;
+      len=data_length-offset;
+      while((!found)&&
+	    ((n=pread(fd,buffer,sizeof(buffer),data_start+pos))>=3)) {
+	for(int i=0;i<(n-2);i++) {
+	  if((buffer[i]==hdr[0])&&(buffer[i+1]==hdr[1])&&
+	     ((buffer[i+2]&0xFC)==(hdr[2]&0xFC))) {
+	    len=pos+i-offset;
+	    found=true;
+	    break;
+	  }
+	}
+	pos+=n-2;
+      }
+    }
+    offsets.push_back(offset);
+    starts.push_back(sample);
+    if(frame_index_samples_per_frame==0) {
+      frame_index_samples_per_frame=samples;
+    }
+    offset+=len;
+    sample+=samples;
+  }
+  if(offsets.size()==0) {
+    return false;
+  }
+
+  //
+  // Free-format frames can only be found by searching, so keep them all
+  //
+  frame_index_interval=FRAME_INDEX_INTERVAL;
+  if(free_format) {
+    frame_index_interval=1;
+  }
+  frame_index_offset.clear();
+  frame_index_sample.clear();
+  for(unsigned i=0;i<offsets.size();i+=frame_index_interval) {
+    frame_index_offset.push_back(offsets[i]);
+    frame_index_sample.push_back(starts[i]);
+  }
+  frame_index_frames=offsets.size();
+  frame_index_samples=sample;
+  frame_index_loaded=true;
+
+  return true;
+}
+
+
+bool RDWaveFile::ReadFrameIndex()
+{
+  FILE *f=NULL;
+  unsigned char header[32];
+  unsigned char entry[8];
+  unsigned count;
+  unsigned len;
+  char *fingerprint=NULL;
+
+  if((f=fopen((wave_file_name+".frames").toUtf8(),"r"))==NULL) {
+    return false;
+  }
+  if((fread(header,1,32,f)!=32)||(memcmp(header,"RDFI",4)!=0)||
+     (ReadDword(header,4)!=FRAME_INDEX_VERSION)) {
+    fclose(f);
+    return false;
+  }
+
+  //
+  // Make sure we still describe the same audio
+  //
+  len=ReadDword(header,28);
+  if((len==0)||(len>1024)) {
+    fclose(f);
+    return false;
+  }
+  fingerprint=new char[len+1];
+  if(fread(fingerprint,1,len,f)!=len) {
+    delete[] fingerprint;
+    fclose(f);
+    return false;
+  }
+  fingerprint[len]=0;
+  if(QString(fingerprint)!=RDFileFingerprint(wave_file_name)) {
+    delete[] fingerprint;
+    fclose(f);
+    return false;
+  }
+  delete[] fingerprint;
+
+  frame_index_interval=ReadDword(header,8);
+  frame_index_samples_per_frame=ReadDword(header,12);
+  frame_index_frames=ReadDword(header,16);
+  frame_index_samples=ReadDword(header,20);
+  count=ReadDword(header,24);
+  if((frame_index_interval==0)||(count==0)) {
+    fclose(f);
+    return false;
+  }
+  frame_index_offset.clear();
+  frame_index_sample.clear();
+  for(unsigned i=0;i<count;i++) {
+    if(fread(entry,1,8,f)!=8) {
+      frame_index_offset.clear();
+      frame_index_sample.clear();
+      fclose(f);
+      return false;
+    }
+    frame_index_offset.push_back(ReadDword(entry,0));
+    frame_index_sample.push_back(ReadDword(entry,4));
+  }
+  fclose(f);
+  frame_index_loaded=true;
+
+  return true;
+}
+
+
+bool RDWaveFile::WriteFrameIndex()
+{
+  FILE *f=NULL;
+  unsigned char header[32];
+  unsigned char entry[8];
+  QString filename=wave_file_name+".frames";
+  QString tempname=filename+QString().sprintf(".%d",getpid());
+  QByteArray fingerprint=RDFileFingerprint(wave_file_name).toUtf8();
+
+  if((f=fopen(tempname.toUtf8(),"w"))==NULL) {
+    return false;
+  }
+  memcpy(header,"RDFI",4);
+  WriteDword(header,4,FRAME_INDEX_VERSION);
+  WriteDword(header,8,frame_index_interval);
+  WriteDword(header,12,frame_index_samples_per_frame);
+  WriteDword(header,16,frame_index_frames);
+  WriteDword(header,20,frame_index_samples);
+  WriteDword(header,24,frame_index_offset.size());
+  WriteDword(header,28,fingerprint.size());
+  fwrite(header,1,32,f);
+  fwrite(fingerprint.constData(),1,fingerprint.size(),f);
+  for(unsigned i=0;i<frame_index_offset.size();i++) {
+    WriteDword(entry,0,frame_index_offset[i]);
+    WriteDword(entry,4,frame_index_sample[i]);
+    fwrite(entry,1,8,f);
+  }
+  if(fclose(f)!=0) {
+    unlink(tempname.toUtf8());
+    return false;
+  }
+  if(rename(tempname.toUtf8(),filename.toUtf8())!=0) {
+    unlink(tempname.toUtf8());
+    return false;
+  }
+
+  return true;
+}
+
+
+int RDWaveFile::MpegFrameLength(const unsigned char hdr[4],
+				unsigned *samples) const
+{
+  static const unsigned bitrates[2][3][16]={
+    {{0,32,64,96,128,160,192,224,256,288,320,352,384,416,448,0},  // MPEG-1
+     {0,32,48,56,64,80,96,112,128,160,192,224,256,320,384,0},
+     {0,32,40,48,56,64,80,96,112,128,160,192,224,256,320,0}},
+    {{0,32,48,56,64,80,96,112,128,144,160,176,192,224,256,0},  // MPEG-2/2.5
+     {0,8,16,24,32,40,48,56,64,80,96,112,128,144,160,0},
+     {0,8,16,24,32,40,48,56,64,80,96,112,128,144,160,0}}};
+  static const unsigned samprates[3]={44100,48000,32000};
+  unsigned version=(hdr[1]>>3)&0x03;
+  unsigned layer=(hdr[1]>>1)&0x03;
+  unsigned bitrate_index=(hdr[2]>>4)&0x0F;
+  unsigned samprate_index=(hdr[2]>>2)&0x03;
+  unsigned padding=(hdr[2]>>1)&0x01;
+  unsigned lsf;
+  unsigned samprate;
+  unsigned bitrate;
+
+  //
+  // Sync
+  //
+  if((hdr[0]!=0xFF)||((hdr[1]&0xE0)!=0xE0)) {
+    return -1;
+  }
+  if((version==1)||(layer==0)||(bitrate_index==15)||(samprate_index==3)) {
+    return -1;
+  }
+  lsf=(version==3)?0:1;
+  samprate=samprates[samprate_index];
+  if(version==2) {  // MPEG-2
+    samprate/=2;
+  }
+  if(version==0) {  // MPEG-2.5
+    samprate/=4;
+  }
+  bitrate=1000*bitrates[lsf][3-layer][bitrate_index];
+
+  switch(layer) {
+  case 3:  // Layer 1
+    *samples=384;
+    if(bitrate==0) {  // Free format
+      return 0;
+    }
+    return 4*(12*bitrate/samprate+padding);
+
+  case 2:  // Layer 2
+    *samples=1152;
+    if(bitrate==0) {
+      return 0;
+    }
+    return 144*bitrate/samprate+padding;
+
+  case 1:  // Layer 3
+    *samples=lsf?576:1152;
+    if(bitrate==0) {
+      return 0;
+    }
+    if(lsf) {
+      return 72*bitrate/samprate+padding;
+    }
+    return 144*bitrate/samprate+padding;
+  }
+  return -1;
+}
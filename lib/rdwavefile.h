@@ -86,6 +86,15 @@
 //
 #define MPEG_BUFFER_SIZE 32768
 
+//
+// MPEG Frame Index
+//
+// The byte offset and starting sample of every Nth frame are stored.
+//
+#define FRAME_INDEX_INTERVAL 8
+#define FRAME_INDEX_VERSION 1
+#define FRAME_INDEX_SCAN_SIZE 65536
+
 //
 // Default Values
 //
@@ -241,6 +250,30 @@ class RDWaveFile
    **/
    int seekWave(int offset,int whence);
 
+  /**
+   * Set the DATA chunk file pointer to the start of the MPEG frame
+   * containing a given sample, using the MPEG frame index.
+   * @param sample The sample to seek to.
+   * Returns If successful, the number of the first sample in the frame,
+   * otherwise -1.
+   **/
+   int seekMpegSample(unsigned sample);
+
+  /**
+   * Load the MPEG frame index for the file, building it and writing it
+   * to its sidecar file if it is missing or out of date.
+   * Returns true if an index is available.
+   **/
+   bool loadFrameIndex();
+
+  /**
+   * Load the MPEG frame index for the file from its sidecar file only,
+   * never scanning the file. Seeks through this object will not build
+   * a missing index either, but use the nominal frame size instead.
+   * Returns true if an index is available.
+   **/
+   bool readFrameIndex();
+
    void getSettings(RDSettings *settings);
    void setSettings(const RDSettings *settings);
 
@@ -1076,6 +1109,11 @@ class RDWaveFile
 #endif  // HAVE_VORBIS
    int WriteOggBuffer(char *buf,int size);
    unsigned FrameOffset(int msecs) const;
+   bool IsMpeg() const;
+   bool BuildFrameIndex();
+   bool ReadFrameIndex();
+   bool WriteFrameIndex();
+   int MpegFrameLength(const unsigned char hdr[4],unsigned *samples) const;
    QString wave_file_name;
    QFile wave_file;
    RDWaveData *wave_data;
@@ -1102,6 +1140,15 @@ class RDWaveFile
    unsigned ptr_offset_msecs;
    RDWaveFile::MpegID mpeg_id;              
    int mpeg_frame_size;
+   std::vector<unsigned> frame_index_offset;
+   std::vector<unsigned> frame_index_sample;
+   unsigned frame_index_interval;
+   unsigned frame_index_samples_per_frame;
+   unsigned frame_index_frames;
+   unsigned frame_index_samples;
+   bool frame_index_loaded;
+   bool frame_index_build;
+   bool frame_index_missing;
    bool id3v1_tag;
    bool id3v2_tag[2];
    unsigned id3v2_offset[2];
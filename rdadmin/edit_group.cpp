@@ -400,6 +400,9 @@ void EditGroup::okData()
   }
   q=new RDSqlQuery(sql);
   delete q;
+  rda->ripc()->sendNotification(RDNotification::GroupType,
+				RDNotification::ModifyAction,
+				group_group->name());
 
   done(true);
 }
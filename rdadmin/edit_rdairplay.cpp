@@ -1296,6 +1296,9 @@ void EditRDAirPlay::okData()
     air_conf->setOpMode(i+RD_RDVAIRPLAY_LOG_BASE,air_virtual_opmodes[i]);
   }
   air_conf->setSkinPath(air_skin_edit->text());
+  rda->ripc()->sendNotification(RDNotification::StationType,
+				RDNotification::ModifyAction,
+				air_conf->station());
   done(0);
 }
 
@@ -480,6 +480,9 @@ void EditRDPanel::okData()
   air_conf->setFlashPanel(air_flash_box->isChecked());
   air_conf->setPanelPauseEnabled(air_panel_pause_box->isChecked());
   air_conf->setButtonLabelTemplate(air_label_template_edit->text());
+  rda->ripc()->sendNotification(RDNotification::StationType,
+				RDNotification::ModifyAction,
+				air_conf->station());
 
   done(0);
 }
@@ -703,6 +703,9 @@ void EditStation::okData()
   station_station->setCaeStation(station_cae_station_box->currentText());
   station_catch_connect->reloadHeartbeat();
   station_catch_connect->reloadOffset();
+  rda->ripc()->sendNotification(RDNotification::StationType,
+				RDNotification::ModifyAction,
+				station_station->name());
 
   //
   // Allow the event loop to run so the packets get delivered
@@ -704,6 +704,9 @@ void EditSvc::musTemplateActivatedData(int index)
 void EditSvc::okData()
 {
   Save();
+  rda->ripc()->sendNotification(RDNotification::ServiceType,
+				RDNotification::ModifyAction,
+				svc_svc->name());
   done(true);
 }
 
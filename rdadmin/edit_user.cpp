@@ -624,6 +624,9 @@ void EditUser::okData()
   user_user->setAddPodcast(user_add_podcast_button->isChecked());
   user_user->setEditPodcast(user_edit_podcast_button->isChecked());
   user_user->setDeletePodcast(user_delete_podcast_button->isChecked());
+  rda->ripc()->sendNotification(RDNotification::UserType,
+				RDNotification::ModifyAction,
+				user_user->name());
 
   done(true);
 }
@@ -256,6 +256,9 @@ void ListGroups::deleteData()
   sql=QString("delete from GROUPS where ")+
     "NAME=\""+RDEscapeString(grpname)+"\"";
   RDSqlQuery::apply(sql);
+  rda->ripc()->sendNotification(RDNotification::GroupType,
+				RDNotification::DeleteAction,
+				grpname);
   list_groups_model->removeGroup(grpname);
 }
 
@@ -21,6 +21,7 @@
 #include <QMessageBox>
 
 #include <rdairplay_conf.h>
+#include <rdapplication.h>
 #include <rddb.h>
 #include <rdescape_string.h>
 
@@ -158,6 +159,9 @@ void ListStations::deleteData()
 			  QMessageBox::Yes,QMessageBox::No)==
      QMessageBox::Yes) {
     RDStation::remove(hostname);
+    rda->ripc()->sendNotification(RDNotification::StationType,
+				  RDNotification::DeleteAction,
+				  hostname);
     list_stations_model->removeStation(hostname);
   }
 }
@@ -173,6 +173,9 @@ void ListSvcs::deleteData()
   RDSvc *svc=new RDSvc(svcname,rda->station(),rda->config());
   svc->remove();
   delete svc;
+  rda->ripc()->sendNotification(RDNotification::ServiceType,
+				RDNotification::DeleteAction,
+				svcname);
   list_services_model->removeService(svcname);
 }
 
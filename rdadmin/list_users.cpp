@@ -22,6 +22,7 @@
 
 #include <qmessagebox.h>
 
+#include <rdapplication.h>
 #include <rdcart.h>
 #include <rdescape_string.h>
 #include <rdtextfile.h>
@@ -219,6 +220,9 @@ void ListUsers::deleteData()
   sql=QString("delete from WEB_CONNECTIONS where ")+
     "LOGIN_NAME=\""+RDEscapeString(username)+"\"";
   RDSqlQuery::apply(sql);
+  rda->ripc()->sendNotification(RDNotification::UserType,
+				RDNotification::DeleteAction,
+				username);
 
   list_users_model->removeUser(username);
 }
@@ -20,6 +20,7 @@
 
 #include <QMessageBox>
 
+#include <rdapplication.h>
 #include <rddb.h>
 #include <rdescape_string.h>
 #include <rdpasswd.h>
@@ -237,6 +238,9 @@ void RenameGroup::okData()
     delete q;
   }
 
+  rda->ripc()->sendNotification(RDNotification::GroupType,
+				RDNotification::ModifyAction,
+				group_name_edit->text());
   *group_new_name=group_newname_edit->text();
 
   done(true);
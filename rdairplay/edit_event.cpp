@@ -219,6 +219,7 @@ int EditEvent::exec(int line)
   setWindowTitle("RDAirPlay - "+
 		 QString().sprintf("%d - ",edit_logline->cartNumber())+
 		 edit_logline->title());
+  edit_logline->loadCartNotes();
   edit_cart_notes_text->setText(edit_logline->cartNotes());
   switch(edit_logline->type()) {
   case RDLogLine::Cart:
@@ -2341,6 +2341,8 @@ void MainObject::CheckInRecording(QString cutname,CatchEvent *evt,
   cut->checkInRecording(rda->config()->stationName(),"",
 			rda->config()->stationName(),s,msecs);
   cut->setSha1Hash(RDSha1Hash(RDCut::pathName(cut->cutName())));
+  cut->
+    setSha1Fingerprint(RDFileFingerprint(RDCut::pathName(cut->cutName())));
   delete s;
   cut->autoTrim(RDCut::AudioBoth,-threshold);
   RDCart *cart=new RDCart(cut->cartNumber());
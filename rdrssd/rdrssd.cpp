@@ -24,6 +24,7 @@
 #include <QCoreApplication>
 
 #include <rdapplication.h>
+#include <rddbpool.h>
 #include <rdescape_string.h>
 #include <rdfeed.h>
 #include <rdpodcast.h>
@@ -111,7 +112,7 @@ void MainObject::timeoutData()
     "KEY_NAME "+  // 00
     "from FEEDS where "+
     "IS_SUPERFEED='N'";
-  q=new RDSqlQuery(sql);
+  q=new RDSqlQuery(sql,RDDbPool::replica());
   while(q->next()) {
     ProcessFeed(q->value(0).toString());
   }
@@ -206,6 +206,23 @@ bool MainObject::Startup(QString *err_msg)
   }
   delete q;
 
+  //
+  // rdxport.cgi(8)
+  //
+  if(rda->config()->rdxportServiceEnabled()) {
+    svc_processes[RDSERVICE_RDXPORT_ID]=
+      new RDProcess(RDSERVICE_RDXPORT_ID,this);
+    args.clear();
+    args.push_back("--service");
+    svc_processes[RDSERVICE_RDXPORT_ID]->
+      start(QString(RD_LIBEXEC_DIR)+"/rdxport.cgi",args);
+    if(!svc_processes[RDSERVICE_RDXPORT_ID]->process()->waitForStarted(-1)) {
+      *err_msg=tr("unable to start rdxport.cgi(8)")+": "+
+	svc_processes[RDSERVICE_RDXPORT_ID]->errorText();
+      return false;
+    }
+  }
+
   if(!StartDropboxes(err_msg)) {
     return false;
   }
@@ -22,11 +22,13 @@
 
 #include <rdapplication.h>
 #include <rdconf.h>
+#include <rdrowcache.h>
 
 #include "ripcd.h"
 
 void MainObject::RunLocalNotifications(RDNotification *notify)
 {
+  RDRowCache::processNotification(notify);
   if((notify->type()==RDNotification::DropboxType)&&
      (notify->id().toString()==rda->config()->stationName())) {
     pid_t pid=RDGetPid(QString(RD_PID_DIR)+"/rdservice.pid");
@@ -0,0 +1,195 @@
+// dbpool_test.cpp
+//
+// Test database access from several threads at once.
+//
+//   (C) Copyright 2021 Fred Gleason <fredg@paravelsystems.com>
+//
+//   This program is free software; you can redistribute it and/or modify
+//   it under the terms of the GNU General Public License version 2 as
+//   published by the Free Software Foundation.
+//
+//   This program is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//   GNU General Public License for more details.
+//
+//   You should have received a copy of the GNU General Public
+//   License along with this program; if not, write to the Free Software
+//   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+//
+
+#include <stdlib.h>
+#include <sys/time.h>
+
+#include <qapplication.h>
+#include <qlist.h>
+
+#include <rd.h>
+#include <rdapplication.h>
+#include <rdcart.h>
+#include <rddb.h>
+#include <rddbpool.h>
+
+#include "dbpool_test.h"
+
+WorkerThread::WorkerThread(unsigned cartnum,const QString &title,int queries,
+			   bool scoped,QObject *parent)
+  : QThread(parent)
+{
+  worker_cartnum=cartnum;
+  worker_title=title;
+  worker_queries=queries;
+  worker_scoped=scoped;
+  worker_errors=0;
+}
+
+
+int WorkerThread::errors() const
+{
+  return worker_errors;
+}
+
+
+QString WorkerThread::connectionName() const
+{
+  return worker_connection_name;
+}
+
+
+void WorkerThread::run()
+{
+  RDDbConnection *conn=NULL;
+
+  //
+  // Scoped threads check out a connection explicitly, the others get
+  // one of their own on their first query
+  //
+  if(worker_scoped) {
+    conn=new RDDbConnection();
+  }
+  for(int i=0;i<worker_queries;i++) {
+    RDCart *cart=new RDCart(worker_cartnum);
+    if(cart->title()!=worker_title) {
+      worker_errors++;
+    }
+    delete cart;
+  }
+  worker_connection_name=RDDbPool::database().connectionName();
+  if(conn!=NULL) {
+    delete conn;
+  }
+}
+
+
+MainObject::MainObject(QObject *parent)
+  :QObject(parent)
+{
+  unsigned cartnum=0;
+  int threads=4;
+  int queries=1000;
+  QString err_msg;
+  QString sql;
+  RDSqlQuery *q=NULL;
+  bool ok=false;
+  QList<WorkerThread *> workers;
+  int errors=0;
+
+  //
+  // Open the Database
+  //
+  rda=static_cast<RDApplication *>(new RDCoreApplication("dbpool_test","dbpool_test",DBPOOL_TEST_USAGE,this));
+  if(!rda->open(&err_msg)) {
+    fprintf(stderr,"dbpool_test: %s\n",err_msg.toUtf8().constData());
+    exit(1);
+  }
+
+  //
+  // Read Command Options
+  //
+  for(unsigned i=0;i<rda->cmdSwitch()->keys();i++) {
+    if(rda->cmdSwitch()->key(i)=="--cart") {
+      cartnum=rda->cmdSwitch()->value(i).toUInt(&ok);
+      if((!ok)||(cartnum==0)||(cartnum>RD_MAX_CART_NUMBER)) {
+	fprintf(stderr,"dbpool_test: invalid --cart argument\n");
+	exit(256);
+      }
+      rda->cmdSwitch()->setProcessed(i,true);
+    }
+    if(rda->cmdSwitch()->key(i)=="--threads") {
+      threads=rda->cmdSwitch()->value(i).toInt(&ok);
+      if((!ok)||(threads<1)) {
+	fprintf(stderr,"dbpool_test: invalid --threads argument\n");
+	exit(256);
+      }
+      rda->cmdSwitch()->setProcessed(i,true);
+    }
+    if(rda->cmdSwitch()->key(i)=="--queries") {
+      queries=rda->cmdSwitch()->value(i).toInt(&ok);
+      if((!ok)||(queries<1)) {
+	fprintf(stderr,"dbpool_test: invalid --queries argument\n");
+	exit(256);
+      }
+      rda->cmdSwitch()->setProcessed(i,true);
+    }
+    if(!rda->cmdSwitch()->processed(i)) {
+      fprintf(stderr,"dbpool_test: unknown option \"%s\"\n",
+	      rda->cmdSwitch()->key(i).toUtf8().constData());
+      exit(256);
+    }
+  }
+  if(cartnum==0) {
+    sql="select NUMBER from CART order by NUMBER limit 1";
+    q=new RDSqlQuery(sql);
+    if(q->first()) {
+      cartnum=q->value(0).toUInt();
+    }
+    delete q;
+  }
+  RDCart *cart=new RDCart(cartnum);
+  if(!cart->exists()) {
+    fprintf(stderr,"dbpool_test: no such cart\n");
+    exit(1);
+  }
+  QString title=cart->title();
+  delete cart;
+
+  //
+  // Run the Threads
+  //
+  struct timeval start_tv;
+  struct timeval end_tv;
+  gettimeofday(&start_tv,NULL);
+  for(int i=0;i<threads;i++) {
+    workers.push_back(new WorkerThread(cartnum,title,queries,(i%2)==1,this));
+    workers.back()->start();
+  }
+  for(int i=0;i<workers.size();i++) {
+    workers.at(i)->wait();
+  }
+  gettimeofday(&end_tv,NULL);
+  double elapsed=(double)(end_tv.tv_sec-start_tv.tv_sec)+
+    (double)(end_tv.tv_usec-start_tv.tv_usec)/1000000.0;
+
+  for(int i=0;i<workers.size();i++) {
+    printf("thread %2d  connection: %-12s  errors: %d\n",i,
+	   workers.at(i)->connectionName().toUtf8().constData(),
+	   workers.at(i)->errors());
+    errors+=workers.at(i)->errors();
+  }
+  printf("total lookups: %d  lookups/sec: %.1lf\n",threads*queries,
+	 (double)(threads*queries)/elapsed);
+  printf("connections left open: %d\n",RDDbPool::openConnections());
+
+  if((errors>0)||(RDDbPool::openConnections()!=0)) {
+    exit(1);
+  }
+  exit(0);
+}
+
+
+int main(int argc,char *argv[])
+{
+  QApplication a(argc,argv,false);
+  new MainObject();
+  return a.exec();
+}
@@ -0,0 +1,57 @@
+// dbpool_test.h
+//
+// Test database access from several threads at once.
+//
+//   (C) Copyright 2021 Fred Gleason <fredg@paravelsystems.com>
+//
+//   This program is free software; you can redistribute it and/or modify
+//   it under the terms of the GNU General Public License version 2 as
+//   published by the Free Software Foundation.
+//
+//   This program is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//   GNU General Public License for more details.
+//
+//   You should have received a copy of the GNU General Public
+//   License along with this program; if not, write to the Free Software
+//   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+//
+
+#ifndef DBPOOL_TEST_H
+#define DBPOOL_TEST_H
+
+#include <qobject.h>
+#include <qthread.h>
+
+#define DBPOOL_TEST_USAGE "[options]\n\nLook up a cart from several threads at once, each using its own database\nconnection, and check that every lookup returns the same title. Only reads\nare made.\n\nOptions are:\n--cart=<cart-num>\n     Number of the cart to look up. Default is the first cart.\n\n--threads=<num>\n     Number of threads to run. Default is 4.\n\n--queries=<num>\n     Number of lookups made by each thread. Default is 1000.\n\n"
+
+class WorkerThread : public QThread
+{
+ public:
+  WorkerThread(unsigned cartnum,const QString &title,int queries,
+	       bool scoped,QObject *parent=0);
+  int errors() const;
+  QString connectionName() const;
+
+ protected:
+  void run();
+
+ private:
+  unsigned worker_cartnum;
+  QString worker_title;
+  int worker_queries;
+  bool worker_scoped;
+  int worker_errors;
+  QString worker_connection_name;
+};
+
+
+class MainObject : public QObject
+{
+ public:
+  MainObject(QObject *parent=0);
+};
+
+
+#endif  // DBPOOL_TEST_H
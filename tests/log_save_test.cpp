@@ -0,0 +1,143 @@
+// log_save_test.cpp
+//
+// Test saving edited logs with RDLogModel.
+//
+//   (C) Copyright 2021 Fred Gleason <fredg@paravelsystems.com>
+//
+//   This program is free software; you can redistribute it and/or modify
+//   it under the terms of the GNU General Public License version 2 as
+//   published by the Free Software Foundation.
+//
+//   This program is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//   GNU General Public License for more details.
+//
+//   You should have received a copy of the GNU General Public
+//   License along with this program; if not, write to the Free Software
+//   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+//
+
+#include <stdlib.h>
+
+#include <qapplication.h>
+
+#include <rdapplication.h>
+#include <rddb.h>
+#include <rdlog.h>
+
+#include "log_save_test.h"
+#include "query_timer.h"
+
+MainObject::MainObject(QObject *parent)
+  :QObject(parent)
+{
+  int iterations=10;
+  QString err_msg;
+  bool ok=false;
+
+  //
+  // Open the Database
+  //
+  rda=static_cast<RDApplication *>(new RDCoreApplication("log_save_test","log_save_test",LOG_SAVE_TEST_USAGE,this));
+  if(!rda->open(&err_msg)) {
+    fprintf(stderr,"log_save_test: %s\n",err_msg.toUtf8().constData());
+    exit(1);
+  }
+
+  //
+  // Read Command Options
+  //
+  for(unsigned i=0;i<rda->cmdSwitch()->keys();i++) {
+    if(rda->cmdSwitch()->key(i)=="--log") {
+      test_log_name=rda->cmdSwitch()->value(i);
+      rda->cmdSwitch()->setProcessed(i,true);
+    }
+    if(rda->cmdSwitch()->key(i)=="--iterations") {
+      iterations=rda->cmdSwitch()->value(i).toInt(&ok);
+      if((!ok)||(iterations<1)) {
+	fprintf(stderr,"log_save_test: invalid --iterations argument\n");
+	exit(256);
+      }
+      rda->cmdSwitch()->setProcessed(i,true);
+    }
+    if(!rda->cmdSwitch()->processed(i)) {
+      fprintf(stderr,"log_save_test: unknown option \"%s\"\n",
+	      rda->cmdSwitch()->key(i).toUtf8().constData());
+      exit(256);
+    }
+  }
+  if(test_log_name.isEmpty()) {
+    fprintf(stderr,
+	    "log_save_test: you must specify a log name with \"--log=\"\n");
+    exit(256);
+  }
+  if(!RDLog::exists(test_log_name)) {
+    fprintf(stderr,"log_save_test: no such log\n");
+    exit(1);
+  }
+
+  //
+  // Run the Test
+  //
+  RDLogModel *model=new RDLogModel(test_log_name,false,this);
+  model->load();
+  if(model->lineCount()<10) {
+    fprintf(stderr,"log_save_test: log has fewer than ten lines\n");
+    exit(1);
+  }
+  srandom(time(NULL));
+  for(int i=0;i<iterations;i++) {
+    int lines=model->lineCount();
+    model->move(random()%lines,random()%lines);
+    model->copy(random()%lines,random()%lines);
+    model->remove(random()%model->lineCount(),1);
+    model->logLine(random()%model->lineCount())->
+      setMarkerComment(QString().sprintf("log_save_test %d",i));
+
+    QueryTimer timer;
+    timer.start();
+    model->save(rda->config());
+    timer.stop();
+    ok=Compare(model);
+    printf("round %3d  lines: %5d  queries: %4u  ms: %8.3lf  %s\n",i,
+	   model->lineCount(),timer.queries(),timer.elapsed(),
+	   ok?"ok":"FAILED");
+    if(!ok) {
+      exit(1);
+    }
+  }
+
+  exit(0);
+}
+
+
+bool MainObject::Compare(RDLogModel *model) const
+{
+  RDLogModel *saved=new RDLogModel(test_log_name,true);
+  bool ret=true;
+
+  saved->load();
+  if(saved->lineCount()!=model->lineCount()) {
+    ret=false;
+  }
+  for(int i=0;ret&&(i<model->lineCount());i++) {
+    RDLogLine *ll=model->logLine(i);
+    RDLogLine *sl=saved->logLine(i);
+    ret=(ll->id()==sl->id())&&(ll->type()==sl->type())&&
+      (ll->cartNumber()==sl->cartNumber())&&
+      (ll->markerComment()==sl->markerComment())&&
+      (ll->startTime(RDLogLine::Logged)==sl->startTime(RDLogLine::Logged));
+  }
+  delete saved;
+
+  return ret;
+}
+
+
+int main(int argc,char *argv[])
+{
+  QApplication a(argc,argv,false);
+  new MainObject();
+  return a.exec();
+}
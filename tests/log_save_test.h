@@ -0,0 +1,41 @@
+// log_save_test.h
+//
+// Test saving edited logs with RDLogModel.
+//
+//   (C) Copyright 2021 Fred Gleason <fredg@paravelsystems.com>
+//
+//   This program is free software; you can redistribute it and/or modify
+//   it under the terms of the GNU General Public License version 2 as
+//   published by the Free Software Foundation.
+//
+//   This program is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//   GNU General Public License for more details.
+//
+//   You should have received a copy of the GNU General Public
+//   License along with this program; if not, write to the Free Software
+//   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+//
+
+#ifndef LOG_SAVE_TEST_H
+#define LOG_SAVE_TEST_H
+
+#include <qobject.h>
+
+#include <rdlogmodel.h>
+
+#define LOG_SAVE_TEST_USAGE "[options]\n\nMake random edits (moves, copies, removals and comment changes) to a log,\nsaving it after each round, and check that reloading it gives back the\nedited lines. The log is modified, so use a test log with at least ten\nlines.\n\nOptions are:\n--log=<name>\n     Name of the log to use.\n\n--iterations=<num>\n     Number of rounds of edits. Default is 10.\n\n"
+
+class MainObject : public QObject
+{
+ public:
+  MainObject(QObject *parent=0);
+
+ private:
+  bool Compare(RDLogModel *model) const;
+  QString test_log_name;
+};
+
+
+#endif  // LOG_SAVE_TEST_H
@@ -0,0 +1,242 @@
+// logindex_test.cpp
+//
+// Exercise the line ID index of RDLogModel.
+//
+//   (C) Copyright 2021 Fred Gleason <fredg@paravelsystems.com>
+//
+//   This program is free software; you can redistribute it and/or modify
+//   it under the terms of the GNU General Public License version 2 as
+//   published by the Free Software Foundation.
+//
+//   This program is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//   GNU General Public License for more details.
+//
+//   You should have received a copy of the GNU General Public
+//   License along with this program; if not, write to the Free Software
+//   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+//
+
+#include <stdlib.h>
+#include <sys/time.h>
+
+#include <qapplication.h>
+
+#include <rdapplication.h>
+
+#include "logindex_test.h"
+
+MainObject::MainObject(QObject *parent)
+  :QObject(parent)
+{
+  int lines=20000;
+  int lookups=100000;
+  int edits=500;
+  QString err_msg;
+  bool ok=false;
+
+  //
+  // Open the Database
+  //
+  rda=static_cast<RDApplication *>(new RDCoreApplication("logindex_test","logindex_test",LOGINDEX_TEST_USAGE,this));
+  if(!rda->open(&err_msg)) {
+    fprintf(stderr,"logindex_test: %s\n",err_msg.toUtf8().constData());
+    exit(1);
+  }
+
+  //
+  // Read Command Options
+  //
+  for(unsigned i=0;i<rda->cmdSwitch()->keys();i++) {
+    if(rda->cmdSwitch()->key(i)=="--lines") {
+      lines=rda->cmdSwitch()->value(i).toInt(&ok);
+      if((!ok)||(lines<1)) {
+	fprintf(stderr,"logindex_test: invalid --lines argument\n");
+	exit(256);
+      }
+      rda->cmdSwitch()->setProcessed(i,true);
+    }
+    if(rda->cmdSwitch()->key(i)=="--lookups") {
+      lookups=rda->cmdSwitch()->value(i).toInt(&ok);
+      if((!ok)||(lookups<1)) {
+	fprintf(stderr,"logindex_test: invalid --lookups argument\n");
+	exit(256);
+      }
+      rda->cmdSwitch()->setProcessed(i,true);
+    }
+    if(rda->cmdSwitch()->key(i)=="--edits") {
+      edits=rda->cmdSwitch()->value(i).toInt(&ok);
+      if((!ok)||(edits<0)) {
+	fprintf(stderr,"logindex_test: invalid --edits argument\n");
+	exit(256);
+      }
+      rda->cmdSwitch()->setProcessed(i,true);
+    }
+    if(!rda->cmdSwitch()->processed(i)) {
+      fprintf(stderr,"logindex_test: unknown option \"%s\"\n",
+	      rda->cmdSwitch()->key(i).toUtf8().constData());
+      exit(256);
+    }
+  }
+
+  //
+  // Build the Log
+  //
+  RDLogModel *model=new RDLogModel(this);
+  model->insert(0,lines);
+  ok=Check(model,"insert");
+
+  //
+  // Random Edits
+  //
+  srandom(1);
+  for(int i=0;(i<edits)&&ok;i++) {
+    int line=random()%model->lineCount();
+    int dest=random()%model->lineCount();
+    switch(random()%4) {
+    case 0:
+      model->insert(line,1+random()%3);
+      ok=Check(model,"insert");
+      break;
+
+    case 1:
+      if(model->lineCount()>1) {
+	model->remove(line,1);
+      }
+      ok=Check(model,"remove");
+      break;
+
+    case 2:
+      model->move(line,dest);
+      ok=Check(model,"move");
+      break;
+
+    case 3:
+      model->copy(line,dest);
+      ok=Check(model,"copy");
+      break;
+    }
+  }
+  if(ok) {
+    printf("%d edits checked, %d lines\n",edits,model->lineCount());
+  }
+
+  //
+  // Time the Lookups
+  //
+  if(ok) {
+    struct timeval start_tv;
+    struct timeval end_tv;
+    int last=model->lineCount()-1;
+
+    gettimeofday(&start_tv,NULL);
+    model->insert(0,1);
+    model->lineById(model->logLine(last)->id());
+    gettimeofday(&end_tv,NULL);
+    printf("reindex after insert at line 0: %9.3lf ms\n",
+	   1000.0*((double)(end_tv.tv_sec-start_tv.tv_sec)+
+		   (double)(end_tv.tv_usec-start_tv.tv_usec)/1000000.0));
+    last=model->lineCount()-1;
+    printf("%-8s %8s %14s %14s\n","position","line","index ns","scan ns");
+    int pos[3]={0,last/2,last};
+    const char *names[3]={"first","middle","last"};
+    for(int i=0;i<3;i++) {
+      int id=model->logLine(pos[i])->id();
+      printf("%-8s %8d %14.1lf %14.1lf\n",names[i],pos[i],
+	     TimeLookups(model,id,lookups,false),
+	     TimeLookups(model,id,lookups/100+1,true));
+    }
+    printf("%-8s %8s %14.1lf %14.1lf\n","random","-",
+	   TimeLookups(model,-1,lookups,false),
+	   TimeLookups(model,-1,lookups/100+1,true));
+  }
+  delete model;
+
+  exit(ok?0:1);
+}
+
+
+bool MainObject::Check(RDLogModel *model,const QString &op) const
+{
+  QString err_msg;
+  int last=model->lineCount()-1;
+  int lines[4]={0,last/2,last,(int)(random()%(last+1))};
+
+  if(!model->checkIdIndex(&err_msg)) {
+    fprintf(stderr,"logindex_test: after %s: %s\n",op.toUtf8().constData(),
+	    err_msg.toUtf8().constData());
+    return false;
+  }
+  for(int i=0;i<4;i++) {
+    int id=model->logLine(lines[i])->id();
+    if(model->lineById(id)!=LinearScan(model,id)) {
+      fprintf(stderr,
+	      "logindex_test: after %s: ID %d found at line %d, expected %d\n",
+	      op.toUtf8().constData(),id,model->lineById(id),
+	      LinearScan(model,id));
+      return false;
+    }
+  }
+  if(model->lineById(model->nextId())!=-1) {
+    fprintf(stderr,"logindex_test: after %s: found nonexistent ID %d\n",
+	    op.toUtf8().constData(),model->nextId());
+    return false;
+  }
+  return true;
+}
+
+
+int MainObject::LinearScan(RDLogModel *model,int id) const
+{
+  for(int i=0;i<model->lineCount();i++) {
+    if(model->logLine(i)->id()==id) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+
+double MainObject::TimeLookups(RDLogModel *model,int id,int lookups,
+			       bool linear) const
+{
+  struct timeval start_tv;
+  struct timeval end_tv;
+  QList<int> ids;
+  volatile int line=0;
+
+  //
+  // Pick the IDs beforehand, so as to time only the lookups
+  //
+  for(int i=0;i<lookups;i++) {
+    if(id<0) {
+      ids.push_back(model->logLine(random()%model->lineCount())->id());
+    }
+    else {
+      ids.push_back(id);
+    }
+  }
+  gettimeofday(&start_tv,NULL);
+  for(int i=0;i<lookups;i++) {
+    if(linear) {
+      line=LinearScan(model,ids.at(i));
+    }
+    else {
+      line=model->lineById(ids.at(i));
+    }
+  }
+  gettimeofday(&end_tv,NULL);
+
+  return 1000000000.0*((double)(end_tv.tv_sec-start_tv.tv_sec)+
+		       (double)(end_tv.tv_usec-start_tv.tv_usec)/1000000.0)/
+    (double)lookups;
+}
+
+
+int main(int argc,char *argv[])
+{
+  QApplication a(argc,argv,false);
+  new MainObject();
+  return a.exec();
+}
@@ -0,0 +1,42 @@
+// logindex_test.h
+//
+// Exercise the line ID index of RDLogModel.
+//
+//   (C) Copyright 2021 Fred Gleason <fredg@paravelsystems.com>
+//
+//   This program is free software; you can redistribute it and/or modify
+//   it under the terms of the GNU General Public License version 2 as
+//   published by the Free Software Foundation.
+//
+//   This program is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//   GNU General Public License for more details.
+//
+//   You should have received a copy of the GNU General Public
+//   License along with this program; if not, write to the Free Software
+//   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+//
+
+#ifndef LOGINDEX_TEST_H
+#define LOGINDEX_TEST_H
+
+#include <qobject.h>
+
+#include <rdlogmodel.h>
+
+#define LOGINDEX_TEST_USAGE "[options]\n\nBuild a log in memory, check RDLogModel::lineById() against a linear scan\nacross inserts, removes, moves and copies, then time lookups at the start,\nmiddle and end of the log.\n\nOptions are:\n--lines=<num>\n     Number of lines in the log. Default is 20000.\n\n--lookups=<num>\n     Number of lookups to time at each position. Default is 100000.\n\n--edits=<num>\n     Number of random edits to check. Default is 500.\n\n"
+
+class MainObject : public QObject
+{
+ public:
+  MainObject(QObject *parent=0);
+
+ private:
+  bool Check(RDLogModel *model,const QString &op) const;
+  int LinearScan(RDLogModel *model,int id) const;
+  double TimeLookups(RDLogModel *model,int id,int lookups,bool linear) const;
+};
+
+
+#endif  // LOGINDEX_TEST_H
@@ -0,0 +1,174 @@
+// logload_benchmark.cpp
+//
+// Benchmark the loading of a long log by RDLogModel.
+//
+//   (C) Copyright 2021 Fred Gleason <fredg@paravelsystems.com>
+//
+//   This program is free software; you can redistribute it and/or modify
+//   it under the terms of the GNU General Public License version 2 as
+//   published by the Free Software Foundation.
+//
+//   This program is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//   GNU General Public License for more details.
+//
+//   You should have received a copy of the GNU General Public
+//   License along with this program; if not, write to the Free Software
+//   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+//
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <qapplication.h>
+
+#include <rdapplication.h>
+#include <rddb.h>
+#include <rdlog.h>
+#include <rdlogmodel.h>
+
+#include "logload_benchmark.h"
+#include "query_timer.h"
+
+MainObject::MainObject(QObject *parent)
+  :QObject(parent)
+{
+  int lines=10000;
+  int iterations=10;
+  QString svcname;
+  QString logname;
+  QString err_msg;
+  QString sql;
+  RDSqlQuery *q=NULL;
+  QList<unsigned> carts;
+  bool ok=false;
+
+  //
+  // Open the Database
+  //
+  rda=static_cast<RDApplication *>(new RDCoreApplication("logload_benchmark","logload_benchmark",LOGLOAD_BENCHMARK_USAGE,this));
+  if(!rda->open(&err_msg)) {
+    fprintf(stderr,"logload_benchmark: %s\n",err_msg.toUtf8().constData());
+    exit(1);
+  }
+
+  //
+  // Read Command Options
+  //
+  for(unsigned i=0;i<rda->cmdSwitch()->keys();i++) {
+    if(rda->cmdSwitch()->key(i)=="--lines") {
+      lines=rda->cmdSwitch()->value(i).toInt(&ok);
+      if((!ok)||(lines<1)) {
+	fprintf(stderr,"logload_benchmark: invalid --lines argument\n");
+	exit(256);
+      }
+      rda->cmdSwitch()->setProcessed(i,true);
+    }
+    if(rda->cmdSwitch()->key(i)=="--iterations") {
+      iterations=rda->cmdSwitch()->value(i).toInt(&ok);
+      if((!ok)||(iterations<1)) {
+	fprintf(stderr,"logload_benchmark: invalid --iterations argument\n");
+	exit(256);
+      }
+      rda->cmdSwitch()->setProcessed(i,true);
+    }
+    if(rda->cmdSwitch()->key(i)=="--service") {
+      svcname=rda->cmdSwitch()->value(i);
+      rda->cmdSwitch()->setProcessed(i,true);
+    }
+    if(!rda->cmdSwitch()->processed(i)) {
+      fprintf(stderr,"logload_benchmark: unknown option \"%s\"\n",
+	      rda->cmdSwitch()->key(i).toUtf8().constData());
+      exit(256);
+    }
+  }
+  if(svcname.isEmpty()) {
+    q=new RDSqlQuery("select NAME from SERVICES order by NAME");
+    if(q->first()) {
+      svcname=q->value(0).toString();
+    }
+    delete q;
+  }
+  if(svcname.isEmpty()) {
+    fprintf(stderr,"logload_benchmark: no service available\n");
+    exit(1);
+  }
+  sql=QString("select NUMBER from CART order by NUMBER limit 1000");
+  q=new RDSqlQuery(sql);
+  while(q->next()) {
+    carts.push_back(q->value(0).toUInt());
+  }
+  delete q;
+
+  //
+  // Create the Log
+  //
+  logname=QString().sprintf("logload_benchmark_%d",getpid());
+  if(!RDLog::create(logname,svcname,QDate(),rda->user()->name(),&err_msg,
+		    rda->config())) {
+    fprintf(stderr,"logload_benchmark: %s\n",err_msg.toUtf8().constData());
+    exit(1);
+  }
+  RDLogModel *model=new RDLogModel(logname,false,this);
+  model->insert(0,lines);
+  for(int i=0;i<lines;i++) {
+    RDLogLine *ll=model->logLine(i);
+    ll->setStartTime(RDLogLine::Logged,QTime().addMSecs(i*1000));
+    ll->setTransType(RDLogLine::Segue);
+    if(((i%1000)==999)&&(i<(lines-1))) {
+      ll->setType(RDLogLine::Chain);
+      ll->setMarkerLabel(logname);
+    }
+    else {
+      if(((i%10)==9)||carts.isEmpty()) {
+	ll->setType(RDLogLine::Marker);
+	ll->setMarkerComment(QString().sprintf("Marker %d",i));
+      }
+      else {
+	ll->setType(RDLogLine::Cart);
+	ll->setCartNumber(carts.at(i%carts.size()));
+      }
+    }
+  }
+  model->save(rda->config());
+  delete model;
+
+  //
+  // Run the Test
+  //
+  double total=0.0;
+  for(int i=0;i<iterations;i++) {
+    QueryTimer timer;
+
+    model=new RDLogModel(logname,false,this);
+    timer.start();
+    model->load();
+    timer.stop();
+    total+=timer.elapsed();
+    printf("load %3d  lines: %5d  queries: %4u  ms: %9.3lf\n",i,
+	   model->lineCount(),timer.queries(),timer.elapsed());
+    ok=model->lineCount()==lines;
+    delete model;
+    if(!ok) {
+      fprintf(stderr,"logload_benchmark: wrong number of lines loaded\n");
+      break;
+    }
+  }
+  printf("mean ms/load: %9.3lf\n",total/(double)iterations);
+
+  //
+  // Clean Up
+  //
+  RDLog::remove(logname,rda->station(),rda->user(),rda->config());
+
+  exit(ok?0:1);
+}
+
+
+int main(int argc,char *argv[])
+{
+  QApplication a(argc,argv,false);
+  new MainObject();
+  return a.exec();
+}
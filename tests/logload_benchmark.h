@@ -0,0 +1,35 @@
+// logload_benchmark.h
+//
+// Benchmark the loading of a long log by RDLogModel.
+//
+//   (C) Copyright 2021 Fred Gleason <fredg@paravelsystems.com>
+//
+//   This program is free software; you can redistribute it and/or modify
+//   it under the terms of the GNU General Public License version 2 as
+//   published by the Free Software Foundation.
+//
+//   This program is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//   GNU General Public License for more details.
+//
+//   You should have received a copy of the GNU General Public
+//   License along with this program; if not, write to the Free Software
+//   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+//
+
+#ifndef LOGLOAD_BENCHMARK_H
+#define LOGLOAD_BENCHMARK_H
+
+#include <qobject.h>
+
+#define LOGLOAD_BENCHMARK_USAGE "[options]\n\nCreate a synthetic log, time repeated loads of it by RDLogModel, then\ndelete it.  The log uses the carts of the library in turn, with a marker\nevery tenth line and a chain every thousandth.\n\nOptions are:\n--lines=<num>\n     Number of lines in the log. Default is 10000.\n\n--iterations=<num>\n     Number of times to load the log. Default is 10.\n\n--service=<svc-name>\n     Service to own the log. Default is the first service.\n\n"
+
+class MainObject : public QObject
+{
+ public:
+  MainObject(QObject *parent=0);
+};
+
+
+#endif  // LOGLOAD_BENCHMARK_H
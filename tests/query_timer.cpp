@@ -0,0 +1,78 @@
+// query_timer.cpp
+//
+// Time a database operation and count the queries it makes.
+//
+//   (C) Copyright 2021 Fred Gleason <fredg@paravelsystems.com>
+//
+//   This program is free software; you can redistribute it and/or modify
+//   it under the terms of the GNU General Public License version 2 as
+//   published by the Free Software Foundation.
+//
+//   This program is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//   GNU General Public License for more details.
+//
+//   You should have received a copy of the GNU General Public
+//   License along with this program; if not, write to the Free Software
+//   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+//
+
+#include <rddb.h>
+
+#include "query_timer.h"
+
+QueryTimer::QueryTimer()
+{
+  timer_start_tv.tv_sec=0;
+  timer_start_tv.tv_usec=0;
+  timer_end_tv=timer_start_tv;
+  timer_start_queries=0;
+  timer_queries=0;
+}
+
+
+void QueryTimer::start()
+{
+  timer_start_queries=QueryCount();
+  gettimeofday(&timer_start_tv,NULL);
+}
+
+
+void QueryTimer::stop()
+{
+  gettimeofday(&timer_end_tv,NULL);
+
+  //
+  // The second SHOW STATUS counts itself
+  //
+  timer_queries=QueryCount()-timer_start_queries-1;
+}
+
+
+unsigned QueryTimer::queries() const
+{
+  return timer_queries;
+}
+
+
+double QueryTimer::elapsed() const
+{
+  return 1000.0*((double)(timer_end_tv.tv_sec-timer_start_tv.tv_sec)+
+		 (double)(timer_end_tv.tv_usec-timer_start_tv.tv_usec)/
+		 1000000.0);
+}
+
+
+unsigned QueryTimer::QueryCount() const
+{
+  unsigned ret=0;
+  RDSqlQuery *q=new RDSqlQuery("show session status like \"Questions\"");
+
+  if(q->first()) {
+    ret=q->value(1).toUInt();
+  }
+  delete q;
+
+  return ret;
+}
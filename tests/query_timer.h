@@ -0,0 +1,50 @@
+// query_timer.h
+//
+// Time a database operation and count the queries it makes.
+//
+//   (C) Copyright 2021 Fred Gleason <fredg@paravelsystems.com>
+//
+//   This program is free software; you can redistribute it and/or modify
+//   it under the terms of the GNU General Public License version 2 as
+//   published by the Free Software Foundation.
+//
+//   This program is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//   GNU General Public License for more details.
+//
+//   You should have received a copy of the GNU General Public
+//   License along with this program; if not, write to the Free Software
+//   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+//
+
+#ifndef QUERY_TIMER_H
+#define QUERY_TIMER_H
+
+#include <sys/time.h>
+
+//
+// QueryTimer
+//
+// Measures the wall clock time between start() and stop(), along with
+// the number of queries the session sent to the server in between.
+//
+class QueryTimer
+{
+ public:
+  QueryTimer();
+  void start();
+  void stop();
+  unsigned queries() const;
+  double elapsed() const;
+
+ private:
+  unsigned QueryCount() const;
+  struct timeval timer_start_tv;
+  struct timeval timer_end_tv;
+  unsigned timer_start_queries;
+  unsigned timer_queries;
+};
+
+
+#endif  // QUERY_TIMER_H
@@ -0,0 +1,162 @@
+// render_benchmark.cpp
+//
+// Measure the speed of the Rivendell log renderer.
+//
+//   (C) Copyright 2021 Fred Gleason <fredg@paravelsystems.com>
+//
+//   This program is free software; you can redistribute it and/or modify
+//   it under the terms of the GNU General Public License version 2 as
+//   published by the Free Software Foundation.
+//
+//   This program is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//   GNU General Public License for more details.
+//
+//   You should have received a copy of the GNU General Public
+//   License along with this program; if not, write to the Free Software
+//   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+//
+
+#include <stdlib.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <sndfile.h>
+
+#include <qapplication.h>
+
+#include <rdapplication.h>
+#include <rdlog.h>
+#include <rdlogmodel.h>
+#include <rdrenderer.h>
+#include <rdtempdirectory.h>
+
+#include "render_benchmark.h"
+
+MainObject::MainObject(QObject *parent)
+  :QObject(parent)
+{
+  QString logname;
+  QString username;
+  QList<int> workers;
+  QString err_msg;
+  bool ok=false;
+
+  //
+  // Open the Database
+  //
+  rda=static_cast<RDApplication *>(new RDCoreApplication("render_benchmark","render_benchmark",RENDER_BENCHMARK_USAGE,this));
+  if(!rda->open(&err_msg)) {
+    fprintf(stderr,"render_benchmark: %s\n",err_msg.toUtf8().constData());
+    exit(1);
+  }
+
+  //
+  // Read Command Options
+  //
+  for(unsigned i=0;i<rda->cmdSwitch()->keys();i++) {
+    if(rda->cmdSwitch()->key(i)=="--log") {
+      logname=rda->cmdSwitch()->value(i);
+      rda->cmdSwitch()->setProcessed(i,true);
+    }
+    if(rda->cmdSwitch()->key(i)=="--username") {
+      username=rda->cmdSwitch()->value(i);
+      rda->cmdSwitch()->setProcessed(i,true);
+    }
+    if(rda->cmdSwitch()->key(i)=="--workers") {
+      QStringList f0=rda->cmdSwitch()->value(i).split(",");
+      for(int j=0;j<f0.size();j++) {
+	workers.push_back(f0.at(j).toInt(&ok));
+	if((!ok)||(workers.back()<0)) {
+	  fprintf(stderr,"render_benchmark: invalid --workers argument\n");
+	  exit(256);
+	}
+      }
+      rda->cmdSwitch()->setProcessed(i,true);
+    }
+    if(!rda->cmdSwitch()->processed(i)) {
+      fprintf(stderr,"render_benchmark: unknown option \"%s\"\n",
+	      rda->cmdSwitch()->key(i).toUtf8().constData());
+      exit(256);
+    }
+  }
+  if(logname.isEmpty()) {
+    fprintf(stderr,"render_benchmark: you must specify a log with \"--log=\"\n");
+    exit(256);
+  }
+  if(workers.size()==0) {
+    workers.push_back(1);
+    workers.push_back(0);
+  }
+  if(!username.isEmpty()) {
+    rda->user()->setName(username);
+  }
+
+  //
+  // Load the Log
+  //
+  RDLog *log=new RDLog(logname);
+  if(!log->exists()) {
+    fprintf(stderr,"render_benchmark: no such log\n");
+    exit(1);
+  }
+  delete log;
+  RDLogModel *model=new RDLogModel(logname,false,this);
+  model->load();
+
+  RDSettings settings;
+  settings.setFormat(RDSettings::Pcm16);
+  settings.setChannels(2);
+  settings.setSampleRate(rda->system()->sampleRate());
+  settings.setNormalizationLevel(0);
+  QString filename=RDTempDirectory::basePath()+
+    QString().sprintf("/render_benchmark-%d.wav",getpid());
+
+  //
+  // Run the Tests
+  //
+  for(int i=0;i<workers.size();i++) {
+    struct timeval start_tv;
+    struct timeval end_tv;
+    SF_INFO sf_info;
+    SNDFILE *sf=NULL;
+
+    RDRenderer *r=new RDRenderer(this);
+    r->setWorkers(workers.at(i));
+    gettimeofday(&start_tv,NULL);
+    if(!r->renderToFile(filename,model,&settings,QTime(0,0,0,1),true,
+			&err_msg,-1,-1)) {
+      fprintf(stderr,"render_benchmark: %s\n",err_msg.toUtf8().constData());
+      unlink(filename.toUtf8());
+      exit(1);
+    }
+    gettimeofday(&end_tv,NULL);
+    double elapsed=(double)(end_tv.tv_sec-start_tv.tv_sec)+
+      (double)(end_tv.tv_usec-start_tv.tv_usec)/1000000.0;
+
+    memset(&sf_info,0,sizeof(sf_info));
+    if((sf=sf_open(filename.toUtf8(),SFM_READ,&sf_info))==NULL) {
+      fprintf(stderr,"render_benchmark: unable to read rendered audio\n");
+      unlink(filename.toUtf8());
+      exit(1);
+    }
+    double length=(double)sf_info.frames/(double)sf_info.samplerate;
+    sf_close(sf);
+
+    printf("workers: %3d  audio: %10.3lf s  elapsed: %10.3lf s  real-time factor: %8.2lfx\n",
+	   r->workers(),length,elapsed,length/elapsed);
+    delete r;
+  }
+  unlink(filename.toUtf8());
+
+  exit(0);
+}
+
+
+int main(int argc,char *argv[])
+{
+  QApplication a(argc,argv,false);
+  new MainObject();
+  return a.exec();
+}
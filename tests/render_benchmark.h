@@ -0,0 +1,35 @@
+// render_benchmark.h
+//
+// Measure the speed of the Rivendell log renderer.
+//
+//   (C) Copyright 2021 Fred Gleason <fredg@paravelsystems.com>
+//
+//   This program is free software; you can redistribute it and/or modify
+//   it under the terms of the GNU General Public License version 2 as
+//   published by the Free Software Foundation.
+//
+//   This program is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//   GNU General Public License for more details.
+//
+//   You should have received a copy of the GNU General Public
+//   License along with this program; if not, write to the Free Software
+//   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+//
+
+#ifndef RENDER_BENCHMARK_H
+#define RENDER_BENCHMARK_H
+
+#include <qobject.h>
+
+#define RENDER_BENCHMARK_USAGE "[options]\n\nMeasure the speed of the Rivendell log renderer\n\nOptions are:\n--log=<log-name>\n     Name of the log to render.\n\n--username=<username>\n     Rivendell user to use for any audio that must be exported.\n\n--workers=<num>[,<num>...]\n     Render the log once for each of the given numbers of threads.\n     Default is \"1,0\" (single threaded, then one per CPU core).\n\n"
+
+class MainObject : public QObject
+{
+ public:
+  MainObject(QObject *parent=0);
+};
+
+
+#endif  // RENDER_BENCHMARK_H
@@ -0,0 +1,157 @@
+// replica_test.cpp
+//
+// Test routing of read-only queries to a database replica.
+//
+//   (C) Copyright 2021 Fred Gleason <fredg@paravelsystems.com>
+//
+//   This program is free software; you can redistribute it and/or modify
+//   it under the terms of the GNU General Public License version 2 as
+//   published by the Free Software Foundation.
+//
+//   This program is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//   GNU General Public License for more details.
+//
+//   You should have received a copy of the GNU General Public
+//   License along with this program; if not, write to the Free Software
+//   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+//
+
+#include <stdlib.h>
+
+#include <qapplication.h>
+
+#include <rd.h>
+#include <rdapplication.h>
+#include <rddb.h>
+#include <rddbpool.h>
+
+#include "replica_test.h"
+
+MainObject::MainObject(QObject *parent)
+  :QObject(parent)
+{
+  unsigned cartnum=0;
+  int queries=1000;
+  QString err_msg;
+  QString sql;
+  QString title;
+  RDSqlQuery *q=NULL;
+  bool ok=false;
+  int replica_reads=0;
+  int errors=0;
+
+  //
+  // Open the Database
+  //
+  rda=static_cast<RDApplication *>(new RDCoreApplication("replica_test","replica_test",REPLICA_TEST_USAGE,this));
+  if(!rda->open(&err_msg)) {
+    fprintf(stderr,"replica_test: %s\n",err_msg.toUtf8().constData());
+    exit(1);
+  }
+
+  //
+  // Read Command Options
+  //
+  for(unsigned i=0;i<rda->cmdSwitch()->keys();i++) {
+    if(rda->cmdSwitch()->key(i)=="--cart") {
+      cartnum=rda->cmdSwitch()->value(i).toUInt(&ok);
+      if((!ok)||(cartnum==0)||(cartnum>RD_MAX_CART_NUMBER)) {
+	fprintf(stderr,"replica_test: invalid --cart argument\n");
+	exit(256);
+      }
+      rda->cmdSwitch()->setProcessed(i,true);
+    }
+    if(rda->cmdSwitch()->key(i)=="--queries") {
+      queries=rda->cmdSwitch()->value(i).toInt(&ok);
+      if((!ok)||(queries<1)) {
+	fprintf(stderr,"replica_test: invalid --queries argument\n");
+	exit(256);
+      }
+      rda->cmdSwitch()->setProcessed(i,true);
+    }
+    if(!rda->cmdSwitch()->processed(i)) {
+      fprintf(stderr,"replica_test: unknown option \"%s\"\n",
+	      rda->cmdSwitch()->key(i).toUtf8().constData());
+      exit(256);
+    }
+  }
+  if(rda->config()->mysqlReplicaHostname().isEmpty()) {
+    fprintf(stderr,"replica_test: no ReplicaHostname= set in rd.conf(5)\n");
+    exit(1);
+  }
+  if(!RDDbPool::isReplica(RDDbPool::replica())) {
+    fprintf(stderr,"replica_test: replica is not usable, see syslog\n");
+    exit(1);
+  }
+
+  //
+  // Get the reference values from the primary
+  //
+  if(cartnum==0) {
+    sql="select NUMBER from CART order by NUMBER limit 1";
+    q=new RDSqlQuery(sql);
+    if(q->first()) {
+      cartnum=q->value(0).toUInt();
+    }
+    delete q;
+  }
+  sql="select TITLE from CART where NUMBER=?";
+  q=new RDSqlQuery(sql,QList<QVariant>()<<cartnum);
+  if(!q->first()) {
+    fprintf(stderr,"replica_test: no such cart\n");
+    exit(1);
+  }
+  title=q->value(0).toString();
+  delete q;
+
+  //
+  // Lookups
+  //
+  for(int i=0;i<queries;i++) {
+    QSqlDatabase db=RDDbPool::replica();
+    if(RDDbPool::isReplica(db)) {
+      replica_reads++;
+    }
+    q=new RDSqlQuery(sql,QList<QVariant>()<<cartnum,db);
+    if((!q->first())||(q->value(0).toString()!=title)) {
+      errors++;
+    }
+    delete q;
+  }
+  printf("lookups: %d  on replica: %d  errors: %d\n",
+	 queries,replica_reads,errors);
+
+  //
+  // Read-your-writes
+  //
+  if(!RDDbPool::replicaCanRead("select TITLE from CART")) {
+    fprintf(stderr,"replica_test: CART reads routed to primary before write\n");
+    errors++;
+  }
+  RDDbPool::noteWrite("update CART set TITLE=? where NUMBER=?");
+  if(RDDbPool::replicaCanRead("select TITLE from CART where NUMBER=1")) {
+    fprintf(stderr,"replica_test: CART reads routed to replica after write\n");
+    errors++;
+  }
+  if(!RDDbPool::replicaCanRead("select CUT_NAME from CUTS")) {
+    fprintf(stderr,
+	    "replica_test: CUTS reads routed to primary after CART write\n");
+    errors++;
+  }
+  printf("read-your-writes: %s\n",(errors==0)?"ok":"FAILED");
+
+  if(errors>0) {
+    exit(1);
+  }
+  exit(0);
+}
+
+
+int main(int argc,char *argv[])
+{
+  QApplication a(argc,argv,false);
+  new MainObject();
+  return a.exec();
+}
@@ -0,0 +1,35 @@
+// replica_test.h
+//
+// Test routing of read-only queries to a database replica.
+//
+//   (C) Copyright 2021 Fred Gleason <fredg@paravelsystems.com>
+//
+//   This program is free software; you can redistribute it and/or modify
+//   it under the terms of the GNU General Public License version 2 as
+//   published by the Free Software Foundation.
+//
+//   This program is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//   GNU General Public License for more details.
+//
+//   You should have received a copy of the GNU General Public
+//   License along with this program; if not, write to the Free Software
+//   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+//
+
+#ifndef REPLICA_TEST_H
+#define REPLICA_TEST_H
+
+#include <qobject.h>
+
+#define REPLICA_TEST_USAGE "[options]\n\nLook up a cart on the read replica set by ReplicaHostname= in rd.conf(5)\nand compare the results with those from the primary server, then check\nthat reads of a table written by this process go to the primary. Only\nreads are made. Stopping the replica server while the lookups run should\nsend the remaining lookups to the primary without errors.\n\nOptions are:\n--cart=<cart-num>\n     Number of the cart to look up. Default is the first cart.\n\n--queries=<num>\n     Number of lookups to make. Default is 1000.\n\n"
+
+class MainObject : public QObject
+{
+ public:
+  MainObject(QObject *parent=0);
+};
+
+
+#endif  // REPLICA_TEST_H
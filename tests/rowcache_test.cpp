@@ -0,0 +1,153 @@
+// rowcache_test.cpp
+//
+// Test the RDRowCache row cache
+//
+//   (C) Copyright 2021 Fred Gleason <fredg@paravelsystems.com>
+//
+//   This program is free software; you can redistribute it and/or modify
+//   it under the terms of the GNU General Public License version 2 as
+//   published by the Free Software Foundation.
+//
+//   This program is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//   GNU General Public License for more details.
+//
+//   You should have received a copy of the GNU General Public
+//   License along with this program; if not, write to the Free Software
+//   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+//
+
+#include <stdlib.h>
+
+#include <qapplication.h>
+#include <qdatetime.h>
+
+#include <rdapplication.h>
+#include <rdrowcache.h>
+#include <rdstation.h>
+
+#include "rowcache_test.h"
+
+MainObject::MainObject(QObject *parent)
+  :QObject(parent)
+{
+  int queries=1000;
+  QString err_msg;
+  QString desc;
+  QString user_name;
+  QString default_name;
+  QTime timer;
+  bool ok=false;
+  int errors=0;
+
+  //
+  // Open the Database
+  //
+  rda=static_cast<RDApplication *>(new RDCoreApplication("rowcache_test","rowcache_test",ROWCACHE_TEST_USAGE,this));
+  if(!rda->open(&err_msg)) {
+    fprintf(stderr,"rowcache_test: %s\n",err_msg.toUtf8().constData());
+    exit(1);
+  }
+
+  //
+  // Read Command Options
+  //
+  for(unsigned i=0;i<rda->cmdSwitch()->keys();i++) {
+    if(rda->cmdSwitch()->key(i)=="--queries") {
+      queries=rda->cmdSwitch()->value(i).toInt(&ok);
+      if((!ok)||(queries<1)) {
+	fprintf(stderr,"rowcache_test: invalid --queries argument\n");
+	exit(256);
+      }
+      rda->cmdSwitch()->setProcessed(i,true);
+    }
+    if(!rda->cmdSwitch()->processed(i)) {
+      fprintf(stderr,"rowcache_test: unknown option \"%s\"\n",
+	      rda->cmdSwitch()->key(i).toUtf8().constData());
+      exit(256);
+    }
+  }
+  RDStation *station=new RDStation(rda->config()->stationName());
+  if(!station->exists()) {
+    fprintf(stderr,"rowcache_test: no STATIONS row for this host\n");
+    exit(1);
+  }
+
+  //
+  // Uncached
+  //
+  RDRowCache::setTtl(0);
+  desc=station->description();
+  user_name=station->userName();
+  default_name=station->defaultName();
+  timer.start();
+  for(int i=0;i<queries;i++) {
+    station->description();
+    station->userName();
+    station->defaultName();
+  }
+  printf("uncached: %d reads in %d mS\n",3*queries,timer.elapsed());
+
+  //
+  // Cached
+  //
+  RDRowCache::setTtl(60);
+  RDRowCache::resetCounters();
+  timer.start();
+  for(int i=0;i<queries;i++) {
+    if((station->description()!=desc)||(station->userName()!=user_name)||
+       (station->defaultName()!=default_name)) {
+      errors++;
+    }
+  }
+  printf("cached: %d reads in %d mS, %llu hits, %llu misses, %d errors\n",
+	 3*queries,timer.elapsed(),RDRowCache::hits(),RDRowCache::misses(),
+	 errors);
+  if(RDRowCache::misses()!=1) {
+    fprintf(stderr,"rowcache_test: expected 1 miss\n");
+    errors++;
+  }
+
+  //
+  // Invalidation
+  //
+  RDRowCache::resetCounters();
+  RDRowCache::noteWrite("update CART set TITLE=? where NUMBER=?");
+  station->description();
+  if(RDRowCache::misses()!=0) {
+    fprintf(stderr,"rowcache_test: STATIONS row dropped by CART write\n");
+    errors++;
+  }
+  RDRowCache::noteWrite("update STATIONS set DESCRIPTION=? where NAME=?");
+  station->description();
+  if(RDRowCache::misses()!=1) {
+    fprintf(stderr,"rowcache_test: STATIONS row kept after STATIONS write\n");
+    errors++;
+  }
+  RDNotification *notify=
+    new RDNotification(RDNotification::StationType,
+		       RDNotification::ModifyAction,station->name());
+  RDRowCache::processNotification(notify);
+  delete notify;
+  station->description();
+  if(RDRowCache::misses()!=2) {
+    fprintf(stderr,"rowcache_test: STATIONS row kept after notification\n");
+    errors++;
+  }
+  printf("invalidation: %s\n",(errors==0)?"ok":"FAILED");
+  delete station;
+
+  if(errors>0) {
+    exit(1);
+  }
+  exit(0);
+}
+
+
+int main(int argc,char *argv[])
+{
+  QApplication a(argc,argv,false);
+  new MainObject();
+  return a.exec();
+}
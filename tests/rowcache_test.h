@@ -0,0 +1,35 @@
+// rowcache_test.h
+//
+// Test the RDRowCache row cache
+//
+//   (C) Copyright 2021 Fred Gleason <fredg@paravelsystems.com>
+//
+//   This program is free software; you can redistribute it and/or modify
+//   it under the terms of the GNU General Public License version 2 as
+//   published by the Free Software Foundation.
+//
+//   This program is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//   GNU General Public License for more details.
+//
+//   You should have received a copy of the GNU General Public
+//   License along with this program; if not, write to the Free Software
+//   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+//
+
+#ifndef ROWCACHE_TEST_H
+#define ROWCACHE_TEST_H
+
+#include <qobject.h>
+
+#define ROWCACHE_TEST_USAGE "[options]\n\nRead the STATIONS row of this host repeatedly through RDStation, with\nthe row cache disabled and then enabled, and print the number of cache\nhits and misses. Then check that local writes and notifications drop\nthe cached row. Only reads are made.\n\nOptions are:\n--queries=<num>\n     Number of times to read each value. Default is 1000.\n\n"
+
+class MainObject : public QObject
+{
+ public:
+  MainObject(QObject *parent=0);
+};
+
+
+#endif  // ROWCACHE_TEST_H
@@ -0,0 +1,256 @@
+// snapshot_benchmark.cpp
+//
+// Count the database queries made by cart import and edit operations.
+//
+//   (C) Copyright 2021 Fred Gleason <fredg@paravelsystems.com>
+//
+//   This program is free software; you can redistribute it and/or modify
+//   it under the terms of the GNU General Public License version 2 as
+//   published by the Free Software Foundation.
+//
+//   This program is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//   GNU General Public License for more details.
+//
+//   You should have received a copy of the GNU General Public
+//   License along with this program; if not, write to the Free Software
+//   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+//
+
+#include <stdlib.h>
+
+#include <qapplication.h>
+
+#include <rd.h>
+#include <rdapplication.h>
+#include <rdcart.h>
+#include <rdcut.h>
+#include <rddb.h>
+
+#include "query_timer.h"
+#include "snapshot_benchmark.h"
+
+MainObject::MainObject(QObject *parent)
+  :QObject(parent)
+{
+  int iterations=100;
+  QString err_msg;
+  bool ok=false;
+
+  bench_cartnum=0;
+  bench_cutnum=1;
+
+  //
+  // Open the Database
+  //
+  rda=static_cast<RDApplication *>(new RDCoreApplication("snapshot_benchmark","snapshot_benchmark",SNAPSHOT_BENCHMARK_USAGE,this));
+  if(!rda->open(&err_msg)) {
+    fprintf(stderr,"snapshot_benchmark: %s\n",err_msg.toUtf8().constData());
+    exit(1);
+  }
+
+  //
+  // Read Command Options
+  //
+  for(unsigned i=0;i<rda->cmdSwitch()->keys();i++) {
+    if(rda->cmdSwitch()->key(i)=="--cart") {
+      bench_cartnum=rda->cmdSwitch()->value(i).toUInt(&ok);
+      if((!ok)||(bench_cartnum==0)||(bench_cartnum>RD_MAX_CART_NUMBER)) {
+	fprintf(stderr,"snapshot_benchmark: invalid --cart argument\n");
+	exit(256);
+      }
+      rda->cmdSwitch()->setProcessed(i,true);
+    }
+    if(rda->cmdSwitch()->key(i)=="--cut") {
+      bench_cutnum=rda->cmdSwitch()->value(i).toUInt(&ok);
+      if((!ok)||(bench_cutnum==0)||(bench_cutnum>RD_MAX_CUT_NUMBER)) {
+	fprintf(stderr,"snapshot_benchmark: invalid --cut argument\n");
+	exit(256);
+      }
+      rda->cmdSwitch()->setProcessed(i,true);
+    }
+    if(rda->cmdSwitch()->key(i)=="--iterations") {
+      iterations=rda->cmdSwitch()->value(i).toInt(&ok);
+      if((!ok)||(iterations<1)) {
+	fprintf(stderr,"snapshot_benchmark: invalid --iterations argument\n");
+	exit(256);
+      }
+      rda->cmdSwitch()->setProcessed(i,true);
+    }
+    if(!rda->cmdSwitch()->processed(i)) {
+      fprintf(stderr,"snapshot_benchmark: unknown option \"%s\"\n",
+	      rda->cmdSwitch()->key(i).toUtf8().constData());
+      exit(256);
+    }
+  }
+  if(bench_cartnum==0) {
+    fprintf(stderr,
+	    "snapshot_benchmark: you must specify a cart with \"--cart=\"\n");
+    exit(256);
+  }
+  RDCart *cart=new RDCart(bench_cartnum);
+  if((!cart->exists())||(cart->type()!=RDCart::Audio)) {
+    fprintf(stderr,"snapshot_benchmark: no such audio cart\n");
+    exit(1);
+  }
+  if(!RDCut::exists(bench_cartnum,bench_cutnum)) {
+    fprintf(stderr,"snapshot_benchmark: no such cut\n");
+    exit(1);
+  }
+
+  //
+  // The current metadata, to be written back by each operation
+  //
+  RDCut *cut=new RDCut(bench_cartnum,bench_cutnum);
+  cart->getMetadata(&bench_data);
+  cut->getMetadata(&bench_data);
+  delete cut;
+  delete cart;
+
+  //
+  // Run the Tests
+  //
+  for(int flow=0;flow<3;flow++) {
+    for(int snapshot=0;snapshot<2;snapshot++) {
+      QueryTimer timer;
+
+      timer.start();
+      for(int i=0;i<iterations;i++) {
+	switch(flow) {
+	case 0:
+	  ImportFlow(snapshot);
+	  break;
+
+	case 1:
+	  EditCartFlow(snapshot);
+	  break;
+
+	case 2:
+	  EditCutFlow(snapshot);
+	  break;
+	}
+      }
+      timer.stop();
+      double queries=(double)timer.queries()/(double)iterations;
+      printf("%-10s  %-14s  queries/cart: %7.1lf  ms/cart: %8.3lf\n",
+	     (const char *)QString(flow==0?"import":
+				   flow==1?"edit cart":"edit cut").toUtf8(),
+	     snapshot?"snapshot":"field-by-field",queries,
+	     timer.elapsed()/(double)iterations);
+    }
+  }
+
+  exit(0);
+}
+
+
+void MainObject::ImportFlow(bool snapshot)
+{
+  //
+  // The database side of an rdxport Import call, following the
+  // conversion of the audio
+  //
+  RDCart *cart=new RDCart(bench_cartnum);
+  RDCut *cut=new RDCut(bench_cartnum,bench_cutnum);
+  unsigned length_deviation=0;
+
+  if(snapshot) {
+    cart->loadSnapshot();
+    cut->loadSnapshot();
+  }
+  else {
+    cart->exists();
+    cut->exists();
+  }
+  cart->setMetadata(&bench_data);
+  cut->setMetadata(&bench_data);
+  cut->commit();
+  cart->updateLength();
+  cart->resetRotation();
+  cart->calculateAverageLength(&length_deviation);
+  cart->setLengthDeviation(length_deviation);
+  cart->setTitle(bench_data.title());
+  cart->commit();
+  delete cut;
+  delete cart;
+}
+
+
+void MainObject::EditCartFlow(bool snapshot)
+{
+  //
+  // An rdxport EditCart call that sets the common metadata fields
+  //
+  RDCart *cart=new RDCart(bench_cartnum);
+
+  if(snapshot) {
+    cart->loadSnapshot();
+  }
+  else {
+    cart->exists();
+  }
+  cart->type();
+  cart->setTitle(bench_data.title());
+  cart->setArtist(bench_data.artist());
+  cart->setAlbum(bench_data.album());
+  cart->setLabel(bench_data.label());
+  cart->setClient(bench_data.client());
+  cart->setAgency(bench_data.agency());
+  cart->setPublisher(bench_data.publisher());
+  cart->setComposer(bench_data.composer());
+  cart->setConductor(bench_data.conductor());
+  cart->setUserDefined(bench_data.userDefined());
+  cart->setUsageCode((RDCart::UsageCode)bench_data.usageCode());
+  cart->updateLength();
+  cart->commit();
+  delete cart;
+}
+
+
+void MainObject::EditCutFlow(bool snapshot)
+{
+  //
+  // An rdxport EditCut call that sets the cut text and markers
+  //
+  RDCut *cut=new RDCut(bench_cartnum,bench_cutnum);
+
+  if(snapshot) {
+    cut->loadSnapshot();
+  }
+  else {
+    cut->exists();
+  }
+  cut->startPoint();
+  cut->endPoint();
+  cut->fadeupPoint();
+  cut->fadedownPoint();
+  cut->setDescription(bench_data.description());
+  cut->setOutcue(bench_data.outCue());
+  cut->setIsrc(bench_data.isrc());
+  cut->setIsci(bench_data.isci());
+  cut->setStartPoint(bench_data.startPos());
+  cut->setEndPoint(bench_data.endPos());
+  cut->setFadeupPoint(bench_data.fadeUpPos());
+  cut->setFadedownPoint(bench_data.fadeDownPos());
+  cut->setSegueStartPoint(bench_data.segueStartPos());
+  cut->setSegueEndPoint(bench_data.segueEndPos());
+  cut->commit();
+
+  RDCart *cart=new RDCart(bench_cartnum);
+  if(snapshot) {
+    cart->loadSnapshot();
+  }
+  cart->updateLength();
+  cart->resetRotation();
+  delete cart;
+  delete cut;
+}
+
+
+int main(int argc,char *argv[])
+{
+  QApplication a(argc,argv,false);
+  new MainObject();
+  return a.exec();
+}
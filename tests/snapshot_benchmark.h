@@ -0,0 +1,45 @@
+// snapshot_benchmark.h
+//
+// Count the database queries made by cart import and edit operations.
+//
+//   (C) Copyright 2021 Fred Gleason <fredg@paravelsystems.com>
+//
+//   This program is free software; you can redistribute it and/or modify
+//   it under the terms of the GNU General Public License version 2 as
+//   published by the Free Software Foundation.
+//
+//   This program is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//   GNU General Public License for more details.
+//
+//   You should have received a copy of the GNU General Public
+//   License along with this program; if not, write to the Free Software
+//   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+//
+
+#ifndef SNAPSHOT_BENCHMARK_H
+#define SNAPSHOT_BENCHMARK_H
+
+#include <qobject.h>
+
+#include <rdwavedata.h>
+
+#define SNAPSHOT_BENCHMARK_USAGE "[options]\n\nCount the database queries made by cart import and edit operations, with\nand without RDCart/RDCut snapshots. The metadata of the cart is written\nback unchanged, but its timestamps are updated and its rotation is reset,\nso use a test cart.\n\nOptions are:\n--cart=<cart-num>\n     Number of the audio cart to use.\n\n--cut=<cut-num>\n     Number of the cut to use. Default is 1.\n\n--iterations=<num>\n     Number of times to run each operation. Default is 100.\n\n"
+
+class MainObject : public QObject
+{
+ public:
+  MainObject(QObject *parent=0);
+
+ private:
+  void ImportFlow(bool snapshot);
+  void EditCartFlow(bool snapshot);
+  void EditCutFlow(bool snapshot);
+  unsigned bench_cartnum;
+  unsigned bench_cutnum;
+  RDWaveData bench_data;
+};
+
+
+#endif  // SNAPSHOT_BENCHMARK_H
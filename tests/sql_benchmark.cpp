@@ -0,0 +1,177 @@
+// sql_benchmark.cpp
+//
+// Compare the speed of text and prepared RDSqlQuery queries.
+//
+//   (C) Copyright 2021 Fred Gleason <fredg@paravelsystems.com>
+//
+//   This program is free software; you can redistribute it and/or modify
+//   it under the terms of the GNU General Public License version 2 as
+//   published by the Free Software Foundation.
+//
+//   This program is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//   GNU General Public License for more details.
+//
+//   You should have received a copy of the GNU General Public
+//   License along with this program; if not, write to the Free Software
+//   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+//
+
+#include <stdlib.h>
+#include <sys/time.h>
+
+#include <qapplication.h>
+
+#include <rdapplication.h>
+#include <rddb.h>
+#include <rdescape_string.h>
+
+#include "sql_benchmark.h"
+
+MainObject::MainObject(QObject *parent)
+  :QObject(parent)
+{
+  int carts=100;
+  int iterations=10000;
+  QString err_msg;
+  QString sql;
+  RDSqlQuery *q=NULL;
+  bool ok=false;
+
+  //
+  // Open the Database
+  //
+  rda=static_cast<RDApplication *>(new RDCoreApplication("sql_benchmark","sql_benchmark",SQL_BENCHMARK_USAGE,this));
+  if(!rda->open(&err_msg)) {
+    fprintf(stderr,"sql_benchmark: %s\n",err_msg.toUtf8().constData());
+    exit(1);
+  }
+
+  //
+  // Read Command Options
+  //
+  for(unsigned i=0;i<rda->cmdSwitch()->keys();i++) {
+    if(rda->cmdSwitch()->key(i)=="--carts") {
+      carts=rda->cmdSwitch()->value(i).toInt(&ok);
+      if((!ok)||(carts<1)) {
+	fprintf(stderr,"sql_benchmark: invalid --carts argument\n");
+	exit(256);
+      }
+      rda->cmdSwitch()->setProcessed(i,true);
+    }
+    if(rda->cmdSwitch()->key(i)=="--iterations") {
+      iterations=rda->cmdSwitch()->value(i).toInt(&ok);
+      if((!ok)||(iterations<1)) {
+	fprintf(stderr,"sql_benchmark: invalid --iterations argument\n");
+	exit(256);
+      }
+      rda->cmdSwitch()->setProcessed(i,true);
+    }
+    if(!rda->cmdSwitch()->processed(i)) {
+      fprintf(stderr,"sql_benchmark: unknown option \"%s\"\n",
+	      rda->cmdSwitch()->key(i).toUtf8().constData());
+      exit(256);
+    }
+  }
+
+  //
+  // Get the Carts to Look Up
+  //
+  sql=QString().sprintf("select NUMBER from CART order by NUMBER limit %d",
+			carts);
+  q=new RDSqlQuery(sql);
+  while(q->next()) {
+    bench_carts.push_back(q->value(0).toUInt());
+  }
+  delete q;
+  if(bench_carts.size()==0) {
+    fprintf(stderr,"sql_benchmark: no carts found\n");
+    exit(1);
+  }
+
+  //
+  // Run the Tests
+  //
+  for(int mode=0;mode<3;mode++) {
+    struct timeval start_tv;
+    struct timeval end_tv;
+
+    gettimeofday(&start_tv,NULL);
+    RunLookups((MainObject::Mode)mode,iterations);
+    gettimeofday(&end_tv,NULL);
+
+    double elapsed=(double)(end_tv.tv_sec-start_tv.tv_sec)+
+      (double)(end_tv.tv_usec-start_tv.tv_usec)/1000000.0;
+    printf("%-18s  queries/sec: %9.1lf  us/query: %8.1lf\n",
+	   mode==MainObject::Text?"text":
+	   mode==MainObject::Cached?"prepared, cached":"prepared, uncached",
+	   (double)iterations/elapsed,1000000.0*elapsed/(double)iterations);
+  }
+
+  exit(0);
+}
+
+
+void MainObject::RunLookups(Mode mode,int iterations)
+{
+  //
+  // The lookups made by RDCart::selectCut() and RDLogModel::LoadLines()
+  //
+  QString sql;
+  RDSqlQuery *q=NULL;
+  unsigned cartnum=0;
+
+  RDSqlQuery::clearStatementCache();
+  RDSqlQuery::setStatementCacheSize(mode==MainObject::Uncached?0:
+				    RDSQLQUERY_STATEMENT_CACHE_SIZE);
+  for(int i=0;i<iterations;i++) {
+    cartnum=bench_carts.at(i%bench_carts.size());
+    switch(mode) {
+    case MainObject::Text:
+      sql=QString("select TITLE,ARTIST,GROUP_NAME from CART where ")+
+	QString().sprintf("NUMBER=%u",cartnum);
+      q=new RDSqlQuery(sql);
+      break;
+
+    case MainObject::Cached:
+    case MainObject::Uncached:
+      sql=QString("select TITLE,ARTIST,GROUP_NAME from CART where NUMBER=?");
+      q=new RDSqlQuery(sql,QList<QVariant>()<<cartnum);
+      break;
+    }
+    while(q->next()) {
+      q->value(0);
+    }
+    delete q;
+
+    switch(mode) {
+    case MainObject::Text:
+      sql=QString("select CUT_NAME,WEIGHT from CUTS where ")+
+	"(CART_NUMBER="+QString().sprintf("%u",cartnum)+")&&"+
+	"(DESCRIPTION!=\""+RDEscapeString("Benchmark \"cut\"")+"\")";
+      q=new RDSqlQuery(sql);
+      break;
+
+    case MainObject::Cached:
+    case MainObject::Uncached:
+      sql=QString("select CUT_NAME,WEIGHT from CUTS where ")+
+	"(CART_NUMBER=?)&&(DESCRIPTION!=?)";
+      q=new RDSqlQuery(sql,QList<QVariant>()<<cartnum<<"Benchmark \"cut\"");
+      break;
+    }
+    while(q->next()) {
+      q->value(0);
+    }
+    delete q;
+  }
+  RDSqlQuery::setStatementCacheSize(RDSQLQUERY_STATEMENT_CACHE_SIZE);
+}
+
+
+int main(int argc,char *argv[])
+{
+  QApplication a(argc,argv,false);
+  new MainObject();
+  return a.exec();
+}
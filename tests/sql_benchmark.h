@@ -0,0 +1,41 @@
+// sql_benchmark.h
+//
+// Compare the speed of text and prepared RDSqlQuery queries.
+//
+//   (C) Copyright 2021 Fred Gleason <fredg@paravelsystems.com>
+//
+//   This program is free software; you can redistribute it and/or modify
+//   it under the terms of the GNU General Public License version 2 as
+//   published by the Free Software Foundation.
+//
+//   This program is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//   GNU General Public License for more details.
+//
+//   You should have received a copy of the GNU General Public
+//   License along with this program; if not, write to the Free Software
+//   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+//
+
+#ifndef SQL_BENCHMARK_H
+#define SQL_BENCHMARK_H
+
+#include <qlist.h>
+#include <qobject.h>
+
+#define SQL_BENCHMARK_USAGE "[options]\n\nCompare the speed of cart lookups made with the values quoted into the\nSQL text against the same lookups made with bound values, both with and\nwithout the RDSqlQuery prepared statement cache. Only reads are made.\n\nOptions are:\n--carts=<num>\n     Number of carts (taken from the start of the CART table) to look up.\n     Default is 100.\n\n--iterations=<num>\n     Number of lookups to make in each mode. Default is 10000.\n\n"
+
+class MainObject : public QObject
+{
+ public:
+  MainObject(QObject *parent=0);
+
+ private:
+  enum Mode {Text=0,Cached=1,Uncached=2};
+  void RunLookups(Mode mode,int iterations);
+  QList<unsigned> bench_carts;
+};
+
+
+#endif  // SQL_BENCHMARK_H
@@ -31,7 +31,7 @@
 #include <dbversion.h>
 #include <rdconf.h>
 #include <rdescape_string.h>
-#include <rdhash.h>
+#include <rdhashbatch.h>
 #include <rdlog.h>
 
 #include "rddbmgr.h"
@@ -388,9 +388,14 @@ void MainObject::RelinkAudio(const QString &srcdir) const
 
   QDir dir(srcdir);
   QStringList files=dir.entryList(QDir::Files|QDir::Readable|QDir::Hidden);
+  RDHashBatch *batch=new RDHashBatch(db_hash_workers);
   for(int i=0;i<files.size();i++) {
-    QString filename=dir.path()+"/"+files[i];
-    QString hash=RDSha1Hash(filename);
+    batch->addFile(dir.path()+"/"+files[i]);
+  }
+  batch->run();
+  for(int i=0;i<batch->size();i++) {
+    QString filename=batch->filename(i);
+    QString hash=batch->hash(i);
     QString firstdest;
     bool delete_source=true;
 
@@ -433,6 +438,7 @@ void MainObject::RelinkAudio(const QString &srcdir) const
       unlink(filename.toUtf8());
     }
   }
+  delete batch;
 }
 
 
@@ -832,42 +838,75 @@ void MainObject::Rehash(const QString &arg) const
   QSqlQuery *q;
   unsigned cartnum;
   bool ok=false;
+  RDHashBatch *batch=new RDHashBatch(db_hash_workers);
+  batch->setThrottle(true);
 
   if(arg.toLower()=="all") {
-    sql=QString("select NUMBER from CART where ")+
-      QString().sprintf("TYPE=%d ",RDCart::Audio)+
-      "order by NUMBER";
+    sql=QString("select ")+
+      "CUTS.CUT_NAME,"+          // 00
+      "CUTS.SHA1_FINGERPRINT "+  // 01
+      "from CUTS left join CART "+
+      "on CUTS.CART_NUMBER=CART.NUMBER where "+
+      QString().sprintf("CART.TYPE=%d ",RDCart::Audio)+
+      "order by CUTS.CUT_NAME";
     q=new QSqlQuery(sql);
     while(q->next()) {
-      RehashCart(q->value(0).toUInt());
+      batch->addCut(q->value(0).toString(),
+		    db_force?QString():q->value(1).toString());
     }
     delete q;
-    return;
   }
-  cartnum=arg.toUInt(&ok);
-  if(ok&&(cartnum>0)&&(cartnum<=RD_MAX_CART_NUMBER)) {
-    RehashCart(cartnum);
-    return;
+  else {
+    cartnum=arg.toUInt(&ok);
+    if(ok&&(cartnum>0)&&(cartnum<=RD_MAX_CART_NUMBER)) {
+      RehashCart(batch,cartnum);
+    }
+    else {
+      RDCut *cut=new RDCut(arg);
+      if(cut->exists()) {
+	batch->addCut(arg,db_force?QString():cut->sha1Fingerprint());
+      }
+      delete cut;
+    }
+  }
+
+  //
+  // Generate the hashes in parallel, then validate them in order.
+  // Cuts whose audio file still matches the stored fingerprint are
+  // skipped unless '--force' was given.
+  //
+  QStringList updates;
+  batch->run();
+  for(int i=0;i<batch->size();i++) {
+    if(batch->skipped(i)) {
+      continue;
+    }
+    if(RehashCut(batch->cutName(i),batch->hash(i))) {
+      updates.push_back(batch->cutName(i));
+    }
   }
-  RDCut *cut=new RDCut(arg);
-  if(cut->exists()) {
-    RehashCut(arg);
+  if(updates.size()>0) {
+    batch->updateCuts(updates);
   }
-  delete cut;
+  delete batch;
 }
 
 
-void MainObject::RehashCart(unsigned cartnum) const
+void MainObject::RehashCart(RDHashBatch *batch,unsigned cartnum) const
 {
   RDCart *cart=new RDCart(cartnum);
   if(cart->exists()) {
     if(cart->type()==RDCart::Audio) {
-      QString sql=QString("select CUT_NAME from CUTS where ")+
+      QString sql=QString("select ")+
+	"CUT_NAME,"+          // 00
+	"SHA1_FINGERPRINT "+  // 01
+	"from CUTS where "+
 	QString().sprintf("CART_NUMBER=%u ",cartnum)+
 	"order by CUT_NAME";
       QSqlQuery *q=new QSqlQuery(sql);
       while(q->next()) {
-	RehashCut(q->value(0).toString());
+	batch->addCut(q->value(0).toString(),
+		      db_force?QString():q->value(1).toString());
       }
       delete q;
     }
@@ -875,12 +914,14 @@ void MainObject::RehashCart(unsigned cartnum) const
   else {
     printf("  Cart %06u does not exist.\n",cartnum);
   }
+  delete cart;
 }
 
 
-void MainObject::RehashCut(const QString &cutnum) const
+bool MainObject::RehashCut(const QString &cutnum,const QString &hash) const
 {
-  QString hash=RDSha1Hash(RDCut::pathName(cutnum),true);
+  bool ret=false;
+
   if(hash.isEmpty()) {
     printf("  Unable to generate hash for \"%s\"\n",
 	   RDCut::pathName(cutnum).toUtf8().constData());
@@ -888,23 +929,21 @@ void MainObject::RehashCut(const QString &cutnum) const
   else {
     RDCut *cut=new RDCut(cutnum);
     if(cut->exists()) {
-      if(cut->sha1Hash().isEmpty()) {
-	cut->setSha1Hash(hash);
+      if(cut->sha1Hash().isEmpty()||(cut->sha1Hash()==hash)) {
+	ret=true;  // New hash, or refresh the stored fingerprint
       }
       else {
-	if(cut->sha1Hash()!=hash) {
-	  RDCart *cart=new RDCart(RDCut::cartNumber(cutnum));
-	  printf("  Cut %d [%s] in cart %06u [%s] has inconsistent SHA1 hash.  Fix? (y/N) ",
-		 cut->cutNumber(),
-		 cut->description().toUtf8().constData(),
-		 cart->number(),
-		 cart->title().toUtf8().constData());
-	  fflush(NULL);
-	  if(UserResponse()) {
-	    cut->setSha1Hash(hash);
-	  }
-	  delete cart;
+	RDCart *cart=new RDCart(RDCut::cartNumber(cutnum));
+	printf("  Cut %d [%s] in cart %06u [%s] has inconsistent SHA1 hash.  Fix? (y/N) ",
+	       cut->cutNumber(),
+	       cut->description().toUtf8().constData(),
+	       cart->number(),
+	       cart->title().toUtf8().constData());
+	fflush(NULL);
+	if(UserResponse()) {
+	  ret=true;
 	}
+	delete cart;
       }
     }
     else {
@@ -912,6 +951,8 @@ void MainObject::RehashCut(const QString &cutnum) const
     }
     delete cut;
   }
+
+  return ret;
 }
 
 
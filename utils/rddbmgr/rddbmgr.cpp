@@ -52,6 +52,8 @@ MainObject::MainObject(QObject *parent)
   db_no=false;
   db_relink_audio="";
   db_relink_audio_move=false;
+  db_hash_workers=0;
+  db_force=false;
 
   db_check_all=true;
   db_check_orphaned_audio=false;
@@ -210,6 +212,18 @@ MainObject::MainObject(QObject *parent)
       db_rehash=cmd->value(i);
       cmd->setProcessed(i,true);
     }
+    if(cmd->key(i)=="--force") {
+      db_force=true;
+      cmd->setProcessed(i,true);
+    }
+    if(cmd->key(i)=="--hash-workers") {
+      db_hash_workers=cmd->value(i).toInt(&ok);
+      if((!ok)||(db_hash_workers<0)) {
+	fprintf(stderr,"rddbmgr: invalid --hash-workers value\n");
+	exit(1);
+      }
+      cmd->setProcessed(i,true);
+    }
     if(cmd->key(i)=="--orphaned-audio") {
       db_check_all=false;
       db_check_orphaned_audio=true;
@@ -25,6 +25,7 @@
 
 #include <rdconfig.h>
 #include <rdfeed.h>
+#include <rdhashbatch.h>
 #include <rdstation.h>
 
 #define RDDBMGR_USAGE "[options]\n"
@@ -65,8 +66,8 @@ class MainObject : public QObject
   void CheckOrphanedAudio() const;
   void ValidateAudioLengths() const;
   void Rehash(const QString &arg) const;
-  void RehashCart(unsigned cartnum) const;
-  void RehashCut(const QString &cutnum) const;
+  void RehashCart(RDHashBatch *batch,unsigned cartnum) const;
+  bool RehashCut(const QString &cutnum,const QString &hash) const;
   void SetCutLength(const QString &cutname,int len) const;
   void RemoveCart(unsigned cartnum);
   bool CopyToAudioStore(const QString &destfile,const QString &srcfile) const;
@@ -151,6 +152,8 @@ class MainObject : public QObject
   QString db_orphan_group_name;
   QString db_dump_cuts_dir;
   QString db_rehash;
+  int db_hash_workers;
+  bool db_force;
   QString db_relink_audio;
   bool db_relink_audio_move;
   QString db_table_create_postfix;
@@ -40,6 +40,26 @@ bool MainObject::RevertSchema(int cur_schema,int set_schema,QString *err_msg)
   // NEW SCHEMA REVERSIONS GO HERE...
 
 
+  //
+  // Revert 350
+  //
+  if((cur_schema==350)&&(set_schema<cur_schema)) {
+    DropColumn("CUTS","LOUDNESS");
+    DropColumn("CUTS","PEAK_LEVEL");
+
+    WriteSchemaVersion(--cur_schema);
+  }
+
+  //
+  // Revert 349
+  //
+  if((cur_schema==349)&&(set_schema<cur_schema)) {
+    DropColumn("PODCASTS","SHA1_FINGERPRINT");
+    DropColumn("CUTS","SHA1_FINGERPRINT");
+
+    WriteSchemaVersion(--cur_schema);
+  }
+
   //
   // Revert 348
   //
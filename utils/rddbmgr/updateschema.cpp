@@ -10460,6 +10460,38 @@ bool MainObject::UpdateSchema(int cur_schema,int set_schema,QString *err_msg)
     WriteSchemaVersion(++cur_schema);
   }
 
+  if((cur_schema<349)&&(set_schema>cur_schema)) {
+    sql=QString("alter table CUTS add column ")+
+      "SHA1_FINGERPRINT varchar(191) after SHA1_HASH";
+    if(!RDSqlQuery::apply(sql,err_msg)) {
+      return false;
+    }
+
+    sql=QString("alter table PODCASTS add column ")+
+      "SHA1_FINGERPRINT varchar(191) after SHA1_HASH";
+    if(!RDSqlQuery::apply(sql,err_msg)) {
+      return false;
+    }
+
+    WriteSchemaVersion(++cur_schema);
+  }
+
+  if((cur_schema<350)&&(set_schema>cur_schema)) {
+    sql=QString("alter table CUTS add column ")+
+      "PEAK_LEVEL int after SHA1_FINGERPRINT";
+    if(!RDSqlQuery::apply(sql,err_msg)) {
+      return false;
+    }
+
+    sql=QString("alter table CUTS add column ")+
+      "LOUDNESS int after PEAK_LEVEL";
+    if(!RDSqlQuery::apply(sql,err_msg)) {
+      return false;
+    }
+
+    WriteSchemaVersion(++cur_schema);
+  }
+
 
   // NEW SCHEMA UPDATES GO HERE...
 
@@ -27,6 +27,7 @@
 #include <syslog.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <unistd.h>
 
 #include <QApplication>
 
@@ -40,8 +41,10 @@
 #include <rdlog.h>
 #include <rdmaint.h>
 #include <rdpodcast.h>
+#include <rdhashbatch.h>
 #include <rdrehash.h>
 #include <rdurl.h>
+#include <rdwavefile.h>
 
 MainObject::MainObject(QObject *parent)
   :QObject(parent)
@@ -127,6 +130,7 @@ void MainObject::RunSystemMaintenance()
   PurgeWebapiAuths();
   PurgeStacks();
   RehashCuts();
+  IndexCuts();
 
   PrintMessage("Finished System Maintenance");
 }
@@ -386,33 +390,106 @@ void MainObject::RehashCuts()
 
   QString sql;
   RDSqlQuery *q;
+  RDHashBatch *batch=new RDHashBatch();
+  QStringList remote_cutnames;
   RDRehash::ErrorCode err;
 
+  //
+  // Audio in a locally mounted store is hashed here, the rest by the
+  // RDRehash web service
+  //
+  batch->setThrottle(true);
   sql="select CUT_NAME from CUTS where SHA1_HASH is null limit 100";
   q=new RDSqlQuery(sql);
   while(q->next()) {
+    if(access(RDCut::pathName(q->value(0).toString()).toUtf8(),R_OK)==0) {
+      batch->addCut(q->value(0).toString());
+    }
+    else {
+      remote_cutnames.push_back(q->value(0).toString());
+    }
+  }
+  delete q;
+  batch->run();
+  for(int i=0;i<batch->size();i++) {
+    if(batch->hash(i).isEmpty()) {
+      rda->syslog(LOG_WARNING,"failed to rehash cut %s [unable to read audio]",
+		  (const char *)batch->cutName(i).toUtf8());
+    }
+    else {
+      if(maint_verbose) {
+	fprintf(stderr,"rehashed cut \"%s\"\n",
+		batch->cutName(i).toUtf8().constData());
+      }
+    }
+  }
+  batch->updateCuts();
+  delete batch;
+
+  for(int i=0;i<remote_cutnames.size();i++) {
     if((err=RDRehash::rehash(rda->station(),rda->user(),rda->config(),
-			     RDCut::cartNumber(q->value(0).toString()),
-			     RDCut::cutNumber(q->value(0).toString())))!=RDRehash::ErrorOk) {
+			     RDCut::cartNumber(remote_cutnames.at(i)),
+			     RDCut::cutNumber(remote_cutnames.at(i))))!=
+       RDRehash::ErrorOk) {
       rda->syslog(LOG_WARNING,"failed to rehash cut %s [%s]",
-		  (const char *)q->value(0).toString().toUtf8(),
+		  (const char *)remote_cutnames.at(i).toUtf8(),
 		  (const char *)RDRehash::errorText(err).toUtf8());
-      
     }
     else {
       if(maint_verbose) {
 	fprintf(stderr,"rehashed cut \"%s\"\n",
-		q->value(0).toString().toUtf8().constData());
+		remote_cutnames.at(i).toUtf8().constData());
       }
     }
     sleep(1);
   }
-  delete q;
 
   PrintMessage("Completed RehashCuts()");
 }
 
 
+void MainObject::IndexCuts()
+{
+  PrintMessage("Starting IndexCuts()");
+
+  QString sql;
+  RDSqlQuery *q;
+  QString pathname;
+  RDWaveFile *wave=NULL;
+  int indexed=0;
+
+  //
+  // Build the frame index of MPEG cuts recorded by caed(8) in a locally
+  // mounted store, which (unlike imported audio) get none, so that
+  // playout doesn't have to fall back to the nominal frame size
+  //
+  sql="select CUT_NAME from CUTS where CODING_FORMAT=1";
+  q=new RDSqlQuery(sql);
+  while(q->next()&&(indexed<100)) {
+    pathname=RDCut::pathName(q->value(0).toString());
+    if((access((pathname+".frames").toUtf8(),F_OK)==0)||
+       (access(pathname.toUtf8(),R_OK)!=0)) {
+      continue;
+    }
+    wave=new RDWaveFile(pathname);
+    if(wave->openWave()) {
+      if(wave->loadFrameIndex()) {
+	indexed++;
+	if(maint_verbose) {
+	  fprintf(stderr,"indexed cut \"%s\"\n",
+		  q->value(0).toString().toUtf8().constData());
+	}
+      }
+      wave->closeWave();
+    }
+    delete wave;
+  }
+  delete q;
+
+  PrintMessage("Completed IndexCuts()");
+}
+
+
  void MainObject::PrintMessage(const QString &msg) const
  {
    if(maint_verbose) {
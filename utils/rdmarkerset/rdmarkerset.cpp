@@ -30,6 +30,7 @@
 
 #include <rd.h>
 #include <rdapplication.h>
+#include <rdaudioanalysis.h>
 #include <rdaudioinfo.h>
 #include <rddb.h>
 #include <rdcart.h>
@@ -53,6 +54,14 @@ MainObject::MainObject(QObject *parent)
   set_verbose=false;
   set_auto_trim=1;
   set_auto_segue=1;
+  set_local=false;
+  set_dry_run=false;
+  set_workers=0;
+  set_batch_size=RDMARKERSET_DEFAULT_BATCH_SIZE;
+  set_next_cut=0;
+  set_changed=0;
+  set_missing=0;
+  set_errors=0;
 
   //
   // Open the Database
@@ -91,6 +100,31 @@ MainObject::MainObject(QObject *parent)
       }
       rda->cmdSwitch()->setProcessed(i,true);
     }    
+    if(rda->cmdSwitch()->key(i)=="--local") {
+      set_local=true;
+      rda->cmdSwitch()->setProcessed(i,true);
+    }
+    if(rda->cmdSwitch()->key(i)=="--workers") {
+      set_workers=rda->cmdSwitch()->value(i).toInt(&ok);
+      if((!ok)||(set_workers<1)) {
+	fprintf(stderr,"rdmarkerset: invalid --workers value\n");
+	exit(256);
+      }
+      rda->cmdSwitch()->setProcessed(i,true);
+    }
+    if(rda->cmdSwitch()->key(i)=="--batch-size") {
+      set_batch_size=rda->cmdSwitch()->value(i).toInt(&ok);
+      if((!ok)||(set_batch_size<1)) {
+	fprintf(stderr,"rdmarkerset: invalid --batch-size value\n");
+	exit(256);
+      }
+      rda->cmdSwitch()->setProcessed(i,true);
+    }
+    if(rda->cmdSwitch()->key(i)=="--dry-run") {
+      set_dry_run=true;
+      set_local=true;
+      rda->cmdSwitch()->setProcessed(i,true);
+    }
     if(rda->cmdSwitch()->key(i)=="--verbose") {
       set_verbose=true;
       rda->cmdSwitch()->setProcessed(i,true);
@@ -118,6 +152,12 @@ MainObject::MainObject(QObject *parent)
     exit(256);
   }
 
+  if(set_workers==0) {
+    if((set_workers=sysconf(_SC_NPROCESSORS_ONLN))<1) {
+      set_workers=1;
+    }
+  }
+
   //
   // Check for Root Perms
   //
@@ -175,9 +215,18 @@ void MainObject::userChangedData()
 {
   for(unsigned i=0;i<set_group_names.size();i++) {
     Print("Processing group \""+set_group_names[i]+"\"...");
-    ProcessGroup(set_group_names[i]);
+    if(set_local) {
+      ProcessGroupLocal(set_group_names[i]);
+    }
+    else {
+      ProcessGroup(set_group_names[i]);
+    }
     Print("");
   }
+  if(set_local&&(set_verbose||set_dry_run)) {
+    printf("%u cut(s) %s, %u without audio, %u error(s)\n",set_changed,
+	   set_dry_run?"would be changed":"changed",set_missing,set_errors);
+  }
 
   exit(0);
 }
@@ -379,6 +428,370 @@ void MainObject::ClearAutoSegue(unsigned cartnum,int cutnum,
 }
 
 
+void MainObject::ProcessGroupLocal(const QString &group_name)
+{
+  QString sql;
+  RDSqlQuery *q;
+  std::vector<pthread_t> threads;
+  std::vector<unsigned> carts;
+  QString update;
+  int pending=0;
+
+  //
+  // Load Cuts
+  //
+  sql=QString("select ")+
+    "CUTS.CUT_NAME,"+           // 00
+    "CART.TITLE,"+              // 01
+    "CUTS.DESCRIPTION,"+        // 02
+    "CUTS.START_POINT,"+        // 03
+    "CUTS.END_POINT,"+          // 04
+    "CUTS.TALK_START_POINT,"+   // 05
+    "CUTS.TALK_END_POINT,"+     // 06
+    "CUTS.SEGUE_START_POINT,"+  // 07
+    "CUTS.SEGUE_END_POINT,"+    // 08
+    "CUTS.HOOK_START_POINT,"+   // 09
+    "CUTS.HOOK_END_POINT,"+     // 10
+    "CUTS.FADEUP_POINT,"+       // 11
+    "CUTS.FADEDOWN_POINT "+     // 12
+    "from CART left join CUTS "+
+    "on CART.NUMBER=CUTS.CART_NUMBER where (CART.GROUP_NAME=\""+
+    RDEscapeString(group_name)+"\")&&"+
+    QString().sprintf("(CART.TYPE!=%d)&&",RDCart::Macro)+
+    "(CUTS.CUT_NAME is not null) "+
+    "order by CUTS.CUT_NAME";
+  q=new RDSqlQuery(sql);
+  set_cuts.clear();
+  while(q->next()) {
+    MarkerCut mc;
+    mc.cart_number=RDCut::cartNumber(q->value(0).toString());
+    mc.cut_number=RDCut::cutNumber(q->value(0).toString());
+    mc.title=q->value(1).toString();
+    mc.description=q->value(2).toString();
+    mc.filename=RDCut::pathName(q->value(0).toString());
+    mc.start_point=q->value(3).toInt();
+    mc.end_point=q->value(4).toInt();
+    mc.talk_start_point=q->value(5).toInt();
+    mc.talk_end_point=q->value(6).toInt();
+    mc.segue_start_point=q->value(7).toInt();
+    mc.segue_end_point=q->value(8).toInt();
+    mc.hook_start_point=q->value(9).toInt();
+    mc.hook_end_point=q->value(10).toInt();
+    mc.fadeup_point=q->value(11).toInt();
+    mc.fadedown_point=q->value(12).toInt();
+    mc.has_audio=false;
+    mc.has_energy=false;
+    mc.audio_length=0;
+    mc.trim_start_point=-1;
+    mc.trim_end_point=-1;
+    mc.segue_point=-1;
+    set_cuts.push_back(mc);
+  }
+  delete q;
+
+  //
+  // Analyze Audio
+  //
+  // The workers only touch the audio files; all database access stays
+  // on this thread.
+  //
+  set_next_cut=0;
+  pthread_mutex_init(&set_cut_mutex,NULL);
+  for(int i=0;i<set_workers;i++) {
+    pthread_t thread;
+    if(pthread_create(&thread,NULL,MainObject::WorkerCallback,this)==0) {
+      threads.push_back(thread);
+    }
+  }
+  if(threads.size()==0) {
+    MainObject::WorkerCallback(this);
+  }
+  for(unsigned i=0;i<threads.size();i++) {
+    pthread_join(threads[i],NULL);
+  }
+  pthread_mutex_destroy(&set_cut_mutex);
+
+  //
+  // Apply Changes
+  //
+  for(unsigned i=0;i<set_cuts.size();i++) {
+    if((update=ApplyMarkers(&set_cuts[i])).isEmpty()) {
+      continue;
+    }
+    set_changed++;
+    if(set_dry_run) {
+      continue;
+    }
+    if(pending==0) {
+      RDSqlQuery::apply("start transaction");
+    }
+    sql=QString("update CUTS set ")+update+" where "+
+      "CUT_NAME=\""+RDCut::cutName(set_cuts[i].cart_number,
+				    set_cuts[i].cut_number)+"\"";
+    RDSqlQuery::apply(sql);
+    if((carts.size()==0)||(carts.back()!=set_cuts[i].cart_number)) {
+      carts.push_back(set_cuts[i].cart_number);
+    }
+    if(++pending>=set_batch_size) {
+      RDSqlQuery::apply("commit");
+      pending=0;
+    }
+  }
+  if(pending>0) {
+    RDSqlQuery::apply("commit");
+  }
+
+  //
+  // Update Cart Lengths
+  //
+  for(unsigned i=0;i<carts.size();i++) {
+    RDCart *cart=new RDCart(carts[i]);
+    cart->updateLength();
+    delete cart;
+  }
+  set_cuts.clear();
+}
+
+
+void MainObject::AnalyzeCut(MarkerCut *mc) const
+{
+  int point;
+  bool need_trim=set_auto_trim<0;
+  bool need_segue=set_auto_segue<0;
+
+  //
+  // Use the import analysis if it is still current
+  //
+  RDAudioAnalysis *ana=new RDAudioAnalysis();
+  if(ana->load(mc->filename)&&
+     ((!need_trim)||ana->hasTrimLevel(100*set_auto_trim))&&
+     ((!need_segue)||ana->hasTrimLevel(100*set_auto_segue))) {
+    mc->has_audio=true;
+    mc->has_energy=true;
+    mc->audio_length=ana->length();
+    if(need_trim) {
+      mc->trim_start_point=ana->startPoint(100*set_auto_trim);
+      mc->trim_end_point=ana->endPoint(100*set_auto_trim);
+    }
+    if(need_segue) {
+      mc->segue_point=ana->endPoint(100*set_auto_segue);
+    }
+    delete ana;
+    return;
+  }
+  delete ana;
+
+  //
+  // Otherwise, scan the energy data
+  //
+  RDWaveFile *wave=new RDWaveFile(mc->filename);
+  if(!wave->openWave()) {
+    delete wave;
+    return;
+  }
+  mc->has_audio=true;
+  mc->has_energy=wave->hasEnergy();
+  mc->audio_length=wave->getExtTimeLength();
+  if(mc->has_energy) {
+    if(need_trim) {
+      if((point=wave->startTrim(REFERENCE_LEVEL-100*set_auto_trim))>=0) {
+	mc->trim_start_point=
+	  (double)point*1000.0/(double)wave->getSamplesPerSec();
+      }
+      if((point=wave->endTrim(REFERENCE_LEVEL-100*set_auto_trim))>=0) {
+	mc->trim_end_point=
+	  (double)point*1000.0/(double)wave->getSamplesPerSec();
+      }
+    }
+    if(need_segue) {
+      if((point=wave->endTrim(REFERENCE_LEVEL-100*set_auto_segue))>=0) {
+	mc->segue_point=
+	  (double)point*1000.0/(double)wave->getSamplesPerSec();
+      }
+    }
+  }
+  delete wave;
+}
+
+
+QString MainObject::ApplyMarkers(MarkerCut *mc)
+{
+  QString ret;
+  MarkerCut orig=*mc;
+  QString name=QString().sprintf("%06u / %03d [",
+				 mc->cart_number,mc->cut_number)+
+    mc->title+" / "+mc->description+"]";
+
+  if(!mc->has_audio) {
+    set_missing++;
+    return ret;
+  }
+  if((!mc->has_energy)&&((set_auto_trim<0)||(set_auto_segue<0))) {
+    fprintf(stderr,"rdmarkerset: cart %06u, cut %d has no peak data\n",
+	    mc->cart_number,mc->cut_number);
+    set_errors++;
+    return ret;
+  }
+
+  //
+  // Trim
+  //
+  if(set_auto_trim<0) {
+    int start=mc->trim_start_point;
+    int end=mc->trim_end_point;
+    if(start<0) {
+      start=0;
+    }
+    if(end<0) {
+      end=mc->audio_length;
+    }
+    if((mc->talk_start_point>=0)&&(start>mc->talk_start_point)) {
+      mc->talk_start_point=start;
+    }
+    if((mc->talk_end_point>=0)&&(end<mc->talk_end_point)) {
+      mc->talk_end_point=end;
+    }
+    if((mc->segue_start_point>=0)&&(start>mc->segue_start_point)) {
+      mc->segue_start_point=start;
+    }
+    if((mc->segue_end_point>=0)&&(end<mc->segue_end_point)) {
+      mc->segue_end_point=end;
+    }
+    if((mc->hook_start_point>=0)&&(start>mc->hook_start_point)) {
+      mc->hook_start_point=start;
+    }
+    if((mc->hook_end_point>=0)&&(end<mc->hook_end_point)) {
+      mc->hook_end_point=end;
+    }
+    if((mc->fadeup_point>=0)&&(start>mc->fadeup_point)) {
+      mc->fadeup_point=-1;
+    }
+    if((mc->fadedown_point>=0)&&(end<mc->fadedown_point)) {
+      mc->fadedown_point=-1;
+    }
+    mc->start_point=start;
+    mc->end_point=end;
+    Print("  auto-trimming "+name+
+	  QString().sprintf(" to %d dBFS",set_auto_trim));
+  }
+  else {
+    if(set_auto_trim==0) {
+      mc->start_point=0;
+      mc->end_point=mc->audio_length;
+      Print("  clearing auto-trim from "+name);
+    }
+  }
+
+  //
+  // Segue
+  //
+  if(set_auto_segue<0) {
+    if((mc->segue_point>=0)&&(mc->segue_point<mc->end_point)) {
+      mc->segue_start_point=mc->segue_point;
+      mc->segue_end_point=mc->end_point;
+      Print("  setting segue-start for "+name+
+	    QString().sprintf(" at %d dBFS",set_auto_segue));
+    }
+    else {
+      Print("  segue-start for "+name+" cannot be set beyond end marker");
+    }
+  }
+  else {
+    if(set_auto_segue==0) {
+      mc->segue_start_point=-1;
+      mc->segue_end_point=-1;
+    }
+  }
+
+  //
+  // Generate Changes
+  //
+  ret+=ChangedPoint("START_POINT",orig.start_point,mc->start_point);
+  ret+=ChangedPoint("END_POINT",orig.end_point,mc->end_point);
+  ret+=ChangedPoint("TALK_START_POINT",
+		    orig.talk_start_point,mc->talk_start_point);
+  ret+=ChangedPoint("TALK_END_POINT",orig.talk_end_point,mc->talk_end_point);
+  ret+=ChangedPoint("SEGUE_START_POINT",
+		    orig.segue_start_point,mc->segue_start_point);
+  ret+=ChangedPoint("SEGUE_END_POINT",
+		    orig.segue_end_point,mc->segue_end_point);
+  ret+=ChangedPoint("HOOK_START_POINT",
+		    orig.hook_start_point,mc->hook_start_point);
+  ret+=ChangedPoint("HOOK_END_POINT",orig.hook_end_point,mc->hook_end_point);
+  ret+=ChangedPoint("FADEUP_POINT",orig.fadeup_point,mc->fadeup_point);
+  ret+=ChangedPoint("FADEDOWN_POINT",orig.fadedown_point,mc->fadedown_point);
+  if(ret.isEmpty()) {
+    return ret;
+  }
+  ret+=QString().sprintf("LENGTH=%d",mc->end_point-mc->start_point);
+  if(set_dry_run) {
+    printf("%s\n",(name+":").toUtf8().constData());
+    printf("%s",DryRunReport("start",orig.start_point,mc->start_point).
+	   toUtf8().constData());
+    printf("%s",DryRunReport("end",orig.end_point,mc->end_point).
+	   toUtf8().constData());
+    printf("%s",DryRunReport("segue start",orig.segue_start_point,
+			     mc->segue_start_point).toUtf8().constData());
+    printf("%s",DryRunReport("segue end",orig.segue_end_point,
+			     mc->segue_end_point).toUtf8().constData());
+    printf("%s",DryRunReport("talk start",orig.talk_start_point,
+			     mc->talk_start_point).toUtf8().constData());
+    printf("%s",DryRunReport("talk end",orig.talk_end_point,
+			     mc->talk_end_point).toUtf8().constData());
+    printf("%s",DryRunReport("hook start",orig.hook_start_point,
+			     mc->hook_start_point).toUtf8().constData());
+    printf("%s",DryRunReport("hook end",orig.hook_end_point,
+			     mc->hook_end_point).toUtf8().constData());
+    printf("%s",DryRunReport("fade up",orig.fadeup_point,
+			     mc->fadeup_point).toUtf8().constData());
+    printf("%s",DryRunReport("fade down",orig.fadedown_point,
+			     mc->fadedown_point).toUtf8().constData());
+  }
+
+  return ret;
+}
+
+
+QString MainObject::ChangedPoint(const QString &field,int before,
+				 int after) const
+{
+  if(before==after) {
+    return QString();
+  }
+  return field+QString().sprintf("=%d,",after);
+}
+
+
+QString MainObject::DryRunReport(const QString &marker,int before,
+				 int after) const
+{
+  if(before==after) {
+    return QString();
+  }
+  return QString().sprintf("  %-12s %8d -> %8d\n",
+			   marker.toUtf8().constData(),before,after);
+}
+
+
+void *MainObject::WorkerCallback(void *ptr)
+{
+  MainObject *obj=(MainObject *)ptr;
+  unsigned n;
+
+  while(1) {
+    pthread_mutex_lock(&obj->set_cut_mutex);
+    n=obj->set_next_cut++;
+    pthread_mutex_unlock(&obj->set_cut_mutex);
+    if(n>=obj->set_cuts.size()) {
+      return NULL;
+    }
+    obj->AnalyzeCut(&obj->set_cuts[n]);
+  }
+
+  return NULL;
+}
+
+
 void MainObject::Print(const QString &msg)
 {
   if(set_verbose) {
@@ -22,13 +22,40 @@
 #ifndef RDMARKERSET_H
 #define RDMARKERSET_H
 
+#include <pthread.h>
 #include <stdlib.h>
 
 #include <vector>
 
 #include <qobject.h>
 
-#define RDMARKERSET_USAGE "[options]\nThe following options are recognized:\n\n--group=<group>\n     Apply marker changes to the group specified by <group>.  This\n     option may be given multiple times.\n\n--all-groups\n     Apply marker changes to ALL groups.\n\n--auto-trim=<level>\n     Auto-trim the specified cuts to the level indicated by <level> dBFS.\n     Specifying a '0' for <level> will remove auto-trim --i.e. move the\n     Start and End markers to the extreme start and end of the audio data.\n     Default action is to leave the Start and End markers unaltered.\n\n--auto-segue=<level>\n     Set the Segue Start marker on the specified cuts to the level indicated\n     by <level> dBFS and the Segue End marker to the position of the End\n     marker.  Specifying a '0' for <level> will remove the segue markers.\n     Default action is to leave the segue markers unaltered.\n\n--verbose\n     Print messages to stdout describing progress.\n\n"
+#define RDMARKERSET_DEFAULT_BATCH_SIZE 500
+
+struct MarkerCut {
+  unsigned cart_number;
+  int cut_number;
+  QString title;
+  QString description;
+  QString filename;
+  int start_point;
+  int end_point;
+  int talk_start_point;
+  int talk_end_point;
+  int segue_start_point;
+  int segue_end_point;
+  int hook_start_point;
+  int hook_end_point;
+  int fadeup_point;
+  int fadedown_point;
+  bool has_audio;
+  bool has_energy;
+  int audio_length;
+  int trim_start_point;
+  int trim_end_point;
+  int segue_point;
+};
+
+#define RDMARKERSET_USAGE "[options]\nThe following options are recognized:\n\n--group=<group>\n     Apply marker changes to the group specified by <group>.  This\n     option may be given multiple times.\n\n--all-groups\n     Apply marker changes to ALL groups.\n\n--auto-trim=<level>\n     Auto-trim the specified cuts to the level indicated by <level> dBFS.\n     Specifying a '0' for <level> will remove auto-trim --i.e. move the\n     Start and End markers to the extreme start and end of the audio data.\n     Default action is to leave the Start and End markers unaltered.\n\n--auto-segue=<level>\n     Set the Segue Start marker on the specified cuts to the level indicated\n     by <level> dBFS and the Segue End marker to the position of the End\n     marker.  Specifying a '0' for <level> will remove the segue markers.\n     Default action is to leave the segue markers unaltered.\n\n--local\n     Read the audio directly from the audio store rather than through the\n     web API, analyzing cuts in parallel and writing marker changes in\n     batched transactions.\n\n--workers=<num>\n     Use <num> threads for analyzing audio in --local mode.  Default is\n     one per CPU core.\n\n--batch-size=<num>\n     Write marker changes in transactions of <num> cuts in --local mode.\n     Default is 500.\n\n--dry-run\n     Report the marker changes that would be made without making them.\n     Implies --local.\n\n--verbose\n     Print messages to stdout describing progress.\n\n"
 
 class MainObject : public QObject
 {
@@ -49,12 +76,28 @@ class MainObject : public QObject
 		    const QString &desc);
   void ClearAutoSegue(unsigned cartnum,int cutnum,const QString &title,
 		      const QString &desc);
+  void ProcessGroupLocal(const QString &group_name);
+  void AnalyzeCut(MarkerCut *mc) const;
+  QString ApplyMarkers(MarkerCut *mc);
+  QString ChangedPoint(const QString &field,int before,int after) const;
+  QString DryRunReport(const QString &marker,int before,int after) const;
   void Print(const QString &msg);
+  static void *WorkerCallback(void *ptr);
   bool set_all_groups;
   std::vector<QString> set_group_names;
   int set_auto_trim;
   int set_auto_segue;
   bool set_verbose;
+  bool set_local;
+  bool set_dry_run;
+  int set_workers;
+  int set_batch_size;
+  std::vector<MarkerCut> set_cuts;
+  unsigned set_next_cut;
+  pthread_mutex_t set_cut_mutex;
+  unsigned set_changed;
+  unsigned set_missing;
+  unsigned set_errors;
 };
 
 
@@ -37,6 +37,7 @@
 #include <rddbheartbeat.h>
 #include <rdlog.h>
 #include <rdrenderer.h>
+#include <rdrendersink.h>
 #include <rdsettings.h>
 
 #include "rdrender.h"
@@ -50,8 +51,12 @@ MainObject::MainObject(QObject *parent)
   render_first_line=-1;
   render_last_line=-1;
   render_ignore_stops=false;
+  render_workers=0;
   render_cart_number=0;
   render_cut_number=-1;
+  render_to_stdout=false;
+  render_to_socket_port=0;
+  render_segment_length=RDRENDER_DEFAULT_SEGMENT_LENGTH;
   render_start_time=QTime::currentTime();
 
   //
@@ -197,6 +202,14 @@ MainObject::MainObject(QObject *parent)
       }
       rda->cmdSwitch()->setProcessed(i,true);
     }
+    if(rda->cmdSwitch()->key(i)=="--segment-length") {
+      render_segment_length=rda->cmdSwitch()->value(i).toInt(&ok);
+      if((!ok)||(render_segment_length<=0)) {
+	fprintf(stderr,"rdrender: invalid --segment-length argument\n");
+	exit(1);
+      }
+      rda->cmdSwitch()->setProcessed(i,true);
+    }
     if(rda->cmdSwitch()->key(i)=="--start-time") {
       render_start_time=QTime::fromString(rda->cmdSwitch()->value(i));
       if(!render_start_time.isValid()) {
@@ -227,6 +240,40 @@ MainObject::MainObject(QObject *parent)
       render_to_file=rda->cmdSwitch()->value(i);
       rda->cmdSwitch()->setProcessed(i,true);
     }
+    if(rda->cmdSwitch()->key(i)=="--to-segments") {
+      render_to_segments=rda->cmdSwitch()->value(i);
+      if(render_to_segments.isEmpty()) {
+	fprintf(stderr,"rdrender: invalid --to-segments argument\n");
+	exit(1);
+      }
+      rda->cmdSwitch()->setProcessed(i,true);
+    }
+    if(rda->cmdSwitch()->key(i)=="--to-socket") {
+      QStringList f0=rda->cmdSwitch()->value(i).split(":");
+      if((f0.size()!=2)||f0[0].isEmpty()) {
+	fprintf(stderr,"rdrender: invalid --to-socket argument\n");
+	exit(1);
+      }
+      render_to_socket_hostname=f0[0];
+      render_to_socket_port=f0[1].toUInt(&ok);
+      if((!ok)||(render_to_socket_port==0)) {
+	fprintf(stderr,"rdrender: invalid port in --to-socket argument\n");
+	exit(1);
+      }
+      rda->cmdSwitch()->setProcessed(i,true);
+    }
+    if(rda->cmdSwitch()->key(i)=="--to-stdout") {
+      render_to_stdout=true;
+      rda->cmdSwitch()->setProcessed(i,true);
+    }
+    if(rda->cmdSwitch()->key(i)=="--workers") {
+      render_workers=rda->cmdSwitch()->value(i).toInt(&ok);
+      if((!ok)||(render_workers<0)) {
+	fprintf(stderr,"rdrender: invalid --workers argument\n");
+	exit(1);
+      }
+      rda->cmdSwitch()->setProcessed(i,true);
+    }
     if(!rda->cmdSwitch()->processed(i)) {
       fprintf(stderr,"rdrepld: unknown command option \"%s\"\n",
 	      rda->cmdSwitch()->key(i).toUtf8().constData());
@@ -246,11 +293,37 @@ MainObject::MainObject(QObject *parent)
     fprintf(stderr,"rdrender: invalid audio settings\n");
     exit(1);
   }
-  if(render_to_file.isEmpty()&&
-     ((render_cart_number==0)||(render_cut_number==-1))) {
-    fprintf(stderr,"rdrender: you must specify exactly one --to-cart or --to-file option\n");
+  int dests=0;
+  if((render_cart_number!=0)&&(render_cut_number!=-1)) {
+    dests++;
+  }
+  if(!render_to_file.isEmpty()) {
+    dests++;
+  }
+  if(render_to_stdout) {
+    dests++;
+  }
+  if(!render_to_socket_hostname.isEmpty()) {
+    dests++;
+  }
+  if(!render_to_segments.isEmpty()) {
+    dests++;
+  }
+  if(dests!=1) {
+    fprintf(stderr,"rdrender: you must specify exactly one --to-cart, --to-file, --to-segments, --to-socket or --to-stdout option\n");
+    exit(1);
+  }
+  if((render_to_stdout||(!render_to_socket_hostname.isEmpty())||
+      (!render_to_segments.isEmpty()))&&
+     (((render_settings.format()!=RDSettings::Pcm16)&&
+       (render_settings.format()!=RDSettings::Pcm24))||
+      (render_settings.normalizationLevel()!=0))) {
+    fprintf(stderr,"rdrender: streamed output requires --format=pcm16 or --format=pcm24 and no normalization\n");
     exit(1);
   }
+  if(render_to_stdout||(!render_to_socket_hostname.isEmpty())) {
+    signal(SIGPIPE,SIG_IGN);  // Report a closed reader as a write error
+  }
   render_logname=rda->cmdSwitch()->key(rda->cmdSwitch()->keys()-1);
   if(render_start_time.isNull()) {
     render_start_time=QTime(0,0,0,1);
@@ -295,9 +368,31 @@ void MainObject::userData()
   //
   QString err_msg;
   RDRenderer *r=new RDRenderer(this);
+  r->setWorkers(render_workers);
   connect(r,SIGNAL(progressMessageSent(const QString &)),
 	  this,SLOT(printProgressMessage(const QString &)));
-  if(render_to_file.isEmpty()) {
+  RDRenderSink *sink=NULL;
+  if(render_to_stdout) {
+    sink=new RDRenderStreamSink(fileno(stdout));
+  }
+  if(!render_to_socket_hostname.isEmpty()) {
+    sink=new RDRenderSocketSink(render_to_socket_hostname,
+				render_to_socket_port);
+  }
+  if(!render_to_segments.isEmpty()) {
+    sink=new RDRenderChunkSink(render_to_segments,render_segment_length);
+  }
+  if(sink!=NULL) {
+    if(!r->renderToSink(sink,log_model,&render_settings,
+			render_start_time,render_ignore_stops,
+			&err_msg,render_first_line,render_last_line,
+			render_first_time,render_last_time)) {
+      fprintf(stderr,"rdrender: %s\n",err_msg.toUtf8().constData());
+      exit(1);
+    }
+    delete sink;
+  }
+  else if(render_to_file.isEmpty()) {
     if(!r->renderToCart(render_cart_number,render_cut_number,log_model,
 			&render_settings,render_start_time,
 			render_ignore_stops,&err_msg,render_first_line,
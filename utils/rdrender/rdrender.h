@@ -36,6 +36,7 @@
 #define RDRENDER_DEFAULT_BITRATE 256000
 #define RDRENDER_DEFAULT_QUALITY 3
 #define RDRENDER_DEFAULT_NORMALIZATION_LEVEL 0
+#define RDRENDER_DEFAULT_SEGMENT_LENGTH 10
 #define RDRENDER_USAGE "[options] <logname>\n"
 
 class MainObject : public QObject
@@ -52,6 +53,11 @@ class MainObject : public QObject
   bool render_verbose;
   QString render_logname;
   QString render_to_file;
+  bool render_to_stdout;
+  QString render_to_socket_hostname;
+  uint16_t render_to_socket_port;
+  QString render_to_segments;
+  int render_segment_length;
   unsigned render_cart_number;
   int render_cut_number;
   QString render_temp_output_filename;
@@ -61,6 +67,7 @@ class MainObject : public QObject
   QTime render_first_time;
   QTime render_last_time;
   bool render_ignore_stops;
+  int render_workers;
   RDSettings render_settings;
 };
 
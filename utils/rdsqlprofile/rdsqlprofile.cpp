@@ -0,0 +1,151 @@
+// rdsqlprofile.cpp
+//
+// Summarize Rivendell SQL query profiles
+//
+//   (C) Copyright 2021 Fred Gleason <fredg@paravelsystems.com>
+//
+//   This program is free software; you can redistribute it and/or modify
+//   it under the terms of the GNU General Public License version 2 as
+//   published by the Free Software Foundation.
+//
+//   This program is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//   GNU General Public License for more details.
+//
+//   You should have received a copy of the GNU General Public
+//   License along with this program; if not, write to the Free Software
+//   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFileInfo>
+#include <QStringList>
+
+#include <rdcmd_switch.h>
+#include <rdconfig.h>
+#include <rdsqlprofiler.h>
+
+#include "rdsqlprofile.h"
+
+MainObject::MainObject(QObject *parent)
+  : QObject(parent)
+{
+  QStringList paths;
+  QString module;
+  int top=20;
+  RDSqlProfiler::SortKey sort_key=RDSqlProfiler::TotalTime;
+  bool ok=false;
+
+  //
+  // Read Command Options
+  //
+  RDCmdSwitch *cmd=new RDCmdSwitch("rdsqlprofile",RDSQLPROFILE_USAGE);
+  for(unsigned i=0;i<cmd->keys();i++) {
+    if(cmd->key(i)=="--top") {
+      top=cmd->value(i).toInt(&ok);
+      if((!ok)||(top<=0)) {
+	fprintf(stderr,"rdsqlprofile: invalid --top value\n");
+	exit(1);
+      }
+      cmd->setProcessed(i,true);
+    }
+    if(cmd->key(i)=="--sort") {
+      if(cmd->value(i)=="total") {
+	sort_key=RDSqlProfiler::TotalTime;
+      }
+      else {
+	if(cmd->value(i)=="count") {
+	  sort_key=RDSqlProfiler::Count;
+	}
+	else {
+	  if(cmd->value(i)=="max") {
+	    sort_key=RDSqlProfiler::MaxTime;
+	  }
+	  else {
+	    if(cmd->value(i)=="rows") {
+	      sort_key=RDSqlProfiler::Rows;
+	    }
+	    else {
+	      fprintf(stderr,"rdsqlprofile: invalid --sort value\n");
+	      exit(1);
+	    }
+	  }
+	}
+      }
+      cmd->setProcessed(i,true);
+    }
+    if(cmd->key(i)=="--module") {
+      module=cmd->value(i);
+      cmd->setProcessed(i,true);
+    }
+    if((!cmd->processed(i))&&(!cmd->key(i).startsWith("-"))&&
+       cmd->value(i).isEmpty()) {
+      paths.push_back(cmd->key(i));
+      cmd->setProcessed(i,true);
+    }
+    if(!cmd->processed(i)) {
+      fprintf(stderr,"rdsqlprofile: unknown command option \"%s\"\n",
+	      cmd->key(i).toUtf8().constData());
+      exit(2);
+    }
+  }
+  delete cmd;
+
+  //
+  // Default to the configured directory
+  //
+  if(paths.size()==0) {
+    RDConfig *config=new RDConfig();
+    config->load();
+    if(config->mysqlProfileDirectory().isEmpty()) {
+      fprintf(stderr,
+	      "rdsqlprofile: no ProfileDirectory set in rd.conf(5)\n");
+      exit(1);
+    }
+    paths.push_back(config->mysqlProfileDirectory());
+    delete config;
+  }
+
+  //
+  // Merge and Report
+  //
+  for(int i=0;i<paths.size();i++) {
+    Merge(paths.at(i));
+  }
+  printf("%s",RDSqlProfiler::report(top,sort_key,module).toUtf8().
+	 constData());
+
+  exit(0);
+}
+
+
+void MainObject::Merge(const QString &path)
+{
+  QString err_msg;
+  QStringList files;
+
+  if(QFileInfo(path).isDir()) {
+    files=QDir(path).entryList(QStringList("*.sqlprofile"),QDir::Files,
+			       QDir::Name);
+    for(int i=0;i<files.size();i++) {
+      Merge(path+"/"+files.at(i));
+    }
+    return;
+  }
+  if(!RDSqlProfiler::merge(path,&err_msg)) {
+    fprintf(stderr,"rdsqlprofile: %s\n",err_msg.toUtf8().constData());
+  }
+}
+
+
+int main(int argc,char *argv[])
+{
+  QCoreApplication a(argc,argv);
+  new MainObject();
+  return a.exec();
+}
@@ -0,0 +1,38 @@
+// rdsqlprofile.h
+//
+// Summarize Rivendell SQL query profiles
+//
+//   (C) Copyright 2021 Fred Gleason <fredg@paravelsystems.com>
+//
+//   This program is free software; you can redistribute it and/or modify
+//   it under the terms of the GNU General Public License version 2 as
+//   published by the Free Software Foundation.
+//
+//   This program is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//   GNU General Public License for more details.
+//
+//   You should have received a copy of the GNU General Public
+//   License along with this program; if not, write to the Free Software
+//   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+//
+
+#ifndef RDSQLPROFILE_H
+#define RDSQLPROFILE_H
+
+#include <qobject.h>
+
+#define RDSQLPROFILE_USAGE "[options] [<file>|<dir> ...]\n\nSummarize the query statistics written when ProfileQueries is enabled\nin rd.conf(5).  Each <dir> is searched for *.sqlprofile files; if none\nare given, the ProfileDirectory set in rd.conf(5) is used.\n\n--top=<num>\n     Show the <num> most expensive queries.  Default is 20.\n\n--sort=total|count|max|rows\n     Rank queries by their total time, number of calls, longest time or\n     number of rows.  Default is 'total'.\n\n--module=<name>\n     Only show queries made by the <name> module (e.g. 'rdairplay').\n"
+
+class MainObject : public QObject
+{
+ public:
+  MainObject(QObject *parent=0);
+
+ private:
+  void Merge(const QString &path);
+};
+
+
+#endif  // RDSQLPROFILE_H
@@ -27,6 +27,7 @@
 #include <rdapplication.h>
 #include <rdcart_search_text.h>
 #include <rdconf.h>
+#include <rddbpool.h>
 #include <rdescape_string.h>
 #include <rdformpost.h>
 #include <rdgroup.h>
@@ -129,6 +130,14 @@ void Xport::ListCarts()
   RDCart::Type cart_type=RDCart::All;
   QString type;
   QStringList mlist;
+  int limit=0;
+  int after_cart=0;
+  int json=0;
+  unsigned last_cart=0;
+  int count=0;
+  QDateTime changed_since;
+  QString etag;
+  bool ok=false;
 
   //
   // Verify Post
@@ -137,6 +146,15 @@ void Xport::ListCarts()
   xport_post->getValue("FILTER",&filter);
   xport_post->getValue("INCLUDE_CUTS",&include_cuts);
   xport_post->getValue("TYPE",&type);
+  xport_post->getValue("LIMIT",&limit);
+  xport_post->getValue("AFTER_CART",&after_cart);
+  xport_post->getValue("JSON",&json);
+  if((limit<0)||(after_cart<0)) {
+    XmlExit("Invalid LIMIT or AFTER_CART",400,"carts.cpp",LINE_NUMBER);
+  }
+  if(xport_post->getValue("CHANGED_SINCE",&changed_since,&ok)&&(!ok)) {
+    XmlExit("Invalid CHANGED_SINCE",400,"carts.cpp",LINE_NUMBER);
+  }
   if(type.toLower()=="audio") {
     cart_type=RDCart::Audio;
   }
@@ -164,19 +182,82 @@ void Xport::ListCarts()
   if(cart_type!=RDCart::All) {
     where+=QString().sprintf("&&(TYPE=%u)",cart_type);
   }
+  if(after_cart>0) {
+    where+=QString().sprintf("&&(CART.NUMBER>%d)",after_cart);
+  }
+  if(changed_since.isValid()) {
+    where+="&&(CART.METADATA_DATETIME>="+
+      RDCheckDateTime(changed_since,"yyyy-MM-dd hh:mm:ss")+")";
+  }
+
+  //
+  // Find the end of the page. This is done separately from the main
+  // query because a page is counted in carts, not in cart+cut rows.
+  //
+  if(limit>0) {
+    sql=QString("select CART.NUMBER from CART ")+where+
+      " order by CART.NUMBER"+QString().sprintf(" limit %d",limit);
+    q=new RDSqlQuery(sql,RDDbPool::replica());
+    while(q->next()) {
+      last_cart=q->value(0).toUInt();
+    }
+    delete q;
+    where+=QString().sprintf("&&(CART.NUMBER<=%u)",last_cart);
+  }
   sql=RDCart::xmlSql(include_cuts)+where+" order by CART.NUMBER";
-  q=new RDSqlQuery(sql);
+  if(include_cuts) {
+    sql+=",CUTS.CUT_NAME";
+  }
+  q=new RDSqlQuery(sql,RDDbPool::replica());
 
   //
-  // Process Request
+  // Check Validators
   //
-  printf("Content-type: application/xml\n");
-  printf("Status: 200\n\n");
-  printf("<?xml version=\"1.0\" encoding=\"UTF-8\" ?>\n");
-  printf("<cartList>\n");
-  printf("%s\n",(const char *)RDCart::xml(q,include_cuts,true).toUtf8()); 
-  printf("</cartList>\n");
+  etag=QueryEtag(QString().sprintf("ListCarts:%d:",json)+sql,q);
+  CheckNotModified(etag,QDateTime());
+
+  //
+  // Process Request, writing out each cart as it is read
+  //
+  if(json) {
+    printf("Content-type: application/json\n");
+    PrintValidators(etag,QDateTime());
+    printf("Status: 200\n\n");
+    printf("{\r\n");
+    printf("    \"cartList\": [");
+  }
+  else {
+    printf("Content-type: application/xml\n");
+    PrintValidators(etag,QDateTime());
+    printf("Status: 200\n\n");
+    printf("<?xml version=\"1.0\" encoding=\"UTF-8\" ?>\n");
+    printf("<cartList>\n");
+  }
+  while(q->next()) {
+    if(json) {
+      if(count>0) {
+	printf(",");
+      }
+      printf("\r\n%s",(const char *)RDCart::jsonCart(q,include_cuts,true,8).
+	     toUtf8());
+    }
+    else {
+      printf("%s",(const char *)RDCart::xmlCart(q,include_cuts,true).
+	     toUtf8());
+    }
+    count++;
+  }
   delete q;
+  if(json) {
+    if(count>0) {
+      printf("\r\n    ");
+    }
+    printf("]\r\n");
+    printf("}\r\n");
+  }
+  else {
+    printf("</cartList>\n");
+  }
   Exit(0);
 }
 
@@ -276,7 +357,7 @@ void Xport::EditCart()
   // Process Request
   //
   cart=new RDCart(cart_number);
-  if(!cart->exists()) {
+  if(!cart->loadSnapshot()) {
     delete cart;
     XmlExit("No such cart",404,"carts.cpp",LINE_NUMBER);
   }
@@ -394,6 +475,7 @@ void Xport::EditCart()
   if(length_changed) {
     cart->updateLength();
   }
+  cart->commit();
 
   printf("Content-type: application/xml\n");
   printf("Status: 200\n\n");
@@ -508,6 +590,7 @@ void Xport::AddCut()
 void Xport::ListCuts()
 {
   int cart_number;
+  int json=0;
   QString sql;
   RDSqlQuery *q;
 
@@ -517,6 +600,7 @@ void Xport::ListCuts()
   if(!xport_post->getValue("CART_NUMBER",&cart_number)) {
     XmlExit("Missing CART_NUMBER",400,"carts.cpp",LINE_NUMBER);
   }
+  xport_post->getValue("JSON",&json);
 
   //
   // Verify User Perms
@@ -529,16 +613,36 @@ void Xport::ListCuts()
   // Process Request
   //
   sql=RDCart::xmlSql(true)+
-    QString().sprintf(" where CART.NUMBER=%u",cart_number);
-  q=new RDSqlQuery(sql);
-  printf("Content-type: application/xml\n");
-  printf("Status: 200\n\n");
-  printf("<?xml version=\"1.0\" encoding=\"UTF-8\" ?>\n");
-  printf("<cutList>\n");
-  while(q->next()) {
-    printf("%s\n",(const char *)RDCut::xml(q,false).toUtf8());
+    QString().sprintf(" where CART.NUMBER=%u",cart_number)+
+    " order by CUTS.CUT_NAME";
+  q=new RDSqlQuery(sql,RDDbPool::replica());
+  if(json) {
+    printf("Content-type: application/json\n");
+    printf("Status: 200\n\n");
+    printf("{\r\n");
+    printf("    \"cutList\": [");
+    while(q->next()) {
+      if(q->at()>0) {
+	printf(",");
+      }
+      printf("\r\n%s",(const char *)RDCut::json(q,false,8).toUtf8());
+    }
+    if(q->size()>0) {
+      printf("\r\n    ");
+    }
+    printf("]\r\n");
+    printf("}\r\n");
+  }
+  else {
+    printf("Content-type: application/xml\n");
+    printf("Status: 200\n\n");
+    printf("<?xml version=\"1.0\" encoding=\"UTF-8\" ?>\n");
+    printf("<cutList>\n");
+    while(q->next()) {
+      printf("%s\n",(const char *)RDCut::xml(q,false).toUtf8());
+    }
+    printf("</cutList>\n");
   }
-  printf("</cutList>\n");
   delete q;
 
   Exit(0);
@@ -685,7 +789,7 @@ void Xport::EditCut()
   }
 
   cut=new RDCut(cart_number,cut_number);
-  if(!cut->exists()) {
+  if(!cut->loadSnapshot()) {
     delete cut;
     XmlExit("No such cut",404,"carts.cpp",LINE_NUMBER);
   }
@@ -845,8 +949,10 @@ void Xport::EditCut()
     cut->setTalkEndPoint(talk_points[1]);
     length_changed=true;
   }
+  cut->commit();
   if(length_changed||rotation_changed) {
     RDCart *cart=new RDCart(cut->cartNumber());
+    cart->loadSnapshot();
     if(length_changed) {
       cart->updateLength();
     }
@@ -18,12 +18,18 @@
 //   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 //
 
+#include <errno.h>
 #include <stdio.h>
 #include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/sendfile.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
 
+#include <QStringList>
+
 #include <rdapplication.h>
 #include <rdaudioconvert.h>
 #include <rdcart.h>
@@ -33,8 +39,14 @@
 #include <rdtempdirectory.h>
 #include <rdweb.h>
 
+#include "exportcache.h"
 #include "rdxport.h"
 
+//
+// Largest amount of data passed to a single sendfile(2) call
+//
+#define EXPORT_SENDFILE_BLOCK 1048576
+
 void Xport::Export()
 {
   RDAudioConvert::ErrorCode conv_err=RDAudioConvert::ErrorOk;
@@ -134,18 +146,67 @@ void Xport::Export()
     delete cart;
   }
 
+  //
+  // Check Client Cache
+  //
+  // The entity tag is a hash of the SHA1 hash of the cut audio plus
+  // everything else that affects the exported data; it also serves as
+  // the key for the rendition cache.
+  //
+  QString id;
+  QString etag;
+  RDCut *cut=new RDCut(cartnum,cutnum);
+  if(!cut->sha1Hash().isEmpty()) {
+    QString key=cut->sha1Hash()+
+      QString().sprintf(":%d:%d:%d:%d:%d:%d:%d:%d:%d:%.6f",format,channels,
+			sample_rate,bit_rate,quality,normalization_level,
+			start_point,end_point,enable_metadata,speed_ratio);
+    if(wavedata!=NULL) {
+      //
+      // The embedded metadata itself, as cut edits don't touch the
+      // cart's METADATA_DATETIME
+      //
+      key+=":"+wavedata->dump()+":"+rdxl;
+    }
+    id=ExportCache::id(key);
+    etag="\""+id+"\"";
+  }
+  delete cut;
+  CheckNotModified(etag,QDateTime());
+
+  //
+  // Check Rendition Cache
+  //
+  int fd=-1;
+  ExportCache *cache=
+    new ExportCache(rda->config()->exportCacheDirectory(),
+		    (int64_t)rda->config()->exportCacheMaxSize()*1048576);
+  if(id.isEmpty()||(!cache->isActive())) {
+    delete cache;
+    cache=NULL;
+  }
+  if((cache!=NULL)&&((fd=cache->open(id))>=0)) {
+    SendAudio(fd,settings->format(),etag);
+    close(fd);
+    Exit(0);
+  }
+
   //
   // Export Cut
   //
-  int fd;
-  ssize_t n;
-  uint8_t data[2048];
   QString err_msg;
-  RDTempDirectory *tempdir=new RDTempDirectory("rdxport-export");
-  if(!tempdir->create(&err_msg)) {
-    XmlExit("unable to create temporary directory ["+err_msg+"]",500);
+  QString tmpfile;
+  RDTempDirectory *tempdir=NULL;
+  if(cache==NULL) {
+    tempdir=new RDTempDirectory("rdxport-export");
+    if(!tempdir->create(&err_msg)) {
+      XmlExit("unable to create temporary directory ["+err_msg+"]",500);
+    }
+    tmpfile=tempdir->path()+"/exported_audio";
+  }
+  else {
+    tmpfile=cache->tempFilename(id);
   }
-  QString tmpfile=tempdir->path()+"/exported_audio";
   RDAudioConvert *conv=new RDAudioConvert();
   conv->setSourceFile(RDCut::pathName(cartnum,cutnum));
   conv->setDestinationFile(tmpfile);
@@ -156,37 +217,21 @@ void Xport::Export()
   conv->setSpeedRatio(speed_ratio);
   switch(conv_err=conv->convert()) {
   case RDAudioConvert::ErrorOk:
-    switch(settings->format()) {
-    case RDSettings::Pcm16:
-    case RDSettings::Pcm24:
-      printf("Content-type: audio/x-wav\n\n");
-      break;
-
-    case RDSettings::MpegL1:
-    case RDSettings::MpegL2:
-    case RDSettings::MpegL2Wav:
-    case RDSettings::MpegL3:
-      printf("Content-type: audio/x-mpeg\n\n");
-      break;
-
-    case RDSettings::OggVorbis:
-      printf("Content-type: audio/ogg\n\n");
-      break;
-
-    case RDSettings::Flac:
-      printf("Content-type: audio/flac\n\n");
-      break;
+    if((fd=open(tmpfile.toUtf8(),O_RDONLY))<0) {
+      unlink(tmpfile.toUtf8());
+      XmlExit("Unable to open exported audio",500,"export.cpp",LINE_NUMBER);
     }
-    fflush(NULL);
-    if((fd=open(tmpfile.toUtf8(),O_RDONLY))>=0) {
-      while((n=read(fd,data,2048))>0) {
-	write(1,data,n);
-      }
+    if((cache!=NULL)&&cache->insert(id,tmpfile)) {
+      cache->trim();
     }
+    else {
+      unlink(tmpfile.toUtf8());
+    }
+    SendAudio(fd,settings->format(),etag);
     close(fd);
-    unlink(tmpfile.toUtf8());
-    //    rmdir(tmpdir);
-    delete tempdir;
+    if(tempdir!=NULL) {
+      delete tempdir;
+    }
     Exit(0);
     break;
 
@@ -210,12 +255,18 @@ void Xport::Export()
     resp_code=500;
     break;
   }
+  unlink(tmpfile.toUtf8());
   delete conv;
   delete settings;
   if(wavedata!=NULL) {
     delete wavedata;
   }
-  delete tempdir;
+  if(tempdir!=NULL) {
+    delete tempdir;
+  }
+  if(cache!=NULL) {
+    delete cache;
+  }
   if(resp_code==200) {
     Exit(200);
   }
@@ -224,3 +275,155 @@ void Xport::Export()
 	    LINE_NUMBER,conv_err);
   }
 }
+
+
+void Xport::SendAudio(int fd,RDSettings::Format fmt,const QString &etag)
+{
+  struct stat st;
+  off_t total=0;
+  off_t first=0;
+  off_t last=0;
+  off_t offset=0;
+  ssize_t n=0;
+  char data[2048];
+
+  if(fstat(fd,&st)!=0) {
+    XmlExit("Unable to access exported audio",500,"export.cpp",LINE_NUMBER);
+  }
+  total=st.st_size;
+  last=total-1;
+
+  //
+  // Byte Range
+  //
+  // Only a single range is supported; anything else (or a range that
+  // doesn't parse, or one qualified by an out of date If-Range) gets
+  // the entire file.
+  //
+  int resp_code=200;
+  QString range;
+  if(getenv("HTTP_RANGE")!=NULL) {
+    range=QString(getenv("HTTP_RANGE")).trimmed();
+  }
+  if((getenv("HTTP_IF_RANGE")!=NULL)&&
+     (QString(getenv("HTTP_IF_RANGE")).trimmed()!=etag)) {
+    range="";
+  }
+  if(range.startsWith("bytes=")&&(!range.contains(","))) {
+    QStringList f0=range.mid(6).split("-");
+    if(f0.size()==2) {
+      off_t range_first=0;
+      off_t range_last=total-1;
+      bool first_ok=true;
+      bool last_ok=true;
+      if(f0.at(0).trimmed().isEmpty()) {
+	off_t len=f0.at(1).trimmed().toLongLong(&last_ok);
+	if(last_ok) {
+	  range_first=total-len;
+	  if(range_first<0) {
+	    range_first=0;
+	  }
+	  if((len>0)&&(total>0)) {
+	    first=range_first;
+	    resp_code=206;
+	  }
+	  else {
+	    resp_code=416;
+	  }
+	}
+      }
+      else {
+	range_first=f0.at(0).trimmed().toLongLong(&first_ok);
+	if(!f0.at(1).trimmed().isEmpty()) {
+	  range_last=f0.at(1).trimmed().toLongLong(&last_ok);
+	  if(range_last>=total) {
+	    range_last=total-1;
+	  }
+	}
+	if(first_ok&&last_ok) {
+	  if((range_first>=total)||(range_first>range_last)) {
+	    resp_code=416;
+	  }
+	  else {
+	    first=range_first;
+	    last=range_last;
+	    resp_code=206;
+	  }
+	}
+      }
+    }
+  }
+  if(resp_code==416) {
+    printf("Status: 416\n");
+    printf("Content-Range: bytes */%ld\n",(long)total);
+    printf("\n");
+    return;
+  }
+
+  //
+  // Header
+  //
+  switch(fmt) {
+  case RDSettings::Pcm16:
+  case RDSettings::Pcm24:
+    printf("Content-type: audio/x-wav\n");
+    break;
+
+  case RDSettings::MpegL1:
+  case RDSettings::MpegL2:
+  case RDSettings::MpegL2Wav:
+  case RDSettings::MpegL3:
+    printf("Content-type: audio/x-mpeg\n");
+    break;
+
+  case RDSettings::OggVorbis:
+    printf("Content-type: audio/ogg\n");
+    break;
+
+  case RDSettings::Flac:
+    printf("Content-type: audio/flac\n");
+    break;
+  }
+  if(resp_code==206) {
+    printf("Status: 206\n");
+    printf("Content-Range: bytes %ld-%ld/%ld\n",
+	   (long)first,(long)last,(long)total);
+  }
+  printf("Content-Length: %ld\n",(long)(last-first+1));
+  printf("Accept-Ranges: bytes\n");
+  if(!etag.isEmpty()) {
+    printf("ETag: %s\n",etag.toUtf8().constData());
+  }
+  printf("\n");
+  fflush(NULL);
+
+  //
+  // Data
+  //
+  offset=first;
+  while(offset<=last) {
+    size_t len=last-offset+1;
+    if(len>EXPORT_SENDFILE_BLOCK) {
+      len=EXPORT_SENDFILE_BLOCK;
+    }
+    if((n=sendfile(1,fd,&offset,len))<=0) {
+      if((n<0)&&(errno==EINTR)) {
+	continue;
+      }
+      if((n<0)&&((errno==EINVAL)||(errno==ENOSYS))) {
+	//
+	// sendfile(2) not possible to this descriptor, so copy instead
+	//
+	lseek(fd,offset,SEEK_SET);
+	while((offset<=last)&&
+	      ((n=read(fd,data,qMin((off_t)sizeof(data),last-offset+1)))>0)) {
+	  if(write(1,data,n)!=n) {
+	    break;
+	  }
+	  offset+=n;
+	}
+      }
+      break;
+    }
+  }
+}
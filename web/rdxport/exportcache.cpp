@@ -0,0 +1,159 @@
+// exportcache.cpp
+//
+// On-disk cache of rendered exports for rdxport.cgi(8)
+//
+//   (C) Copyright 2021 Fred Gleason <fredg@paravelsystems.com>
+//
+//   This program is free software; you can redistribute it and/or modify
+//   it under the terms of the GNU General Public License version 2 as
+//   published by the Free Software Foundation.
+//
+//   This program is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//   GNU General Public License for more details.
+//
+//   You should have received a copy of the GNU General Public
+//   License along with this program; if not, write to the Free Software
+//   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+//
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <vector>
+
+#include <openssl/sha.h>
+
+#include "exportcache.h"
+
+class __ExportCacheEntry
+{
+ public:
+  __ExportCacheEntry(const QString &name,time_t mtime,int64_t size)
+  {
+    entry_name=name;
+    entry_mtime=mtime;
+    entry_size=size;
+  }
+  bool operator<(const __ExportCacheEntry &other) const
+  {
+    return entry_mtime<other.entry_mtime;
+  }
+  QString entry_name;
+  time_t entry_mtime;
+  int64_t entry_size;
+};
+
+
+ExportCache::ExportCache(const QString &dirname,int64_t max_size)
+{
+  cache_dirname=dirname;
+  cache_max_size=max_size;
+}
+
+
+bool ExportCache::isActive() const
+{
+  return (!cache_dirname.isEmpty())&&(cache_max_size>0)&&
+    (access(cache_dirname.toUtf8(),W_OK|X_OK)==0);
+}
+
+
+int ExportCache::open(const QString &id) const
+{
+  int fd=-1;
+
+  if((fd=::open(Filename(id).toUtf8(),O_RDONLY))>=0) {
+    futimens(fd,NULL);  // Mark as recently used
+  }
+  return fd;
+}
+
+
+QString ExportCache::tempFilename(const QString &id) const
+{
+  return Filename(id)+QString().sprintf(".%d.tmp",getpid());
+}
+
+
+bool ExportCache::insert(const QString &id,const QString &tempfile) const
+{
+  return rename(tempfile.toUtf8(),Filename(id).toUtf8())==0;
+}
+
+
+void ExportCache::trim() const
+{
+  DIR *dir=NULL;
+  struct dirent *dent=NULL;
+  struct stat st;
+  std::vector<__ExportCacheEntry> entries;
+  int64_t total=0;
+  time_t now=time(NULL);
+  QString name;
+
+  if((dir=opendir(cache_dirname.toUtf8()))==NULL) {
+    return;
+  }
+  while((dent=readdir(dir))!=NULL) {
+    if(dent->d_name[0]=='.') {
+      continue;
+    }
+    name=cache_dirname+"/"+QString::fromUtf8(dent->d_name);
+    if((stat(name.toUtf8(),&st)!=0)||(!S_ISREG(st.st_mode))) {
+      continue;
+    }
+    if(name.endsWith(".tmp")) {
+      //
+      // Export in progress, or left behind by one that crashed
+      //
+      if((now-st.st_mtime)>EXPORTCACHE_STALE_TEMP_AGE) {
+	unlink(name.toUtf8());
+      }
+      continue;
+    }
+    entries.push_back(__ExportCacheEntry(name,st.st_mtime,st.st_size));
+    total+=st.st_size;
+  }
+  closedir(dir);
+
+  if(total<=cache_max_size) {
+    return;
+  }
+  std::sort(entries.begin(),entries.end());
+  for(unsigned i=0;i<entries.size();i++) {
+    if(total<=(cache_max_size*EXPORTCACHE_TRIM_PERCENT/100)) {
+      break;
+    }
+    if(unlink(entries.at(i).entry_name.toUtf8())==0) {
+      total-=entries.at(i).entry_size;
+    }
+  }
+}
+
+
+QString ExportCache::id(const QString &key)
+{
+  QByteArray data=key.toUtf8();
+  unsigned char md[SHA_DIGEST_LENGTH];
+  QString ret;
+
+  SHA1((const unsigned char *)data.constData(),data.size(),md);
+  for(int i=0;i<SHA_DIGEST_LENGTH;i++) {
+    ret+=QString().sprintf("%02x",0xff&md[i]);
+  }
+  return ret;
+}
+
+
+QString ExportCache::Filename(const QString &id) const
+{
+  return cache_dirname+"/"+id;
+}
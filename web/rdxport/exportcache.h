@@ -0,0 +1,70 @@
+// exportcache.h
+//
+// On-disk cache of rendered exports for rdxport.cgi(8)
+//
+//   (C) Copyright 2021 Fred Gleason <fredg@paravelsystems.com>
+//
+//   This program is free software; you can redistribute it and/or modify
+//   it under the terms of the GNU General Public License version 2 as
+//   published by the Free Software Foundation.
+//
+//   This program is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//   GNU General Public License for more details.
+//
+//   You should have received a copy of the GNU General Public
+//   License along with this program; if not, write to the Free Software
+//   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+//
+
+#ifndef EXPORTCACHE_H
+#define EXPORTCACHE_H
+
+#include <stdint.h>
+
+#include <qstring.h>
+
+//
+// When trimming, remove entries until the cache is no larger than this
+// percentage of its maximum size
+//
+#define EXPORTCACHE_TRIM_PERCENT 90
+
+//
+// Seconds after which an abandoned temporary file is removed
+//
+#define EXPORTCACHE_STALE_TEMP_AGE 86400
+
+//
+// ExportCache
+//
+// A directory of previously rendered exports, each stored under a
+// hash of everything that went into making it: the SHA1 hash of the cut
+// audio, the export settings and (where metadata is included) the time
+// the cart metadata was last changed. A changed cut thus simply misses,
+// and its stale renditions age out. Entries are used in least recently
+// used order, as tracked by their modification times, and are removed
+// once the cache grows beyond its maximum size. Entries are only ever
+// created by rename(2), so several rdxport.cgi(8) processes can share
+// one cache without locking.
+//
+class ExportCache
+{
+ public:
+  ExportCache(const QString &dirname,int64_t max_size);
+  bool isActive() const;
+  int open(const QString &id) const;
+  QString tempFilename(const QString &id) const;
+  bool insert(const QString &id,const QString &tempfile) const;
+  void trim() const;
+  static QString id(const QString &key);
+
+ private:
+  QString Filename(const QString &id) const;
+  QString cache_dirname;
+  int64_t cache_max_size;
+};
+
+
+#endif  // EXPORTCACHE_H
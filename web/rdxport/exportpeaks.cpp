@@ -2,7 +2,7 @@
 //
 // Rivendell web service portal -- ExportPeaks service
 //
-//   (C) Copyright 2010-2018 Fred Gleason <fredg@paravelsystems.com>
+//   (C) Copyright 2010-2021 Fred Gleason <fredg@paravelsystems.com>
 //
 //   This program is free software; you can redistribute it and/or modify
 //   it under the terms of the GNU General Public License version 2 as
@@ -17,13 +17,16 @@
 //   License along with this program; if not, write to the Free Software
 //   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 //
-
 #include <stdio.h>
 #include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
 
+#include <QStringList>
+
 #include <rdapplication.h>
 #include <rdaudioconvert.h>
 #include <rdcart.h>
@@ -34,6 +37,11 @@
 
 #include "rdxport.h"
 
+//
+// Number of energy frames buffered per write
+//
+#define EXPORTPEAKS_BLOCK_SIZE 4096
+
 void Xport::ExportPeaks()
 {
   //
@@ -47,6 +55,30 @@ void Xport::ExportPeaks()
   if(!xport_post->getValue("CUT_NUMBER",&cutnum)) {
     XmlExit("Missing CUT_NUMBER",400,"exportpeaks.cpp",LINE_NUMBER);
   }
+  int start_point=-1;
+  if(!xport_post->getValue("START_POINT",&start_point)) {
+    start_point=-1;
+  }
+  int end_point=-1;
+  if(!xport_post->getValue("END_POINT",&end_point)) {
+    end_point=-1;
+  }
+  int points=0;
+  if(!xport_post->getValue("POINTS",&points)) {
+    points=0;
+  }
+  int frames_per_point=0;
+  if(!xport_post->getValue("FRAMES_PER_POINT",&frames_per_point)) {
+    frames_per_point=0;
+  }
+  if((points<0)||(frames_per_point<0)) {
+    XmlExit("Invalid POINTS/FRAMES_PER_POINT",400,"exportpeaks.cpp",
+	    LINE_NUMBER);
+  }
+  if((start_point>=0)&&(end_point>=0)&&(end_point<start_point)) {
+    XmlExit("Invalid START_POINT/END_POINT",400,"exportpeaks.cpp",
+	    LINE_NUMBER);
+  }
 
   //
   // Verify User Perms
@@ -55,6 +87,22 @@ void Xport::ExportPeaks()
     XmlExit("No such cart",404,"exportpeaks.cpp",LINE_NUMBER);
   }
 
+  //
+  // Check Client Cache
+  //
+  // The entity tag is derived from the SHA1 hash of the cut audio plus
+  // the request parameters, so it changes whenever the audio does.
+  //
+  QString etag;
+  RDCut *cut=new RDCut(cartnum,cutnum);
+  if(!cut->sha1Hash().isEmpty()) {
+    etag=QString("\"")+cut->sha1Hash()+
+      QString().sprintf("-%d-%d-%d-%d\"",start_point,end_point,
+			points,frames_per_point);
+  }
+  delete cut;
+  CheckNotModified(etag,QDateTime());
+
   //
   // Open Audio File
   //
@@ -66,13 +114,120 @@ void Xport::ExportPeaks()
     XmlExit("No peak data available",400,"exportpeaks.cpp",LINE_NUMBER);
   }
 
+  //
+  // Calculate Range
+  //
+  // Energy data consists of one value per channel for each block of
+  // 1152 samples, interleaved LEFT>>RIGHT>>LEFT>>...
+  //
+  unsigned chans=wave->getChannels();
+  if((chans==0)||(chans>2)) {
+    XmlExit("Unsupported channel count",500,"exportpeaks.cpp",LINE_NUMBER);
+  }
+  unsigned total_frames=wave->energySize()/chans;
+  unsigned first_frame=0;
+  unsigned last_frame=total_frames;
+  if(start_point>0) {
+    first_frame=(unsigned)((double)start_point*
+			   (double)wave->getSamplesPerSec()/1152000.0);
+  }
+  if(end_point>=0) {
+    last_frame=(unsigned)((double)end_point*
+			  (double)wave->getSamplesPerSec()/1152000.0)+1;
+  }
+  if(last_frame>total_frames) {
+    last_frame=total_frames;
+  }
+  if(first_frame>last_frame) {
+    first_frame=last_frame;
+  }
+  unsigned frames=last_frame-first_frame;
+  if((points>0)&&(frames_per_point==0)) {
+    frames_per_point=(frames+points-1)/points;
+  }
+  if(frames_per_point==0) {
+    frames_per_point=1;
+  }
+  bool downsample=(points>0)||(frames_per_point>1);
+
+  //
+  // Read the energy data in one go, then take the range from memory
+  //
+  unsigned short *energy=new unsigned short[total_frames*chans+1];
+  wave->readEnergy(energy,total_frames*chans);
+  delete wave;
+
   //
   // Send Data
   //
-  printf("Content-type: application/octet-stream\n\n");
+  unsigned short *buf=new unsigned short[EXPORTPEAKS_BLOCK_SIZE*chans];
+  unsigned out_points=downsample?
+    (frames+frames_per_point-1)/frames_per_point:frames;
+  printf("Content-type: application/octet-stream\n");
+  printf("Content-length: %u\n",
+	 (unsigned)(sizeof(unsigned short)*out_points*chans*(downsample?2:1)));
+  if(!etag.isEmpty()) {
+    printf("ETag: %s\n",etag.toUtf8().constData());
+  }
+  printf("\n");
   fflush(NULL);
-  unsigned short *peaks=new unsigned short[wave->energySize()];
-  wave->readEnergy(peaks,wave->energySize());
-  write(1,peaks,sizeof(unsigned short)*wave->energySize());
+  if(!downsample) {
+    //
+    // Raw energy frames
+    //
+    unsigned frame=first_frame;
+    while(frame<last_frame) {
+      unsigned n=last_frame-frame;
+      if(n>EXPORTPEAKS_BLOCK_SIZE) {
+	n=EXPORTPEAKS_BLOCK_SIZE;
+      }
+      write(1,energy+frame*chans,sizeof(unsigned short)*n*chans);
+      frame+=n;
+    }
+  }
+  else {
+    //
+    // Min/max pairs, per channel per point
+    //
+    unsigned n=0;
+    unsigned short min[2];
+    unsigned short max[2];
+    for(unsigned frame=first_frame;frame<last_frame;
+	frame+=frames_per_point) {
+      unsigned end=frame+frames_per_point;
+      if(end>last_frame) {
+	end=last_frame;
+      }
+      for(unsigned j=0;j<chans;j++) {
+	min[j]=0xFFFF;
+	max[j]=0;
+      }
+      for(unsigned k=frame;k<end;k++) {
+	for(unsigned j=0;j<chans;j++) {
+	  unsigned short e=energy[k*chans+j];
+	  if(e<min[j]) {
+	    min[j]=e;
+	  }
+	  if(e>max[j]) {
+	    max[j]=e;
+	  }
+	}
+      }
+      for(unsigned j=0;j<chans;j++) {
+	buf[n++]=min[j];
+	buf[n++]=max[j];
+      }
+      if((n+2*chans)>(EXPORTPEAKS_BLOCK_SIZE*chans)) {
+	write(1,buf,sizeof(unsigned short)*n);
+	n=0;
+      }
+    }
+    if(n>0) {
+      write(1,buf,sizeof(unsigned short)*n);
+    }
+  }
+  delete[] buf;
+  delete[] energy;
+
   Exit(0);
 }
@@ -26,6 +26,7 @@
 
 #include <rdapplication.h>
 #include <rdconf.h>
+#include <rddbpool.h>
 #include <rdescape_string.h>
 #include <rdformpost.h>
 #include <rdgroup.h>
@@ -47,7 +48,7 @@ void Xport::ListGroups()
     "GROUP_NAME from USER_PERMS where "+
     "USER_NAME=\""+RDEscapeString(rda->user()->name())+"\" "+
     "order by GROUP_NAME";
-  q=new RDSqlQuery(sql);
+  q=new RDSqlQuery(sql,RDDbPool::replica());
 
   //
   // Process Request
@@ -89,7 +90,7 @@ void Xport::ListGroup()
     "GROUP_NAME from USER_PERMS	where "+
     "(USER_NAME=\""+RDEscapeString(rda->user()->name())+"\")&&"+
     "(GROUP_NAME=\""+RDEscapeString(group_name)+"\")";
-  q=new RDSqlQuery(sql);
+  q=new RDSqlQuery(sql,RDDbPool::replica());
   if(!q->first()) {
     delete q;
     XmlExit("No such group",404,"groups.cpp",LINE_NUMBER);
@@ -99,6 +99,22 @@ void Xport::Import()
     XmlExit("Missing file data",400,"import.cpp",LINE_NUMBER);
   }
 
+  //
+  // Verify Upload
+  //
+  // Both checks use what RDFormPost worked out as the file data arrived,
+  // so neither needs to read the upload again.
+  //
+  QString sha1_hash;
+  if(xport_post->getValue("SHA1_HASH",&sha1_hash)&&
+     (sha1_hash.trimmed().toLower()!=xport_post->fileSha1Hash("FILENAME"))) {
+    XmlExit("File data does not match SHA1_HASH",400,"import.cpp",
+	    LINE_NUMBER);
+  }
+  if(xport_post->fileType("FILENAME")==RDWaveFile::Unknown) {
+    XmlExit("Format Not Supported",415,"import.cpp",LINE_NUMBER);
+  }
+
   //
   // Verify User Perms
   //
@@ -164,10 +180,10 @@ void Xport::Import()
     cart=new RDCart(cartnum);
     cut=new RDCut(cartnum,cutnum);
   }
-  if(!RDCart::exists(cartnum)) {
+  if(!cart->loadSnapshot()) {
     XmlExit("No such cart",404,"import.cpp",LINE_NUMBER);
   }
-  if(!RDCut::exists(cartnum,cutnum)) {
+  if(!cut->loadSnapshot()) {
     XmlExit("No such cut",404,"import.cpp",LINE_NUMBER);
   }
   RDLibraryConf *conf=new RDLibraryConf(rda->config()->stationName());
@@ -203,7 +219,9 @@ void Xport::Import()
       XmlExit("Duplicate Cart Title Not Allowed",404,"import.cpp",LINE_NUMBER);
     }
   }
+  RDAudioAnalysis *ana=new RDAudioAnalysis();
   RDAudioConvert *conv=new RDAudioConvert();
+  conv->setAnalysis(ana);
   conv->setSourceFile(filename);
   conv->setDestinationFile(RDCut::pathName(cartnum,cutnum));
   conv->setDestinationSettings(settings);
@@ -213,6 +231,7 @@ void Xport::Import()
     wave=new RDWaveFile(RDCut::pathName(cartnum,cutnum));
     if(wave->openWave()) {
       msecs=wave->getExtTimeLength();
+      wave->loadFrameIndex();
     }
     else {
       delete wave;
@@ -221,6 +240,9 @@ void Xport::Import()
     delete wave;
     cut->checkInRecording(rda->config()->stationName(),rda->user()->name(),
 			  remote_host,settings,msecs);
+    ana->setSha1Hash(RDSha1Hash(RDCut::pathName(cut->cutName())));
+    ana->save(RDCut::pathName(cut->cutName()));
+    cut->setAnalysis(ana);
     if(use_metadata>0) {
       cart->setMetadata(conv->sourceWaveData());
       cut->setMetadata(conv->sourceWaveData());
@@ -228,6 +250,7 @@ void Xport::Import()
     if(autotrim_level!=0) {
       cut->autoTrim(RDCut::AudioBoth,100*autotrim_level);
     }
+    cut->commit();
     cart->updateLength();
     cart->resetRotation();
     cart->calculateAverageLength(&length_deviation);
@@ -256,10 +279,10 @@ void Xport::Import()
     break;
   }
   if(resp_code==200) {
-    cut->setSha1Hash(RDSha1Hash(RDCut::pathName(cut->cutName())));
     if(!title.isEmpty()) {
       cart->setTitle(title);
     }
+    cart->commit();
     printf("Content-type: application/xml\n");
     printf("Status: %d\n",resp_code);
     printf("\n");
@@ -27,6 +27,7 @@
 #include <rdapplication.h>
 #include <rdconf.h>
 #include <rddb.h>
+#include <rddbpool.h>
 #include <rdescape_string.h>
 #include <rdformpost.h>
 #include <rdlog.h>
@@ -115,6 +116,9 @@ void Xport::ListLogs()
   QString trackable;
   QString filter="";
   QString recent="";
+  QDateTime changed_since;
+  QString etag;
+  bool ok=false;
 
   //
   // Get Options
@@ -128,11 +132,33 @@ void Xport::ListLogs()
   xport_post->getValue("FILTER",&filter);
   filter=filter.trimmed();
   xport_post->getValue("RECENT",&recent);
-
-  //
-  // Generate Log List
-  //
-  sql="select NAME from LOGS";
+  if(xport_post->getValue("CHANGED_SINCE",&changed_since,&ok)&&(!ok)) {
+    XmlExit("Invalid CHANGED_SINCE",400,"logs.cpp",LINE_NUMBER);
+  }
+
+  //
+  // Generate Log List, selecting all of the fields used by RDLog::xml()
+  // so that they go into the ETag
+  //
+  sql=QString("select ")+
+    "NAME,"+                // 00
+    "SERVICE,"+             // 01
+    "DESCRIPTION,"+         // 02
+    "ORIGIN_USER,"+         // 03
+    "ORIGIN_DATETIME,"+     // 04
+    "LINK_DATETIME,"+       // 05
+    "MODIFIED_DATETIME,"+   // 06
+    "PURGE_DATE,"+          // 07
+    "AUTO_REFRESH,"+        // 08
+    "START_DATE,"+          // 09
+    "END_DATE,"+            // 10
+    "SCHEDULED_TRACKS,"+    // 11
+    "COMPLETED_TRACKS,"+    // 12
+    "MUSIC_LINKS,"+         // 13
+    "MUSIC_LINKED,"+        // 14
+    "TRAFFIC_LINKS,"+       // 15
+    "TRAFFIC_LINKED "+      // 16
+    "from LOGS";
   sql+=" where";
   if(!log_name.isEmpty()) {
     sql+=" (NAME=\""+RDEscapeString(log_name)+"\")&&";
@@ -155,6 +181,10 @@ void Xport::ListLogs()
   if(trackable=="1") {
     sql+=" (SCHEDULED_TRACKS>0)&&";
   }
+  if(changed_since.isValid()) {
+    sql+=" (MODIFIED_DATETIME>="+
+      RDCheckDateTime(changed_since,"yyyy-MM-dd hh:mm:ss")+")&&";
+  }
   if(!filter.isEmpty()) {
     if(service_name.isEmpty()) {
       sql+=" ((LOGS.NAME like \"%%"+RDEscapeString(filter)+"%%\")||";
@@ -181,12 +211,19 @@ void Xport::ListLogs()
   else {
     sql+=" order by NAME";
   }
-  q=new RDSqlQuery(sql);
+  q=new RDSqlQuery(sql,RDDbPool::replica());
+
+  //
+  // Check Validators
+  //
+  etag=QueryEtag("ListLogs:"+sql,q);
+  CheckNotModified(etag,QDateTime());
 
   //
   // Process Request
   //
   printf("Content-type: application/xml\n");
+  PrintValidators(etag,QDateTime());
   printf("Status: 200\n\n");
   printf("<?xml version=\"1.0\" encoding=\"UTF-8\" ?>\n");
   printf("<logList>\n");
@@ -221,19 +258,30 @@ void Xport::ListLog()
     XmlExit("No such log",404,"logs.cpp",LINE_NUMBER);
   }
 
+  //
+  // A log that has not been saved since If-Modified-Since needn't be
+  // loaded at all
+  //
+  QDateTime last_modified=log->modifiedDatetime();
+  CheckNotModified(QString(),last_modified);
+
   //
   // Generate Log Listing
   //
   RDLogModel *log_model=log->createLogEvent();
   log_model->load(true);
+  QByteArray xml=log_model->xml().toUtf8();
+  QString etag=DataEtag("ListLog:"+xml);
+  CheckNotModified(etag,last_modified);
 
   //
   // Process Request
   //
   printf("Content-type: application/xml\n");
+  PrintValidators(etag,last_modified);
   printf("Status: 200\n\n");
   printf("<?xml version=\"1.0\" encoding=\"UTF-8\" ?>\n");
-  printf("%s\n",(const char *)log_model->xml().toUtf8());
+  printf("%s\n",xml.constData());
 
   Exit(0);
 }
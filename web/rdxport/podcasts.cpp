@@ -94,7 +94,12 @@ void Xport::SavePodcast()
   feed=new RDFeed(keyname,rda->config(),this);
   destpath=QString(RD_AUDIO_ROOT)+"/"+cast->audioFilename();
 
-  if(!RDCopy(filename,destpath)) {
+  //
+  // The upload is moved into place if it is on the same filesystem, so
+  // that the audio is only written to disk once
+  //
+  if((rename(filename.toUtf8(),destpath.toUtf8())!=0)&&
+     (!RDCopy(filename,destpath))) {
     delete feed;
     delete cast;
     XmlExit("Internal server error [copy failed]",500,"podcasts.cpp",
@@ -107,7 +112,8 @@ void Xport::SavePodcast()
     delete cast;
     XmlExit(err_msg.toUtf8(),500,"podcasts.cpp",LINE_NUMBER);
   }
-  cast->setSha1Hash(RDSha1Hash(destpath));
+  cast->setSha1Hash(xport_post->fileSha1Hash("FILENAME"));
+  cast->setSha1Fingerprint(RDFileFingerprint(destpath));
 
   printf("Content-type: text/html; charset: UTF-8\n");
   printf("Status: 200\n\n");
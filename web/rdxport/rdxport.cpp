@@ -30,9 +30,14 @@
 #include <map>
 
 #include <QApplication>
+#include <QSqlRecord>
+
+#include <openssl/sha.h>
 
 #include <rdapplication.h>
+#include <rddatetime.h>
 #include <rddb.h>
+#include <rddbpool.h>
 #include <rdescape_string.h>
 #include <rdweb.h>
 #include <rdformpost.h>
@@ -40,50 +45,60 @@
 #include <dbversion.h>
 
 #include "rdxport.h"
+#include "server.h"
 
-Xport::Xport(QObject *parent)
+Xport::Xport(Xport::Mode mode,QObject *parent)
   :QObject(parent)
 {
   QString err_msg;
 
-  //
-  // Open the Database
-  //
-  rda=static_cast<RDApplication *>(new RDCoreApplication("rdxport.cgi","rdxport.cgi",RDXPORT_CGI_USAGE,this));
-  if(!rda->open(&err_msg,NULL,false)) {
-    printf("Content-type: text/html\n");
-    printf("Status: 500\n");
-    printf("\n");
-    printf("rdxport.cgi: %s\n",(const char *)err_msg.toUtf8());
-    Exit(0);
-  }
+  xport_post=NULL;
 
   //
-  // Read Command Options
+  // In service mode, the database and ripcd(8) connections are already
+  // open and privileges dropped by the worker that forked us.
   //
-  for(unsigned i=0;i<rda->cmdSwitch()->keys();i++) {
-    if(!rda->cmdSwitch()->processed(i)) {
+  if(mode==Xport::CgiMode) {
+    //
+    // Open the Database
+    //
+    rda=static_cast<RDApplication *>(new RDCoreApplication("rdxport.cgi","rdxport.cgi",RDXPORT_CGI_USAGE,this));
+    if(!rda->open(&err_msg,NULL,false)) {
       printf("Content-type: text/html\n");
       printf("Status: 500\n");
       printf("\n");
-      printf("rdxport.cgi: unknown command option \"%s\"\n",
-	     (const char *)rda->cmdSwitch()->key(i).toUtf8());
+      printf("rdxport.cgi: %s\n",(const char *)err_msg.toUtf8());
       Exit(0);
     }
-  }
+    RDDbPool::disableReplica();
+
+    //
+    // Read Command Options
+    //
+    for(unsigned i=0;i<rda->cmdSwitch()->keys();i++) {
+      if(!rda->cmdSwitch()->processed(i)) {
+	printf("Content-type: text/html\n");
+	printf("Status: 500\n");
+	printf("\n");
+	printf("rdxport.cgi: unknown command option \"%s\"\n",
+	       (const char *)rda->cmdSwitch()->key(i).toUtf8());
+	Exit(0);
+      }
+    }
 
-  //
-  // Drop root permissions
-  //
-  if(setgid(rda->config()->gid())<0) {
-    XmlExit("Unable to set Rivendell group",500,"rdxport.cpp",LINE_NUMBER);
-  }
-  if(setuid(rda->config()->uid())<0) {
-    XmlExit("Unable to set Rivendell user",500,"rdxport.cpp",LINE_NUMBER);
-  }
-  if(getuid()==0) {
-    XmlExit("Rivendell user should never be \"root\"!",500,"rdxport.cpp",
-	    LINE_NUMBER);
+    //
+    // Drop root permissions
+    //
+    if(setgid(rda->config()->gid())<0) {
+      XmlExit("Unable to set Rivendell group",500,"rdxport.cpp",LINE_NUMBER);
+    }
+    if(setuid(rda->config()->uid())<0) {
+      XmlExit("Unable to set Rivendell user",500,"rdxport.cpp",LINE_NUMBER);
+    }
+    if(getuid()==0) {
+      XmlExit("Rivendell user should never be \"root\"!",500,"rdxport.cpp",
+	      LINE_NUMBER);
+    }
   }
 
   //
@@ -129,6 +144,10 @@ Xport::Xport(QObject *parent)
   if(!Authenticate()) {
     XmlExit("Invalid User",403,"rdxport.cpp",LINE_NUMBER);
   }
+  if(mode==Xport::ServiceMode) {
+    ripcConnectedData(true);
+    return;
+  }
 
   //
   // Connect to ripcd(8)
@@ -435,6 +454,111 @@ void Xport::SendNotification(RDNotification::Type type,
 }
 
 
+QString Xport::QueryEtag(const QString &salt,RDSqlQuery *q) const
+{
+  //
+  // Hash every value of every row of 'q', then rewind it so that it can
+  // be used to generate the response. The query that produced 'q' should
+  // be included in 'salt'.
+  //
+  // No Last-Modified is derived from the rows, as the latest timestamp
+  // among them doesn't move when a row is deleted or drops out of the
+  // query, so only this strong validator is used for query results.
+  //
+  SHA_CTX ctx;
+  unsigned char md[SHA_DIGEST_LENGTH];
+  QByteArray data=salt.toUtf8();
+  int cols=q->record().count();
+  QString ret="\"";
+
+  SHA1_Init(&ctx);
+  SHA1_Update(&ctx,data.constData(),data.size());
+  while(q->next()) {
+    for(int i=0;i<cols;i++) {
+      if(q->value(i).isNull()) {
+	SHA1_Update(&ctx,"\x1d",1);
+      }
+      else {
+	data=q->value(i).toString().toUtf8();
+	SHA1_Update(&ctx,data.constData(),data.size());
+      }
+      SHA1_Update(&ctx,"\x1f",1);
+    }
+    SHA1_Update(&ctx,"\x1e",1);
+  }
+  SHA1_Final(md,&ctx);
+  q->seek(-1);
+  for(int i=0;i<SHA_DIGEST_LENGTH;i++) {
+    ret+=QString().sprintf("%02x",0xff&md[i]);
+  }
+
+  return ret+"\"";
+}
+
+
+QString Xport::DataEtag(const QByteArray &data) const
+{
+  unsigned char md[SHA_DIGEST_LENGTH];
+  QString ret="\"";
+
+  SHA1((const unsigned char *)data.constData(),data.size(),md);
+  for(int i=0;i<SHA_DIGEST_LENGTH;i++) {
+    ret+=QString().sprintf("%02x",0xff&md[i]);
+  }
+
+  return ret+"\"";
+}
+
+
+void Xport::CheckNotModified(const QString &etag,
+			     const QDateTime &last_modified)
+{
+  //
+  // As per RFC7232 Section 6, If-Modified-Since is ignored when
+  // If-None-Match is present
+  //
+  bool not_modified=false;
+
+  if(getenv("HTTP_IF_NONE_MATCH")!=NULL) {
+    if(!etag.isEmpty()) {
+      QStringList tags=QString(getenv("HTTP_IF_NONE_MATCH")).split(",");
+      for(int i=0;i<tags.size();i++) {
+	if((tags.at(i).trimmed()==etag)||(tags.at(i).trimmed()=="*")) {
+	  not_modified=true;
+	}
+      }
+    }
+  }
+  else {
+    if(last_modified.isValid()&&(getenv("HTTP_IF_MODIFIED_SINCE")!=NULL)) {
+      bool ok=false;
+      QDateTime since=
+	RDParseRfc822DateTime(getenv("HTTP_IF_MODIFIED_SINCE"),&ok);
+      not_modified=ok&&(last_modified<=since);
+    }
+  }
+  if(not_modified) {
+    printf("Status: 304\n");
+    PrintValidators(etag,last_modified);
+    printf("\n");
+    Exit(0);
+  }
+}
+
+
+void Xport::PrintValidators(const QString &etag,
+			    const QDateTime &last_modified) const
+{
+  if(!etag.isEmpty()) {
+    printf("ETag: %s\n",etag.toUtf8().constData());
+  }
+  if(last_modified.isValid()) {
+    printf("Last-Modified: %s\n",
+	   RDWriteHttpDateTime(last_modified).toUtf8().constData());
+  }
+}
+
+
 void Xport::Exit(int code)
 {
   if(xport_post!=NULL) {
@@ -473,8 +597,20 @@ void Xport::XmlExit(const QString &str,int code,const QString &srcfile,
 
 int main(int argc,char *argv[])
 {
+  bool service=false;
+
   QCoreApplication::setSetuidAllowed(true);
   QCoreApplication a(argc,argv,false);
-  new Xport();
+  for(int i=1;i<argc;i++) {
+    if(QString(argv[i])=="--service") {
+      service=true;
+    }
+  }
+  if(service) {
+    new XportServer();
+  }
+  else {
+    new Xport();
+  }
   return a.exec();
 }
@@ -24,6 +24,7 @@
 #include <qobject.h>
 
 #include <rdaudioconvert.h>
+#include <rddb.h>
 #include <rdfeed.h>
 #include <rdformpost.h>
 #include <rdnotification.h>
@@ -39,7 +40,8 @@ class Xport : public QObject
   Q_OBJECT;
  public:
   enum LockLogOperation {LockLogCreate=0,LockLogUpdate=1,LockLogClear=2};
-  Xport(QObject *parent=0);
+  enum Mode {CgiMode=0,ServiceMode=1};
+  Xport(Mode mode=Xport::CgiMode,QObject *parent=0);
 
  private slots:
   void ripcConnectedData(bool state);
@@ -48,6 +50,7 @@ class Xport : public QObject
   bool Authenticate();
   void TryCreateTicket(const QString &name);
   void Export();
+  void SendAudio(int fd,RDSettings::Format fmt,const QString &etag);
   void Import();
   void DeleteAudio();
   void AddCart();
@@ -101,6 +104,11 @@ class Xport : public QObject
   void SaveFile();
   void SendNotification(RDNotification::Type type,RDNotification::Action action,
 			const QVariant &id);
+  QString QueryEtag(const QString &salt,RDSqlQuery *q) const;
+  QString DataEtag(const QByteArray &data) const;
+  void CheckNotModified(const QString &etag,const QDateTime &last_modified);
+  void PrintValidators(const QString &etag,
+		       const QDateTime &last_modified) const;
   void Exit(int code);
   void XmlExit(const QString &msg,int code,
 	       const QString &srcfile="",int line=-1,
@@ -60,6 +60,8 @@ void Xport::Rehash()
     XmlExit("No such cut",404,"rdhash.cpp",LINE_NUMBER);
   }
   cut->setSha1Hash(RDSha1Hash(RDCut::pathName(cart_number,cut_number)));
+  cut->setSha1Fingerprint(RDFileFingerprint(RDCut::pathName(cart_number,
+							    cut_number)));
   delete cut;
   XmlExit("OK",200,"rdhash.cpp",LINE_NUMBER);
 }
@@ -0,0 +1,837 @@
+// server.cpp
+//
+// Persistent service mode for rdxport.cgi(8)
+//
+//   (C) Copyright 2021 Fred Gleason <fredg@paravelsystems.com>
+//
+//   This program is free software; you can redistribute it and/or modify
+//   it under the terms of the GNU General Public License version 2 as
+//   published by the Free Software Foundation.
+//
+//   This program is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//   GNU General Public License for more details.
+//
+//   You should have received a copy of the GNU General Public
+//   License along with this program; if not, write to the Free Software
+//   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+//
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syslog.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+
+#include <qdatetime.h>
+#include <qstringlist.h>
+
+#include <rdapplication.h>
+#include <rdconfig.h>
+#include <rddb.h>
+#include <rddbpool.h>
+#include <rdnotification.h>
+#include <rdrowcache.h>
+#include <rdtempdirectory.h>
+
+#include "rdxport.h"
+#include "server.h"
+
+volatile sig_atomic_t __xport_server_exiting=false;
+int __xport_server_relay_fd=-1;
+QDateTime __xport_server_child_start;
+
+void __XportServerSigHandler(int signo)
+{
+  __xport_server_exiting=true;
+}
+
+
+void __XportServerChildExit()
+{
+  //
+  // Tell the worker which tables the request changed, so that it keeps
+  // reading them from the primary for as long as the replica may lag
+  //
+  if(__xport_server_relay_fd>=0) {
+    QStringList tables=
+      RDDbPool::writtenTables(__xport_server_child_start);
+    QByteArray data;
+    for(int i=0;i<tables.size();i++) {
+      data+=("WT "+tables.at(i)+"!").toUtf8();
+    }
+    if(data.size()>0) {
+      write(__xport_server_relay_fd,data.constData(),data.size());
+    }
+  }
+
+  //
+  // Leave without running any further exit handlers or static
+  // destructors, as those would close the database connection that the
+  // request shares with its worker.
+  //
+  fflush(stdout);
+  _exit(0);
+}
+
+
+XportServer::XportServer(QObject *parent)
+  : QObject(parent)
+{
+  struct sockaddr_in sa;
+  struct sigaction act;
+  int opt=1;
+  QString err_msg;
+
+  server_listen_fd=-1;
+  server_notifier=NULL;
+  server_requests=0;
+
+  //
+  // Load Configuration
+  //
+  RDConfig *config=new RDConfig();
+  config->load();
+  openlog("rdxport.cgi",0,config->syslogFacility());
+  server_workers=config->rdxportServiceWorkers();
+  if(server_workers<1) {
+    server_workers=1;
+  }
+  server_max_requests=config->rdxportServiceMaxRequests();
+
+  //
+  // Open the listening socket
+  //
+  QHostAddress addr(config->rdxportServiceAddress());
+  if(addr.protocol()!=QAbstractSocket::IPv4Protocol) {
+    fprintf(stderr,"rdxport.cgi: invalid service address \"%s\"\n",
+	    config->rdxportServiceAddress().toUtf8().constData());
+    exit(1);
+  }
+  if((server_listen_fd=socket(AF_INET,SOCK_STREAM,0))<0) {
+    fprintf(stderr,"rdxport.cgi: unable to create socket [%s]\n",
+	    strerror(errno));
+    exit(1);
+  }
+  setsockopt(server_listen_fd,SOL_SOCKET,SO_REUSEADDR,&opt,sizeof(opt));
+  memset(&sa,0,sizeof(sa));
+  sa.sin_family=AF_INET;
+  sa.sin_port=htons(config->rdxportServicePort());
+  sa.sin_addr.s_addr=htonl(addr.toIPv4Address());
+  if(bind(server_listen_fd,(struct sockaddr *)(&sa),sizeof(sa))<0) {
+    fprintf(stderr,"rdxport.cgi: unable to bind %s:%u [%s]\n",
+	    addr.toString().toUtf8().constData(),
+	    0xFFFF&config->rdxportServicePort(),strerror(errno));
+    exit(1);
+  }
+  if(listen(server_listen_fd,SOMAXCONN)<0) {
+    fprintf(stderr,"rdxport.cgi: unable to listen [%s]\n",strerror(errno));
+    exit(1);
+  }
+  fcntl(server_listen_fd,F_SETFL,
+	fcntl(server_listen_fd,F_GETFL)|O_NONBLOCK);
+
+  //
+  // Drop root permissions
+  //
+  if(setgid(config->gid())<0) {
+    fprintf(stderr,"rdxport.cgi: unable to set Rivendell group\n");
+    exit(1);
+  }
+  if(setuid(config->uid())<0) {
+    fprintf(stderr,"rdxport.cgi: unable to set Rivendell user\n");
+    exit(1);
+  }
+  if(getuid()==0) {
+    fprintf(stderr,"rdxport.cgi: Rivendell user should never be \"root\"!\n");
+    exit(1);
+  }
+  delete config;
+
+  //
+  // Start the workers (only returns in a worker)
+  //
+  memset(&act,0,sizeof(act));
+  act.sa_handler=__XportServerSigHandler;
+  sigaction(SIGTERM,&act,NULL);
+  sigaction(SIGINT,&act,NULL);
+  RunMaster();
+
+  //
+  // Open the database and connect to ripcd(8)
+  //
+  ::signal(SIGPIPE,SIG_IGN);
+  rda=static_cast<RDApplication *>(new RDCoreApplication("rdxport.cgi","rdxport.cgi",RDXPORT_CGI_USAGE,this));
+  if(!rda->open(&err_msg,NULL,false)) {
+    syslog(LOG_ERR,"worker unable to open database [%s]",
+	   err_msg.toUtf8().constData());
+    exit(1);
+  }
+  connect(rda->ripc(),SIGNAL(connected(bool)),
+	  this,SLOT(ripcConnectedData(bool)));
+  rda->ripc()->
+    connectHost("localhost",RIPCD_TCP_PORT,rda->config()->password());
+}
+
+
+void XportServer::ripcConnectedData(bool state)
+{
+  if(!state) {
+    rda->syslog(LOG_ERR,"worker unable to connect to ripc service");
+    exit(1);
+  }
+  if(server_notifier==NULL) {
+    server_notifier=
+      new QSocketNotifier(server_listen_fd,QSocketNotifier::Read,this);
+    connect(server_notifier,SIGNAL(activated(int)),
+	    this,SLOT(newConnectionData(int)));
+  }
+}
+
+
+void XportServer::newConnectionData(int fd)
+{
+  struct sockaddr_in sa;
+  socklen_t len=sizeof(sa);
+  bool healthy=true;
+  int sock;
+
+  if((sock=accept(server_listen_fd,(struct sockaddr *)(&sa),&len))<0) {
+    return;  // Taken by another worker
+  }
+  QHostAddress peer((quint32)ntohl(sa.sin_addr.s_addr));
+  server_pending.clear();
+  SetTimeouts(sock,RDXPORT_SERVICE_HEADER_TIMEOUT);
+  while(ServeRequest(sock,peer,&healthy)) {
+    SetTimeouts(sock,RDXPORT_SERVICE_KEEPALIVE_TIMEOUT);
+  }
+  close(sock);
+  server_pending.clear();
+
+  if(!healthy) {
+    rda->syslog(LOG_WARNING,"request failed to exit cleanly, restarting worker");
+    exit(0);
+  }
+  if((server_max_requests>0)&&(server_requests>=server_max_requests)) {
+    exit(0);
+  }
+}
+
+
+void XportServer::RunMaster()
+{
+  QMap<pid_t,time_t> workers;
+  pid_t pid;
+  int status;
+
+  while(!__xport_server_exiting) {
+    while((!__xport_server_exiting)&&(workers.size()<server_workers)) {
+      if((pid=fork())==0) {
+	::signal(SIGTERM,SIG_DFL);
+	::signal(SIGINT,SIG_DFL);
+	return;
+      }
+      if(pid<0) {
+	syslog(LOG_ERR,"unable to start worker [%s]",strerror(errno));
+	sleep(1);
+	break;
+      }
+      workers[pid]=time(NULL);
+    }
+    if((pid=wait(&status))>0) {
+      if(workers.contains(pid)) {
+	if((time(NULL)-workers.value(pid))<RDXPORT_SERVICE_MIN_WORKER_LIFE) {
+	  sleep(1);
+	}
+	workers.remove(pid);
+      }
+    }
+  }
+
+  //
+  // Shut down
+  //
+  for(QMap<pid_t,time_t>::const_iterator it=workers.begin();
+      it!=workers.end();it++) {
+    kill(it.key(),SIGTERM);
+  }
+  while((wait(&status)>0)||(errno==EINTR));
+  exit(0);
+}
+
+
+bool XportServer::ServeRequest(int sock,const QHostAddress &peer,
+			       bool *healthy)
+{
+  QByteArray header;
+  QMap<QString,QString> hdrs;
+  unsigned content_length=0;
+  bool ok=false;
+  int spool_fd=-1;
+  int out[2];
+  int relay[2];
+  pid_t pid;
+  int status=0;
+
+  if(!ReadHeader(sock,&header)) {
+    return false;
+  }
+  server_requests++;
+
+  //
+  // Parse the request
+  //
+  QStringList lines=QString::fromUtf8(header).split("\r\n");
+  QStringList f0=lines.at(0).split(" ",QString::SkipEmptyParts);
+  if((f0.size()!=3)||(!f0.at(2).startsWith("HTTP/1."))) {
+    SendError(sock,400);
+    return false;
+  }
+  bool http11=f0.at(2)!="HTTP/1.0";
+  for(int i=1;i<lines.size();i++) {
+    int colon=lines.at(i).indexOf(":");
+    if(colon>0) {
+      QString name=lines.at(i).left(colon).trimmed().toLower();
+      QString value=lines.at(i).mid(colon+1).trimmed();
+      if(hdrs.contains(name)) {
+	hdrs[name]+=", "+value;
+      }
+      else {
+	hdrs[name]=value;
+      }
+    }
+  }
+  if(hdrs.contains("transfer-encoding")) {
+    SendError(sock,411);
+    return false;
+  }
+  if(hdrs.contains("content-length")) {
+    content_length=hdrs.value("content-length").toUInt(&ok);
+    if(!ok) {
+      SendError(sock,400);
+      return false;
+    }
+  }
+  bool keep_alive=http11;
+  if(hdrs.value("connection").toLower().contains("close")) {
+    keep_alive=false;
+  }
+  if(hdrs.value("connection").toLower().contains("keep-alive")) {
+    keep_alive=true;
+  }
+  if((server_max_requests>0)&&(server_requests>=server_max_requests)) {
+    keep_alive=false;
+  }
+
+  //
+  // Spool the body, so that it can be handed to the request as a
+  // whole and the connection is left ready for the next request
+  //
+  if((spool_fd=SpoolBody(sock,content_length))<0) {
+    SendError(sock,500);
+    return false;
+  }
+
+  //
+  // Run it
+  //
+  if(pipe(out)<0) {
+    close(spool_fd);
+    SendError(sock,500);
+    return false;
+  }
+  if(socketpair(AF_UNIX,SOCK_STREAM,0,relay)<0) {
+    close(out[0]);
+    close(out[1]);
+    close(spool_fd);
+    SendError(sock,500);
+    return false;
+  }
+  //
+  // Check the replica here, so that the request inherits the result
+  // (and the connection) instead of repeating the check itself
+  //
+  RDDbPool::replica();
+
+  fflush(stdout);
+  fflush(stderr);
+  if((pid=fork())==0) {
+    close(out[0]);
+    close(relay[0]);
+    RunChild(sock,spool_fd,out[1],relay[1],peer,f0.at(0),f0.at(1),f0.at(2),
+	     hdrs);
+  }
+  close(out[1]);
+  close(relay[1]);
+  close(spool_fd);
+  if(pid<0) {
+    close(out[0]);
+    close(relay[0]);
+    SendError(sock,503);
+    return false;
+  }
+  keep_alive=RelayResponse(sock,out[0],http11,keep_alive);
+  close(out[0]);
+  while((waitpid(pid,&status,0)<0)&&(errno==EINTR));
+  *healthy=WIFEXITED(status)&&(WEXITSTATUS(status)==0);
+  RelayNotifications(relay[0]);
+  close(relay[0]);
+
+  return keep_alive&&(*healthy);
+}
+
+
+bool XportServer::ReadHeader(int sock,QByteArray *header)
+{
+  char data[4096];
+  ssize_t n;
+  int end;
+
+  while((end=server_pending.indexOf("\r\n\r\n"))<0) {
+    if(server_pending.size()>RDXPORT_SERVICE_MAX_HEADER_SIZE) {
+      SendError(sock,431);
+      return false;
+    }
+    if((n=recv(sock,data,sizeof(data),0))<=0) {
+      if((n<0)&&(errno==EINTR)) {
+	continue;
+      }
+      return false;
+    }
+    if(server_pending.isEmpty()) {
+      SetTimeouts(sock,RDXPORT_SERVICE_HEADER_TIMEOUT);
+    }
+    server_pending.append(data,n);
+  }
+  *header=server_pending.left(end);
+  server_pending.remove(0,end+4);
+
+  return true;
+}
+
+
+int XportServer::SpoolBody(int sock,unsigned len)
+{
+  char tempname[PATH_MAX];
+  char data[RDXPORT_SERVICE_BUFFER_SIZE];
+  unsigned n=server_pending.size();
+  ssize_t m;
+  int fd;
+
+  strncpy(tempname,(RDTempDirectory::basePath()+"/rdxportXXXXXX").toUtf8(),
+	  PATH_MAX);
+  if((fd=mkstemp(tempname))<0) {
+    rda->syslog(LOG_WARNING,"unable to create spool file [%s]",
+		strerror(errno));
+    return -1;
+  }
+  unlink(tempname);
+  if(n>len) {
+    n=len;
+  }
+  if(!WriteAll(fd,server_pending.constData(),n)) {
+    close(fd);
+    return -1;
+  }
+  server_pending.remove(0,n);
+  len-=n;
+  while(len>0) {
+    if((m=recv(sock,data,len<sizeof(data) ? len : sizeof(data),0))<=0) {
+      if((m<0)&&(errno==EINTR)) {
+	continue;
+      }
+      close(fd);
+      return -1;
+    }
+    if(!WriteAll(fd,data,m)) {
+      close(fd);
+      return -1;
+    }
+    len-=m;
+  }
+  lseek(fd,0,SEEK_SET);
+
+  return fd;
+}
+
+
+void XportServer::RunChild(int sock,int spool_fd,int out_fd,int relay_fd,
+			   const QHostAddress &peer,const QString &method,
+			   const QString &target,const QString &version,
+			   const QMap<QString,QString> &hdrs)
+{
+  //
+  // Stop listening, so that any event processing done by the request
+  // can't pick up connections meant for the worker
+  //
+  server_notifier->setEnabled(false);
+  close(server_listen_fd);
+  close(sock);
+  dup2(spool_fd,0);
+  close(spool_fd);
+  dup2(out_fd,1);
+  close(out_fd);
+  ::signal(SIGPIPE,SIG_DFL);
+
+  //
+  // Put the relay in place of the worker's ripcd(8) connection, so that
+  // any event processing done by the request can't read messages meant
+  // for the worker, or leave it part way through one. Notifications the
+  // request sends go back to the worker instead.
+  //
+  int ripc_fd=rda->ripc()->socketDescriptor();
+  if(ripc_fd>=0) {
+    dup2(relay_fd,ripc_fd);
+    fcntl(ripc_fd,F_SETFD,FD_CLOEXEC);
+  }
+  fcntl(relay_fd,F_SETFD,FD_CLOEXEC);
+  __xport_server_relay_fd=relay_fd;
+  __xport_server_child_start=QDateTime::currentDateTime();
+
+  //
+  // CGI Environment
+  //
+  QString path=target;
+  QString query;
+  int q=target.indexOf("?");
+  if(q>=0) {
+    path=target.left(q);
+    query=target.mid(q+1);
+  }
+  setenv("GATEWAY_INTERFACE","CGI/1.1",1);
+  setenv("SERVER_PROTOCOL",version.toUtf8(),1);
+  setenv("REQUEST_METHOD",method.toUtf8(),1);
+  setenv("SCRIPT_NAME",path.toUtf8(),1);
+  setenv("QUERY_STRING",query.toUtf8(),1);
+
+  //
+  // Trust a forwarded client address only from a proxy on this host
+  //
+  QString remote_addr=peer.toString();
+  if(((peer.toIPv4Address()&0xFF000000)==0x7F000000)&&
+     hdrs.contains("x-forwarded-for")) {
+    remote_addr=hdrs.value("x-forwarded-for").split(",").last().trimmed();
+  }
+  setenv("REMOTE_ADDR",remote_addr.toUtf8(),1);
+
+  //
+  // Request headers. 'Proxy' is dropped so that it can't turn up as
+  // HTTP_PROXY (httpoxy), as are names containing an underscore, which
+  // could otherwise pass themselves off as another header.
+  //
+  for(QMap<QString,QString>::const_iterator it=hdrs.begin();
+      it!=hdrs.end();it++) {
+    if((it.key()=="proxy")||it.key().contains("_")) {
+      continue;
+    }
+    if(it.key()=="content-length") {
+      setenv("CONTENT_LENGTH",it.value().toUtf8(),1);
+      continue;
+    }
+    if(it.key()=="content-type") {
+      setenv("CONTENT_TYPE",it.value().toUtf8(),1);
+      continue;
+    }
+    setenv(("HTTP_"+it.key().toUpper().replace("-","_")).toUtf8(),
+	   it.value().toUtf8(),1);
+  }
+
+  //
+  // Process it
+  //
+  atexit(__XportServerChildExit);
+  RDSqlQuery::abandonStatementCache();
+  new Xport(Xport::ServiceMode);
+  exit(0);
+}
+
+
+void XportServer::RelayNotifications(int relay_fd) const
+{
+  //
+  // Send on the notifications written by a request, which has now
+  // exited, applying them here as well since ripcd(8) doesn't echo them
+  // back to the connection they came from, and take note of the tables
+  // it changed for the benefit of later requests
+  //
+  char data[RDXPORT_SERVICE_BUFFER_SIZE];
+  QByteArray buffer;
+  ssize_t n;
+
+  while((n=read(relay_fd,data,sizeof(data)))!=0) {
+    if(n<0) {
+      if(errno==EINTR) {
+	continue;
+      }
+      break;
+    }
+    buffer.append(data,n);
+  }
+  QStringList cmds=
+    QString::fromUtf8(buffer).split("!",QString::SkipEmptyParts);
+  for(int i=0;i<cmds.size();i++) {
+    if(cmds.at(i).startsWith("ON ")) {
+      RDNotification *notify=new RDNotification();
+      if(notify->read(cmds.at(i).mid(3))) {
+	rda->ripc()->sendNotification(*notify);
+	RDRowCache::processNotification(notify);
+      }
+      delete notify;
+    }
+    if(cmds.at(i).startsWith("WT ")) {
+      QString table=cmds.at(i).mid(3);
+      RDDbPool::noteWrittenTable(table);
+      if(table=="*") {
+	RDRowCache::invalidate();
+      }
+      else {
+	if(RDRowCache::isCacheable(table)) {
+	  RDRowCache::invalidate(table);
+	}
+      }
+    }
+  }
+}
+
+
+bool XportServer::RelayResponse(int sock,int out_fd,bool http11,
+				bool keep_alive)
+{
+  char data[RDXPORT_SERVICE_BUFFER_SIZE];
+  QByteArray buffer;
+  QByteArray head;
+  int code=200;
+  QByteArray reason;
+  qint64 content_length=-1;
+  qint64 sent=0;
+  bool chunked=false;
+  bool client_ok=true;
+  bool ok=false;
+  int end=-1;
+  int sep=0;
+  ssize_t n;
+
+  //
+  // Read the CGI header
+  //
+  while(end<0) {
+    int crlf=buffer.indexOf("\r\n\r\n");
+    int lf=buffer.indexOf("\n\n");
+    if((crlf>=0)&&((lf<0)||(crlf<lf))) {
+      end=crlf;
+      sep=4;
+    }
+    else {
+      if(lf>=0) {
+	end=lf;
+	sep=2;
+      }
+      else {
+	if((n=read(out_fd,data,sizeof(data)))<=0) {
+	  if((n<0)&&(errno==EINTR)) {
+	    continue;
+	  }
+	  SendError(sock,502);
+	  return false;
+	}
+	buffer.append(data,n);
+      }
+    }
+  }
+  QList<QByteArray> lines=buffer.left(end).split('\n');
+  buffer.remove(0,end+sep);
+  for(int i=0;i<lines.size();i++) {
+    QByteArray line=lines.at(i).trimmed();
+    int colon=line.indexOf(':');
+    if(colon<=0) {
+      continue;
+    }
+    QByteArray name=line.left(colon).trimmed();
+    QByteArray value=line.mid(colon+1).trimmed();
+    QByteArray lname=name.toLower();
+    if(lname=="status") {
+      code=value.left(3).toInt();
+      reason=value.mid(4).trimmed();
+      continue;
+    }
+    if((lname=="connection")||(lname=="transfer-encoding")) {
+      continue;
+    }
+    if(lname=="content-length") {
+      content_length=value.toLongLong(&ok);
+      if(!ok) {
+	content_length=-1;
+	continue;
+      }
+    }
+    if((lname=="location")&&(code==200)) {
+      code=302;
+    }
+    head+=name+": "+value+"\r\n";
+  }
+  if((code<100)||(code>999)) {
+    code=500;
+  }
+  if(reason.isEmpty()) {
+    reason=StatusText(code).toUtf8();
+  }
+
+  //
+  // Send the HTTP header
+  //
+  if(content_length<0) {
+    if(keep_alive&&http11) {
+      chunked=true;
+      head+="Transfer-Encoding: chunked\r\n";
+    }
+    else {
+      keep_alive=false;
+    }
+  }
+  if(keep_alive) {
+    if(!http11) {
+      head+="Connection: keep-alive\r\n";
+    }
+  }
+  else {
+    head+="Connection: close\r\n";
+  }
+  head=QString().sprintf("HTTP/1.1 %d ",code).toUtf8()+reason+"\r\n"+head+
+    "\r\n";
+  client_ok=WriteAll(sock,head.constData(),head.size());
+
+  //
+  // Relay the body, continuing to drain the request even if the client
+  // has gone away so that it can finish cleanly
+  //
+  const char *body=buffer.constData();
+  n=buffer.size();
+  do {
+    if(n<0) {
+      if(errno==EINTR) {
+	continue;
+      }
+      break;
+    }
+    if(client_ok&&(n>0)) {
+      if(chunked) {
+	QByteArray size=QString().sprintf("%lX\r\n",(unsigned long)n).toUtf8();
+	client_ok=WriteAll(sock,size.constData(),size.size())&&
+	  WriteAll(sock,body,n)&&WriteAll(sock,"\r\n",2);
+      }
+      else {
+	client_ok=WriteAll(sock,body,n);
+      }
+    }
+    sent+=n;
+    body=data;
+  } while((n=read(out_fd,data,sizeof(data)))!=0);
+  if(client_ok&&chunked) {
+    client_ok=WriteAll(sock,"0\r\n\r\n",5);
+  }
+  if((content_length>=0)&&(sent!=content_length)) {
+    keep_alive=false;
+  }
+
+  return client_ok&&keep_alive;
+}
+
+
+void XportServer::SendError(int sock,int code) const
+{
+  QString body=QString().sprintf("%d ",code)+StatusText(code)+"\n";
+  QByteArray data=(QString().sprintf("HTTP/1.1 %d ",code)+StatusText(code)+
+		   "\r\n"+
+		   "Content-Type: text/plain\r\n"+
+		   QString().sprintf("Content-Length: %d\r\n",body.length())+
+		   "Connection: close\r\n"+
+		   "\r\n"+body).toUtf8();
+  WriteAll(sock,data.constData(),data.size());
+}
+
+
+bool XportServer::WriteAll(int fd,const char *data,size_t len) const
+{
+  ssize_t n;
+
+  while(len>0) {
+    if((n=write(fd,data,len))<0) {
+      if(errno==EINTR) {
+	continue;
+      }
+      return false;
+    }
+    data+=n;
+    len-=n;
+  }
+  return true;
+}
+
+
+void XportServer::SetTimeouts(int sock,int recv_secs) const
+{
+  struct timeval tv;
+
+  memset(&tv,0,sizeof(tv));
+  tv.tv_sec=recv_secs;
+  setsockopt(sock,SOL_SOCKET,SO_RCVTIMEO,&tv,sizeof(tv));
+  tv.tv_sec=RDXPORT_SERVICE_SEND_TIMEOUT;
+  setsockopt(sock,SOL_SOCKET,SO_SNDTIMEO,&tv,sizeof(tv));
+}
+
+
+QString XportServer::StatusText(int code) const
+{
+  switch(code) {
+  case 200:
+    return QString("OK");
+
+  case 206:
+    return QString("Partial Content");
+
+  case 302:
+    return QString("Found");
+
+  case 304:
+    return QString("Not Modified");
+
+  case 400:
+    return QString("Bad Request");
+
+  case 403:
+    return QString("Forbidden");
+
+  case 404:
+    return QString("Not Found");
+
+  case 411:
+    return QString("Length Required");
+
+  case 416:
+    return QString("Range Not Satisfiable");
+
+  case 431:
+    return QString("Request Header Fields Too Large");
+
+  case 500:
+    return QString("Internal Server Error");
+
+  case 502:
+    return QString("Bad Gateway");
+
+  case 503:
+    return QString("Service Unavailable");
+  }
+  return QString("Unknown");
+}
@@ -0,0 +1,107 @@
+// server.h
+//
+// Persistent service mode for rdxport.cgi(8)
+//
+//   (C) Copyright 2021 Fred Gleason <fredg@paravelsystems.com>
+//
+//   This program is free software; you can redistribute it and/or modify
+//   it under the terms of the GNU General Public License version 2 as
+//   published by the Free Software Foundation.
+//
+//   This program is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//   GNU General Public License for more details.
+//
+//   You should have received a copy of the GNU General Public
+//   License along with this program; if not, write to the Free Software
+//   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+//
+
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <sys/types.h>
+
+#include <qbytearray.h>
+#include <qhostaddress.h>
+#include <qmap.h>
+#include <qobject.h>
+#include <qsocketnotifier.h>
+
+//
+// Seconds to wait for a request header
+//
+#define RDXPORT_SERVICE_HEADER_TIMEOUT 30
+
+//
+// Seconds an idle keep-alive connection is held open
+//
+#define RDXPORT_SERVICE_KEEPALIVE_TIMEOUT 5
+
+//
+// Seconds to wait for a client to accept response data, as per the
+// 'TimeOut' directive in rd-bin.conf
+//
+#define RDXPORT_SERVICE_SEND_TIMEOUT 1200
+
+#define RDXPORT_SERVICE_MAX_HEADER_SIZE 65536
+#define RDXPORT_SERVICE_BUFFER_SIZE 65536
+
+//
+// Workers that exit sooner than this many seconds after being started
+// are respawned no faster than once a second
+//
+#define RDXPORT_SERVICE_MIN_WORKER_LIFE 5
+
+//
+// XportServer
+//
+// Runs rdxport.cgi as a long-lived HTTP/1.1 service rather than as a new
+// CGI process for each request. A master process binds the listening
+// socket and maintains a fixed pool of worker processes, each of which
+// opens its own database and ripcd(8) connections once and then serves
+// requests one at a time. Every request is handled in a child forked
+// from its worker with the usual CGI environment, so the existing command
+// handlers (and their exit()-based control flow) run unchanged while
+// inheriting the already open connections, apart from that to ripcd(8):
+// a request's notifications are passed back to its worker, which sends
+// them on. A worker is recycled after 'MaxRequests=' requests, or
+// immediately if a request child fails to exit cleanly and so may have
+// left a connection in an unknown state.
+//
+class XportServer : public QObject
+{
+  Q_OBJECT;
+ public:
+  XportServer(QObject *parent=0);
+
+ private slots:
+  void ripcConnectedData(bool state);
+  void newConnectionData(int fd);
+
+ private:
+  void RunMaster();
+  bool ServeRequest(int sock,const QHostAddress &peer,bool *healthy);
+  bool ReadHeader(int sock,QByteArray *header);
+  int SpoolBody(int sock,unsigned len);
+  void RunChild(int sock,int spool_fd,int out_fd,int relay_fd,
+		const QHostAddress &peer,const QString &method,
+		const QString &target,const QString &version,
+		const QMap<QString,QString> &hdrs);
+  bool RelayResponse(int sock,int out_fd,bool http11,bool keep_alive);
+  void RelayNotifications(int relay_fd) const;
+  void SendError(int sock,int code) const;
+  bool WriteAll(int fd,const char *data,size_t len) const;
+  void SetTimeouts(int sock,int recv_secs) const;
+  QString StatusText(int code) const;
+  int server_listen_fd;
+  QSocketNotifier *server_notifier;
+  int server_workers;
+  int server_max_requests;
+  int server_requests;
+  QByteArray server_pending;
+};
+
+
+#endif  // SERVER_H
@@ -27,6 +27,7 @@
 #include <rdapplication.h>
 #include <rdconf.h>
 #include <rddb.h>
+#include <rddbpool.h>
 #include <rdescape_string.h>
 #include <rdformpost.h>
 #include <rdsvc.h>
@@ -42,6 +43,7 @@ void Xport::ListServices()
   RDSqlQuery *q;
   RDSvc *svc;
   QString trackable;
+  QString etag;
 
   //
   // Get Options
@@ -51,7 +53,7 @@ void Xport::ListServices()
   //
   // Generate Service List
   //
-  sql=QString("select NAME from SERVICES where ");
+  sql=QString("select NAME,DESCRIPTION from SERVICES where ");
   sql2=QString("select SERVICE_NAME from USER_SERVICE_PERMS where ")+
     "USER_NAME=\""+RDEscapeString(rda->user()->name())+"\"";
   q=new RDSqlQuery(sql2);
@@ -67,12 +69,19 @@ void Xport::ListServices()
     sql+="&&(TRACK_GROUP!=\"\")&&(TRACK_GROUP is not null)";
   }
   sql+=" order by NAME";
-  q=new RDSqlQuery(sql);
+  q=new RDSqlQuery(sql,RDDbPool::replica());
+
+  //
+  // Check Validators
+  //
+  etag=QueryEtag("ListServices:"+sql,q);
+  CheckNotModified(etag,QDateTime());
 
   //
   // Process Request
   //
   printf("Content-type: application/xml\n");
+  PrintValidators(etag,QDateTime());
   printf("Status: 200\n\n");
   printf("<?xml version=\"1.0\" encoding=\"UTF-8\" ?>\n");
   printf("<serviceList>\n");
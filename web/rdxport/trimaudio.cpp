@@ -25,6 +25,7 @@
 #include <fcntl.h>
 
 #include <rdapplication.h>
+#include <rdaudioanalysis.h>
 #include <rdaudioconvert.h>
 #include <rdcart.h>
 #include <rdconf.h>
@@ -63,15 +64,38 @@ void Xport::TrimAudio()
   }
 
   //
-  // Open Audio File
+  // Use the import analysis if it is still current
   //
-  RDWaveFile *wave=new RDWaveFile(RDCut::pathName(cartnum,cutnum));
-  if(!wave->openWave()) {
-    XmlExit("No such audio",404,"trimaudio.cpp",LINE_NUMBER);
+  int start_point=-1;
+  int end_point=-1;
+  RDAudioAnalysis *ana=new RDAudioAnalysis();
+  if(ana->load(RDCut::pathName(cartnum,cutnum))&&
+     ana->hasTrimLevel(trim_level)) {
+    start_point=ana->startPoint(trim_level);
+    end_point=ana->endPoint(trim_level);
   }
-  if(!wave->hasEnergy()) {
-    XmlExit("No peak data available",400,"trimaudio.cpp",LINE_NUMBER);
+  else {
+    //
+    // Open Audio File
+    //
+    RDWaveFile *wave=new RDWaveFile(RDCut::pathName(cartnum,cutnum));
+    if(!wave->openWave()) {
+      XmlExit("No such audio",404,"trimaudio.cpp",LINE_NUMBER);
+    }
+    if(!wave->hasEnergy()) {
+      XmlExit("No peak data available",400,"trimaudio.cpp",LINE_NUMBER);
+    }
+    point=wave->startTrim(REFERENCE_LEVEL-trim_level);
+    if(point>=0) {
+      start_point=(double)point*1000.0/(double)wave->getSamplesPerSec();
+    }
+    point=wave->endTrim(REFERENCE_LEVEL-trim_level);
+    if(point>=0) {
+      end_point=(double)point*1000.0/(double)wave->getSamplesPerSec();
+    }
+    delete wave;
   }
+  delete ana;
 
   //
   // Send Data
@@ -82,16 +106,8 @@ void Xport::TrimAudio()
   printf("  <cartNumber>%u</cartNumber>\n",cartnum);
   printf("  <cutNumber>%d</cutNumber>\n",cutnum);
   printf("  <trimLevel>%d</trimLevel>\n",trim_level);
-  point=wave->startTrim(REFERENCE_LEVEL-trim_level);
-  if(point>=0) {
-    point=(double)point*1000.0/(double)wave->getSamplesPerSec();
-  }
-  printf("  <startTrimPoint>%d</startTrimPoint>\n",point);
-  point=wave->endTrim(REFERENCE_LEVEL-trim_level);
-  if(point>=0) {
-    point=(double)point*1000.0/(double)wave->getSamplesPerSec();
-  }
-  printf("  <endTrimPoint>%d</endTrimPoint>\n",point);
+  printf("  <startTrimPoint>%d</startTrimPoint>\n",start_point);
+  printf("  <endTrimPoint>%d</endTrimPoint>\n",end_point);
   printf("</trimPoint>\n");
   SendNotification(RDNotification::CartType,RDNotification::ModifyAction,
 		   QVariant(cartnum));